@@ -1207,6 +1207,7 @@ test_profiling() {
 	$UCX_READ_PROFILE -r ucx_jenkins.prof | grep "printf" -C 20
 	$UCX_READ_PROFILE -r ucx_jenkins.prof | grep -q "calc_pi"
 	$UCX_READ_PROFILE -r ucx_jenkins.prof | grep -q "print_pi"
+	$UCX_READ_PROFILE -f chrome ucx_jenkins.prof | grep -q '"name":"calc_pi"'
 }
 
 test_ucs_load() {
@@ -11,6 +11,7 @@
 
 #include "ucx_info.h"
 
+#include <ucs/arch/memcpy.h>
 #include <ucs/sys/sys.h>
 #include <ucs/time/time.h>
 #include <ucs/config/parser.h>
@@ -42,7 +43,13 @@ static const char* cpu_vendor_names[] = {
     [UCS_CPU_VENDOR_FUJITSU_ARM]      = "Fujitsu ARM"
 };
 
-static double measure_memcpy_bandwidth(size_t size)
+static void memcpy_relaxed(void *dst, const void *src, size_t size)
+{
+    ucs_memcpy_relaxed(dst, src, size);
+}
+
+static double measure_memcpy_bandwidth(ucs_memcpy_func_t func, size_t size,
+                                       double duration)
 {
     ucs_time_t start_time, end_time;
     void *src, *dst;
@@ -66,10 +73,10 @@ static double measure_memcpy_bandwidth(size_t size)
     iter = 0;
     start_time = ucs_get_time();
     do {
-        ucs_memcpy_relaxed(dst, src, size);
+        func(dst, src, size);
         end_time = ucs_get_time();
         ++iter;
-    } while (end_time < start_time + ucs_time_from_sec(0.5));
+    } while (end_time < start_time + ucs_time_from_sec(duration));
 
     result = size * iter / ucs_time_to_sec(end_time - start_time);
 
@@ -80,6 +87,36 @@ out:
     return result;
 }
 
+static void print_memcpy_kernels()
+{
+    const ucs_memcpy_kernel_t *kernels;
+    unsigned i, count;
+    size_t size;
+
+    kernels = ucs_memcpy_kernels(&count);
+    printf("# Memcpy kernels: %s, non-temporal: %s\n",
+           ucs_memcpy_selected(0)->name, ucs_memcpy_selected(1)->name);
+    printf("#   %10s", "bytes");
+    for (i = 0; i < count; ++i) {
+        if (ucs_memcpy_kernel_is_supported(&kernels[i])) {
+            printf(" %10s", kernels[i].name);
+        }
+    }
+    printf("  (GB/s)\n");
+
+    for (size = 4096; size <= 64 * UCS_MBYTE; size *= 4) {
+        printf("#   %10zu", size);
+        for (i = 0; i < count; ++i) {
+            if (ucs_memcpy_kernel_is_supported(&kernels[i])) {
+                printf(" %10.3f",
+                       measure_memcpy_bandwidth(kernels[i].func, size, 0.05) /
+                       UCS_GBYTE);
+            }
+        }
+        printf("\n");
+    }
+}
+
 void print_sys_info()
 {
     size_t size;
@@ -92,6 +129,8 @@ void print_sys_info()
     printf("# Memcpy bandwidth:\n");
     for (size = 4096; size <= 256 * UCS_MBYTE; size *= 2) {
         printf("#     %10zu bytes: %.3f MB/s\n", size,
-               measure_memcpy_bandwidth(size) / UCS_MBYTE);
+               measure_memcpy_bandwidth(memcpy_relaxed, size, 0.5) /
+               UCS_MBYTE);
     }
+    print_memcpy_kernels();
 }
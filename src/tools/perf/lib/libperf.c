@@ -400,6 +400,7 @@ static ucs_status_t ucx_perf_test_check_params(ucx_perf_params_t *params)
         ((params->send_mem_type != UCS_MEMORY_TYPE_HOST) ||
          (params->recv_mem_type != UCS_MEMORY_TYPE_HOST)) &&
         ((params->command == UCX_PERF_CMD_PUT) ||
+         (params->command == UCX_PERF_CMD_PUT_FLUSH) ||
          (params->command == UCX_PERF_CMD_GET) ||
          (params->command == UCX_PERF_CMD_ADD) ||
          (params->command == UCX_PERF_CMD_FADD) ||
@@ -947,6 +948,7 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
     switch (params->command) {
     case UCX_PERF_CMD_PUT:
     case UCX_PERF_CMD_GET:
+    case UCX_PERF_CMD_PUT_FLUSH:
         ucp_params->features |= UCP_FEATURE_RMA;
         break;
     case UCX_PERF_CMD_ADD:
@@ -972,6 +974,9 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
     case UCX_PERF_CMD_STREAM:
         ucp_params->features |= UCP_FEATURE_STREAM;
         break;
+    case UCX_PERF_CMD_AM:
+        ucp_params->features |= UCP_FEATURE_AM;
+        break;
     default:
         if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
             ucs_error("Invalid test command");
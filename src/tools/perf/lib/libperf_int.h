@@ -25,6 +25,7 @@ BEGIN_C_DECLS
 
 #define TIMING_QUEUE_SIZE    2048
 #define UCT_PERF_TEST_AM_ID  5
+#define UCP_PERF_TEST_AM_ID  5
 #define ADDR_BUF_SIZE        2048
 
 
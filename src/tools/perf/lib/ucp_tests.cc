@@ -34,10 +34,28 @@ public:
     ucp_perf_test_runner(ucx_perf_context_t &perf) :
         m_perf(perf),
         m_outstanding(0),
-        m_max_outstanding(m_perf.params.max_outstanding)
+        m_max_outstanding(m_perf.params.max_outstanding),
+        m_am_rx_count(0)
 
     {
+        ucs_status_t status;
+
         ucs_assert_always(m_max_outstanding > 0);
+
+        if (CMD == UCX_PERF_CMD_AM) {
+            status = ucp_worker_set_am_handler(m_perf.ucp.worker,
+                                               UCP_PERF_TEST_AM_ID, am_data_cb,
+                                               this, UCP_AM_FLAG_WHOLE_MSG);
+            ucs_assert_always(status == UCS_OK);
+        }
+    }
+
+    ~ucp_perf_test_runner()
+    {
+        if (CMD == UCX_PERF_CMD_AM) {
+            ucp_worker_set_am_handler(m_perf.ucp.worker, UCP_PERF_TEST_AM_ID,
+                                      NULL, NULL, 0);
+        }
     }
 
     void create_iov_buffer(ucp_dt_iov_t *iov, void *buffer)
@@ -114,6 +132,27 @@ public:
         return ucs_likely(status == UCS_OK) ? length : status;
     }
 
+    ucs_status_t UCS_F_ALWAYS_INLINE ep_flush(ucp_ep_h ep)
+    {
+        ucp_request_param_t param;
+        ucs_status_t status;
+        void *request;
+
+        param.op_attr_mask = 0;
+        request            = ucp_ep_flush_nbx(ep, &param);
+        if (!UCS_PTR_IS_PTR(request)) {
+            return UCS_PTR_STATUS(request);
+        }
+
+        while ((status = ucp_request_check_status(request)) ==
+                UCS_INPROGRESS) {
+            progress_requestor();
+        }
+        ucp_request_free(request);
+
+        return status;
+    }
+
     static void send_cb(void *request, ucs_status_t status)
     {
         ucp_perf_request_t *r      = reinterpret_cast<ucp_perf_request_t*>(
@@ -143,6 +182,57 @@ public:
         ucp_request_free(request);
     }
 
+    static void am_recv_data_cb(void *request, ucs_status_t status,
+                                size_t length, void *user_data)
+    {
+        ucp_perf_test_runner *test = (ucp_perf_test_runner*)user_data;
+
+        ++test->m_am_rx_count;
+        ucp_request_free(request);
+    }
+
+    static ucs_status_t am_data_cb(void *arg, void *data, size_t length,
+                                   ucp_ep_h reply_ep, unsigned flags)
+    {
+        ucp_perf_test_runner *test = (ucp_perf_test_runner*)arg;
+        ucp_request_param_t param;
+        void *request;
+
+        if (!(flags & UCP_CB_PARAM_FLAG_RNDV)) {
+            ++test->m_am_rx_count;
+            return UCS_OK;
+        }
+
+        /* rendezvous: fetch the payload to the receive buffer */
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                             UCP_OP_ATTR_FIELD_USER_DATA;
+        param.cb.recv_am   = am_recv_data_cb;
+        param.user_data    = test;
+        request            = ucp_am_recv_data_nbx(test->m_perf.ucp.worker, data,
+                                                  test->m_perf.recv_buffer,
+                                                  length, &param);
+        if (UCS_PTR_IS_ERR(request)) {
+            /* the parameters were rejected and the descriptor was not
+             * consumed, return the error to drop the message */
+            ucs_error("ucp_am_recv_data_nbx() failed: %s",
+                      ucs_status_string(UCS_PTR_STATUS(request)));
+            ++test->m_am_rx_count;
+            return UCS_PTR_STATUS(request);
+        } else if (request == NULL) {
+            /* the data was received immediately */
+            ++test->m_am_rx_count;
+        }
+
+        return UCS_INPROGRESS;
+    }
+
+    void UCS_F_ALWAYS_INLINE wait_am_recv(unsigned count)
+    {
+        while (m_am_rx_count < count) {
+            progress_responder();
+        }
+    }
+
     void UCS_F_ALWAYS_INLINE wait_window(unsigned n, bool is_requestor)
     {
         while (m_outstanding >= (m_max_outstanding - n + 1)) {
@@ -158,6 +248,7 @@ public:
     send(ucp_ep_h ep, void *buffer, unsigned length, ucp_datatype_t datatype,
          uint8_t sn, uint64_t remote_addr, ucp_rkey_h rkey)
     {
+        ucs_status_t status;
         void *request;
 
         /* coverity[switch_selector_expr_is_constant] */
@@ -165,6 +256,7 @@ public:
         case UCX_PERF_CMD_TAG:
         case UCX_PERF_CMD_TAG_SYNC:
         case UCX_PERF_CMD_STREAM:
+        case UCX_PERF_CMD_AM:
             wait_window(1, true);
             /* coverity[switch_selector_expr_is_constant] */
             switch (CMD) {
@@ -180,6 +272,10 @@ public:
                 request = ucp_stream_send_nb(ep, buffer, length, datatype,
                                              send_cb, 0);
                 break;
+            case UCX_PERF_CMD_AM:
+                request = ucp_am_send_nb(ep, UCP_PERF_TEST_AM_ID, buffer,
+                                         length, datatype, send_cb, 0);
+                break;
             default:
                 request = UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
                 break;
@@ -195,6 +291,12 @@ public:
             return ucp_put(ep, buffer, length, remote_addr, rkey);
         case UCX_PERF_CMD_GET:
             return ucp_get(ep, buffer, length, remote_addr, rkey);
+        case UCX_PERF_CMD_PUT_FLUSH:
+            status = ucp_put_nbi(ep, buffer, length, remote_addr, rkey);
+            if (UCS_STATUS_IS_ERR(status)) {
+                return status;
+            }
+            return ep_flush(ep);
         case UCX_PERF_CMD_ADD:
             if (length == sizeof(uint32_t)) {
                 return ucp_atomic_add32(ep, 1, remote_addr, rkey);
@@ -282,6 +384,7 @@ public:
         case UCX_PERF_CMD_FADD:
         case UCX_PERF_CMD_SWAP:
         case UCX_PERF_CMD_CSWAP:
+        case UCX_PERF_CMD_PUT_FLUSH:
             /* coverity[switch_selector_expr_is_constant] */
             switch (TYPE) {
             case UCX_PERF_TEST_TYPE_STREAM_UNI:
@@ -296,6 +399,10 @@ public:
             } else {
                 return recv_stream(ep, buffer, length, datatype);
             }
+        case UCX_PERF_CMD_AM:
+            wait_am_recv(1);
+            --m_am_rx_count;
+            return UCS_OK;
         default:
             return UCS_ERR_INVALID_PARAM;
         }
@@ -452,6 +559,63 @@ public:
         return UCS_OK;
     }
 
+    ucs_status_t run_stream_bi()
+    {
+        ucp_ep_h ep;
+        void *send_buffer;
+        ucp_datatype_t send_datatype;
+        uint64_t remote_addr;
+        ucp_rkey_h rkey;
+        size_t length, send_length;
+        unsigned send_count;
+        uint8_t sn;
+
+        length        = ucx_perf_get_message_size(&m_perf.params);
+        ucs_assert(length >= sizeof(psn_t));
+
+        ucp_perf_test_prepare_iov_buffers();
+
+        ucp_perf_barrier(&m_perf);
+
+        ucx_perf_test_start_clock(&m_perf);
+
+        ucx_perf_omp_barrier(&m_perf);
+
+        send_buffer   = m_perf.send_buffer;
+        ep            = m_perf.ucp.ep;
+        remote_addr   = m_perf.ucp.remote_addr;
+        rkey          = m_perf.ucp.rkey;
+        sn            = 0;
+        send_count    = 0;
+        send_length   = length;
+        send_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.send_datatype,
+                                                   m_perf.ucp.send_iov, &send_length,
+                                                   &send_buffer);
+
+        /* both sides send, incoming messages are consumed by the receive
+         * handler while waiting for the send window */
+        UCX_PERF_TEST_FOREACH(&m_perf) {
+            send(ep, send_buffer, send_length, send_datatype, sn, remote_addr,
+                 rkey);
+            ucx_perf_update(&m_perf, 1, length);
+            ++send_count;
+            ++sn;
+        }
+
+        /* the peer sends the same number of messages */
+        wait_am_recv(send_count);
+
+        wait_window(m_max_outstanding, true);
+        flush();
+
+        ucx_perf_omp_barrier(&m_perf);
+
+        ucx_perf_get_time(&m_perf);
+
+        ucp_perf_barrier(&m_perf);
+        return UCS_OK;
+    }
+
     ucs_status_t run()
     {
         /* coverity[switch_selector_expr_is_constant] */
@@ -461,6 +625,7 @@ public:
         case UCX_PERF_TEST_TYPE_STREAM_UNI:
             return run_stream_uni();
         case UCX_PERF_TEST_TYPE_STREAM_BI:
+            return run_stream_bi();
         default:
             return UCS_ERR_INVALID_PARAM;
         }
@@ -528,6 +693,7 @@ private:
     ucx_perf_context_t &m_perf;
     unsigned           m_outstanding;
     const unsigned     m_max_outstanding;
+    unsigned           m_am_rx_count;
 };
 
 
@@ -562,6 +728,10 @@ private:
               UCX_PERF_TEST_FLAG_TAG_WILDCARD|UCX_PERF_TEST_FLAG_TAG_UNEXP_PROBE, \
               UCX_PERF_TEST_FLAG_TAG_WILDCARD|UCX_PERF_TEST_FLAG_TAG_UNEXP_PROBE)
 
+#define TEST_CASE_ALL_AM(_perf, _case) \
+    TEST_CASE(_perf, UCS_PP_TUPLE_0 _case, UCS_PP_TUPLE_1 _case, \
+              0, UCX_PERF_TEST_FLAG_ONE_SIDED)
+
 #define TEST_CASE_ALL_OSD(_perf, _case) \
     TEST_CASE(_perf, UCS_PP_TUPLE_0 _case, UCS_PP_TUPLE_1 _case, \
               0, UCX_PERF_TEST_FLAG_ONE_SIDED) \
@@ -577,7 +747,8 @@ ucs_status_t ucp_perf_test_dispatch(ucx_perf_context_t *perf)
         (UCX_PERF_CMD_ADD,   UCX_PERF_TEST_TYPE_STREAM_UNI),
         (UCX_PERF_CMD_FADD,  UCX_PERF_TEST_TYPE_STREAM_UNI),
         (UCX_PERF_CMD_SWAP,  UCX_PERF_TEST_TYPE_STREAM_UNI),
-        (UCX_PERF_CMD_CSWAP, UCX_PERF_TEST_TYPE_STREAM_UNI)
+        (UCX_PERF_CMD_CSWAP, UCX_PERF_TEST_TYPE_STREAM_UNI),
+        (UCX_PERF_CMD_PUT_FLUSH, UCX_PERF_TEST_TYPE_STREAM_UNI)
         );
 
     UCS_PP_FOREACH(TEST_CASE_ALL_TAG, perf,
@@ -592,6 +763,12 @@ ucs_status_t ucp_perf_test_dispatch(ucx_perf_context_t *perf)
         (UCX_PERF_CMD_STREAM,   UCX_PERF_TEST_TYPE_PINGPONG)
         );
 
+    UCS_PP_FOREACH(TEST_CASE_ALL_AM, perf,
+        (UCX_PERF_CMD_AM,       UCX_PERF_TEST_TYPE_PINGPONG),
+        (UCX_PERF_CMD_AM,       UCX_PERF_TEST_TYPE_STREAM_UNI),
+        (UCX_PERF_CMD_AM,       UCX_PERF_TEST_TYPE_STREAM_BI)
+        );
+
     ucs_error("Invalid test case: %d/%d/0x%x",
               perf->params.command, perf->params.test_type,
               perf->params.flags);
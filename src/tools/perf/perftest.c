@@ -162,6 +162,18 @@ test_type_t tests[] = {
     {"stream_lat", UCX_PERF_API_UCP, UCX_PERF_CMD_STREAM, UCX_PERF_TEST_TYPE_PINGPONG,
      "stream latency", "latency", 1},
 
+    {"ucp_am_lat", UCX_PERF_API_UCP, UCX_PERF_CMD_AM, UCX_PERF_TEST_TYPE_PINGPONG,
+     "active message latency", "latency", 1},
+
+    {"ucp_am_bw", UCX_PERF_API_UCP, UCX_PERF_CMD_AM, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "active message bandwidth / message rate", "overhead", 32},
+
+    {"ucp_am_bibw", UCX_PERF_API_UCP, UCX_PERF_CMD_AM, UCX_PERF_TEST_TYPE_STREAM_BI,
+     "active message bidirectional bandwidth / message rate", "overhead", 32},
+
+    {"ucp_put_flush", UCX_PERF_API_UCP, UCX_PERF_CMD_PUT_FLUSH, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "put with remote completion (put + ep flush) round-trip latency / bandwidth", "latency", 1},
+
      {NULL}
 };
 
@@ -10,6 +10,7 @@
 
 #include <ucs/profile/profile.h>
 #include <ucs/datastruct/khash.h>
+#include <ucs/sys/math.h>
 
 #include <sys/signal.h>
 #include <sys/fcntl.h>
@@ -23,6 +24,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <errno.h>
+#include <inttypes.h>
 
 
 #define INDENT             4
@@ -52,6 +54,12 @@
     fprintf(stderr, "Error: " _fmt "\n", ## __VA_ARGS__)
 
 
+typedef enum {
+    OUTPUT_FORMAT_TEXT,
+    OUTPUT_FORMAT_CHROME
+} output_format_t;
+
+
 typedef enum {
     TIME_UNITS_NSEC,
     TIME_UNITS_USEC,
@@ -64,6 +72,7 @@ typedef enum {
 typedef struct options {
     const char                   *filename;
     int                          raw;
+    output_format_t              format;
     time_units_t                 time_units;
     int                          thread_list[MAX_THREADS + 1];
 } options_t;
@@ -428,16 +437,60 @@ out:
 
 KHASH_MAP_INIT_INT64(request_ids, size_t)
 
+/*
+ * Fill scope_ends[i] with the record which closes the scope opened by record i,
+ * or NULL if the scope was not closed. Returns the minimal nesting level, which
+ * is negative if the log starts in the middle of a scope.
+ */
+static int find_scope_ends(const profile_data_t *data,
+                           const profile_thread_data_t *thread,
+                           const ucs_profile_record_t **scope_ends)
+{
+    const ucs_profile_record_t **stack[UCS_PROFILE_STACK_MAX * 2];
+    const ucs_profile_record_t *rec, **sep;
+    const ucs_profile_location_t *loc;
+    int nesting, min_nesting;
+
+    memset(stack, 0, sizeof(stack));
+
+    /* Find the first record with minimal nesting level, which is the base of call stack */
+    nesting         = 0;
+    min_nesting     = 0;
+    for (rec = thread->records;
+         rec < thread->records + thread->header->num_records; ++rec) {
+        loc = &data->locations[rec->location];
+        switch (loc->type) {
+        case UCS_PROFILE_TYPE_SCOPE_BEGIN:
+            stack[nesting + UCS_PROFILE_STACK_MAX] = &scope_ends[rec - thread->records];
+            ++nesting;
+            break;
+        case UCS_PROFILE_TYPE_SCOPE_END:
+            --nesting;
+            if (nesting < min_nesting) {
+                min_nesting     = nesting;
+            }
+            sep = stack[nesting + UCS_PROFILE_STACK_MAX];
+            if (sep != NULL) {
+                *sep = rec;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return min_nesting;
+}
+
 static void show_profile_data_log(profile_data_t *data, options_t *opts,
                                   int thread_idx)
 {
     profile_thread_data_t *thread = &data->threads[thread_idx];
     size_t num_records            = thread->header->num_records;
     size_t reqid_ctr              = 1;
-    const ucs_profile_record_t **stack[UCS_PROFILE_STACK_MAX * 2];
     const ucs_profile_record_t **scope_ends;
     const ucs_profile_location_t *loc;
-    const ucs_profile_record_t *rec, *se, **sep;
+    const ucs_profile_record_t *rec, *se;
     int nesting, min_nesting;
     uint64_t prev_time;
     const char *action;
@@ -472,32 +525,7 @@ static void show_profile_data_log(profile_data_t *data, options_t *opts,
            CLEAR_COLOR);
     printf("\n");
 
-    memset(stack, 0, sizeof(stack));
-
-    /* Find the first record with minimal nesting level, which is the base of call stack */
-    nesting         = 0;
-    min_nesting     = 0;
-    for (rec = thread->records; rec < thread->records + num_records; ++rec) {
-        loc = &data->locations[rec->location];
-        switch (loc->type) {
-        case UCS_PROFILE_TYPE_SCOPE_BEGIN:
-            stack[nesting + UCS_PROFILE_STACK_MAX] = &scope_ends[rec - thread->records];
-            ++nesting;
-            break;
-        case UCS_PROFILE_TYPE_SCOPE_END:
-            --nesting;
-            if (nesting < min_nesting) {
-                min_nesting     = nesting;
-            }
-            sep = stack[nesting + UCS_PROFILE_STACK_MAX];
-            if (sep != NULL) {
-                *sep = rec;
-            }
-            break;
-        default:
-            break;
-        }
-    }
+    min_nesting = find_scope_ends(data, thread, scope_ends);
 
     if (num_records > 0) {
         prev_time = thread->records[0].timestamp;
@@ -591,6 +619,267 @@ static void show_profile_data_log(profile_data_t *data, options_t *opts,
     free(scope_ends);
 }
 
+typedef struct {
+    size_t                       id;       /* Unique request id */
+    uint32_t                     location; /* Location of REQUEST_NEW record */
+} trace_request_t;
+
+KHASH_MAP_INIT_INT64(trace_requests, trace_request_t)
+
+static void print_json_string(const char *str)
+{
+    const char *p;
+
+    putchar('"');
+    for (p = str; *p != '\0'; ++p) {
+        if ((*p == '"') || (*p == '\\')) {
+            printf("\\%c", *p);
+        } else if ((unsigned char)*p < 0x20) {
+            printf("\\u%04x", *p);
+        } else {
+            putchar(*p);
+        }
+    }
+    putchar('"');
+}
+
+/* Trace event timestamps are in microseconds */
+static double trace_timestamp(const profile_data_t *data, uint64_t base,
+                              uint64_t time)
+{
+    return (time - base) * 1e6 / data->header->one_second;
+}
+
+static void show_trace_event(const profile_data_t *data, const char *name,
+                             const char *cat, const char *phase,
+                             const profile_thread_data_t *thread,
+                             double ts, int *first)
+{
+    printf("%s\n  {\"name\":", *first ? "" : ",");
+    print_json_string(name);
+    printf(",\"cat\":\"%s\",\"ph\":\"%s\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f",
+           cat, phase, data->header->pid, thread->header->tid, ts);
+    *first = 0;
+}
+
+static void show_trace_location_args(const ucs_profile_location_t *loc)
+{
+    printf(",\"args\":{\"function\":");
+    print_json_string(loc->function);
+    printf(",\"file\":");
+    print_json_string(basename(loc->file));
+    printf(",\"line\":%d}", loc->line);
+}
+
+/* Close the async span and the flow of a request */
+static void show_trace_request_end(const profile_data_t *data,
+                                   const trace_request_t *request,
+                                   const profile_thread_data_t *thread,
+                                   double ts, int *first)
+{
+    const char *name = data->locations[request->location].name;
+
+    show_trace_event(data, name, "request", "e", thread, ts, first);
+    printf(",\"id\":\"0x%zx\"}", request->id);
+    show_trace_event(data, name, "request", "f", thread, ts, first);
+    printf(",\"id\":\"0x%zx\",\"bp\":\"e\"}", request->id);
+}
+
+/*
+ * Export the log as Chrome trace-event JSON, which can be loaded by
+ * chrome://tracing or https://ui.perfetto.dev. Scopes become complete events
+ * on their thread track, samples become instant events, and every request
+ * becomes an async span from REQUEST_NEW to REQUEST_FREE. The request records
+ * are also connected by flow arrows, which show how a request moves between
+ * the scopes (and threads) which handled it.
+ */
+static int show_profile_data_chrome(profile_data_t *data, options_t *opts)
+{
+    const ucs_profile_record_t ***scope_ends = NULL;
+    const ucs_profile_record_t **cursors     = NULL;
+    const ucs_profile_record_t *rec, *se, *end;
+    const profile_thread_data_t *thread, *rec_thread;
+    const ucs_profile_location_t *loc;
+    khash_t(trace_requests) requests;
+    trace_request_t *request;
+    size_t request_ctr;
+    uint64_t base;
+    int first, ret, hash_extra_status;
+    khiter_t hash_it;
+    unsigned i, num_threads, rec_idx;
+    double ts;
+
+    if (!(data->header->mode & UCS_BIT(UCS_PROFILE_MODE_LOG))) {
+        print_error("trace export requires a profile collected in 'log' mode");
+        return -EINVAL;
+    }
+
+    for (num_threads = 0; opts->thread_list[num_threads] != -1; ++num_threads);
+
+    scope_ends = calloc(num_threads, sizeof(*scope_ends));
+    cursors    = calloc(num_threads, sizeof(*cursors));
+    if ((scope_ends == NULL) || (cursors == NULL)) {
+        print_error("failed to allocate threads info");
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    base = UINT64_MAX;
+    for (i = 0; i < num_threads; ++i) {
+        thread        = &data->threads[opts->thread_list[i] - 1];
+        scope_ends[i] = calloc(thread->header->num_records + 1,
+                               sizeof(*scope_ends[i]));
+        if (scope_ends[i] == NULL) {
+            print_error("failed to allocate memory for scope ends");
+            ret = -ENOMEM;
+            goto out;
+        }
+
+        find_scope_ends(data, thread, scope_ends[i]);
+        cursors[i] = thread->records;
+        base       = ucs_min(base, thread->header->start_time);
+        if (thread->header->num_records > 0) {
+            base = ucs_min(base, thread->records[0].timestamp);
+        }
+    }
+
+    printf("{\"displayTimeUnit\":\"ns\",\n");
+    printf(" \"otherData\":{\"host\":");
+    print_json_string(data->header->hostname);
+    printf(",\"command\":");
+    print_json_string(data->header->cmdline);
+    printf(",\"ucs_lib\":");
+    print_json_string(data->header->ucs_path);
+    printf("},\n");
+    printf(" \"traceEvents\":[");
+
+    first = 1;
+    for (i = 0; i < num_threads; ++i) {
+        thread = &data->threads[opts->thread_list[i] - 1];
+        show_trace_event(data, "thread_name", "__metadata", "M", thread, 0,
+                         &first);
+        printf(",\"args\":{\"name\":\"thread %d%s\"}}", opts->thread_list[i],
+               (thread->header->tid == data->header->pid) ? " (main)" : "");
+    }
+
+    kh_init_inplace(trace_requests, &requests);
+    request_ctr = 1;
+
+    /* Merge the records of all threads by timestamp, so request events are
+     * processed in order even when a request moves between threads */
+    for (;;) {
+        rec_idx = num_threads;
+        for (i = 0; i < num_threads; ++i) {
+            thread = &data->threads[opts->thread_list[i] - 1];
+            if ((cursors[i] < thread->records + thread->header->num_records) &&
+                ((rec_idx == num_threads) ||
+                 (cursors[i]->timestamp < cursors[rec_idx]->timestamp))) {
+                rec_idx = i;
+            }
+        }
+
+        if (rec_idx == num_threads) {
+            break;
+        }
+
+        rec_thread = &data->threads[opts->thread_list[rec_idx] - 1];
+        rec        = cursors[rec_idx]++;
+        loc        = &data->locations[rec->location];
+        ts         = trace_timestamp(data, base, rec->timestamp);
+
+        switch (loc->type) {
+        case UCS_PROFILE_TYPE_SCOPE_BEGIN:
+            se = scope_ends[rec_idx][rec - rec_thread->records];
+            if (se != NULL) {
+                end = se;
+                loc = &data->locations[se->location];
+            } else {
+                end = NULL; /* unfinished scope */
+            }
+            show_trace_event(data, loc->name, "scope", "X", rec_thread, ts,
+                             &first);
+            printf(",\"dur\":%.3f",
+                   (end != NULL) ?
+                   trace_timestamp(data, rec->timestamp, end->timestamp) :
+                   trace_timestamp(data, rec->timestamp,
+                                   ucs_max(rec_thread->header->end_time,
+                                           rec->timestamp)));
+            show_trace_location_args(loc);
+            printf("}");
+            break;
+        case UCS_PROFILE_TYPE_SAMPLE:
+            show_trace_event(data, loc->name, "sample", "i", rec_thread, ts,
+                             &first);
+            printf(",\"s\":\"t\"");
+            show_trace_location_args(loc);
+            printf("}");
+            break;
+        case UCS_PROFILE_TYPE_REQUEST_NEW:
+            hash_it = kh_put(trace_requests, &requests, rec->param64,
+                             &hash_extra_status);
+            if (hash_it == kh_end(&requests)) {
+                break; /* error inserting to hash */
+            }
+
+            request = &kh_value(&requests, hash_it);
+            if (hash_extra_status == 0) {
+                /* The old request was not released, end its span before the
+                 * new one starts, otherwise the viewer leaves it open */
+                show_trace_request_end(data, request, rec_thread, ts, &first);
+            }
+
+            request->id       = request_ctr++;
+            request->location = rec->location;
+
+            show_trace_event(data, loc->name, "request", "b", rec_thread, ts,
+                             &first);
+            printf(",\"id\":\"0x%zx\",\"args\":{\"address\":\"0x%" PRIx64 "\"}}",
+                   request->id, rec->param64);
+            show_trace_event(data, loc->name, "request", "s", rec_thread, ts,
+                             &first);
+            printf(",\"id\":\"0x%zx\"}", request->id);
+            break;
+        case UCS_PROFILE_TYPE_REQUEST_EVENT:
+        case UCS_PROFILE_TYPE_REQUEST_FREE:
+            hash_it = kh_get(trace_requests, &requests, rec->param64);
+            if (hash_it == kh_end(&requests)) {
+                break; /* could not find request */
+            }
+
+            request = &kh_value(&requests, hash_it);
+            if (loc->type == UCS_PROFILE_TYPE_REQUEST_EVENT) {
+                show_trace_event(data, loc->name, "request", "n", rec_thread,
+                                 ts, &first);
+                printf(",\"id\":\"0x%zx\",\"args\":{\"param\":%u}}",
+                       request->id, rec->param32);
+                show_trace_event(data, loc->name, "request", "t", rec_thread,
+                                 ts, &first);
+                printf(",\"id\":\"0x%zx\"}", request->id);
+            } else {
+                show_trace_request_end(data, request, rec_thread, ts, &first);
+                kh_del(trace_requests, &requests, hash_it);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    printf("\n]}\n");
+    kh_destroy_inplace(trace_requests, &requests);
+    ret = 0;
+
+out:
+    if (scope_ends != NULL) {
+        for (i = 0; i < num_threads; ++i) {
+            free(scope_ends[i]);
+        }
+    }
+    free(scope_ends);
+    free(cursors);
+    return ret;
+}
+
 static void close_pipes()
 {
     close(output_pipefds[0]);
@@ -751,6 +1040,10 @@ static int show_profile_data(profile_data_t *data, options_t *opts)
         }
     }
 
+    if (opts->format == OUTPUT_FORMAT_CHROME) {
+        return show_profile_data_chrome(data, opts);
+    }
+
     /* redirect output if needed */
     if (!opts->raw) {
         ret = redirect_output(data, opts);
@@ -781,6 +1074,10 @@ static void usage()
     printf("Usage: ucx_read_profile [options] [profile-file]\n");
     printf("Options are:\n");
     printf("  -r              Show raw output\n");
+    printf("  -f <format>     Select output format:\n");
+    printf("                     text   - human-readable text (default)\n");
+    printf("                     chrome - Chrome trace-event JSON of the log, "
+           "for chrome://tracing or ui.perfetto.dev\n");
     printf("  -T <threads>    Comma-separated list of threads to show, "
            "e.g. \"1,2,3\", or \"all\" to show all threads\n");
     printf("  -t <units>      Select time units to use:\n");
@@ -796,17 +1093,29 @@ static int parse_args(int argc, char **argv, options_t *opts)
     int ret, c;
 
     opts->raw         = !isatty(fileno(stdout));
+    opts->format      = OUTPUT_FORMAT_TEXT;
     opts->time_units  = TIME_UNITS_USEC;
     ret = parse_thread_list(opts->thread_list, "all");
     if (ret < 0) {
         return ret;
     }
 
-    while ( (c = getopt(argc, argv, "rT:t:h")) != -1 ) {
+    while ( (c = getopt(argc, argv, "rf:T:t:h")) != -1 ) {
         switch (c) {
         case 'r':
             opts->raw = 1;
             break;
+        case 'f':
+            if (!strcasecmp(optarg, "text")) {
+                opts->format = OUTPUT_FORMAT_TEXT;
+            } else if (!strcasecmp(optarg, "chrome")) {
+                opts->format = OUTPUT_FORMAT_CHROME;
+            } else {
+                print_error("invalid output format '%s'\n", optarg);
+                usage();
+                return -1;
+            }
+            break;
         case 'T':
             ret = parse_thread_list(opts->thread_list, optarg);
             if (ret < 0) {
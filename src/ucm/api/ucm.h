@@ -53,7 +53,12 @@ typedef enum ucm_event_type {
      * existing memory allocations.
      * Currently implemented only for @ref UCM_EVENT_MEM_TYPE_ALLOC.
      */
-    UCM_EVENT_FLAG_EXISTING_ALLOC = UCS_BIT(25)
+    UCM_EVENT_FLAG_EXISTING_ALLOC = UCS_BIT(25),
+
+    /* Deliver @ref UCM_EVENT_VM_UNMAPPED events to the handler only if the
+     * unmapped range may overlap a range added by @ref ucm_event_filter_add.
+     */
+    UCM_EVENT_FLAG_ADDR_FILTER    = UCS_BIT(26)
 
 } ucm_event_type_t;
 
@@ -272,6 +277,32 @@ ucs_status_t ucm_set_event_handler(int events, int priority,
 void ucm_unset_event_handler(int events, ucm_event_callback_t cb, void *arg);
 
 
+/**
+ * @brief Add an address range to the memory events filter.
+ *
+ * Handlers installed with @ref UCM_EVENT_FLAG_ADDR_FILTER receive
+ * @ref UCM_EVENT_VM_UNMAPPED events only for ranges which may overlap one of
+ * the ranges added to the filter. The filter is coarse, so a handler may still
+ * get events for unrelated ranges. A range may be added several times, and has
+ * to be removed the same number of times.
+ *
+ * @param [in]  address    Start of the address range.
+ * @param [in]  size       Size of the address range.
+ */
+void ucm_event_filter_add(const void *address, size_t size);
+
+
+/**
+ * @brief Remove an address range from the memory events filter.
+ *
+ * @param [in]  address    Start of the address range, as passed to
+ *                          @ref ucm_event_filter_add.
+ * @param [in]  size       Size of the address range, as passed to
+ *                          @ref ucm_event_filter_add.
+ */
+void ucm_event_filter_remove(const void *address, size_t size);
+
+
 /**
  * @brief Add memory events to the external events list.
  *
@@ -133,8 +133,9 @@ static void ucm_cudafree_dispatch_events(CUdeviceptr dptr, const char *func_name
 CUresult ucm_cuMemFree(CUdeviceptr dptr)
 {
     CUresult ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_cuMemFree(dptr=%p)",(void*)dptr);
 
@@ -142,15 +143,16 @@ CUresult ucm_cuMemFree(CUdeviceptr dptr)
 
     ret = ucm_orig_cuMemFree(dptr);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 CUresult ucm_cuMemFreeHost(void *p)
 {
     CUresult ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_cuMemFreeHost(ptr=%p)", p);
 
@@ -158,15 +160,16 @@ CUresult ucm_cuMemFreeHost(void *p)
 
     ret = ucm_orig_cuMemFreeHost(p);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 CUresult ucm_cuMemAlloc(CUdeviceptr *dptr, size_t size)
 {
     CUresult ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cuMemAlloc(dptr, size);
     if (ret == CUDA_SUCCESS) {
@@ -175,15 +178,16 @@ CUresult ucm_cuMemAlloc(CUdeviceptr *dptr, size_t size)
         ucm_cuda_set_ptr_attr(*dptr);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 CUresult ucm_cuMemAllocManaged(CUdeviceptr *dptr, size_t size, unsigned int flags)
 {
     CUresult ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cuMemAllocManaged(dptr, size, flags);
     if (ret == CUDA_SUCCESS) {
@@ -193,7 +197,7 @@ CUresult ucm_cuMemAllocManaged(CUdeviceptr *dptr, size_t size, unsigned int flag
                                     UCS_MEMORY_TYPE_CUDA_MANAGED);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
@@ -202,8 +206,9 @@ CUresult ucm_cuMemAllocPitch(CUdeviceptr *dptr, size_t *pPitch,
                              unsigned int ElementSizeBytes)
 {
     CUresult ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cuMemAllocPitch(dptr, pPitch, WidthInBytes, Height, ElementSizeBytes);
     if (ret == CUDA_SUCCESS) {
@@ -214,44 +219,47 @@ CUresult ucm_cuMemAllocPitch(CUdeviceptr *dptr, size_t *pPitch,
         ucm_cuda_set_ptr_attr(*dptr);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 CUresult ucm_cuMemHostGetDevicePointer(CUdeviceptr *pdptr, void *p, unsigned int Flags)
 {
     CUresult ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cuMemHostGetDevicePointer(pdptr, p, Flags);
     if (ret == CUDA_SUCCESS) {
         ucm_trace("ucm_cuMemHostGetDevicePointer(pdptr=%p p=%p)",(void *)*pdptr, p);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 CUresult ucm_cuMemHostUnregister(void *p)
 {
     CUresult ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_cuMemHostUnregister(ptr=%p)", p);
 
     ret = ucm_orig_cuMemHostUnregister(p);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 cudaError_t ucm_cudaFree(void *devPtr)
 {
     cudaError_t ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_cudaFree(devPtr=%p)", devPtr);
 
@@ -259,7 +267,7 @@ cudaError_t ucm_cudaFree(void *devPtr)
 
     ret = ucm_orig_cudaFree(devPtr);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return ret;
 }
@@ -267,8 +275,9 @@ cudaError_t ucm_cudaFree(void *devPtr)
 cudaError_t ucm_cudaFreeHost(void *ptr)
 {
     cudaError_t ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_cudaFreeHost(ptr=%p)", ptr);
 
@@ -276,15 +285,16 @@ cudaError_t ucm_cudaFreeHost(void *ptr)
 
     ret = ucm_orig_cudaFreeHost(ptr);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 cudaError_t ucm_cudaMalloc(void **devPtr, size_t size)
 {
     cudaError_t ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cudaMalloc(devPtr, size);
     if (ret == cudaSuccess) {
@@ -293,7 +303,7 @@ cudaError_t ucm_cudaMalloc(void **devPtr, size_t size)
         ucm_cuda_set_ptr_attr((CUdeviceptr) *devPtr);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return ret;
 }
@@ -301,8 +311,9 @@ cudaError_t ucm_cudaMalloc(void **devPtr, size_t size)
 cudaError_t ucm_cudaMallocManaged(void **devPtr, size_t size, unsigned int flags)
 {
     cudaError_t ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cudaMallocManaged(devPtr, size, flags);
     if (ret == cudaSuccess) {
@@ -311,7 +322,7 @@ cudaError_t ucm_cudaMallocManaged(void **devPtr, size_t size, unsigned int flags
         ucm_dispatch_mem_type_alloc(*devPtr, size, UCS_MEMORY_TYPE_CUDA_MANAGED);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return ret;
 }
@@ -320,8 +331,9 @@ cudaError_t ucm_cudaMallocPitch(void **devPtr, size_t *pitch,
                                 size_t width, size_t height)
 {
     cudaError_t ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cudaMallocPitch(devPtr, pitch, width, height);
     if (ret == cudaSuccess) {
@@ -330,36 +342,38 @@ cudaError_t ucm_cudaMallocPitch(void **devPtr, size_t *pitch,
         ucm_cuda_set_ptr_attr((CUdeviceptr) *devPtr);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 cudaError_t ucm_cudaHostGetDevicePointer(void **pDevice, void *pHost, unsigned int flags)
 {
     cudaError_t ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ret = ucm_orig_cudaHostGetDevicePointer(pDevice, pHost, flags);
     if (ret == cudaSuccess) {
         ucm_trace("ucm_cuMemHostGetDevicePointer(pDevice=%p pHost=%p)", pDevice, pHost);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
 cudaError_t ucm_cudaHostUnregister(void *ptr)
 {
     cudaError_t ret;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_cudaHostUnregister(ptr=%p)", ptr);
 
     ret = ucm_orig_cudaHostUnregister(ptr);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return ret;
 }
 
@@ -427,6 +441,7 @@ static int ucm_cudamem_scan_regions_cb(void *arg, void *addr, size_t length,
     static const char *cuda_path_pattern = "/dev/nvidia";
     ucm_event_handler_t *handler         = arg;
     ucm_event_t event;
+    unsigned token;
 
     /* we are interested in blocks which don't have any access permissions, or
      * mapped to nvidia device.
@@ -443,9 +458,9 @@ static int ucm_cudamem_scan_regions_cb(void *arg, void *addr, size_t length,
     event.mem_type.size     = length;
     event.mem_type.mem_type = UCS_MEMORY_TYPE_LAST; /* unknown memory type */
 
-    ucm_event_enter();
+    token = ucm_event_enter();
     handler->cb(UCM_EVENT_MEM_TYPE_ALLOC, &event, handler->arg);
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return 0;
 }
@@ -13,6 +13,7 @@
 #include <ucm/mmap/mmap.h>
 #include <ucm/malloc/malloc_hook.h>
 #include <ucm/util/sys.h>
+#include <ucs/arch/atomic.h>
 #include <ucs/arch/cpu.h>
 #include <ucs/datastruct/khash.h>
 #include <ucs/sys/compiler.h>
@@ -21,6 +22,7 @@
 #include <ucs/type/spinlock.h>
 
 #include <sys/mman.h>
+#include <sched.h>
 #include <pthread.h>
 #include <sys/shm.h>
 #include <sys/ipc.h>
@@ -35,11 +37,53 @@ static ucs_recursive_spinlock_t ucm_kh_lock;
 #define ucm_ptr_hash(_ptr)  kh_int64_hash_func((uintptr_t)(_ptr))
 KHASH_INIT(ucm_ptr_size, const void*, size_t, 1, ucm_ptr_hash, kh_int64_hash_equal)
 
-static pthread_rwlock_t ucm_event_lock = PTHREAD_RWLOCK_INITIALIZER;
+/* Number of reader counter stripes, must be a power of 2 */
+#define UCM_EVENT_READER_STRIPES  64
+
+/* Number of address filter buckets, must be a power of 2, and the log2 of the
+ * address range size which is mapped to a bucket */
+#define UCM_EVENT_FILTER_BUCKETS  4096
+#define UCM_EVENT_FILTER_SHIFT    21
+
+
+/* Snapshot of a handler, as seen by event dispatch */
+typedef struct ucm_event_entry {
+    int                   events;
+    ucm_event_callback_t  cb;
+    void                  *arg;
+} ucm_event_entry_t;
+
+
+/* Immutable array of handlers, in dispatch order. A new array is published
+ * whenever the handlers list changes, and the old one is released after all
+ * dispatches which could see it have completed. */
+typedef struct ucm_event_table {
+    unsigned              count;
+    ucm_event_entry_t     *entries;
+} ucm_event_table_t;
+
+
+/* Number of threads inside event dispatch sections, per phase */
+typedef struct ucm_event_readers {
+    volatile uint32_t     count[2];
+} UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) ucm_event_readers_t;
+
+
+/* Protects the handlers list and external events, and serializes the
+ * publishing of handler tables */
+static pthread_mutex_t ucm_event_lock = PTHREAD_MUTEX_INITIALIZER;
 static ucs_list_link_t ucm_event_handlers;
 static int ucm_external_events = 0;
 static khash_t(ucm_ptr_size) ucm_shmat_ptrs;
 
+static volatile unsigned ucm_event_phase = 0;
+static ucm_event_readers_t ucm_event_readers[UCM_EVENT_READER_STRIPES];
+
+/* Number of registered address ranges which overlap each filter bucket, and
+ * number of ranges too large to be tracked by buckets */
+static volatile uint32_t ucm_event_filter_buckets[UCM_EVENT_FILTER_BUCKETS];
+static volatile uint32_t ucm_event_filter_wide = 0;
+
 static size_t ucm_shm_size(int shmid)
 {
     struct shmid_ds ds;
@@ -127,52 +171,218 @@ static ucs_list_link_t ucm_event_handlers =
                 UCS_LIST_INITIALIZER(&ucm_event_orig_handler.list,
                                      &ucm_event_orig_handler.list);
 
+static ucm_event_entry_t ucm_event_orig_entry = {
+    .events   = UCM_EVENT_MMAP | UCM_EVENT_MUNMAP | UCM_EVENT_MREMAP |
+                UCM_EVENT_SHMAT | UCM_EVENT_SHMDT | UCM_EVENT_SBRK |
+                UCM_EVENT_MADVISE,
+    .cb       = ucm_event_call_orig
+};
+static ucm_event_table_t ucm_event_orig_table = {
+    .count    = 1,
+    .entries  = &ucm_event_orig_entry
+};
+static ucm_event_table_t * volatile ucm_event_table = &ucm_event_orig_table;
+
+
+static UCS_F_ALWAYS_INLINE unsigned ucm_event_reader_stripe()
+{
+    return kh_int64_hash_func((uintptr_t)pthread_self()) &
+           (UCM_EVENT_READER_STRIPES - 1);
+}
+
+/* Check whether an unmapped range may overlap a range added to the filter */
+static int ucm_event_filter_match(ucm_event_t *event)
+{
+    uintptr_t start = (uintptr_t)event->vm_unmapped.address;
+    size_t size     = event->vm_unmapped.size;
+    uintptr_t bucket, last;
+
+    if ((size == 0) || (ucm_event_filter_wide > 0)) {
+        return 1;
+    }
+
+    bucket = start >> UCM_EVENT_FILTER_SHIFT;
+    last   = (start + size - 1) >> UCM_EVENT_FILTER_SHIFT;
+    if ((last - bucket) >= UCM_EVENT_FILTER_BUCKETS) {
+        return 1;
+    }
+
+    do {
+        if (ucm_event_filter_buckets[bucket &
+                                     (UCM_EVENT_FILTER_BUCKETS - 1)] > 0) {
+            return 1;
+        }
+    } while (bucket++ != last);
+
+    return 0;
+}
+
+static void ucm_event_filter_update(const void *address, size_t size,
+                                    int32_t delta)
+{
+    uintptr_t bucket, last;
+
+    if (size == 0) {
+        return;
+    }
+
+    bucket = (uintptr_t)address >> UCM_EVENT_FILTER_SHIFT;
+    last   = ((uintptr_t)address + size - 1) >> UCM_EVENT_FILTER_SHIFT;
+    if ((last - bucket) >= UCM_EVENT_FILTER_BUCKETS) {
+        ucs_atomic_add32(&ucm_event_filter_wide, delta);
+    } else {
+        do {
+            ucs_atomic_add32(&ucm_event_filter_buckets[
+                                     bucket & (UCM_EVENT_FILTER_BUCKETS - 1)],
+                             delta);
+        } while (bucket++ != last);
+    }
+
+    /* Make the filter update visible before the caller proceeds, e.g. to
+     * register the memory */
+    ucs_memory_bus_fence();
+}
+
+void ucm_event_filter_add(const void *address, size_t size)
+{
+    ucm_event_filter_update(address, size, 1);
+}
+
+void ucm_event_filter_remove(const void *address, size_t size)
+{
+    ucm_event_filter_update(address, size, -1);
+}
 
 void ucm_event_dispatch(ucm_event_type_t event_type, ucm_event_t *event)
 {
-    ucm_event_handler_t *handler;
+    ucm_event_table_t *table = ucm_event_table;
+    int filter_match         = -1;
+    ucm_event_entry_t *entry;
+
+    for (entry = table->entries; entry < (table->entries + table->count);
+         ++entry) {
+        if (!(entry->events & event_type)) {
+            continue;
+        }
 
-    ucs_list_for_each(handler, &ucm_event_handlers, list) {
-        if (handler->events & event_type) {
-            handler->cb(event_type, event, handler->arg);
+        if ((entry->events & UCM_EVENT_FLAG_ADDR_FILTER) &&
+            (event_type == UCM_EVENT_VM_UNMAPPED)) {
+            if (filter_match < 0) {
+                filter_match = ucm_event_filter_match(event);
+            }
+            if (!filter_match) {
+                continue;
+            }
         }
+
+        entry->cb(event_type, event, entry->arg);
     }
 }
 
-#define ucm_event_lock(_lock_func) \
-    { \
-        int ret; \
-        do { \
-            ret = _lock_func(&ucm_event_lock); \
-        } while (ret == EAGAIN); \
-        if (ret != 0) { \
-            ucm_fatal("%s() failed: %s", #_lock_func, strerror(ret)); \
-        } \
+unsigned ucm_event_enter_phase(unsigned phase)
+{
+    unsigned stripe = ucm_event_reader_stripe();
+
+    for (;;) {
+        ucs_atomic_add32(&ucm_event_readers[stripe].count[phase], 1);
+        /* Order the counter update with the following reads of the phase and
+         * the handler table; paired with the fence in ucm_event_synchronize() */
+        ucs_memory_bus_fence();
+
+        /* The phase may have been flipped after the caller read it, and then
+         * a writer would not wait for this counter. Re-check and retry, so the
+         * section is always counted in the phase a writer will wait for. */
+        if (ucs_likely(ucm_event_phase == phase)) {
+            return (stripe << 1) | phase;
+        }
+
+        ucs_atomic_add32(&ucm_event_readers[stripe].count[phase], -1);
+        phase = ucm_event_phase;
     }
+}
+
+unsigned ucm_event_enter()
+{
+    return ucm_event_enter_phase(ucm_event_phase);
+}
 
-void ucm_event_enter()
+void ucm_event_leave(unsigned token)
 {
-    ucm_event_lock(pthread_rwlock_rdlock);
+    /* Complete all handler table reads before a writer may release it */
+    ucs_memory_cpu_fence();
+    ucs_atomic_add32(&ucm_event_readers[token >> 1].count[token & 1], -1);
 }
 
-void ucm_event_enter_exclusive()
+/*
+ * Wait until all dispatch sections which started before the call have
+ * completed. Readers which enter after the phase flip are counted in the new
+ * phase, so the wait can't be starved by new readers.
+ * Must be called with ucm_event_lock held, and not from an event handler.
+ */
+static void ucm_event_synchronize()
 {
-    ucm_event_lock(pthread_rwlock_wrlock);
+    unsigned phase = ucm_event_phase;
+    unsigned i;
+
+    /* Publish the new table before the phase flip. Otherwise, a reader which
+     * sees the new phase could still read the old table, which is released
+     * once the old phase has drained. */
+    ucs_memory_cpu_store_fence();
+    ucm_event_phase = !phase;
+    /* Make the new table and phase visible before reading the counters */
+    ucs_memory_bus_fence();
+
+    for (i = 0; i < UCM_EVENT_READER_STRIPES; ++i) {
+        while (ucm_event_readers[i].count[phase] != 0) {
+            sched_yield();
+        }
+    }
+
+    ucs_memory_cpu_load_fence();
 }
 
-void ucm_event_leave()
+/* Publish a new handler table built from the handlers list.
+ * Must be called with ucm_event_lock held. */
+static void ucm_event_table_update()
 {
-    pthread_rwlock_unlock(&ucm_event_lock);
+    ucm_event_table_t *old_table = ucm_event_table;
+    ucm_event_handler_t *handler;
+    ucm_event_table_t *table;
+    unsigned count;
+
+    count = ucs_list_length(&ucm_event_handlers);
+    table = malloc(sizeof(*table) + (sizeof(*table->entries) * count));
+    if (table == NULL) {
+        ucm_fatal("failed to allocate memory events handler table");
+    }
+
+    table->entries = (ucm_event_entry_t*)(table + 1);
+    table->count   = 0;
+    ucs_list_for_each(handler, &ucm_event_handlers, list) {
+        table->entries[table->count].events = handler->events;
+        table->entries[table->count].cb     = handler->cb;
+        table->entries[table->count].arg    = handler->arg;
+        ++table->count;
+    }
+
+    ucs_memory_cpu_store_fence();
+    ucm_event_table = table;
+
+    ucm_event_synchronize();
+    if (old_table != &ucm_event_orig_table) {
+        free(old_table);
+    }
 }
 
 void *ucm_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
 {
     ucm_event_t event;
+    unsigned token;
 
     ucm_trace("ucm_mmap(addr=%p length=%lu prot=0x%x flags=0x%x fd=%d offset=%ld)",
               addr, length, prot, flags, fd, offset);
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     if ((flags & MAP_FIXED) && (addr != NULL)) {
         ucm_dispatch_vm_munmap(addr, length);
@@ -192,7 +402,7 @@ void *ucm_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t off
         ucm_dispatch_vm_mmap(event.mmap.result, length);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.mmap.result;
 }
@@ -200,8 +410,9 @@ void *ucm_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t off
 int ucm_munmap(void *addr, size_t length)
 {
     ucm_event_t event;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_munmap(addr=%p length=%lu)", addr, length);
 
@@ -212,36 +423,41 @@ int ucm_munmap(void *addr, size_t length)
     event.munmap.size    = length;
     ucm_event_dispatch(UCM_EVENT_MUNMAP, &event);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.munmap.result;
 }
 
 void ucm_vm_mmap(void *addr, size_t length)
 {
-    ucm_event_enter();
+    unsigned token;
+
+    token = ucm_event_enter();
 
     ucm_trace("ucm_vm_mmap(addr=%p length=%lu)", addr, length);
     ucm_dispatch_vm_mmap(addr, length);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 }
 
 void ucm_vm_munmap(void *addr, size_t length)
 {
-    ucm_event_enter();
+    unsigned token;
+
+    token = ucm_event_enter();
 
     ucm_trace("ucm_vm_munmap(addr=%p length=%lu)", addr, length);
     ucm_dispatch_vm_munmap(addr, length);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 }
 
 void *ucm_mremap(void *old_address, size_t old_size, size_t new_size, int flags)
 {
     ucm_event_t event;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_mremap(old_address=%p old_size=%lu new_size=%ld flags=0x%x)",
               old_address, old_size, new_size, flags);
@@ -260,7 +476,7 @@ void *ucm_mremap(void *old_address, size_t old_size, size_t new_size, int flags)
         ucm_dispatch_vm_mmap(event.mremap.result, new_size);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.mremap.result;
 }
@@ -288,11 +504,12 @@ void *ucm_shmat(int shmid, const void *shmaddr, int shmflg)
 {
     uintptr_t attach_addr;
     ucm_event_t event;
+    unsigned token;
     khiter_t iter;
     size_t size;
     int result;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_shmat(shmid=%d shmaddr=%p shmflg=0x%x)",
               shmid, shmaddr, shmflg);
@@ -324,7 +541,7 @@ void *ucm_shmat(int shmid, const void *shmaddr, int shmflg)
         ucm_dispatch_vm_mmap(event.shmat.result, size);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.shmat.result;
 }
@@ -332,9 +549,10 @@ void *ucm_shmat(int shmid, const void *shmaddr, int shmflg)
 int ucm_shmdt(const void *shmaddr)
 {
     ucm_event_t event;
+    unsigned token;
     size_t size;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_debug("ucm_shmdt(shmaddr=%p)", shmaddr);
 
@@ -348,7 +566,7 @@ int ucm_shmdt(const void *shmaddr)
     event.shmdt.shmaddr = shmaddr;
     ucm_event_dispatch(UCM_EVENT_SHMDT, &event);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.shmdt.result;
 }
@@ -356,8 +574,9 @@ int ucm_shmdt(const void *shmaddr)
 void *ucm_sbrk(intptr_t increment)
 {
     ucm_event_t event;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_sbrk(increment=%+ld)", increment);
 
@@ -375,7 +594,7 @@ void *ucm_sbrk(intptr_t increment)
                              increment);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.sbrk.result;
 }
@@ -386,12 +605,13 @@ int ucm_brk(void *addr)
     void *old_addr;
     intptr_t increment;
     ucm_event_t event;
+    unsigned token;
 
     old_addr  = ucm_brk_syscall(0);
     /* in case if addr == NULL - it just returns current pointer */
     increment = addr ? ((intptr_t)addr - (intptr_t)old_addr) : 0;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_brk(addr=%p)", addr);
 
@@ -408,7 +628,7 @@ int ucm_brk(void *addr)
         ucm_dispatch_vm_mmap(old_addr, increment);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.sbrk.result == MAP_FAILED ? -1 : 0;
 #else
@@ -419,8 +639,9 @@ int ucm_brk(void *addr)
 int ucm_madvise(void *addr, size_t length, int advice)
 {
     ucm_event_t event;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_madvise(addr=%p length=%zu advice=%d)", addr, length, advice);
 
@@ -445,7 +666,7 @@ int ucm_madvise(void *addr, size_t length, int advice)
     event.madvise.advice = advice;
     ucm_event_dispatch(UCM_EVENT_MADVISE, &event);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
 
     return event.madvise.result;
 }
@@ -454,24 +675,26 @@ void ucm_event_handler_add(ucm_event_handler_t *handler)
 {
     ucm_event_handler_t *elem;
 
-    ucm_event_enter_exclusive();
+    pthread_mutex_lock(&ucm_event_lock);
     ucs_list_for_each(elem, &ucm_event_handlers, list) {
         if (handler->priority < elem->priority) {
             ucs_list_insert_before(&elem->list, &handler->list);
-            ucm_event_leave();
-            return;
+            goto out;
         }
     }
 
     ucs_list_add_tail(&ucm_event_handlers, &handler->list);
-    ucm_event_leave();
+out:
+    ucm_event_table_update();
+    pthread_mutex_unlock(&ucm_event_lock);
 }
 
 void ucm_event_handler_remove(ucm_event_handler_t *handler)
 {
-    ucm_event_enter_exclusive();
+    pthread_mutex_lock(&ucm_event_lock);
     ucs_list_del(&handler->list);
-    ucm_event_leave();
+    ucm_event_table_update();
+    pthread_mutex_unlock(&ucm_event_lock);
 }
 
 static ucs_status_t ucm_event_install(int events)
@@ -536,7 +759,8 @@ ucs_status_t ucm_set_event_handler(int events, int priority,
                    UCM_EVENT_VM_MAPPED|UCM_EVENT_VM_UNMAPPED|
                    UCM_EVENT_MEM_TYPE_ALLOC|UCM_EVENT_MEM_TYPE_FREE|
                    UCM_EVENT_FLAG_NO_INSTALL|
-                   UCM_EVENT_FLAG_EXISTING_ALLOC)) {
+                   UCM_EVENT_FLAG_EXISTING_ALLOC|
+                   UCM_EVENT_FLAG_ADDR_FILTER)) {
         return UCS_ERR_INVALID_PARAM;
     }
 
@@ -546,7 +770,8 @@ ucs_status_t ucm_set_event_handler(int events, int priority,
 
     /* separate event flags from real events */
     flags   = events & (UCM_EVENT_FLAG_NO_INSTALL |
-                        UCM_EVENT_FLAG_EXISTING_ALLOC);
+                        UCM_EVENT_FLAG_EXISTING_ALLOC |
+                        UCM_EVENT_FLAG_ADDR_FILTER);
     events &= ~flags;
 
     if (!(flags & UCM_EVENT_FLAG_NO_INSTALL) && (events & ~ucm_external_events)) {
@@ -561,7 +786,8 @@ ucs_status_t ucm_set_event_handler(int events, int priority,
         return UCS_ERR_NO_MEMORY;
     }
 
-    handler->events   = events;
+    /* the address filter flag is checked by event dispatch */
+    handler->events   = events | (flags & UCM_EVENT_FLAG_ADDR_FILTER);
     handler->priority = priority;
     handler->cb       = cb;
     handler->arg      = arg;
@@ -581,16 +807,16 @@ ucs_status_t ucm_set_event_handler(int events, int priority,
 
 void ucm_set_external_event(int events)
 {
-    ucm_event_enter_exclusive();
+    pthread_mutex_lock(&ucm_event_lock);
     ucm_external_events |= events;
-    ucm_event_leave();
+    pthread_mutex_unlock(&ucm_event_lock);
 }
 
 void ucm_unset_external_event(int events)
 {
-    ucm_event_enter_exclusive();
+    pthread_mutex_lock(&ucm_event_lock);
     ucm_external_events &= ~events;
-    ucm_event_leave();
+    pthread_mutex_unlock(&ucm_event_lock);
 }
 
 void ucm_unset_event_handler(int events, ucm_event_callback_t cb, void *arg)
@@ -598,17 +824,20 @@ void ucm_unset_event_handler(int events, ucm_event_callback_t cb, void *arg)
     ucm_event_handler_t *elem, *tmp;
     UCS_LIST_HEAD(gc_list);
 
-    ucm_event_enter_exclusive();
+    pthread_mutex_lock(&ucm_event_lock);
     ucs_list_for_each_safe(elem, tmp, &ucm_event_handlers, list) {
         if ((cb == elem->cb) && (arg == elem->arg)) {
             elem->events &= ~events;
-            if (elem->events == 0) {
+            if ((elem->events & ~UCM_EVENT_FLAG_ADDR_FILTER) == 0) {
                 ucs_list_del(&elem->list);
                 ucs_list_add_tail(&gc_list, &elem->list);
             }
         }
     }
-    ucm_event_leave();
+
+    /* After the table is updated, removed handlers are no longer called */
+    ucm_event_table_update();
+    pthread_mutex_unlock(&ucm_event_lock);
 
     /* Do not release memory while we hold event lock - may deadlock */
     ucs_list_for_each_safe(elem, tmp, &gc_list, list) {
@@ -49,11 +49,23 @@ void ucm_event_handler_remove(ucm_event_handler_t *handler);
 
 void ucm_event_dispatch(ucm_event_type_t event_type, ucm_event_t *event);
 
-void ucm_event_enter();
+/**
+ * Enter a section which dispatches memory events. Event handlers which are
+ * removed concurrently are guaranteed not to be called after their removal
+ * completes, and removal waits until the section is left.
+ *
+ * @return Token to pass to @ref ucm_event_leave.
+ */
+unsigned ucm_event_enter();
 
-void ucm_event_enter_exclusive();
+/**
+ * Same as @ref ucm_event_enter, when the caller has already read the current
+ * dispatch phase, which may have changed since then. The phase of the entered
+ * section is returned in the lowest bit of the token.
+ */
+unsigned ucm_event_enter_phase(unsigned phase);
 
-void ucm_event_leave();
+void ucm_event_leave(unsigned token);
 
 static UCS_F_ALWAYS_INLINE void
 ucm_dispatch_vm_mmap(void *addr, size_t length)
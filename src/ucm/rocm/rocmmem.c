@@ -96,8 +96,9 @@ static void ucm_hsa_amd_memory_pool_free_dispatch_events(void *ptr)
 hsa_status_t ucm_hsa_amd_memory_pool_free(void* ptr)
 {
     hsa_status_t status;
+    unsigned token;
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     ucm_trace("ucm_hsa_amd_memory_pool_free(ptr=%p)", ptr);
 
@@ -105,7 +106,7 @@ hsa_status_t ucm_hsa_amd_memory_pool_free(void* ptr)
 
     status = ucm_orig_hsa_amd_memory_pool_free(ptr);
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return status;
 }
 
@@ -116,6 +117,7 @@ hsa_status_t ucm_hsa_amd_memory_pool_allocate(
     ucs_memory_type_t type = UCS_MEMORY_TYPE_ROCM;
     uint32_t pool_flags    = 0;
     hsa_status_t status;
+    unsigned token;
 
     status = hsa_amd_memory_pool_get_info(memory_pool,
                                           HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS,
@@ -125,7 +127,7 @@ hsa_status_t ucm_hsa_amd_memory_pool_allocate(
         type = UCS_MEMORY_TYPE_ROCM_MANAGED;
     }
 
-    ucm_event_enter();
+    token = ucm_event_enter();
 
     status = ucm_orig_hsa_amd_memory_pool_allocate(memory_pool, size, flags, ptr);
     if (status == HSA_STATUS_SUCCESS) {
@@ -133,7 +135,7 @@ hsa_status_t ucm_hsa_amd_memory_pool_allocate(
         ucm_dispatch_mem_type_alloc(*ptr, size, type);
     }
 
-    ucm_event_leave();
+    ucm_event_leave(token);
     return status;
 }
 
@@ -480,7 +480,11 @@ enum ucp_send_am_flags {
  * no longer needed.
  */
 enum ucp_cb_param_flags {
-    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0)
+    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0),
+    UCP_CB_PARAM_FLAG_RNDV = UCS_BIT(1)  /**< The data parameter is a
+                                              rendezvous descriptor, the
+                                              payload should be fetched with
+                                              @ref ucp_am_recv_data_nbx */
 };
 
 
@@ -637,6 +641,91 @@ typedef struct ucp_dt_iov {
 } ucp_dt_iov_t;
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Maximal number of dimensions of a strided datatype.
+ */
+#define UCP_DT_STRIDED_MAX_DIMS 4
+
+
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief UCP strided datatype parameters field mask.
+ *
+ * The enumeration allows specifying which fields in
+ * @ref ucp_dt_strided_params_t are present. It is used to enable backward
+ * compatibility support.
+ */
+enum ucp_dt_strided_params_field {
+    UCP_DT_STRIDED_PARAM_FIELD_BLOCKLEN = UCS_BIT(0), /**< Block length */
+    UCP_DT_STRIDED_PARAM_FIELD_DIMS     = UCS_BIT(1), /**< Dimensions */
+    UCP_DT_STRIDED_PARAM_FIELD_EXTENT   = UCS_BIT(2)  /**< Element extent */
+};
+
+
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Dimension of a strided datatype.
+ *
+ * A dimension repeats the item of the next inner dimension (or the contiguous
+ * block, for the innermost dimension) @a count times, @a stride bytes apart.
+ */
+typedef struct ucp_dt_strided_dim {
+    size_t    count;  /**< Number of items in the dimension */
+    ptrdiff_t stride; /**< Distance in bytes between the beginnings of
+                           consecutive items, may be negative */
+} ucp_dt_strided_dim_t;
+
+
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Strided datatype description.
+ *
+ * A strided datatype element is a nested vector of contiguous blocks: the
+ * innermost dimension @a dims[0] repeats a block of @a blocklen bytes, and
+ * every next dimension repeats the previous one. The packed representation of
+ * the element is the concatenation of all its blocks, with the innermost
+ * dimension running fastest. For example, a column of a row-major matrix of
+ * doubles with @a ncols columns is described by blocklen=8 and a single
+ * dimension {nrows, ncols * 8}.
+ *
+ * When the datatype is used with a count greater than 1, consecutive elements
+ * start @a extent bytes apart.
+ */
+typedef struct ucp_dt_strided_params {
+    /**
+     * Mask of valid fields in this structure, using bits from
+     * @ref ucp_dt_strided_params_field. Fields not specified in this mask
+     * will be ignored. Provides ABI compatibility with respect to adding new
+     * fields.
+     */
+    uint64_t             field_mask;
+
+    /**
+     * Length in bytes of the contiguous block. This field is mandatory.
+     */
+    size_t               blocklen;
+
+    /**
+     * Number of valid entries in @a dims, up to @ref UCP_DT_STRIDED_MAX_DIMS.
+     * If not specified, the element is a single block.
+     */
+    unsigned             num_dims;
+
+    /**
+     * Dimensions of the element, from the innermost to the outermost.
+     */
+    ucp_dt_strided_dim_t dims[UCP_DT_STRIDED_MAX_DIMS];
+
+    /**
+     * Distance in bytes between the beginnings of consecutive elements. If
+     * not specified, it is count * stride of the outermost dimension, or
+     * @a blocklen if there are no dimensions.
+     */
+    ptrdiff_t            extent;
+} ucp_dt_strided_params_t;
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief UCP generic data type descriptor
@@ -1264,6 +1353,7 @@ typedef struct {
         ucp_send_nbx_callback_t        send;
         ucp_tag_recv_nbx_callback_t    recv;
         ucp_stream_recv_nbx_callback_t recv_stream;
+        ucp_am_recv_data_nbx_callback_t recv_am;
     }              cb;
 
     /**
@@ -1723,6 +1813,11 @@ ucs_status_t ucp_worker_get_efd(ucp_worker_h worker, int *fd);
  * notification and may not progress some of the requests as it would when
  * calling @ref ucp_worker_progress (which is not invoked in that duration).
  *
+ * @note If UCX_WAIT_MODE is set to "hybrid", this function first calls
+ * @ref ucp_worker_progress for an adaptively tuned spin time, and returns as
+ * soon as it reports events. Therefore, completion callbacks may be invoked
+ * from within this function.
+ *
  * @note UCP @ref ucp_feature "features" have to be triggered
  *   with @ref UCP_FEATURE_WAKEUP to select proper transport
  *
@@ -2533,6 +2628,48 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
 void ucp_am_data_release(ucp_worker_h worker, void *data);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Receive the payload of a rendezvous Active Message.
+ *
+ * This routine fetches the payload of an Active Message which arrived with
+ * the UCP_CB_PARAM_FLAG_RNDV flag directly into the user buffer, using a
+ * remote memory read from the sender's buffer. The @a data_desc descriptor is
+ * consumed by this call and must not be used or released afterwards. The
+ * routine may be called from the Active Message callback, in which case the
+ * callback must return UCS_INPROGRESS. If the application decides not to
+ * receive the payload, it should pass the descriptor to
+ * @ref ucp_am_data_release, which completes the send operation on the
+ * sender side.
+ *
+ * Active Messages are sent with the rendezvous protocol only when their size
+ * exceeds the UCX_AM_RNDV_THRESH configuration value.
+ *
+ * @note Only contiguous datatypes are currently supported.
+ *
+ * @param [in]  worker      Worker which received the Active Message.
+ * @param [in]  data_desc   Rendezvous descriptor passed as the data parameter
+ *                          to the Active Message callback.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive into @a buffer.
+ * @param [in]  param       Operation parameters, see @ref ucp_request_param_t.
+ *
+ * @return UCS_OK               The data was received immediately, the
+ *                              callback is not invoked.
+ * @return UCS_PTR_IS_ERR(_ptr) The receive operation failed. If the
+ *                              parameters were rejected, including a buffer
+ *                              smaller than the message, @a data_desc was not
+ *                              consumed, and the Active Message callback should
+ *                              return the error status to drop the message.
+ * @return otherwise            Operation was scheduled for receive. A request
+ *                              handle is returned to the application in order
+ *                              to track progress of the operation.
+ */
+ucs_status_ptr_t ucp_am_recv_data_nbx(ucp_worker_h worker, void *data_desc,
+                                      void *buffer, size_t count,
+                                      const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking stream send operation.
@@ -3716,6 +3853,30 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
                                    ucp_datatype_t *datatype_p);
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Create a strided datatype.
+ *
+ * This routine creates a strided datatype object, described by
+ * @ref ucp_dt_strided_params_t. Unlike a generic datatype, a strided datatype
+ * is packed and unpacked by the library without application callbacks, and
+ * zero-copy protocols may send its blocks directly from the user buffer.
+ * The buffer passed to communication routines along with a strided datatype
+ * is the address of the first block of the first element.
+ * The application is responsible for releasing the @a datatype_p object using
+ * @ref ucp_dt_destroy "ucp_dt_destroy()" routine.
+ *
+ * @param [in]  params       Strided datatype description.
+ * @param [out] datatype_p   A pointer to datatype object.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ *
+ * @note The strided datatype must describe host memory.
+ */
+ucs_status_t ucp_dt_create_strided(const ucp_dt_strided_params_t *params,
+                                   ucp_datatype_t *datatype_p);
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Destroy a datatype and release its resources.
@@ -3723,7 +3884,8 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
  * This routine destroys the @a datatype object and
  * releases any resources that are associated with the object.
  * The @a datatype object must be allocated using @ref ucp_dt_create_generic
- * "ucp_dt_create_generic()" routine.
+ * "ucp_dt_create_generic()" or @ref ucp_dt_create_strided
+ * "ucp_dt_create_strided()" routine.
  *
  * @warning
  * @li Once the @a datatype object is released an access to this object may
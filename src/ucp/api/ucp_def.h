@@ -455,6 +455,27 @@ typedef void (*ucp_stream_recv_nbx_callback_t)(void *request, ucs_status_t statu
                                                size_t length, void *user_data);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Completion callback for non-blocking Active Message rendezvous
+ * receives.
+ *
+ * This callback routine is invoked whenever the @ref ucp_am_recv_data_nbx
+ * "receive operation" is completed and the data is ready in the receive buffer.
+ *
+ * @param [in]  request   The completed receive request.
+ * @param [in]  status    Completion status. If the receive operation was
+ *                        completed successfully UCS_OK is returned. Otherwise,
+ *                        an @ref ucs_status_t "error status" is returned.
+ * @param [in]  length    The size of the received data in bytes. The value is
+ *                        valid only if the status is UCS_OK.
+ * @param [in]  user_data User data passed to "user_data" value,
+ *                        see @ref ucp_request_param_t.
+ */
+typedef void (*ucp_am_recv_data_nbx_callback_t)(void *request, ucs_status_t status,
+                                                size_t length, void *user_data);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Completion callback for non-blocking tag receives.
@@ -558,6 +579,10 @@ typedef enum ucp_wakeup_event_types {
  * @param [in]  flags    If this flag is set to UCP_CB_PARAM_FLAG_DATA,
  *                       the callback can return UCS_INPROGRESS and
  *                       data will persist after the callback returns.
+ *                       If UCP_CB_PARAM_FLAG_RNDV is also set, @a data is
+ *                       an opaque rendezvous descriptor rather than the
+ *                       payload, and @a length is the size of the payload
+ *                       which can be fetched with @ref ucp_am_recv_data_nbx.
  *
  * @return UCS_OK        @a data will not persist after the callback returns.
  *
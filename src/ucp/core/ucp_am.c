@@ -17,6 +17,7 @@
 #include <ucp/core/ucp_worker.h>
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto_am.inl>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
 
@@ -75,6 +76,16 @@ UCS_PROFILE_FUNC_VOID(ucp_am_data_release, (worker, data),
 {
     ucp_recv_desc_t *rdesc = (ucp_recv_desc_t *)data - 1;
 
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV)) {
+        /* The payload of a rendezvous message is not going to be fetched,
+         * let the sender complete its request */
+        UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+        ucp_rndv_am_reject(worker, data, UCS_OK);
+        ucp_recv_desc_release(rdesc);
+        UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+        return;
+    }
+
     if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC)) {
         /* Don't use UCS_PTR_BYTE_OFFSET here due to coverity false
          * positive report. Need to step back by first_header size, where
@@ -369,6 +380,55 @@ static ucs_status_t ucp_am_zcopy_multi(uct_pending_req_t *self)
                                  1);
 }
 
+static size_t ucp_am_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+    size_t length;
+
+    /* AM header is carried in place of the tag */
+    UCS_STATIC_ASSERT(sizeof(ucp_am_hdr_t) == sizeof(rndv_rts_hdr->super));
+
+    length = ucp_tag_rndv_rts_pack(dest, arg);
+    ucp_am_fill_header((ucp_am_hdr_t*)&rndv_rts_hdr->super, sreq);
+    return length;
+}
+
+static ucs_status_t ucp_am_progress_rndv_rts(uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+    size_t packed_rkey_size;
+
+    packed_rkey_size = ucp_ep_config(sreq->send.ep)->tag.rndv.rkey_size;
+    return ucp_do_am_single(self, UCP_AM_ID_AM_RNDV_RTS, ucp_am_rndv_rts_pack,
+                            sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+}
+
+static ucs_status_t ucp_am_send_start_rndv(ucp_request_t *sreq)
+{
+    ucp_trace_req(sreq, "AM start_rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(sreq->send.ep), sreq->send.buffer,
+                  sreq->send.length);
+    UCS_PROFILE_REQUEST_EVENT(sreq, "am_start_rndv", sreq->send.length);
+
+    ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(sreq->send.ep));
+    sreq->send.uct.func = ucp_am_progress_rndv_rts;
+    return ucp_tag_rndv_reg_send_buffer(sreq);
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_am_get_rndv_threshold(ucp_request_t *req)
+{
+    /* The receiver reads the payload directly from the send buffer, so
+     * rendezvous is used for contiguous data only */
+    if (UCP_DT_IS_CONTIG(req->send.datatype) &&
+        ucp_rndv_is_get_zcopy(req, req->send.ep->worker->context)) {
+        return ucp_ep_config(req->send.ep)->am_u.rndv_thresh;
+    }
+
+    return SIZE_MAX;
+}
+
 static void ucp_am_send_req_init(ucp_request_t *req, ucp_ep_h ep,
                                  const void *buffer, uintptr_t datatype,
                                  size_t count, uint16_t flags,
@@ -394,18 +454,26 @@ ucp_am_send_req(ucp_request_t *req, size_t count,
                 const ucp_ep_msg_config_t *msg_config,
                 ucp_send_callback_t cb, const ucp_request_send_proto_t *proto)
 {
-
+    size_t rndv_thresh  = ucp_am_get_rndv_threshold(req);
     size_t zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
-                                                        count, SIZE_MAX);
+                                                        count, rndv_thresh);
     ssize_t max_short   = ucp_am_get_short_max(req, msg_config);
     ucs_status_t status;
 
     status = ucp_request_send_start(req, max_short,
-                                    zcopy_thresh, SIZE_MAX,
+                                    zcopy_thresh, rndv_thresh,
                                     count, msg_config,
                                     proto);
-    if (status != UCS_OK) {
-       return UCS_STATUS_PTR(status);
+    if (ucs_unlikely(status != UCS_OK)) {
+        if (status != UCS_ERR_NO_PROGRESS) {
+            return UCS_STATUS_PTR(status);
+        }
+
+        ucs_assert(req->send.length >= rndv_thresh);
+        status = ucp_am_send_start_rndv(req);
+        if (status != UCS_OK) {
+            return UCS_STATUS_PTR(status);
+        }
     }
 
     /* Start the request.
@@ -745,6 +813,135 @@ ucp_am_long_middle_handler(void *am_arg, void *am_data, size_t am_length,
     return status;
 }
 
+static ucs_status_t
+ucp_am_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                        unsigned am_flags)
+{
+    ucp_worker_h worker              = am_arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = am_data;
+    ucp_am_hdr_t *hdr                = (ucp_am_hdr_t*)&rndv_rts_hdr->super;
+    uint16_t am_id                   = hdr->am_id;
+    ucp_recv_desc_t *rdesc           = NULL;
+    ucs_status_t status, desc_status;
+    ucp_ep_h reply_ep;
+
+    if (ucs_unlikely(!ucp_am_recv_check_id(worker, am_id))) {
+        status = UCS_OK;
+        goto err_reject;
+    }
+
+    /* Keep the RTS in a descriptor, which is passed to the user callback and
+     * later consumed by ucp_am_recv_data_nbx or ucp_am_data_release */
+    desc_status = ucp_recv_desc_init(worker, am_data, am_length, 0, am_flags,
+                                     0, UCP_RECV_DESC_FLAG_RNDV, 0, &rdesc);
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(desc_status))) {
+        ucs_error("worker %p could not allocate descriptor for active"
+                  " message rendezvous on callback : %u", worker, am_id);
+        status = desc_status;
+        goto err_reject;
+    }
+
+    reply_ep = (hdr->flags & UCP_AM_SEND_REPLY) ?
+               ucp_worker_get_ep_by_ptr(worker, rndv_rts_hdr->sreq.ep_ptr) :
+               NULL;
+
+    status = worker->am.cbs[am_id].cb(worker->am.cbs[am_id].context,
+                                      rdesc + 1, rndv_rts_hdr->size, reply_ep,
+                                      UCP_CB_PARAM_FLAG_DATA |
+                                      UCP_CB_PARAM_FLAG_RNDV);
+    if (status == UCS_INPROGRESS) {
+        /* the user owns the descriptor, UCT descriptor is held only if it
+         * was not copied */
+        return desc_status;
+    }
+
+    /* the user dropped the message without fetching the payload */
+    ucp_rndv_am_reject(worker, rndv_rts_hdr, UCS_OK);
+    if (desc_status == UCS_OK) {
+        ucp_recv_desc_release(rdesc);
+    }
+    return UCS_OK;
+
+err_reject:
+    ucp_rndv_am_reject(worker, rndv_rts_hdr, status);
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_recv_data_nbx,
+                 (worker, data_desc, buffer, count, param),
+                 ucp_worker_h worker, void *data_desc, void *buffer,
+                 size_t count, const ucp_request_param_t *param)
+{
+    ucp_recv_desc_t *rdesc           = (ucp_recv_desc_t*)data_desc - 1;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = data_desc;
+    ucp_datatype_t datatype;
+    ucs_status_ptr_t ret;
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    if (ucs_unlikely(!(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV))) {
+        ucs_error("active message descriptor %p is not a rendezvous one",
+                  data_desc);
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    datatype = (param->op_attr_mask & UCP_OP_ATTR_FIELD_DATATYPE) ?
+               param->datatype : ucp_dt_make_contig(1);
+    if (ucs_unlikely(!UCP_DT_IS_CONTIG(datatype))) {
+        return UCS_STATUS_PTR(UCS_ERR_UNSUPPORTED);
+    }
+
+    if (ucs_unlikely(ucp_contig_dt_length(datatype, count) <
+                     rndv_rts_hdr->size)) {
+        return UCS_STATUS_PTR(UCS_ERR_MESSAGE_TRUNCATED);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    req = ucp_request_get_param(worker, param,
+                                {
+                                    ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+                                    goto out;
+                                });
+
+    req->flags         = UCP_REQUEST_FLAG_RECV_AM;
+    req->recv.worker   = worker;
+    req->recv.buffer   = buffer;
+    req->recv.datatype = datatype;
+    ucp_dt_recv_state_init(&req->recv.state, buffer, datatype, count);
+    req->recv.length   = ucp_contig_dt_length(datatype, count);
+    req->recv.mem_type = ucp_memory_type_detect(worker->context, buffer,
+                                                req->recv.length);
+
+    /* The RTS is not needed after the get operation has been started, since
+     * the remote key is unpacked to the internal request */
+    ucp_rndv_am_matched(worker, req, rndv_rts_hdr);
+    ucp_recv_desc_release(rdesc);
+
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        status = req->status;
+        ucp_request_put_param(param, req);
+        ret = UCS_STATUS_PTR(status);
+        goto out;
+    }
+
+    if (param->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) {
+        ucp_request_set_callback(req, recv.am.cb, param->cb.recv_am,
+                                 (param->op_attr_mask &
+                                  UCP_OP_ATTR_FIELD_USER_DATA) ?
+                                 param->user_data : NULL);
+    }
+
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE,
               ucp_am_handler, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_FIRST,
@@ -753,6 +950,8 @@ UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MIDDLE,
               ucp_am_long_middle_handler, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE_REPLY,
               ucp_am_handler_reply, NULL, 0);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_RNDV_RTS,
+              ucp_am_rndv_rts_handler, NULL, 0);
 
 const ucp_request_send_proto_t ucp_am_proto = {
     .contig_short           = ucp_am_contig_short,
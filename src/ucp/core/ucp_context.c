@@ -16,6 +16,7 @@
 
 #include <ucs/config/parser.h>
 #include <ucs/algorithm/crc.h>
+#include <ucs/arch/memcpy.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/datastruct/queue.h>
 #include <ucs/datastruct/string_set.h>
@@ -37,6 +38,12 @@ static const char *ucp_atomic_modes[] = {
     [UCP_ATOMIC_MODE_LAST]   = NULL,
 };
 
+static const char *ucp_wait_modes[] = {
+    [UCP_WAIT_MODE_BLOCK]  = "block",
+    [UCP_WAIT_MODE_HYBRID] = "hybrid",
+    [UCP_WAIT_MODE_LAST]   = NULL,
+};
+
 static const char * ucp_device_type_names[] = {
     [UCT_DEVICE_TYPE_NET]  = "network",
     [UCT_DEVICE_TYPE_SHM]  = "intra-node",
@@ -132,6 +139,20 @@ static ucs_config_field_t ucp_config_table[] = {
    "is zero or negative",
    ucs_offsetof(ucp_config_t, ctx.rndv_thresh_fallback), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"AM_RNDV_THRESH", "inf",
+   "Threshold for switching active messages sent by ucp_am_send_nb() to the\n"
+   "rendezvous protocol, where the receiver fetches the payload into its own\n"
+   "buffer with ucp_am_recv_data_nbx(). The value \"auto\" selects the same\n"
+   "threshold as the tag-matching get_zcopy rendezvous.",
+   ucs_offsetof(ucp_config_t, ctx.am_rndv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"STREAM_RNDV_THRESH", "inf",
+   "Threshold for switching stream sends to the rendezvous protocol, where the\n"
+   "receiver fetches the payload with get_zcopy directly into a posted\n"
+   "ucp_stream_recv_nb() buffer. The value \"auto\" selects the same threshold\n"
+   "as the tag-matching get_zcopy rendezvous.",
+   ucs_offsetof(ucp_config_t, ctx.stream_rndv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"RNDV_PERF_DIFF", "1",
    "The percentage allowed for performance difference between rendezvous and "
    "the eager_zcopy protocol",
@@ -186,6 +207,36 @@ static ucs_config_field_t ucp_config_table[] = {
    "          Otherwise the CPU mode is selected.",
    ucs_offsetof(ucp_config_t, ctx.atomic_mode), UCS_CONFIG_TYPE_ENUM(ucp_atomic_modes)},
 
+  {"WAIT_MODE", "block",
+   "How ucp_worker_wait() waits for events.\n"
+   " block  - arm the worker and block on its event file descriptor.\n"
+   " hybrid - progress the worker for a spin time which is tuned according to\n"
+   "          the recent idle times, and then arm and block. Reduces wakeup\n"
+   "          latency when events arrive shortly after waiting starts.",
+   ucs_offsetof(ucp_config_t, ctx.wait_mode), UCS_CONFIG_TYPE_ENUM(ucp_wait_modes)},
+
+  {"WAIT_SPIN_MAX", "50us",
+   "Maximal spin time of ucp_worker_wait() in hybrid waiting mode.",
+   ucs_offsetof(ucp_config_t, ctx.wait_spin_max), UCS_CONFIG_TYPE_TIME},
+
+  {"MPOOL_NUMA_POLICY", "default",
+   "NUMA memory policy of the request and receive buffer pools of a worker.\n"
+   " - default: Do not change the policy, pages are allocated on the NUMA node\n"
+   "            which touches them first.\n"
+   " - preferred/bind:\n"
+   "     Set the policy of new pool memory to MPOL_PREFERRED/MPOL_BIND, on the\n"
+   "     NUMA node of the first CPU in the worker CPU mask, or the NUMA node of\n"
+   "     the CPU which creates the worker if the mask is not set.",
+   ucs_offsetof(ucp_config_t, ctx.mpool_numa_policy),
+   UCS_CONFIG_TYPE_ENUM(ucs_numa_policy_names)},
+
+  {"MPOOL_IDLE_RELEASE", "0",
+   "Release memory pool chunks whose objects are all unused, after worker\n"
+   "progress did not find any event for this time. Allows the memory which was\n"
+   "allocated by a burst of operations to be returned to the system.\n"
+   "0 disables releasing chunks.",
+   ucs_offsetof(ucp_config_t, ctx.mpool_idle_release), UCS_CONFIG_TYPE_TIME},
+
   {"ADDRESS_DEBUG_INFO",
 #if ENABLE_DEBUG_DATA
    "y",
@@ -200,6 +251,35 @@ static ucs_config_field_t ucp_config_table[] = {
    "if UCX_ADDRESS_DEBUG_INFO is set to 'yes'",
    ucs_offsetof(ucp_config_t, ctx.max_worker_name), UCS_CONFIG_TYPE_UINT},
 
+  {"ADDRESS_TEMPLATE", "n",
+   "Add a hash of the device and transport attributes (address template) to\n"
+   "worker address. Once both sides of an endpoint see that their templates are\n"
+   "identical, wireup messages carry a compact address which refers to template\n"
+   "entries instead of repeating the transport attributes, and the receiver takes\n"
+   "them from its own template instead of parsing them. Templates of full\n"
+   "addresses from other peers are cached as well, so the transport attributes\n"
+   "of a known template are not parsed again.",
+   ucs_offsetof(ucp_config_t, ctx.address_template), UCS_CONFIG_TYPE_BOOL},
+
+  {"ADDRESS_CACHE_SIZE", "64",
+   "Maximal number of remote address templates cached by each worker.",
+   ucs_offsetof(ucp_config_t, ctx.address_cache_size), UCS_CONFIG_TYPE_UINT},
+
+  {"LANE_SELECT_CACHE_SIZE", "256",
+   "Maximal number of lane selection results memoized by each worker. Endpoints\n"
+   "to peers with identical transports, device attributes and reachability reuse\n"
+   "the lanes selected for the first such peer. 0 disables the memoization.",
+   ucs_offsetof(ucp_config_t, ctx.lane_select_cache_size), UCS_CONFIG_TYPE_UINT},
+
+  {"RKEY_CACHE_SIZE", "0",
+   "Maximal number of unpacked remote keys cached by each worker. Unpacking a\n"
+   "key which was already unpacked on the same endpoint returns the cached handle\n"
+   "instead of allocating and unpacking a new one. Keys which are not used are\n"
+   "evicted when the cache is full. Must be enabled only if peers never pack an\n"
+   "identical key for memory which was unmapped and mapped again.\n"
+   "0 disables the cache.",
+   ucs_offsetof(ucp_config_t, ctx.rkey_cache_size), UCS_CONFIG_TYPE_UINT},
+
   {"USE_MT_MUTEX", "n", "Use mutex for multithreading support in UCP.\n"
    "n      - Not use mutex for multithreading support in UCP (use spinlock by default).\n"
    "y      - Use mutex for multithreading support in UCP.\n",
@@ -1561,6 +1641,9 @@ ucs_status_t ucp_init_version(unsigned api_major_version, unsigned api_minor_ver
         goto err_free_config;
     }
 
+    /* calibrate the bulk copy kernels now, rather than on the data path */
+    ucs_memcpy_select();
+
     if (dfl_config != NULL) {
         ucp_config_release(dfl_config);
     }
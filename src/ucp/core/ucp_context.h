@@ -19,6 +19,7 @@
 #include <ucs/datastruct/mpool.h>
 #include <ucs/datastruct/queue_types.h>
 #include <ucs/memory/memtype_cache.h>
+#include <ucs/memory/numa.h>
 #include <ucs/type/spinlock.h>
 #include <ucs/sys/string.h>
 
@@ -44,6 +45,10 @@ typedef struct ucp_context_config {
     /** Threshold for switching UCP to rendezvous protocol in case the calculated
      *  threshold is zero or negative */
     size_t                                 rndv_thresh_fallback;
+    /** Threshold for switching user active messages to rendezvous protocol */
+    size_t                                 am_rndv_thresh;
+    /** Threshold for switching stream sends to rendezvous protocol */
+    size_t                                 stream_rndv_thresh;
     /** The percentage allowed for performance difference between rendezvous
      *  and the eager_zcopy protocol */
     double                                 rndv_perf_diff;
@@ -78,8 +83,24 @@ typedef struct ucp_context_config {
     int                                    address_debug_info;
     /** Maximal size of worker name for debugging */
     unsigned                               max_worker_name;
+    /** Pack address template hash in worker address */
+    int                                    address_template;
+    /** Maximal number of remote address templates cached by a worker */
+    unsigned                               address_cache_size;
+    /** Maximal number of lane selection results memoized by a worker */
+    unsigned                               lane_select_cache_size;
+    /** Maximal number of unpacked remote keys cached by a worker */
+    unsigned                               rkey_cache_size;
     /** Atomic mode */
     ucp_atomic_mode_t                      atomic_mode;
+    /** Waiting mode of ucp_worker_wait */
+    ucp_wait_mode_t                        wait_mode;
+    /** Maximal spin time of hybrid waiting mode */
+    double                                 wait_spin_max;
+    /** NUMA policy of worker memory pools */
+    ucs_numa_policy_t                      mpool_numa_policy;
+    /** Idle time after which unused memory pool chunks are released */
+    double                                 mpool_idle_release;
     /** If use mutex for MT support or not */
     int                                    use_mt_mutex;
     /** On-demand progress */
@@ -163,6 +163,7 @@ ucs_status_t ucp_worker_create_ep(ucp_worker_h worker, const char *peer_name,
 
 void ucp_ep_delete(ucp_ep_h ep)
 {
+    ucp_rkey_cache_purge_ep(ep);
     ucs_callbackq_remove_if(&ep->worker->uct->progress_q,
                             ucp_wireup_msg_ack_cb_pred, ep);
     UCS_STATS_NODE_FREE(ep->stats);
@@ -1427,8 +1428,10 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
 
     config->tag.rndv.rkey_ptr_dst_mds   = 0;
     config->stream.proto                = &ucp_stream_am_proto;
+    config->stream.rndv_thresh          = SIZE_MAX;
     config->am_u.proto                  = &ucp_am_proto;
     config->am_u.reply_proto            = &ucp_am_reply_proto;
+    config->am_u.rndv_thresh            = SIZE_MAX;
     max_rndv_thresh                     = SIZE_MAX;
     max_am_rndv_thresh                  = SIZE_MAX;
     min_am_rndv_thresh                  = 0;
@@ -1662,6 +1665,25 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
        }
     }
 
+    /* Configuration for active message and stream rendezvous: the receiver
+     * fetches the payload with get_zcopy, so a GET capable lane is needed */
+    if ((config->key.am_lane != UCP_NULL_LANE) && (get_zcopy_lane_count > 0) &&
+        ucp_ep_config_test_rndv_support(config)) {
+        if (context->config.ext.am_rndv_thresh == UCS_MEMUNITS_AUTO) {
+            config->am_u.rndv_thresh = config->tag.rndv.rma_thresh;
+        } else {
+            config->am_u.rndv_thresh = ucs_max(context->config.ext.am_rndv_thresh,
+                                               config->tag.rndv.min_get_zcopy);
+        }
+
+        if (context->config.ext.stream_rndv_thresh == UCS_MEMUNITS_AUTO) {
+            config->stream.rndv_thresh = config->tag.rndv.rma_thresh;
+        } else {
+            config->stream.rndv_thresh = ucs_max(context->config.ext.stream_rndv_thresh,
+                                                 config->tag.rndv.min_get_zcopy);
+        }
+    }
+
     memset(&config->rma, 0, sizeof(config->rma));
 
     rma_zcopy_thresh = ucp_ep_config_calc_rma_zcopy_thresh(worker, config,
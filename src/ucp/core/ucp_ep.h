@@ -59,6 +59,8 @@ enum {
     UCP_EP_FLAG_CLOSE_REQ_VALID        = UCS_BIT(11),/* close protocol is started and
                                                         close_req is valid */
     UCP_EP_FLAG_ERR_HANDLER_INVOKED    = UCS_BIT(12),/* error handler was called */
+    UCP_EP_FLAG_ADDR_TEMPLATE          = UCS_BIT(13),/* remote worker has the same
+                                                        address template */
 
     /* DEBUG bits */
     UCP_EP_FLAG_CONNECT_REQ_SENT       = UCS_BIT(16),/* DEBUG: Connection request was sent */
@@ -303,12 +305,18 @@ struct ucp_ep_config {
         /* Protocols used for stream operations
          * (currently it's only AM based). */
         const ucp_request_send_proto_t   *proto;
+        /* Threshold for switching to rendezvous, where the receiver fetches
+         * the payload with get_zcopy */
+        size_t                           rndv_thresh;
     } stream;
     
     struct {
         /* Protocols used for am operations */
         const ucp_request_send_proto_t   *proto;
         const ucp_request_send_proto_t   *reply_proto;
+        /* Threshold for switching to rendezvous, where the receiver fetches
+         * the payload with get_zcopy */
+        size_t                           rndv_thresh;
     } am_u;
 
 };
@@ -386,6 +394,9 @@ typedef struct {
         ucs_list_link_t           ready_list;    /* List entry in worker's EP list */
         ucs_queue_head_t          match_q;       /* Queue of receive data or requests,
                                                     depends on UCP_EP_FLAG_STREAM_HAS_DATA */
+        ucs_queue_head_t          rndv_q;        /* Received data which is ordered
+                                                    after a rendezvous fetch still
+                                                    in progress */
     } stream;
 
     struct {
@@ -37,8 +37,11 @@ typedef struct ucp_tl_rkey {
  * Rkey flags
  */
 enum {
-    UCP_RKEY_DESC_FLAG_POOL       = UCS_BIT(0)  /* Descriptor was allocated from pool
+    UCP_RKEY_DESC_FLAG_POOL       = UCS_BIT(0), /* Descriptor was allocated from pool
                                                    and must be retuned to pool, not free */
+    UCP_RKEY_DESC_FLAG_CACHED     = UCS_BIT(1)  /* Descriptor belongs to the worker
+                                                   rkey cache and is shared by all
+                                                   unpacks of the same key */
 };
 
 /**
@@ -97,6 +100,10 @@ typedef struct ucp_mem_desc {
 
 void ucp_rkey_resolve_inner(ucp_rkey_h rkey, ucp_ep_h ep);
 
+void ucp_rkey_cache_purge_ep(ucp_ep_h ep);
+
+void ucp_rkey_cache_cleanup(ucp_worker_h worker);
+
 ucp_lane_index_t ucp_rkey_find_rma_lane(ucp_context_h context,
                                         const ucp_ep_config_t *config,
                                         ucs_memory_type_t mem_type,
@@ -220,6 +220,8 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_request_memory_reg,
     const ucp_dt_iov_t *iov;
     ucp_dt_reg_t *dt_reg;
     ucs_status_t status;
+    void *span_address;
+    size_t span_length;
     int flags;
     int level;
 
@@ -266,6 +268,20 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_request_memory_reg,
         }
         state->dt.iov.dt_reg = dt_reg;
         break;
+    case UCP_DATATYPE_STRIDED:
+        /* Register the whole address range of the blocks at once, so every
+         * block is covered by the same memory handle */
+        ucp_dt_strided_span(datatype, buffer,
+                            length / ucp_dt_strided(datatype)->elem_size,
+                            &span_address, &span_length);
+        status = ucp_mem_rereg_mds(context, md_map, span_address, span_length,
+                                   flags, NULL, mem_type, NULL,
+                                   state->dt.strided.memh,
+                                   &state->dt.strided.md_map);
+        ucp_trace_req(req_dbg, "mem reg strided span %p len %zu "
+                      "md_map 0x%"PRIx64"/0x%"PRIx64, span_address,
+                      span_length, state->dt.strided.md_map, md_map);
+        break;
     default:
         status = UCS_ERR_INVALID_PARAM;
         ucs_error("Invalid data type %lx", datatype);
@@ -301,6 +317,9 @@ UCS_PROFILE_FUNC_VOID(ucp_request_memory_dereg, (context, datatype, state, req_d
             state->dt.iov.dt_reg = NULL;
         }
         break;
+    case UCP_DATATYPE_STRIDED:
+        ucp_request_dt_dereg(context, &state->dt.strided, 1, req_dbg);
+        break;
     default:
         break;
     }
@@ -383,6 +402,9 @@ ucp_request_send_start(ucp_request_t *req, ssize_t max_short,
                 multi = ucp_dt_iov_count_nonempty(req->send.buffer, dt_count) >
                         msg_config->max_iov;
             }
+        } else if (ucs_unlikely(UCP_DT_IS_STRIDED(req->send.datatype))) {
+            multi = ucp_dt_strided_iov_count(req->send.datatype, dt_count) >
+                    msg_config->max_iov;
         } else {
             multi = 0;
         }
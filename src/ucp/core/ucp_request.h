@@ -41,15 +41,18 @@ enum {
     UCP_REQUEST_FLAG_CALLBACK             = UCS_BIT(6),
     UCP_REQUEST_FLAG_RECV                 = UCS_BIT(7),
     UCP_REQUEST_FLAG_SYNC                 = UCS_BIT(8),
+    UCP_REQUEST_FLAG_RECV_AM              = UCS_BIT(9),
     UCP_REQUEST_FLAG_OFFLOADED            = UCS_BIT(10),
     UCP_REQUEST_FLAG_BLOCK_OFFLOAD        = UCS_BIT(11),
     UCP_REQUEST_FLAG_STREAM_RECV_WAITALL  = UCS_BIT(12),
     UCP_REQUEST_FLAG_SEND_AM              = UCS_BIT(13),
     UCP_REQUEST_FLAG_SEND_TAG             = UCS_BIT(14),
     UCP_REQUEST_FLAG_RNDV_FRAG            = UCS_BIT(15),
+    UCP_REQUEST_FLAG_RECV_STREAM_RNDV     = UCS_BIT(16),
+    UCP_REQUEST_FLAG_STREAM_RNDV_WAIT     = UCS_BIT(17),
 #if UCS_ENABLE_ASSERT
-    UCP_REQUEST_FLAG_STREAM_RECV          = UCS_BIT(16),
-    UCP_REQUEST_DEBUG_FLAG_EXTERNAL       = UCS_BIT(17)
+    UCP_REQUEST_FLAG_STREAM_RECV          = UCS_BIT(18),
+    UCP_REQUEST_DEBUG_FLAG_EXTERNAL       = UCS_BIT(19)
 #else
     UCP_REQUEST_FLAG_STREAM_RECV          = 0,
     UCP_REQUEST_DEBUG_FLAG_EXTERNAL       = 0
@@ -81,9 +84,13 @@ enum {
     UCP_RECV_DESC_FLAG_EAGER_LAST     = UCS_BIT(5), /* Last fragment of eager tag message.
                                                        Used by tag offload protocol. */
     UCP_RECV_DESC_FLAG_RNDV           = UCS_BIT(6), /* Rendezvous request */
-    UCP_RECV_DESC_FLAG_MALLOC         = UCS_BIT(7)  /* Descriptor was allocated with malloc
+    UCP_RECV_DESC_FLAG_MALLOC         = UCS_BIT(7), /* Descriptor was allocated with malloc
                                                        and must be freed, not returned to the
                                                        memory pool or UCT */
+    UCP_RECV_DESC_FLAG_STREAM_RNDV    = UCS_BIT(8), /* Stream payload is still being fetched
+                                                       by rendezvous */
+    UCP_RECV_DESC_FLAG_STREAM_DROP    = UCS_BIT(9)  /* Stream endpoint was closed, release the
+                                                       descriptor once the fetch completes */
 };
 
 
@@ -248,7 +255,8 @@ struct ucp_request {
             ucp_mem_desc_t        *mdesc;
         } send;
 
-        /* "receive" part - used for tag_recv and stream_recv operations */
+        /* "receive" part - used for tag_recv, stream_recv and am_recv_data
+         * operations */
         struct {
             ucs_queue_elem_t      queue;    /* Expected queue element */
             void                  *buffer;  /* Buffer to receive data to */
@@ -292,7 +300,21 @@ struct ucp_request {
                     ucp_stream_recv_nbx_callback_t cb;     /* Completion callback */
                     size_t                         offset; /* Receive data offset */
                     size_t                         length; /* Completion info to fill */
+                    unsigned                       rndv_count; /* Rendezvous fetches
+                                                                  in progress */
                 } stream;
+
+                struct {
+                    ucp_ep_h                ep;       /* Endpoint the data came from */
+                    ucp_request_t           *rreq;    /* Stream receive request, or
+                                                         NULL if fetching to rdesc */
+                    ucp_recv_desc_t         *rdesc;   /* Bounce descriptor */
+                } stream_rndv;
+
+                struct {
+                    ucp_am_recv_data_nbx_callback_t cb;    /* Completion callback */
+                    size_t                          length; /* Completion info to fill */
+                } am;
             };
         } recv;
 
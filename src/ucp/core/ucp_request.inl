@@ -13,6 +13,7 @@
 
 #include <ucp/core/ucp_worker.h>
 #include <ucp/dt/dt.h>
+#include <ucs/arch/memcpy.h>
 #include <ucs/profile/profile.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucp/dt/dt.inl>
@@ -161,14 +162,20 @@ ucp_request_complete_tag_recv(ucp_request_t *req, ucs_status_t status)
 }
 
 static UCS_F_ALWAYS_INLINE void
-ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
-                                 ucs_status_t status)
+ucp_request_complete_am_recv(ucp_request_t *req, ucs_status_t status)
+{
+    ucs_trace_req("completing AM receive request %p (%p) "UCP_REQUEST_FLAGS_FMT
+                  " len %zu, %s", req, req + 1, UCP_REQUEST_FLAGS_ARG(req->flags),
+                  req->recv.am.length, ucs_status_string(status));
+    UCS_PROFILE_REQUEST_EVENT(req, "complete_recv", status);
+    ucp_request_complete(req, recv.am.cb, status, req->recv.am.length,
+                         req->user_data);
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_request_complete_stream_recv_dequeued(ucp_request_t *req,
+                                          ucs_status_t status)
 {
-    /* dequeue request before complete */
-    ucp_request_t *check_req UCS_V_UNUSED =
-            ucs_queue_pull_elem_non_empty(&ep_ext->stream.match_q, ucp_request_t,
-                                          recv.queue);
-    ucs_assert(check_req               == req);
     ucs_assert((req->recv.stream.offset > 0) || UCS_STATUS_IS_ERR(status));
 
     req->recv.stream.length = req->recv.stream.offset;
@@ -181,6 +188,27 @@ ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
                          req->user_data);
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
+                                 ucs_status_t status)
+{
+    /* dequeue request before complete */
+    ucp_request_t *check_req UCS_V_UNUSED =
+            ucs_queue_pull_elem_non_empty(&ep_ext->stream.match_q, ucp_request_t,
+                                          recv.queue);
+    ucs_assert(check_req               == req);
+
+    if (ucs_unlikely(req->recv.stream.rndv_count > 0)) {
+        /* rendezvous fetches into this request are still in progress, the
+         * last one to finish completes it */
+        req->flags  |= UCP_REQUEST_FLAG_STREAM_RNDV_WAIT;
+        req->status  = status;
+        return;
+    }
+
+    ucp_request_complete_stream_recv_dequeued(req, status);
+}
+
 static UCS_F_ALWAYS_INLINE int
 ucp_request_can_complete_stream_recv(ucp_request_t *req)
 {
@@ -305,6 +333,9 @@ ucp_request_send_state_init(ucp_request_t *req, ucp_datatype_t datatype,
         req->send.state.dt.dt.iov.iovcnt        = dt_count;
         req->send.state.dt.dt.iov.dt_reg        = NULL;
         return;
+    case UCP_DATATYPE_STRIDED:
+        req->send.state.dt.dt.strided.md_map    = 0;
+        return;
     case UCP_DATATYPE_GENERIC:
         dt_gen    = ucp_dt_generic(datatype);
         state_gen = dt_gen->ops.start_pack(dt_gen->context, req->send.buffer,
@@ -446,6 +477,8 @@ ucp_send_request_add_reg_lane(ucp_request_t *req, ucp_lane_index_t lane)
         /* Can use the first DT registration element, since
          * they have the same MD maps */
         md_map = req->send.state.dt.dt.iov.dt_reg[0].md_map;
+    } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+        md_map = req->send.state.dt.dt.strided.md_map;
     } else {
         md_map = 0;
     }
@@ -490,8 +523,8 @@ ucp_request_unpack_contig(ucp_request_t *req, void *buf, const void *data,
                           size_t length)
 {
     if (ucs_likely(UCP_MEM_IS_ACCESSIBLE_FROM_CPU(req->recv.mem_type))) {
-        UCS_PROFILE_NAMED_CALL("memcpy_recv", ucs_memcpy_relaxed, buf,
-                               data, length);
+        UCS_PROFILE_NAMED_CALL_VOID("memcpy_recv", ucs_memcpy_bulk, buf,
+                                    data, length);
     } else {
         ucp_mem_type_unpack(req->recv.worker, buf, data, length,
                             req->recv.mem_type);
@@ -546,6 +579,11 @@ ucp_request_recv_data_unpack(ucp_request_t *req, const void *data,
         req->recv.state.offset += length;
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_unpack, req->recv.datatype,
+                              req->recv.buffer, data, offset, length);
+        return UCS_OK;
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(req->recv.datatype);
         status = UCS_PROFILE_NAMED_CALL("dt_unpack", dt_gen->ops.unpack,
@@ -611,6 +649,8 @@ ucp_recv_desc_release(ucp_recv_desc_t *rdesc)
         /* uct desc is slowpath */
         uct_desc = UCS_PTR_BYTE_OFFSET(rdesc, -rdesc->uct_desc_offset);
         uct_iface_release_desc(uct_desc);
+    } else if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC)) {
+        ucs_free(rdesc);
     } else {
         ucs_mpool_put_inline(rdesc);
     }
@@ -16,15 +16,247 @@
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/profile/profile.h>
 #include <ucs/sys/string.h>
+#include <ucs/algorithm/crc.h>
 #include <inttypes.h>
 
 
+/**
+ * Entry of the worker rkey cache. It is followed in memory by the rkey handle,
+ * and then by a copy of the packed key.
+ */
+struct ucp_rkey_cache_entry {
+    ucp_worker_h             worker;      /* Worker which owns the cache */
+    ucp_ep_h                 ep;          /* Endpoint the key was unpacked on,
+                                             NULL if not in the cache */
+    uint32_t                 checksum;    /* Key in the worker hash */
+    unsigned                 refcount;    /* Number of unpacks which were not
+                                             destroyed yet */
+    ucp_md_map_t             md_map;      /* Reachable remote MDs at unpack */
+    size_t                   packed_size; /* Size of the packed key */
+    ucs_list_link_t          list;        /* Link in worker list of idle keys */
+};
+
+
 static struct {
     ucp_md_map_t md_map;
     uint8_t      mem_type;
 } UCS_S_PACKED ucp_mem_dummy_buffer = {0, UCS_MEMORY_TYPE_HOST};
 
 
+static UCS_F_ALWAYS_INLINE ucp_rkey_h
+ucp_rkey_cache_entry_rkey(ucp_rkey_cache_entry_t *entry)
+{
+    return (ucp_rkey_h)(entry + 1);
+}
+
+static UCS_F_ALWAYS_INLINE ucp_rkey_cache_entry_t *
+ucp_rkey_cache_entry_from_rkey(ucp_rkey_h rkey)
+{
+    return (ucp_rkey_cache_entry_t*)rkey - 1;
+}
+
+static UCS_F_ALWAYS_INLINE void *
+ucp_rkey_cache_entry_packed(ucp_rkey_cache_entry_t *entry)
+{
+    ucp_rkey_h rkey = ucp_rkey_cache_entry_rkey(entry);
+
+    return UCS_PTR_BYTE_OFFSET(rkey, sizeof(*rkey) +
+                               (sizeof(rkey->tl_rkey[0]) *
+                                ucs_popcount(entry->md_map)));
+}
+
+static size_t ucp_rkey_buffer_size(const void *rkey_buffer)
+{
+    const uint8_t *p = rkey_buffer;
+    ucp_md_map_t md_map;
+    unsigned md_index;
+
+    md_map = *(ucp_md_map_t*)p;
+    p     += sizeof(ucp_md_map_t) + sizeof(uint8_t);
+    ucs_for_each_bit(md_index, md_map) {
+        p += sizeof(uint8_t) + *p;
+    }
+
+    return UCS_PTR_BYTE_DIFF(rkey_buffer, p);
+}
+
+static void ucp_rkey_release_tl(ucp_rkey_h rkey)
+{
+    unsigned remote_md_index, rkey_index;
+
+    rkey_index = 0;
+    ucs_for_each_bit(remote_md_index, rkey->md_map) {
+        uct_rkey_release(rkey->tl_rkey[rkey_index].cmpt,
+                         &rkey->tl_rkey[rkey_index].rkey);
+        ++rkey_index;
+    }
+}
+
+static void ucp_rkey_cache_entry_free(ucp_rkey_cache_entry_t *entry)
+{
+    ucp_rkey_release_tl(ucp_rkey_cache_entry_rkey(entry));
+    ucs_free(entry);
+}
+
+/* Remove an entry from the cache. It is released now if not used, or by the
+ * last ucp_rkey_destroy() otherwise. */
+static void ucp_rkey_cache_remove(ucp_worker_h worker, khiter_t iter)
+{
+    ucp_rkey_cache_entry_t *entry = kh_val(&worker->rkey_cache.hash, iter);
+
+    kh_del(ucp_worker_rkey_cache, &worker->rkey_cache.hash, iter);
+    entry->ep = NULL;
+    if (entry->refcount == 0) {
+        ucs_list_del(&entry->list);
+        ucp_rkey_cache_entry_free(entry);
+    }
+}
+
+static ucp_rkey_cache_entry_t *
+ucp_rkey_cache_get(ucp_ep_h ep, uint32_t checksum, const void *rkey_buffer,
+                   size_t packed_size, ucp_md_map_t md_map)
+{
+    ucp_worker_h worker = ep->worker;
+    ucp_rkey_cache_entry_t *entry;
+    khiter_t iter;
+
+    iter = kh_get(ucp_worker_rkey_cache, &worker->rkey_cache.hash, checksum);
+    if (iter == kh_end(&worker->rkey_cache.hash)) {
+        return NULL;
+    }
+
+    entry = kh_val(&worker->rkey_cache.hash, iter);
+    if ((entry->ep == ep) && (entry->packed_size == packed_size) &&
+        (entry->md_map == md_map) &&
+        !memcmp(ucp_rkey_cache_entry_packed(entry), rkey_buffer,
+                packed_size)) {
+        if (entry->refcount++ == 0) {
+            ucs_list_del(&entry->list);
+        }
+        return entry;
+    }
+
+    /* Checksum collision, or the endpoint was reconfigured and can reach other
+     * remote MDs: the newer key replaces the cached one */
+    ucp_rkey_cache_remove(worker, iter);
+    return NULL;
+}
+
+/* Allocate a cache entry for a new key, evicting the least recently used idle
+ * key if the cache is full. Returns NULL if all cached keys are in use. */
+static ucp_rkey_cache_entry_t *
+ucp_rkey_cache_entry_alloc(ucp_worker_h worker, const void *rkey_buffer,
+                           size_t packed_size, ucp_md_map_t md_map)
+{
+    ucp_rkey_cache_entry_t *entry;
+    khiter_t iter;
+
+    /* the rkey handle which follows the entry must be aligned */
+    UCS_STATIC_ASSERT((sizeof(*entry) % sizeof(uint64_t)) == 0);
+
+    if (kh_size(&worker->rkey_cache.hash) >=
+        worker->context->config.ext.rkey_cache_size) {
+        if (ucs_list_is_empty(&worker->rkey_cache.idle)) {
+            return NULL;
+        }
+
+        entry = ucs_list_head(&worker->rkey_cache.idle, ucp_rkey_cache_entry_t,
+                              list);
+        iter  = kh_get(ucp_worker_rkey_cache, &worker->rkey_cache.hash,
+                       entry->checksum);
+        ucs_assert(iter != kh_end(&worker->rkey_cache.hash));
+        ucp_rkey_cache_remove(worker, iter);
+        UCS_STATS_UPDATE_COUNTER(worker->stats,
+                                 UCP_WORKER_STAT_RKEY_CACHE_EVICT, 1);
+    }
+
+    entry = ucs_malloc(sizeof(*entry) + sizeof(ucp_rkey_t) +
+                       (sizeof(ucp_tl_rkey_t) * ucs_popcount(md_map)) +
+                       packed_size, "ucp_rkey_cache_entry");
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    entry->worker      = worker;
+    entry->ep          = NULL;
+    entry->refcount    = 1;
+    entry->md_map      = md_map;
+    entry->packed_size = packed_size;
+    memcpy(ucp_rkey_cache_entry_packed(entry), rkey_buffer, packed_size);
+    return entry;
+}
+
+static void ucp_rkey_cache_add(ucp_ep_h ep, ucp_rkey_cache_entry_t *entry,
+                               uint32_t checksum)
+{
+    ucp_worker_h worker = ep->worker;
+    khiter_t iter;
+    int ret;
+
+    iter = kh_put(ucp_worker_rkey_cache, &worker->rkey_cache.hash, checksum,
+                  &ret);
+    if (ret == UCS_KH_PUT_FAILED) {
+        /* the key is used uncached, and released by ucp_rkey_destroy() */
+        return;
+    }
+
+    ucs_assert(ret != UCS_KH_PUT_KEY_PRESENT);
+    kh_val(&worker->rkey_cache.hash, iter) = entry;
+    entry->ep       = ep;
+    entry->checksum = checksum;
+}
+
+static void ucp_rkey_cache_put(ucp_rkey_h rkey)
+{
+    ucp_rkey_cache_entry_t *entry = ucp_rkey_cache_entry_from_rkey(rkey);
+    ucp_worker_h worker           = entry->worker;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+    ucs_assert(entry->refcount > 0);
+    if (--entry->refcount == 0) {
+        if (entry->ep != NULL) {
+            ucs_list_add_tail(&worker->rkey_cache.idle, &entry->list);
+        } else {
+            ucp_rkey_cache_entry_free(entry);
+        }
+    }
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+}
+
+void ucp_rkey_cache_purge_ep(ucp_ep_h ep)
+{
+    ucp_worker_h worker = ep->worker;
+    khiter_t iter;
+
+    if (kh_size(&worker->rkey_cache.hash) == 0) {
+        return;
+    }
+
+    for (iter = kh_begin(&worker->rkey_cache.hash);
+         iter != kh_end(&worker->rkey_cache.hash); ++iter) {
+        if (kh_exist(&worker->rkey_cache.hash, iter) &&
+            (kh_val(&worker->rkey_cache.hash, iter)->ep == ep)) {
+            ucp_rkey_cache_remove(worker, iter);
+        }
+    }
+}
+
+void ucp_rkey_cache_cleanup(ucp_worker_h worker)
+{
+    ucp_rkey_cache_entry_t *entry;
+
+    kh_foreach_value(&worker->rkey_cache.hash, entry, {
+        if (entry->refcount > 0) {
+            ucs_warn("worker %p: cached rkey %p was not destroyed", worker,
+                     ucp_rkey_cache_entry_rkey(entry));
+        }
+        ucp_rkey_cache_entry_free(entry);
+    })
+
+    kh_destroy_inplace(ucp_worker_rkey_cache, &worker->rkey_cache.hash);
+}
+
+
 size_t ucp_rkey_packed_size(ucp_context_h context, ucp_md_map_t md_map)
 {
     size_t size, md_size;
@@ -174,7 +406,10 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_ep_rkey_unpack, (ep, rkey_buffer, rkey_p),
                  ucp_ep_h ep, const void *rkey_buffer,
                  ucp_rkey_h *rkey_p)
 {
-    ucp_worker_h  worker = ep->worker;
+    ucp_worker_h  worker          = ep->worker;
+    ucp_rkey_cache_entry_t *entry = NULL;
+    uint32_t checksum             = 0;
+    size_t packed_size            = 0;
     const ucp_ep_config_t *ep_config;
     unsigned remote_md_index;
     ucp_md_map_t md_map, remote_md_map;
@@ -205,12 +440,39 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_ep_rkey_unpack, (ep, rkey_buffer, rkey_p),
     md_count = ucs_popcount(md_map);
     p       += sizeof(ucp_md_map_t);
 
+    /* Return the cached handle if the same key was already unpacked on this
+     * endpoint. A new key is unpacked into a cache entry, unless all cached
+     * keys are in use.
+     */
+    if (worker->context->config.ext.rkey_cache_size > 0) {
+        packed_size = ucp_rkey_buffer_size(rkey_buffer);
+        checksum    = ucs_crc32(ucs_crc32(0, &ep, sizeof(ep)), rkey_buffer,
+                                packed_size);
+        entry       = ucp_rkey_cache_get(ep, checksum, rkey_buffer,
+                                         packed_size, md_map);
+        if (entry != NULL) {
+            UCS_STATS_UPDATE_COUNTER(worker->stats,
+                                     UCP_WORKER_STAT_RKEY_CACHE_HIT, 1);
+            *rkey_p = ucp_rkey_cache_entry_rkey(entry);
+            status  = UCS_OK;
+            goto out_unlock;
+        }
+
+        UCS_STATS_UPDATE_COUNTER(worker->stats,
+                                 UCP_WORKER_STAT_RKEY_CACHE_MISS, 1);
+        entry = ucp_rkey_cache_entry_alloc(worker, rkey_buffer, packed_size,
+                                           md_map);
+    }
+
     /* Allocate rkey handle which holds UCT rkeys for all remote MDs. Small key
      * allocations are done from a memory pool.
      * We keep all of them to handle a future transport switch.
      */
     flags = 0;
-    if (md_count <= UCP_RKEY_MPOOL_MAX_MD) {
+    if (entry != NULL) {
+        rkey  = ucp_rkey_cache_entry_rkey(entry);
+        flags = UCP_RKEY_DESC_FLAG_CACHED;
+    } else if (md_count <= UCP_RKEY_MPOOL_MAX_MD) {
         rkey  = ucs_mpool_get_inline(&worker->rkey_mp);
         flags = UCP_RKEY_DESC_FLAG_POOL;
     } else {
@@ -281,6 +543,10 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_ep_rkey_unpack, (ep, rkey_buffer, rkey_p),
     ucs_assert((rkey_index > 0) || (rkey->md_map == 0));
 
     ucp_rkey_resolve_inner(rkey, ep);
+    if (entry != NULL) {
+        ucp_rkey_cache_add(ep, entry, checksum);
+    }
+
     *rkey_p = rkey;
     status  = UCS_OK;
 
@@ -354,16 +620,15 @@ ucs_status_t ucp_rkey_ptr(ucp_rkey_h rkey, uint64_t raddr, void **addr_p)
 
 void ucp_rkey_destroy(ucp_rkey_h rkey)
 {
-    unsigned remote_md_index, rkey_index;
     ucp_worker_h UCS_V_UNUSED worker;
 
-    rkey_index = 0;
-    ucs_for_each_bit(remote_md_index, rkey->md_map) {
-        uct_rkey_release(rkey->tl_rkey[rkey_index].cmpt,
-                         &rkey->tl_rkey[rkey_index].rkey);
-        ++rkey_index;
+    if (rkey->flags & UCP_RKEY_DESC_FLAG_CACHED) {
+        ucp_rkey_cache_put(rkey);
+        return;
     }
 
+    ucp_rkey_release_tl(rkey);
+
     if (rkey->flags & UCP_RKEY_DESC_FLAG_POOL) {
         worker = ucs_container_of(ucs_mpool_obj_owner(rkey), ucp_worker_t,
                                   rkey_mp);
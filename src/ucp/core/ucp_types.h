@@ -46,6 +46,9 @@ typedef struct ucp_recv_desc            ucp_recv_desc_t;
 typedef struct ucp_address_iface_attr   ucp_address_iface_attr_t;
 typedef struct ucp_address_entry        ucp_address_entry_t;
 typedef struct ucp_unpacked_address     ucp_unpacked_address_t;
+typedef struct ucp_address_template     ucp_address_template_t;
+typedef struct ucp_wireup_select_memo   ucp_wireup_select_memo_t;
+typedef struct ucp_rkey_cache_entry     ucp_rkey_cache_entry_t;
 typedef struct ucp_wireup_ep            ucp_wireup_ep_t;
 typedef struct ucp_request_send_proto   ucp_request_send_proto_t;
 typedef struct ucp_worker_iface         ucp_worker_iface_t;
@@ -96,6 +99,10 @@ enum {
                                           defined AM */
     UCP_AM_ID_SINGLE_REPLY      =  26, /* Single fragment user defined AM
                                           carrying remote ep for reply */
+    UCP_AM_ID_AM_RNDV_RTS       =  27, /* Ready-to-Send to init user defined
+                                          AM rendezvous */
+    UCP_AM_ID_STREAM_RNDV_RTS   =  28, /* Ready-to-Send to init stream
+                                          rendezvous */
     UCP_AM_ID_LAST,
     UCP_AM_ID_MAX               =  UCT_AM_ID_MAX  /* Total IDs available for pre-registration */
 };
@@ -113,6 +120,17 @@ typedef enum {
 } ucp_atomic_mode_t;
 
 
+/**
+ * Waiting mode of ucp_worker_wait.
+ */
+typedef enum {
+    UCP_WAIT_MODE_BLOCK,     /* Arm the worker and block until an event */
+    UCP_WAIT_MODE_HYBRID,    /* Progress the worker for an adaptive spin time,
+                              * then arm and block */
+    UCP_WAIT_MODE_LAST
+} ucp_wait_mode_t;
+
+
 /**
  * Communication scheme in RNDV protocol.
  */
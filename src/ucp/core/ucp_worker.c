@@ -16,6 +16,7 @@
 #include "ucp_request.inl"
 
 #include <ucp/wireup/address.h>
+#include <ucp/wireup/wireup.h>
 #include <ucp/wireup/wireup_cm.h>
 #include <ucp/wireup/wireup_ep.h>
 #include <ucp/tag/eager.h>
@@ -61,6 +62,26 @@ static ucs_stats_class_t ucp_worker_tm_offload_stats_class = {
     }
 };
 
+#define UCP_WORKER_WAIT_HIST_NAMES(_base, _prefix) \
+    [(_base) + 0] = _prefix "_lt_1us", \
+    [(_base) + 1] = _prefix "_lt_4us", \
+    [(_base) + 2] = _prefix "_lt_16us", \
+    [(_base) + 3] = _prefix "_lt_64us", \
+    [(_base) + 4] = _prefix "_lt_256us", \
+    [(_base) + 5] = _prefix "_lt_1ms", \
+    [(_base) + 6] = _prefix "_lt_4ms", \
+    [(_base) + 7] = _prefix "_ge_4ms"
+
+static ucs_stats_class_t ucp_worker_wait_stats_class = {
+    .name           = "wait",
+    .num_counters   = UCP_WORKER_WAIT_STAT_LAST,
+    .counter_names  = {
+        UCP_WORKER_WAIT_HIST_NAMES(UCP_WORKER_WAIT_STAT_IDLE,  "idle"),
+        UCP_WORKER_WAIT_HIST_NAMES(UCP_WORKER_WAIT_STAT_SPIN,  "spin"),
+        UCP_WORKER_WAIT_HIST_NAMES(UCP_WORKER_WAIT_STAT_SLEEP, "sleep")
+    }
+};
+
 static ucs_stats_class_t ucp_worker_stats_class = {
     .name           = "ucp_worker",
     .num_counters   = UCP_WORKER_STAT_LAST,
@@ -73,7 +94,15 @@ static ucs_stats_class_t ucp_worker_stats_class = {
         [UCP_WORKER_STAT_TAG_RX_RNDV_UNEXP]        = "rx_rndv_rts_unexp",
         [UCP_WORKER_STAT_TAG_RX_RNDV_GET_ZCOPY]    = "rx_rndv_get_zcopy",
         [UCP_WORKER_STAT_TAG_RX_RNDV_SEND_RTR]     = "rx_rndv_send_rtr",
-        [UCP_WORKER_STAT_TAG_RX_RNDV_RKEY_PTR]     = "rx_rndv_rkey_ptr"
+        [UCP_WORKER_STAT_TAG_RX_RNDV_RKEY_PTR]     = "rx_rndv_rkey_ptr",
+        [UCP_WORKER_STAT_ADDRESS_TEMPLATE_HIT]     = "address_template_hit",
+        [UCP_WORKER_STAT_ADDRESS_TEMPLATE_MISS]    = "address_template_miss",
+        [UCP_WORKER_STAT_LANE_SELECT_HIT]          = "lane_select_hit",
+        [UCP_WORKER_STAT_LANE_SELECT_MISS]         = "lane_select_miss",
+        [UCP_WORKER_STAT_LANE_SELECT_NSEC]         = "lane_select_nsec",
+        [UCP_WORKER_STAT_RKEY_CACHE_HIT]           = "rkey_cache_hit",
+        [UCP_WORKER_STAT_RKEY_CACHE_MISS]          = "rkey_cache_miss",
+        [UCP_WORKER_STAT_RKEY_CACHE_EVICT]         = "rkey_cache_evict"
     }
 };
 #endif
@@ -399,6 +428,9 @@ static ucs_status_t ucp_worker_wakeup_signal_fd(ucp_worker_h worker)
 
     ucs_trace_func("worker=%p fd=%d", worker, worker->eventfd);
 
+    /* let a spinning ucp_worker_wait know about the signal */
+    ucs_atomic_add32(&worker->wait.signal_count, 1);
+
     do {
         ret = write(worker->eventfd, &dummy, sizeof(dummy));
         if (ret == sizeof(dummy)) {
@@ -425,6 +457,84 @@ void ucp_worker_signal_internal(ucp_worker_h worker)
     }
 }
 
+static void ucp_worker_wait_init(ucp_worker_h worker)
+{
+    ucp_context_h context = worker->context;
+
+    if (context->config.ext.wait_mode == UCP_WAIT_MODE_HYBRID) {
+        worker->wait.spin_max = ucs_time_from_sec(context->config.ext.wait_spin_max);
+    } else {
+        worker->wait.spin_max = 0;
+    }
+
+    /* start with the full spin time, until there is idle time history */
+    worker->wait.spin_budget       = worker->wait.spin_max;
+    worker->wait.idle_avg          = worker->wait.spin_max / 2;
+    worker->wait.signal_count      = 0;
+    worker->wait.last_signal_count = 0;
+}
+
+static UCS_F_MAYBE_UNUSED unsigned ucp_worker_wait_hist_bucket(ucs_time_t time)
+{
+    uint64_t usec = (uint64_t)ucs_time_to_usec(time);
+
+    if (usec == 0) {
+        return 0;
+    }
+
+    return ucs_min(1 + (ucs_ilog2(usec) / 2), UCP_WORKER_WAIT_HIST_BUCKETS - 1);
+}
+
+#define UCP_WORKER_WAIT_STAT_UPDATE(_worker, _name, _time) \
+    UCS_STATS_UPDATE_COUNTER((_worker)->wait_stats, \
+                             UCP_WORKER_WAIT_STAT_##_name + \
+                             ucp_worker_wait_hist_bucket(_time), 1)
+
+/*
+ * Update the spin time of the next wait according to the moving average of the
+ * idle time. If events usually arrive within the maximal spin time, spin twice
+ * the average idle time to catch most of them without sleeping. Otherwise,
+ * spinning would likely be wasted, so sleep right away.
+ */
+static void ucp_worker_wait_update(ucp_worker_h worker, ucs_time_t idle_time)
+{
+    ucs_time_t idle_avg;
+
+    idle_avg              = worker->wait.idle_avg -
+                            (worker->wait.idle_avg / 8) + (idle_time / 8);
+    worker->wait.idle_avg = idle_avg;
+
+    if (idle_avg <= worker->wait.spin_max) {
+        worker->wait.spin_budget = ucs_min(idle_avg * 2, worker->wait.spin_max);
+    } else {
+        worker->wait.spin_budget = 0;
+    }
+
+    UCP_WORKER_WAIT_STAT_UPDATE(worker, IDLE, idle_time);
+}
+
+/* Progress the worker until there are events, a wakeup signal since the last
+ * wait, or the spin time is over. Returns nonzero if there was an event. */
+static int ucp_worker_wait_spin(ucp_worker_h worker, ucs_time_t start_time,
+                                ucs_time_t *end_time_p)
+{
+    ucs_time_t deadline = start_time + worker->wait.spin_budget;
+    ucs_time_t now;
+
+    do {
+        if ((ucp_worker_progress(worker) > 0) ||
+            (worker->wait.signal_count != worker->wait.last_signal_count)) {
+            *end_time_p = ucs_get_time();
+            return 1;
+        }
+
+        now = ucs_get_time();
+    } while (now < deadline);
+
+    *end_time_p = now;
+    return 0;
+}
+
 static unsigned ucp_worker_iface_err_handle_progress(void *arg)
 {
     ucp_worker_err_handle_arg_t *err_handle_arg = arg;
@@ -1642,6 +1752,87 @@ static void ucp_worker_print_used_tls(const ucp_ep_config_key_t *key,
     ucs_info("%s", info);
 }
 
+static void ucp_worker_mpool_init(ucp_worker_h worker,
+                                  const ucp_worker_params_t *params)
+{
+    ucp_context_h context = worker->context;
+    int cpu;
+
+    if (context->config.ext.mpool_numa_policy == UCS_NUMA_POLICY_DEFAULT) {
+        worker->mpool.numa_node = -1;
+    } else {
+        cpu = -1;
+        if (params->field_mask & UCP_WORKER_PARAM_FIELD_CPU_MASK) {
+            cpu = ucs_cpu_set_find_lcs(&params->cpu_mask);
+            if (!ucs_cpu_is_set(cpu, &params->cpu_mask)) {
+                cpu = -1;
+            }
+        }
+
+        worker->mpool.numa_node = (cpu >= 0) ? ucs_numa_node_of_cpu(cpu) :
+                                  ucs_numa_current_node();
+    }
+
+    if (context->config.ext.mpool_idle_release > 0) {
+        worker->mpool.idle_release =
+                ucs_time_from_sec(context->config.ext.mpool_idle_release);
+    } else {
+        worker->mpool.idle_release = 0;
+    }
+
+    worker->mpool.idle_deadline = UCS_TIME_INFINITY;
+    worker->mpool.active        = 1;
+}
+
+/* Bind a pool which uses a built-in chunk allocator to the worker NUMA node */
+static void ucp_worker_mpool_set_numa(ucp_worker_h worker, ucs_mpool_t *mp)
+{
+    if (worker->mpool.numa_node < 0) {
+        return;
+    }
+
+    ucs_mpool_set_numa_node(mp, worker->context->config.ext.mpool_numa_policy,
+                            worker->mpool.numa_node);
+}
+
+static void ucp_worker_mpool_release_idle(ucp_worker_h worker)
+{
+    unsigned count;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    count  = ucs_mpool_release_idle(&worker->am_mp);
+    count += ucs_mpool_release_idle(&worker->reg_mp);
+    count += ucs_mpool_release_idle(&worker->rndv_frag_mp);
+    count += ucs_mpool_release_idle(&worker->req_mp);
+    count += ucs_mpool_release_idle(&worker->rkey_mp);
+    UCS_ASYNC_UNBLOCK(&worker->async);
+
+    ucs_debug("worker %p: released %u idle memory pool chunks", worker, count);
+}
+
+/*
+ * Release unused memory pool chunks once progress did not find events for the
+ * idle release time. Chunks are released once per idle period.
+ */
+static void ucp_worker_mpool_check_idle(ucp_worker_h worker, unsigned count)
+{
+    ucs_time_t now;
+
+    if (count > 0) {
+        worker->mpool.active = 1;
+        return;
+    }
+
+    now = ucs_get_time();
+    if (worker->mpool.active) {
+        worker->mpool.active        = 0;
+        worker->mpool.idle_deadline = now + worker->mpool.idle_release;
+    } else if (now >= worker->mpool.idle_deadline) {
+        worker->mpool.idle_deadline = UCS_TIME_INFINITY;
+        ucp_worker_mpool_release_idle(worker);
+    }
+}
+
 static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
 {
     size_t           max_mp_entry_size = 0;
@@ -1668,6 +1859,8 @@ static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
         goto out;
     }
 
+    ucp_worker_mpool_set_numa(worker, &worker->am_mp);
+
     status = ucs_mpool_init(&worker->reg_mp, 0,
                             context->config.ext.seg_size + sizeof(ucp_mem_desc_t),
                             sizeof(ucp_mem_desc_t), UCS_SYS_CACHE_LINE_SIZE,
@@ -1827,11 +2020,17 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     worker->num_ifaces        = 0;
     worker->am_message_id     = ucs_generate_uuid(0);
     worker->rkey_ptr_cb_id    = UCS_CALLBACKQ_ID_NULL;
+    ucp_worker_wait_init(worker);
+    ucp_worker_mpool_init(worker, params);
     ucs_queue_head_init(&worker->rkey_ptr_reqs);
     ucs_list_head_init(&worker->arm_ifaces);
     ucs_list_head_init(&worker->stream_ready_eps);
     ucs_list_head_init(&worker->all_eps);
     ucp_ep_match_init(&worker->ep_match_ctx);
+    kh_init_inplace(ucp_worker_select_memo, &worker->select_memo);
+    kh_init_inplace(ucp_worker_rkey_cache, &worker->rkey_cache.hash);
+    kh_init_inplace(ucp_worker_addr_tmpl, &worker->address_templates);
+    ucs_list_head_init(&worker->rkey_cache.idle);
 
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen_t) <= sizeof(ucp_ep_t));
     if (context->config.features & (UCP_FEATURE_STREAM | UCP_FEATURE_AM)) {
@@ -1866,12 +2065,18 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
         goto err_free_stats;
     }
 
+    status = UCS_STATS_NODE_ALLOC(&worker->wait_stats,
+                                  &ucp_worker_wait_stats_class, worker->stats);
+    if (status != UCS_OK) {
+        goto err_free_tm_offload_stats;
+    }
+
     status = ucs_async_context_init(&worker->async,
                                     context->config.ext.use_mt_mutex ?
                                     UCS_ASYNC_MODE_THREAD_MUTEX :
                                     UCS_ASYNC_THREAD_LOCK_TYPE);
     if (status != UCS_OK) {
-        goto err_free_tm_offload_stats;
+        goto err_free_wait_stats;
     }
 
     /* Create the underlying UCT worker */
@@ -1889,6 +2094,8 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
         goto err_destroy_uct_worker;
     }
 
+    ucp_worker_mpool_set_numa(worker, &worker->req_mp);
+
     /* create memory pool for small rkeys */
     status = ucs_mpool_init(&worker->rkey_mp, 0,
                             sizeof(ucp_rkey_t) +
@@ -1912,7 +2119,7 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     }
 
     /* Initialize tag matching */
-    status = ucp_tag_match_init(&worker->tm);
+    status = ucp_tag_match_init(&worker->tm, context->config.tag_sender_mask);
     if (status != UCS_OK) {
         goto err_wakeup_cleanup;
     }
@@ -1950,6 +2157,12 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     /* Select atomic resources */
     ucp_worker_init_atomic_tls(worker);
 
+    /* Build the template of local worker address */
+    status = ucp_address_template_init(worker);
+    if (status != UCS_OK) {
+        goto err_close_mpools;
+    }
+
     /* Init extensions registered for this context */
     status = ucp_worker_init_extensions(worker);
     if (status != UCS_OK) {
@@ -1984,11 +2197,16 @@ err_destroy_uct_worker:
     uct_worker_destroy(worker->uct);
 err_destroy_async:
     ucs_async_context_cleanup(&worker->async);
+err_free_wait_stats:
+    UCS_STATS_NODE_FREE(worker->wait_stats);
 err_free_tm_offload_stats:
     UCS_STATS_NODE_FREE(worker->tm_offload_stats);
 err_free_stats:
     UCS_STATS_NODE_FREE(worker->stats);
 err_free:
+    ucp_rkey_cache_cleanup(worker);
+    ucp_wireup_select_memo_cleanup(worker);
+    ucp_address_template_cleanup(worker);
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
     ucs_free(worker);
     return status;
@@ -2034,12 +2252,16 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucs_mpool_cleanup(&worker->rndv_frag_mp, 1);
     ucp_worker_close_ifaces(worker);
     ucp_worker_wakeup_cleanup(worker);
+    ucp_rkey_cache_cleanup(worker);
     ucs_mpool_cleanup(&worker->rkey_mp, 1);
     ucs_mpool_cleanup(&worker->req_mp, 1);
     uct_worker_destroy(worker->uct);
     ucs_async_context_cleanup(&worker->async);
     ucp_ep_match_cleanup(&worker->ep_match_ctx);
+    ucp_wireup_select_memo_cleanup(worker);
+    ucp_address_template_cleanup(worker);
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
+    UCS_STATS_NODE_FREE(worker->wait_stats);
     UCS_STATS_NODE_FREE(worker->tm_offload_stats);
     UCS_STATS_NODE_FREE(worker->stats);
     ucs_free(worker);
@@ -2100,6 +2322,10 @@ unsigned ucp_worker_progress(ucp_worker_h worker)
     count = uct_worker_progress(worker->uct);
     ucs_async_check_miss(&worker->async);
 
+    if (ucs_unlikely(worker->mpool.idle_release != 0)) {
+        ucp_worker_mpool_check_idle(worker, count);
+    }
+
     /* coverity[assert_side_effect] */
     ucs_assert(--worker->inprogress == 0);
 
@@ -2212,7 +2438,7 @@ void ucp_worker_wait_mem(ucp_worker_h worker, void *address)
     ucs_arch_wait_mem(address);
 }
 
-ucs_status_t ucp_worker_wait(ucp_worker_h worker)
+static ucs_status_t ucp_worker_wait_block(ucp_worker_h worker)
 {
     ucp_worker_iface_t *wiface;
     struct pollfd *pfd;
@@ -2220,11 +2446,6 @@ ucs_status_t ucp_worker_wait(ucp_worker_h worker)
     nfds_t nfds;
     int ret;
 
-    ucs_trace_func("worker %p", worker);
-
-    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_WAKEUP,
-                                    return UCS_ERR_INVALID_PARAM);
-
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
 
     status = ucp_worker_arm(worker);
@@ -2283,6 +2504,43 @@ out:
     return status;
 }
 
+ucs_status_t ucp_worker_wait(ucp_worker_h worker)
+{
+    ucs_time_t start_time, spin_end_time, end_time;
+    ucs_status_t status;
+    int is_event;
+
+    ucs_trace_func("worker %p", worker);
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_WAKEUP,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    if (worker->wait.spin_max == 0) {
+        return ucp_worker_wait_block(worker);
+    }
+
+    start_time    = ucs_get_time();
+    spin_end_time = start_time;
+    if (worker->wait.spin_budget > 0) {
+        is_event = ucp_worker_wait_spin(worker, start_time, &spin_end_time);
+        UCP_WORKER_WAIT_STAT_UPDATE(worker, SPIN, spin_end_time - start_time);
+        if (is_event) {
+            end_time = spin_end_time;
+            status   = UCS_OK;
+            goto out;
+        }
+    }
+
+    status   = ucp_worker_wait_block(worker);
+    end_time = ucs_get_time();
+    UCP_WORKER_WAIT_STAT_UPDATE(worker, SLEEP, end_time - spin_end_time);
+
+out:
+    worker->wait.last_signal_count = worker->wait.signal_count;
+    ucp_worker_wait_update(worker, end_time - start_time);
+    return status;
+}
+
 ucs_status_t ucp_worker_signal(ucp_worker_h worker)
 {
     ucs_trace_func("worker %p", worker);
@@ -2313,6 +2571,40 @@ void ucp_worker_release_address(ucp_worker_h worker, ucp_address_t *address)
 }
 
 
+static void ucp_worker_print_mpool_info(ucs_mpool_t *mp, FILE *stream)
+{
+    ucs_mpool_data_t *data = mp->data;
+    char backing_str[128], size_str[32], node_str[16];
+    unsigned backing;
+    size_t length;
+
+    backing_str[0] = '\0';
+    for (backing = 0; backing < UCS_MPOOL_CHUNK_BACKING_LAST; ++backing) {
+        if (data->backing_size[backing] == 0) {
+            continue;
+        }
+
+        length = strlen(backing_str);
+        ucs_snprintf_safe(backing_str + length, sizeof(backing_str) - length,
+                          "%s%s %s", (length > 0) ? ", " : "",
+                          ucs_mpool_chunk_backing_names[backing],
+                          ucs_memunits_to_str(data->backing_size[backing],
+                                              size_str, sizeof(size_str)));
+    }
+
+    if (data->numa_node >= 0) {
+        ucs_snprintf_safe(node_str, sizeof(node_str), "%d", data->numa_node);
+    } else {
+        ucs_snprintf_safe(node_str, sizeof(node_str), "any");
+    }
+
+    fprintf(stream, "#                   mpool: %s %s allocated (%s), numa node %s\n",
+            ucs_mpool_name(mp),
+            ucs_memunits_to_str(ucs_mpool_chunks_size(mp), size_str,
+                                sizeof(size_str)),
+            (backing_str[0] != '\0') ? backing_str : "empty", node_str);
+}
+
 void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
 {
     ucp_context_h context = worker->context;
@@ -2352,6 +2644,14 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
         fprintf(stream, "\n");
     }
 
+    UCS_ASYNC_BLOCK(&worker->async);
+    ucp_worker_print_mpool_info(&worker->req_mp, stream);
+    ucp_worker_print_mpool_info(&worker->rkey_mp, stream);
+    ucp_worker_print_mpool_info(&worker->am_mp, stream);
+    ucp_worker_print_mpool_info(&worker->reg_mp, stream);
+    ucp_worker_print_mpool_info(&worker->rndv_frag_mp, stream);
+    UCS_ASYNC_UNBLOCK(&worker->async);
+
     fprintf(stream, "#\n");
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
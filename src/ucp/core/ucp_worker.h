@@ -15,6 +15,7 @@
 #include <ucp/core/ucp_am.h>
 #include <ucp/tag/tag_match.h>
 #include <ucp/wireup/ep_match.h>
+#include <ucs/datastruct/khash.h>
 #include <ucs/datastruct/mpool.h>
 #include <ucs/datastruct/queue_types.h>
 #include <ucs/datastruct/strided_alloc.h>
@@ -101,6 +102,23 @@ enum {
     UCP_WORKER_STAT_TAG_RX_RNDV_SEND_RTR,
     UCP_WORKER_STAT_TAG_RX_RNDV_RKEY_PTR,
 
+    /* Addresses unpacked using a known address template, or which carried a
+     * template that is unknown or does not match their contents */
+    UCP_WORKER_STAT_ADDRESS_TEMPLATE_HIT,
+    UCP_WORKER_STAT_ADDRESS_TEMPLATE_MISS,
+
+    /* Lane selections taken from the selection memo or computed, and the total
+     * time spent in lane selection */
+    UCP_WORKER_STAT_LANE_SELECT_HIT,
+    UCP_WORKER_STAT_LANE_SELECT_MISS,
+    UCP_WORKER_STAT_LANE_SELECT_NSEC,
+
+    /* Remote keys returned from the rkey cache or unpacked anew, and cached
+     * keys evicted to make room for new ones */
+    UCP_WORKER_STAT_RKEY_CACHE_HIT,
+    UCP_WORKER_STAT_RKEY_CACHE_MISS,
+    UCP_WORKER_STAT_RKEY_CACHE_EVICT,
+
     UCP_WORKER_STAT_LAST
 };
 
@@ -126,6 +144,29 @@ enum {
 };
 
 
+/* Number of buckets in ucp_worker_wait histograms: below 1us, then every
+ * bucket is 4 times wider than the previous one, up to 4ms and more */
+#define UCP_WORKER_WAIT_HIST_BUCKETS 8
+
+
+/**
+ * UCP worker wait statistics. Every counter group is a histogram of
+ * UCP_WORKER_WAIT_HIST_BUCKETS counters.
+ */
+enum {
+    /* Time from entering ucp_worker_wait until an event */
+    UCP_WORKER_WAIT_STAT_IDLE,
+    /* Time spent progressing the worker before arming it */
+    UCP_WORKER_WAIT_STAT_SPIN  = UCP_WORKER_WAIT_STAT_IDLE +
+                                 UCP_WORKER_WAIT_HIST_BUCKETS,
+    /* Time spent blocked on the event file descriptor */
+    UCP_WORKER_WAIT_STAT_SLEEP = UCP_WORKER_WAIT_STAT_SPIN +
+                                 UCP_WORKER_WAIT_HIST_BUCKETS,
+    UCP_WORKER_WAIT_STAT_LAST  = UCP_WORKER_WAIT_STAT_SLEEP +
+                                 UCP_WORKER_WAIT_HIST_BUCKETS
+};
+
+
 #define UCP_WORKER_UCT_RECV_EVENT_ARM_FLAGS  (UCT_EVENT_RECV | \
                                               UCT_EVENT_RECV_SIG)
 #define UCP_WORKER_UCT_RECV_EVENT_CAP_FLAGS  (UCT_IFACE_FLAG_EVENT_RECV | \
@@ -196,6 +237,18 @@ struct ucp_worker_cm {
 };
 
 
+/* Hash of lane selection results, by remote address signature checksum */
+KHASH_MAP_INIT_INT(ucp_worker_select_memo, ucp_wireup_select_memo_t*);
+
+
+/* Hash of remote address templates, by template hash */
+KHASH_MAP_INIT_INT64(ucp_worker_addr_tmpl, ucp_address_template_t*);
+
+
+/* Hash of cached remote keys, by checksum of endpoint and packed key */
+KHASH_MAP_INIT_INT(ucp_worker_rkey_cache, ucp_rkey_cache_entry_t*);
+
+
 /**
  * UCP worker (thread context).
  */
@@ -219,6 +272,24 @@ typedef struct ucp_worker {
     int                           eventfd;       /* Event fd to support signal() calls */
     unsigned                      uct_events;    /* UCT arm events */
     ucs_list_link_t               arm_ifaces;    /* List of interfaces to arm */
+    struct {
+        ucs_time_t                spin_max;      /* Maximal spin time */
+        ucs_time_t                spin_budget;   /* Spin time of next wait */
+        ucs_time_t                idle_avg;      /* Moving average of idle time */
+        volatile uint32_t         signal_count;  /* Number of wakeup signals */
+        uint32_t                  last_signal_count; /* Signals seen by the
+                                                        last wait */
+    } wait;                                      /* Hybrid ucp_worker_wait state */
+    struct {
+        int                       numa_node;     /* NUMA node of the pools */
+        ucs_time_t                idle_release;  /* Idle time to release unused
+                                                    chunks after, 0 - never */
+        ucs_time_t                idle_deadline; /* Time to release unused
+                                                    chunks at */
+        int                       active;        /* Whether progress found
+                                                    events since the last idle
+                                                    check */
+    } mpool;                                     /* Memory pools state */
 
     void                          *user_data;    /* User-defined data */
     ucs_strided_alloc_t           ep_alloc;      /* Endpoint allocator */
@@ -241,9 +312,21 @@ typedef struct ucp_worker {
     ucp_am_context_t              am;            /* Array of AM callbacks and their data */
     uint64_t                      am_message_id; /* For matching long am's */
     ucp_ep_h                      mem_type_ep[UCS_MEMORY_TYPE_LAST];/* memory type eps */
+    ucp_address_template_t        *address_template; /* Local address template,
+                                                        NULL if disabled */
+    khash_t(ucp_worker_addr_tmpl) address_templates; /* Cached templates of
+                                                        remote addresses */
+    khash_t(ucp_worker_select_memo) select_memo; /* Lane selection results, by
+                                                    remote address signature */
+    struct {
+        khash_t(ucp_worker_rkey_cache) hash;     /* Cached remote keys */
+        ucs_list_link_t           idle;          /* Cached keys which are not
+                                                    used, oldest first */
+    } rkey_cache;
 
     UCS_STATS_NODE_DECLARE(stats)
     UCS_STATS_NODE_DECLARE(tm_offload_stats)
+    UCS_STATS_NODE_DECLARE(wait_stats)
 
     ucs_cpu_set_t                 cpu_mask;        /* Save CPU mask for subsequent calls to ucp_worker_listen */
     unsigned                      ep_config_max;   /* Maximal number of configurations */
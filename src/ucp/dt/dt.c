@@ -13,6 +13,7 @@
 #include <ucp/core/ucp_ep.inl>
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_mm.h>
+#include <ucs/arch/memcpy.h>
 #include <ucs/profile/profile.h>
 
 
@@ -109,8 +110,9 @@ size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
         if (UCP_MEM_IS_ACCESSIBLE_FROM_CPU(mem_type)) {
-            UCS_PROFILE_CALL(ucs_memcpy_relaxed, dest,
-                             UCS_PTR_BYTE_OFFSET(src, state->offset), length);
+            UCS_PROFILE_CALL_VOID(ucs_memcpy_bulk, dest,
+                                  UCS_PTR_BYTE_OFFSET(src, state->offset),
+                                  length);
         } else {
             ucp_mem_type_pack(worker, dest,
                               UCS_PTR_BYTE_OFFSET(src, state->offset),
@@ -126,6 +128,13 @@ size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
         result_len = length;
         break;
 
+    case UCP_DATATYPE_STRIDED:
+        ucs_assert(UCP_MEM_IS_ACCESSIBLE_FROM_CPU(mem_type));
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_pack, datatype, dest, src,
+                              state->offset, length);
+        result_len = length;
+        break;
+
     case UCP_DATATYPE_GENERIC:
         dt = ucp_dt_generic(datatype);
         result_len = UCS_PROFILE_NAMED_CALL("dt_pack", dt->ops.pack,
@@ -7,6 +7,7 @@
 #ifndef UCP_DT_INL_
 #define UCP_DT_INL_
 
+#include <ucs/arch/memcpy.h>
 #include <ucs/profile/profile.h>
 
 /**
@@ -26,6 +27,9 @@ size_t ucp_dt_length(ucp_datatype_t datatype, size_t count,
         ucs_assert(NULL != iov);
         return ucp_dt_iov_length(iov, count);
 
+    case UCP_DATATYPE_STRIDED:
+        return ucp_dt_strided_length(datatype, count);
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(datatype);
         ucs_assert(NULL != state);
@@ -57,7 +61,8 @@ ucp_dt_unpack_only(ucp_worker_h worker, void *buffer, size_t count,
             goto err_truncated;
         }
         if (ucs_likely(UCP_MEM_IS_ACCESSIBLE_FROM_CPU(mem_type))) {
-            UCS_PROFILE_NAMED_CALL("memcpy_recv", ucs_memcpy_relaxed, buffer, data, length);
+            UCS_PROFILE_NAMED_CALL_VOID("memcpy_recv", ucs_memcpy_bulk, buffer,
+                                        data, length);
         } else {
             ucp_mem_type_unpack(worker, buffer, data, length, mem_type);
         }
@@ -73,6 +78,16 @@ ucp_dt_unpack_only(ucp_worker_h worker, void *buffer, size_t count,
                          &iov_offset, &iovcnt_offset);
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        if (truncation &&
+            ucs_unlikely(length > (buffer_size = ucp_dt_strided_length(datatype,
+                                                                       count)))) {
+            goto err_truncated;
+        }
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_unpack, datatype, buffer, data,
+                              0, length);
+        return UCS_OK;
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(datatype);
         state  = UCS_PROFILE_NAMED_CALL("dt_start", dt_gen->ops.start_unpack,
@@ -118,6 +133,9 @@ ucp_dt_recv_state_init(ucp_dt_state_t *dt_state, void *buffer,
         dt_state->dt.iov.iovcnt        = dt_count;
         dt_state->dt.iov.dt_reg        = NULL;
         break;
+    case UCP_DATATYPE_STRIDED:
+        dt_state->dt.strided.md_map    = 0;
+        break;
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(dt);
         dt_state->dt.generic.state =
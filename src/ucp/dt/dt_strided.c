@@ -0,0 +1,364 @@
+/**
+ * Copyright (C) Huawei Technologies Co., Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "dt_strided.h"
+
+#include <ucs/arch/memcpy.h>
+#include <ucs/debug/assert.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/math.h>
+
+#include <string.h>
+
+
+ucs_status_t ucp_dt_create_strided(const ucp_dt_strided_params_t *params,
+                                   ucp_datatype_t *datatype_p)
+{
+    unsigned num_dims, dim, level;
+    ucp_dt_strided_t *dt;
+    size_t blocklen, count;
+    ptrdiff_t extent, stride;
+    int ret;
+
+    if (!(params->field_mask & UCP_DT_STRIDED_PARAM_FIELD_BLOCKLEN) ||
+        (params->blocklen == 0)) {
+        ucs_error("strided datatype block length must be set and non-zero");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    num_dims = (params->field_mask & UCP_DT_STRIDED_PARAM_FIELD_DIMS) ?
+               params->num_dims : 0;
+    if (num_dims > UCP_DT_STRIDED_MAX_DIMS) {
+        ucs_error("strided datatype has %u dimensions, maximum is %d",
+                  num_dims, UCP_DT_STRIDED_MAX_DIMS);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    for (dim = 0; dim < num_dims; ++dim) {
+        if (params->dims[dim].count == 0) {
+            ucs_error("strided datatype dimension %u has zero count", dim);
+            return UCS_ERR_INVALID_PARAM;
+        }
+    }
+
+    if (params->field_mask & UCP_DT_STRIDED_PARAM_FIELD_EXTENT) {
+        extent = params->extent;
+    } else if (num_dims > 0) {
+        extent = (ptrdiff_t)params->dims[num_dims - 1].count *
+                 params->dims[num_dims - 1].stride;
+    } else {
+        extent = params->blocklen;
+    }
+
+    ret = ucs_posix_memalign((void **)&dt,
+                             ucs_max(sizeof(void *), UCS_BIT(UCP_DATATYPE_SHIFT)),
+                             sizeof(*dt), "strided_dt");
+    if (ret != 0) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* Normalize the dimensions: a dimension whose items are adjacent extends
+     * the block, or the inner dimension */
+    blocklen = params->blocklen;
+    level    = 0;
+    for (dim = 0; dim < num_dims; ++dim) {
+        count  = params->dims[dim].count;
+        stride = params->dims[dim].stride;
+        if (count == 1) {
+            continue;
+        } else if ((level == 0) && (stride == (ptrdiff_t)blocklen)) {
+            blocklen *= count;
+        } else if ((level > 0) &&
+                   (stride == ((ptrdiff_t)dt->count[level - 1] *
+                               dt->stride[level - 1]))) {
+            dt->count[level - 1] *= count;
+        } else {
+            dt->count[level]  = count;
+            dt->stride[level] = stride;
+            ++level;
+        }
+    }
+
+    dt->blocklen    = blocklen;
+    dt->elem_blocks = 1;
+    dt->span_lo     = 0;
+    dt->span_hi     = blocklen;
+    for (dim = 0; dim < level; ++dim) {
+        dt->elem_blocks *= dt->count[dim];
+        stride           = (ptrdiff_t)(dt->count[dim] - 1) * dt->stride[dim];
+        dt->span_lo     += ucs_min(stride, 0);
+        dt->span_hi     += ucs_max(stride, 0);
+    }
+    dt->elem_size = blocklen * dt->elem_blocks;
+
+    /* Elements are iterated as the outermost level, of unbounded count */
+    dt->count[level]  = SIZE_MAX;
+    dt->stride[level] = extent;
+    dt->num_levels    = level + 1;
+
+    ucs_debug("created strided datatype %p: blocklen %zu elem_size %zu "
+              "elem_blocks %zu extent %zd levels %u", dt, dt->blocklen,
+              dt->elem_size, dt->elem_blocks, extent, dt->num_levels);
+
+    *datatype_p = ((uintptr_t)dt) | UCP_DATATYPE_STRIDED;
+    return UCS_OK;
+}
+
+size_t ucp_dt_strided_iov_count(ucp_datatype_t datatype, size_t count)
+{
+    const ucp_dt_strided_t *dt = ucp_dt_strided(datatype);
+
+    if ((dt->num_levels == 1) && (dt->stride[0] == (ptrdiff_t)dt->blocklen)) {
+        return (count > 0) ? 1 : 0;
+    }
+
+    return dt->elem_blocks * count;
+}
+
+void ucp_dt_strided_span(ucp_datatype_t datatype, const void *buffer,
+                         size_t count, void **address_p, size_t *length_p)
+{
+    const ucp_dt_strided_t *dt = ucp_dt_strided(datatype);
+    ptrdiff_t extent           = dt->stride[dt->num_levels - 1];
+    ptrdiff_t elems;
+
+    if (count == 0) {
+        *address_p = (void*)buffer;
+        *length_p  = 0;
+        return;
+    }
+
+    elems      = (ptrdiff_t)(count - 1) * extent;
+    *address_p = UCS_PTR_BYTE_OFFSET(buffer, dt->span_lo + ucs_min(elems, 0));
+    *length_p  = (dt->span_hi + ucs_max(elems, 0)) -
+                 (dt->span_lo + ucs_min(elems, 0));
+}
+
+/*
+ * Find the block which contains a given offset of the packed data. Returns the
+ * address of the block and fills the index of the block in every level.
+ */
+static UCS_F_ALWAYS_INLINE void *
+ucp_dt_strided_seek(const ucp_dt_strided_t *dt, void *buffer, size_t offset,
+                    size_t *idx, size_t *block_offset_p)
+{
+    size_t block = offset / dt->blocklen;
+    void *ptr    = buffer;
+    unsigned level;
+
+    *block_offset_p = offset - (block * dt->blocklen);
+    for (level = 0; level < (dt->num_levels - 1); ++level) {
+        idx[level] = block % dt->count[level];
+        block     /= dt->count[level];
+        ptr        = UCS_PTR_BYTE_OFFSET(ptr, (ptrdiff_t)idx[level] *
+                                              dt->stride[level]);
+    }
+
+    idx[level] = block;
+    return UCS_PTR_BYTE_OFFSET(ptr, (ptrdiff_t)block * dt->stride[level]);
+}
+
+/*
+ * Advance the block address by @a nblocks blocks of the innermost level, which
+ * must not cross the end of the level, and wrap the levels which were
+ * completed.
+ */
+static UCS_F_ALWAYS_INLINE void *
+ucp_dt_strided_advance(const ucp_dt_strided_t *dt, void *ptr, size_t *idx,
+                       size_t nblocks)
+{
+    unsigned level = 0;
+
+    idx[0] += nblocks;
+    ptr     = UCS_PTR_BYTE_OFFSET(ptr, (ptrdiff_t)nblocks * dt->stride[0]);
+
+    /* the element level has unbounded count, so the loop stops there */
+    while (idx[level] == dt->count[level]) {
+        ptr        = UCS_PTR_BYTE_OFFSET(ptr, -((ptrdiff_t)dt->count[level] *
+                                                dt->stride[level]));
+        idx[level] = 0;
+        ++level;
+        ++idx[level];
+        ptr        = UCS_PTR_BYTE_OFFSET(ptr, dt->stride[level]);
+    }
+
+    return ptr;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy_contig(void *strided, void *packed, size_t length, int pack)
+{
+    if (pack) {
+        ucs_memcpy_bulk(packed, strided, length);
+    } else {
+        ucs_memcpy_bulk(strided, packed, length);
+    }
+}
+
+/*
+ * Copy blocks of a fixed length, which is a compile-time constant in the
+ * specialized instances, so the copy is done by a few register moves.
+ */
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy_blocks(void *strided, void *packed, ptrdiff_t stride,
+                           size_t blocklen, size_t nblocks, int pack)
+{
+    size_t i;
+
+    for (i = 0; i < nblocks; ++i) {
+        if (pack) {
+            memcpy(packed, strided, blocklen);
+        } else {
+            memcpy(strided, packed, blocklen);
+        }
+        strided = UCS_PTR_BYTE_OFFSET(strided, stride);
+        packed  = UCS_PTR_BYTE_OFFSET(packed, blocklen);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy_row(void *strided, void *packed, ptrdiff_t stride,
+                        size_t blocklen, size_t nblocks, int pack)
+{
+    size_t i;
+
+    if (stride == (ptrdiff_t)blocklen) {
+        /* the blocks are adjacent */
+        ucp_dt_strided_copy_contig(strided, packed, nblocks * blocklen, pack);
+        return;
+    }
+
+    switch (blocklen) {
+    case 1:
+        ucp_dt_strided_copy_blocks(strided, packed, stride, 1, nblocks, pack);
+        break;
+    case 2:
+        ucp_dt_strided_copy_blocks(strided, packed, stride, 2, nblocks, pack);
+        break;
+    case 4:
+        ucp_dt_strided_copy_blocks(strided, packed, stride, 4, nblocks, pack);
+        break;
+    case 8:
+        ucp_dt_strided_copy_blocks(strided, packed, stride, 8, nblocks, pack);
+        break;
+    case 16:
+        ucp_dt_strided_copy_blocks(strided, packed, stride, 16, nblocks, pack);
+        break;
+    default:
+        for (i = 0; i < nblocks; ++i) {
+            ucp_dt_strided_copy_contig(strided, packed, blocklen, pack);
+            strided = UCS_PTR_BYTE_OFFSET(strided, stride);
+            packed  = UCS_PTR_BYTE_OFFSET(packed, blocklen);
+        }
+        break;
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy(const ucp_dt_strided_t *dt, void *buffer, void *packed,
+                    size_t offset, size_t length, int pack)
+{
+    size_t idx[UCP_DT_STRIDED_NUM_LEVELS];
+    size_t block_offset, nblocks, len;
+    void *ptr;
+
+    ptr = ucp_dt_strided_seek(dt, buffer, offset, idx, &block_offset);
+
+    if (block_offset != 0) {
+        /* rest of a block which was split by the previous fragment */
+        len = ucs_min(dt->blocklen - block_offset, length);
+        ucp_dt_strided_copy_contig(UCS_PTR_BYTE_OFFSET(ptr, block_offset),
+                                   packed, len, pack);
+        packed  = UCS_PTR_BYTE_OFFSET(packed, len);
+        length -= len;
+        ptr     = ucp_dt_strided_advance(dt, ptr, idx, 1);
+    }
+
+    while (length >= dt->blocklen) {
+        nblocks = ucs_min(dt->count[0] - idx[0], length / dt->blocklen);
+        ucp_dt_strided_copy_row(ptr, packed, dt->stride[0], dt->blocklen,
+                                nblocks, pack);
+        packed  = UCS_PTR_BYTE_OFFSET(packed, nblocks * dt->blocklen);
+        length -= nblocks * dt->blocklen;
+        ptr     = ucp_dt_strided_advance(dt, ptr, idx, nblocks);
+    }
+
+    if (length > 0) {
+        /* head of a block which is continued by the next fragment */
+        ucp_dt_strided_copy_contig(ptr, packed, length, pack);
+    }
+}
+
+void ucp_dt_strided_pack(ucp_datatype_t datatype, void *dest, const void *src,
+                         size_t offset, size_t length)
+{
+    ucp_dt_strided_copy(ucp_dt_strided(datatype), (void*)src, dest, offset,
+                        length, 1);
+}
+
+void ucp_dt_strided_unpack(ucp_datatype_t datatype, void *dest,
+                           const void *src, size_t offset, size_t length)
+{
+    ucp_dt_strided_copy(ucp_dt_strided(datatype), dest, (void*)src, offset,
+                        length, 0);
+}
+
+size_t ucp_dt_strided_to_uct_iov(ucp_datatype_t datatype, void *buffer,
+                                 size_t offset, size_t length_max,
+                                 uct_mem_h memh, uct_iov_t *iov,
+                                 size_t max_iov, size_t *iovcnt_p)
+{
+    const ucp_dt_strided_t *dt = ucp_dt_strided(datatype);
+    size_t length_it           = 0;
+    size_t iovcnt              = 0;
+    size_t idx[UCP_DT_STRIDED_NUM_LEVELS];
+    size_t block_offset, nblocks, len;
+    void *ptr, *address;
+
+    ptr = ucp_dt_strided_seek(dt, buffer, offset, idx, &block_offset);
+
+    while (length_it < length_max) {
+        /* adjacent blocks of the innermost level are taken at once */
+        if (dt->stride[0] == (ptrdiff_t)dt->blocklen) {
+            nblocks = ucs_min(dt->count[0] - idx[0],
+                              ucs_div_round_up(length_max - length_it +
+                                               block_offset, dt->blocklen));
+        } else {
+            nblocks = 1;
+        }
+
+        address = UCS_PTR_BYTE_OFFSET(ptr, block_offset);
+        len     = ucs_min((nblocks * dt->blocklen) - block_offset,
+                          length_max - length_it);
+
+        if ((iovcnt > 0) &&
+            (UCS_PTR_BYTE_OFFSET(iov[iovcnt - 1].buffer,
+                                 iov[iovcnt - 1].length) == address)) {
+            iov[iovcnt - 1].length += len;
+        } else if (iovcnt < max_iov) {
+            iov[iovcnt].buffer = address;
+            iov[iovcnt].length = len;
+            iov[iovcnt].memh   = memh;
+            iov[iovcnt].stride = 0;
+            iov[iovcnt].count  = 1;
+            ++iovcnt;
+        } else {
+            break;
+        }
+
+        length_it   += len;
+        block_offset = 0;
+        ptr          = ucp_dt_strided_advance(dt, ptr, idx, nblocks);
+    }
+
+    *iovcnt_p = iovcnt;
+    return length_it;
+}
@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) Huawei Technologies Co., Ltd. 2021.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+
+#ifndef UCP_DT_STRIDED_H_
+#define UCP_DT_STRIDED_H_
+
+#include <ucp/api/ucp.h>
+#include <uct/api/uct.h>
+
+
+#define UCP_DT_IS_STRIDED(_datatype) \
+    (((_datatype) & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_STRIDED)
+
+
+/* Number of iteration dimensions: the user dimensions and the element one */
+#define UCP_DT_STRIDED_NUM_LEVELS  (UCP_DT_STRIDED_MAX_DIMS + 1)
+
+
+/**
+ * Strided datatype structure.
+ *
+ * The datatype is kept in a normalized form: dimensions of a single item are
+ * dropped, and dimensions which are contiguous with respect to the inner ones
+ * are merged into the block or into the inner dimension. The elements of a
+ * buffer are iterated as one more, outermost, dimension of unbounded count.
+ */
+typedef struct ucp_dt_strided {
+    size_t                   blocklen;    /* Contiguous block length */
+    size_t                   elem_size;   /* Packed length of an element */
+    size_t                   elem_blocks; /* Number of blocks in an element */
+    ptrdiff_t                span_lo;     /* Lowest byte of an element, relative
+                                             to its first block */
+    ptrdiff_t                span_hi;     /* End of the highest block of an
+                                             element, relative to its first
+                                             block */
+    unsigned                 num_levels;  /* Number of used entries in count[]
+                                             and stride[], including the
+                                             element level */
+    size_t                   count[UCP_DT_STRIDED_NUM_LEVELS];
+    ptrdiff_t                stride[UCP_DT_STRIDED_NUM_LEVELS];
+} ucp_dt_strided_t;
+
+
+static inline ucp_dt_strided_t* ucp_dt_strided(ucp_datatype_t datatype)
+{
+    return (ucp_dt_strided_t*)(void*)(datatype & ~UCP_DATATYPE_CLASS_MASK);
+}
+
+
+/**
+ * Get the packed length of @a count elements of a strided datatype
+ */
+static inline size_t ucp_dt_strided_length(ucp_datatype_t datatype,
+                                            size_t count)
+{
+    return ucp_dt_strided(datatype)->elem_size * count;
+}
+
+
+/**
+ * Get the number of contiguous memory regions which @a count elements of a
+ * strided datatype consist of, i.e. the number of UCT iov entries needed to
+ * send them with zero-copy.
+ */
+size_t ucp_dt_strided_iov_count(ucp_datatype_t datatype, size_t count);
+
+
+/**
+ * Get the address range which @a count elements of a strided datatype touch.
+ *
+ * @param [in]  datatype    Strided datatype.
+ * @param [in]  buffer      Buffer passed by the user with the datatype.
+ * @param [in]  count       Number of elements.
+ * @param [out] address_p   Lowest address of the range.
+ * @param [out] length_p    Length of the range.
+ */
+void ucp_dt_strided_span(ucp_datatype_t datatype, const void *buffer,
+                         size_t count, void **address_p, size_t *length_p);
+
+
+/**
+ * Copy data from a strided buffer to a contiguous buffer.
+ *
+ * @param [in]  datatype    Strided datatype.
+ * @param [in]  dest        Destination contiguous buffer.
+ * @param [in]  src         Source strided buffer, as passed by the user.
+ * @param [in]  offset      Offset in the packed representation to start from.
+ * @param [in]  length      Number of bytes to copy.
+ */
+void ucp_dt_strided_pack(ucp_datatype_t datatype, void *dest, const void *src,
+                         size_t offset, size_t length);
+
+
+/**
+ * Copy data from a contiguous buffer to a strided buffer.
+ *
+ * @param [in]  datatype    Strided datatype.
+ * @param [in]  dest        Destination strided buffer, as passed by the user.
+ * @param [in]  src         Source contiguous buffer.
+ * @param [in]  offset      Offset in the packed representation to start from.
+ * @param [in]  length      Number of bytes to copy.
+ */
+void ucp_dt_strided_unpack(ucp_datatype_t datatype, void *dest,
+                           const void *src, size_t offset, size_t length);
+
+
+/**
+ * Fill UCT iov entries which describe the blocks of a strided buffer, starting
+ * at a given offset of its packed representation. Adjacent blocks are merged
+ * into a single entry.
+ *
+ * @param [in]  datatype    Strided datatype.
+ * @param [in]  buffer      Strided buffer, as passed by the user.
+ * @param [in]  offset      Offset in the packed representation to start from.
+ * @param [in]  length_max  Maximal number of bytes to describe.
+ * @param [in]  memh        Memory handle of the buffer span, set to all
+ *                          entries.
+ * @param [out] iov         Array of UCT iov entries to fill.
+ * @param [in]  max_iov     Size of @a iov array.
+ * @param [out] iovcnt_p    Number of filled entries.
+ *
+ * @return Number of bytes described by the filled entries.
+ */
+size_t ucp_dt_strided_to_uct_iov(ucp_datatype_t datatype, void *buffer,
+                                 size_t offset, size_t length_max,
+                                 uct_mem_h memh, uct_iov_t *iov,
+                                 size_t max_iov, size_t *iovcnt_p);
+
+#endif
@@ -185,6 +185,7 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
     uint64_t md_flags = context->tl_mds[md_index].attr.cap.flags;
     size_t length_it  = 0;
     ucp_md_index_t memh_index;
+    uct_mem_h memh;
 
     ucs_assert((context->tl_mds[md_index].attr.cap.flags & UCT_MD_FLAG_REG) ||
                !(md_flags & UCT_MD_FLAG_NEED_MEMH));
@@ -215,6 +216,17 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
                                             src_iov, length_max, md_index,
                                             md_flags);
         break;
+    case UCP_DATATYPE_STRIDED:
+        if (md_flags & UCT_MD_FLAG_NEED_MEMH) {
+            memh_index = ucs_bitmap2idx(state->dt.strided.md_map, md_index);
+            memh       = state->dt.strided.memh[memh_index];
+        } else {
+            memh       = UCT_MEM_HANDLE_NULL;
+        }
+        length_it = ucp_dt_strided_to_uct_iov(datatype, (void*)src_iov,
+                                              state->offset, length_max, memh,
+                                              iov, max_dst_iov, iovcnt);
+        break;
     default:
         ucs_error("Invalid data type");
     }
@@ -314,7 +326,8 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             flag_iov_mid = ((state.dt.iov.iovcnt_offset + max_iov) <
                             state.dt.iov.iovcnt);
         } else {
-            ucs_assert(UCP_DT_IS_CONTIG(req->send.datatype));
+            ucs_assert(UCP_DT_IS_CONTIG(req->send.datatype) ||
+                       UCP_DT_IS_STRIDED(req->send.datatype));
         }
 
         if (offset == 0) {
@@ -341,6 +354,10 @@ ucs_status_t ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
             ucp_dt_iov_copy_uct(ep->worker->context, iov, &iovcnt, max_iov, &state,
                                 req->send.buffer, req->send.datatype, mid_len,
                                 ucp_ep_md_index(ep, req->send.lane), NULL);
+            if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+                /* The blocks may exceed max_iov before reaching mid_len */
+                flag_iov_mid = (state.offset < (offset + mid_len));
+            }
 
             if (offset < state.offset) {
                 status = uct_ep_am_zcopy(uct_ep, am_id_middle, (void*)hdr_middle,
@@ -445,6 +462,16 @@ ucp_proto_get_zcopy_threshold(const ucp_request_t *req,
                               ucp_worker_iface_bandwidth(worker, rsc_index));
         }
         return ucs_min(max_zcopy, zcopy_thresh);
+    } else if (UCP_DT_IS_STRIDED(req->send.datatype)) {
+        /* The buffer is registered once, but a zcopy fragment carries at
+         * most max_iov blocks: use zcopy only if such a fragment would be sent
+         * with zcopy as contiguous data */
+        zcopy_thresh = msg_config->mem_type_zcopy_thresh[req->send.mem_type];
+        if ((ucp_dt_strided(req->send.datatype)->blocklen *
+             msg_config->max_iov) < zcopy_thresh) {
+            return max_zcopy;
+        }
+        return ucs_min(max_zcopy, zcopy_thresh);
     } else if (UCP_DT_IS_GENERIC(req->send.datatype)) {
         return max_zcopy;
     }
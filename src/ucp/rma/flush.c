@@ -103,7 +103,8 @@ static void ucp_ep_flush_progress(ucp_request_t *req)
                 break;
             }
 
-            status = uct_ep_pending_add(uct_ep, &req->send.uct, 0);
+            status = uct_ep_pending_add(uct_ep, &req->send.uct,
+                                        UCT_CB_FLAG_PRIO_HIGH);
             ucs_trace("adding pending flush on ep %p lane[%d]: %s", ep, lane,
                       ucs_status_string(status));
             if (status == UCS_OK) {
@@ -31,6 +31,8 @@ void ucp_stream_ep_cleanup(ucp_ep_h ep);
 
 void ucp_stream_ep_activate(ucp_ep_h ep);
 
+void ucp_stream_rndv_fetch_complete(ucp_request_t *rreq, ucs_status_t status);
+
 
 static UCS_F_ALWAYS_INLINE int ucp_stream_ep_is_queued(ucp_ep_ext_proto_t *ep_ext)
 {
@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_request.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/profile/profile.h>
@@ -242,8 +243,9 @@ ucp_stream_recv_request_init(ucp_request_t *req, ucp_ep_h ep, void *buffer,
 #if UCS_ENABLE_ASSERT
     req->status             = UCS_OK; /* for ucp_request_recv_data_unpack() */
 #endif
-    req->recv.stream.length = 0;
-    req->recv.stream.offset = 0;
+    req->recv.stream.length     = 0;
+    req->recv.stream.offset     = 0;
+    req->recv.stream.rndv_count = 0;
 
     ucp_dt_recv_state_init(&req->recv.state, buffer, datatype, count);
 
@@ -409,8 +411,10 @@ ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
                                                     am_data wont be handled in
                                                     place */
 
-    /* First, process expected requests */
-    if (!ucp_stream_ep_has_data(ep_ext)) {
+    /* First, process expected requests, unless there is a rendezvous fetch
+     * in progress which this data is ordered after */
+    if (!ucp_stream_ep_has_data(ep_ext) &&
+        ucs_likely(ucs_queue_is_empty(&ep_ext->stream.rndv_q))) {
         while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
             req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
                                                      ucp_request_t, recv.queue);
@@ -425,7 +429,8 @@ ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
                 }
                 return UCS_OK;
             }
-            ucp_stream_rdesc_advance(&rdesc_tmp, unpacked, ep_ext);
+            rdesc_tmp.length         -= unpacked;
+            rdesc_tmp.payload_offset += unpacked;
             /* This request is full, try next one */
             ucs_assert(ucp_request_can_complete_stream_recv(req));
             ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
@@ -455,12 +460,237 @@ ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
         rdesc->flags           = UCP_RECV_DESC_FLAG_UCT_DESC;
     }
 
+    if (ucs_unlikely(!ucs_queue_is_empty(&ep_ext->stream.rndv_q))) {
+        ucs_queue_push(&ep_ext->stream.rndv_q, &rdesc->stream_queue);
+        return UCS_INPROGRESS;
+    }
+
     ucp_ep_from_ext_proto(ep_ext)->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
     ucs_queue_push(&ep_ext->stream.match_q, &rdesc->stream_queue);
 
     return UCS_INPROGRESS;
 }
 
+/* Deliver data which was held back in rndv_q to the posted requests, and
+ * queue the rest as unexpected */
+static void ucp_stream_rdesc_deliver(ucp_recv_desc_t *rdesc,
+                                     ucp_ep_ext_proto_t *ep_ext)
+{
+    ucp_request_t *req;
+    ssize_t unpacked;
+
+    if (!ucp_stream_ep_has_data(ep_ext)) {
+        while ((rdesc->length > 0) &&
+               !ucs_queue_is_empty(&ep_ext->stream.match_q)) {
+            req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                                     ucp_request_t, recv.queue);
+            unpacked = ucp_stream_rdata_unpack(ucp_stream_rdesc_payload(rdesc),
+                                               rdesc->length, req);
+            if (ucs_unlikely(unpacked < 0)) {
+                ucs_fatal("failed to unpack from rdesc %p to request %p",
+                          rdesc, req);
+            }
+
+            rdesc->length         -= unpacked;
+            rdesc->payload_offset += unpacked;
+            if (ucp_request_can_complete_stream_recv(req)) {
+                ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
+            }
+        }
+    }
+
+    if (rdesc->length == 0) {
+        ucp_recv_desc_release(rdesc);
+        return;
+    }
+
+    ucp_ep_from_ext_proto(ep_ext)->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
+    ucs_queue_push(&ep_ext->stream.match_q, &rdesc->stream_queue);
+}
+
+static void ucp_stream_rndv_q_progress(ucp_ep_ext_proto_t *ep_ext)
+{
+    ucp_ep_h ep = ucp_ep_from_ext_proto(ep_ext);
+    ucp_recv_desc_t *rdesc;
+
+    while (!ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+        rdesc = ucs_queue_head_elem_non_empty(&ep_ext->stream.rndv_q,
+                                              ucp_recv_desc_t, stream_queue);
+        if (rdesc->flags & UCP_RECV_DESC_FLAG_STREAM_RNDV) {
+            break;
+        }
+
+        ucs_queue_pull_non_empty(&ep_ext->stream.rndv_q);
+        ucp_stream_rdesc_deliver(rdesc, ep_ext);
+    }
+
+    if (ucp_stream_ep_has_data(ep_ext) && !ucp_stream_ep_is_queued(ep_ext) &&
+        (ep->flags & UCP_EP_FLAG_USED)) {
+        ucp_stream_ep_enqueue(ep_ext, ep->worker);
+    }
+}
+
+static ucp_request_t *
+ucp_stream_rndv_rreq_get(ucp_ep_h ep, void *buffer, size_t length,
+                         ucs_memory_type_t mem_type)
+{
+    ucp_request_t *rreq;
+
+    rreq = ucp_request_get(ep->worker);
+    if (rreq == NULL) {
+        return NULL;
+    }
+
+    rreq->flags                   = UCP_REQUEST_FLAG_RECV_STREAM_RNDV;
+    rreq->recv.worker             = ep->worker;
+    rreq->recv.buffer             = buffer;
+    rreq->recv.datatype           = ucp_dt_make_contig(1);
+    rreq->recv.length             = length;
+    rreq->recv.mem_type           = mem_type;
+    rreq->recv.stream_rndv.ep     = ep;
+    rreq->recv.stream_rndv.rreq   = NULL;
+    rreq->recv.stream_rndv.rdesc  = NULL;
+    ucp_dt_recv_state_init(&rreq->recv.state, buffer, rreq->recv.datatype,
+                           length);
+    return rreq;
+}
+
+void ucp_stream_rndv_fetch_complete(ucp_request_t *rreq, ucs_status_t status)
+{
+    ucp_request_t *req     = rreq->recv.stream_rndv.rreq;
+    ucp_recv_desc_t *rdesc = rreq->recv.stream_rndv.rdesc;
+    ucp_ep_h ep            = rreq->recv.stream_rndv.ep;
+
+    ucp_trace_req(rreq, "stream rndv fetch completed with status %s",
+                  ucs_status_string(status));
+    ucp_request_put(rreq);
+
+    if (req != NULL) {
+        /* Fetched directly to the user buffer */
+        ucs_assert(req->recv.stream.rndv_count > 0);
+        if (ucs_unlikely(status != UCS_OK)) {
+            if (!(req->flags & UCP_REQUEST_FLAG_STREAM_RNDV_WAIT)) {
+                /* The request is still at the head of match_q */
+                ucp_request_complete_stream_recv(req, ucp_ep_ext_proto(ep),
+                                                 status);
+            } else if (req->status == UCS_OK) {
+                req->status = status;
+            }
+        }
+
+        if ((--req->recv.stream.rndv_count == 0) &&
+            (req->flags & UCP_REQUEST_FLAG_STREAM_RNDV_WAIT)) {
+            req->flags &= ~UCP_REQUEST_FLAG_STREAM_RNDV_WAIT;
+            ucp_request_complete_stream_recv_dequeued(req, req->status);
+        }
+        return;
+    }
+
+    /* Fetched to a bounce descriptor */
+    rdesc->flags &= ~UCP_RECV_DESC_FLAG_STREAM_RNDV;
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_STREAM_DROP) {
+        ucp_recv_desc_release(rdesc);
+        return;
+    }
+
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucs_error("ep %p: failed to fetch %u bytes of stream data: %s", ep,
+                  rdesc->length, ucs_status_string(status));
+        rdesc->length = 0;
+    }
+
+    ucp_stream_rndv_q_progress(ucp_ep_ext_proto(ep));
+}
+
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_rndv_is_direct(ucp_ep_ext_proto_t *ep_ext, size_t length)
+{
+    ucp_request_t *req;
+
+    if (ucp_stream_ep_has_data(ep_ext) ||
+        !ucs_queue_is_empty(&ep_ext->stream.rndv_q) ||
+        ucs_queue_is_empty(&ep_ext->stream.match_q)) {
+        return 0;
+    }
+
+    req = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                        ucp_request_t, recv.queue);
+    return UCP_DT_IS_CONTIG(req->recv.datatype) &&
+           ((req->recv.length - req->recv.stream.offset) >= length);
+}
+
+static ucs_status_t
+ucp_stream_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                            unsigned am_flags)
+{
+    ucp_worker_h worker              = am_arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = am_data;
+    ucp_stream_am_hdr_t *hdr         = (ucp_stream_am_hdr_t*)&rndv_rts_hdr->super;
+    size_t length                    = rndv_rts_hdr->size;
+    ucp_ep_ext_proto_t *ep_ext;
+    ucp_recv_desc_t *rdesc;
+    ucp_request_t *rreq, *req;
+    ucp_ep_h ep;
+
+    ep     = ucp_worker_get_ep_by_ptr(worker, hdr->ep_ptr);
+    ep_ext = ucp_ep_ext_proto(ep);
+
+    if (ucs_unlikely(ep->flags & UCP_EP_FLAG_CLOSED)) {
+        ucs_trace_data("ep %p: stream is invalid", ep);
+        /* drop the data, but let the sender complete */
+        ucp_rndv_am_reject(worker, rndv_rts_hdr, UCS_OK);
+        return UCS_OK;
+    }
+
+    ucs_assert(length > 0);
+
+    if (ucp_stream_rndv_is_direct(ep_ext, length)) {
+        /* Reserve the range in the posted request and fetch right into it */
+        req  = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                             ucp_request_t, recv.queue);
+        rreq = ucp_stream_rndv_rreq_get(ep,
+                                        UCS_PTR_BYTE_OFFSET(req->recv.buffer,
+                                                            req->recv.stream.offset),
+                                        length, req->recv.mem_type);
+        ucs_assertv_always(rreq != NULL,
+                           "failed to allocate stream rendezvous request");
+
+        rreq->recv.stream_rndv.rreq  = req;
+        req->recv.stream.offset     += length;
+        if (req->recv.stream.rndv_count++ == 0) {
+            req->status = UCS_OK;
+        }
+
+        if (ucp_request_can_complete_stream_recv(req)) {
+            ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
+        }
+    } else {
+        /* No room in a posted request, fetch to a descriptor which keeps its
+         * place in the stream until it is received */
+        rdesc = ucs_malloc(sizeof(*rdesc) + sizeof(ucp_stream_am_data_t) +
+                           length, "stream_rndv_rdesc");
+        ucs_assertv_always(rdesc != NULL,
+                           "ucp recv descriptor is not allocated");
+
+        rdesc->length         = length;
+        rdesc->payload_offset = sizeof(*rdesc) + sizeof(ucp_stream_am_data_t);
+        rdesc->flags          = UCP_RECV_DESC_FLAG_MALLOC |
+                                UCP_RECV_DESC_FLAG_STREAM_RNDV;
+        ucs_queue_push(&ep_ext->stream.rndv_q, &rdesc->stream_queue);
+
+        rreq = ucp_stream_rndv_rreq_get(ep, ucp_stream_rdesc_payload(rdesc),
+                                        length, UCS_MEMORY_TYPE_HOST);
+        ucs_assertv_always(rreq != NULL,
+                           "failed to allocate stream rendezvous request");
+
+        rreq->recv.stream_rndv.rdesc = rdesc;
+    }
+
+    ucp_trace_req(rreq, "stream rndv rts from ep %p length %zu", ep, length);
+    ucp_rndv_am_matched(worker, rreq, rndv_rts_hdr);
+    return UCS_OK;
+}
+
 void ucp_stream_ep_init(ucp_ep_h ep)
 {
     ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
@@ -469,12 +699,14 @@ void ucp_stream_ep_init(ucp_ep_h ep)
         ep_ext->stream.ready_list.prev = NULL;
         ep_ext->stream.ready_list.next = NULL;
         ucs_queue_head_init(&ep_ext->stream.match_q);
+        ucs_queue_head_init(&ep_ext->stream.rndv_q);
     }
 }
 
 void ucp_stream_ep_cleanup(ucp_ep_h ep)
 {
     ucp_ep_ext_proto_t* ep_ext;
+    ucp_recv_desc_t *rdesc;
     ucp_request_t *req;
     size_t length;
     void *data;
@@ -491,6 +723,18 @@ void ucp_stream_ep_cleanup(ucp_ep_h ep)
 
     ep_ext = ucp_ep_ext_proto(ep);
 
+    /* drop data ordered after rendezvous fetches, and the fetched data itself
+     * once the fetch completes */
+    while (!ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+        rdesc = ucs_queue_pull_elem_non_empty(&ep_ext->stream.rndv_q,
+                                              ucp_recv_desc_t, stream_queue);
+        if (rdesc->flags & UCP_RECV_DESC_FLAG_STREAM_RNDV) {
+            rdesc->flags |= UCP_RECV_DESC_FLAG_STREAM_DROP;
+        } else {
+            ucp_recv_desc_release(rdesc);
+        }
+    }
+
     if (ucp_stream_ep_is_queued(ep_ext)) {
         ucp_stream_ep_dequeue(ep_ext);
     }
@@ -545,7 +789,8 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
 
     ucs_assert(status == UCS_INPROGRESS);
 
-    if (!ucp_stream_ep_is_queued(ep_ext) && (ep->flags & UCP_EP_FLAG_USED)) {
+    if (ucp_stream_ep_has_data(ep_ext) && !ucp_stream_ep_is_queued(ep_ext) &&
+        (ep->flags & UCP_EP_FLAG_USED)) {
         ucp_stream_ep_enqueue(ep_ext, worker);
     }
 
@@ -568,7 +813,25 @@ static void ucp_stream_am_dump(ucp_worker_h worker, uct_am_trace_type_t type,
                      UCS_PTR_BYTE_OFFSET(data, hdr_len), length - hdr_len);
 }
 
+static void ucp_stream_rndv_rts_dump(ucp_worker_h worker,
+                                     uct_am_trace_type_t type, uint8_t id,
+                                     const void *data, size_t length,
+                                     char *buffer, size_t max)
+{
+    const ucp_rndv_rts_hdr_t *rndv_rts_hdr = data;
+    const ucp_stream_am_hdr_t *hdr         = (const ucp_stream_am_hdr_t*)
+                                             &rndv_rts_hdr->super;
+
+    snprintf(buffer, max, "STREAM_RNDV_RTS ep_ptr 0x%lx sreq 0x%lx "
+             "address 0x%"PRIx64" size %zu", hdr->ep_ptr,
+             rndv_rts_hdr->sreq.reqptr, rndv_rts_hdr->address,
+             rndv_rts_hdr->size);
+}
+
 UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_DATA, ucp_stream_am_handler,
               ucp_stream_am_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_RNDV_RTS,
+              ucp_stream_rndv_rts_handler, ucp_stream_rndv_rts_dump, 0);
 
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_DATA);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_RNDV_RTS);
@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_context.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
 
@@ -53,21 +54,119 @@ static void ucp_stream_send_req_init(ucp_request_t* req, ucp_ep_h ep,
                                 sizeof(req->send.msg_proto.tag));
 }
 
+static size_t ucp_stream_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+    ucp_stream_am_hdr_t *hdr         = (ucp_stream_am_hdr_t*)&rndv_rts_hdr->super;
+    size_t length;
+
+    /* Stream header is carried in place of the tag */
+    UCS_STATIC_ASSERT(sizeof(*hdr) == sizeof(rndv_rts_hdr->super));
+
+    length      = ucp_tag_rndv_rts_pack(dest, arg);
+    hdr->ep_ptr = ucp_request_get_dest_ep_ptr(sreq);
+    return length;
+}
+
+static ucs_status_t ucp_stream_progress_rndv_rts(uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+    size_t packed_rkey_size;
+
+    packed_rkey_size = ucp_ep_config(sreq->send.ep)->tag.rndv.rkey_size;
+    return ucp_do_am_single(self, UCP_AM_ID_STREAM_RNDV_RTS,
+                            ucp_stream_rndv_rts_pack,
+                            sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+}
+
+static ucs_status_t ucp_stream_send_start_rndv(ucp_request_t *sreq)
+{
+    ucs_status_t status;
+
+    ucp_trace_req(sreq, "stream start_rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(sreq->send.ep), sreq->send.buffer,
+                  sreq->send.length);
+    UCS_PROFILE_REQUEST_EVENT(sreq, "stream_start_rndv", sreq->send.length);
+
+    /* The RTS must be ordered with eager stream fragments, so it goes on the
+     * same lane */
+    ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(sreq->send.ep));
+
+    if (sreq->send.length > UINT32_MAX) {
+        /* The receiver may have to hold the whole payload in a single
+         * ucp_recv_desc_t, which has a 32-bit length */
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    /* The receiver has no way to reject a stream rendezvous, so fall back to
+     * eager if the buffer could not be registered, for whatever reason */
+    status = ucp_tag_rndv_reg_send_buffer(sreq);
+    if (status != UCS_OK) {
+        ucs_debug("req %p: failed to register stream send buffer %p length "
+                  "%zu: %s, falling back to eager", sreq, sreq->send.buffer,
+                  sreq->send.length, ucs_status_string(status));
+        ucp_request_send_buffer_dereg(sreq);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    if ((sreq->send.state.dt.dt.contig.md_map == 0) &&
+        (ucp_ep_config(sreq->send.ep)->key.rma_bw_md_map != 0)) {
+        ucs_debug("req %p: stream send buffer %p length %zu is not "
+                  "registered on any memory domain, falling back to eager",
+                  sreq, sreq->send.buffer, sreq->send.length);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    sreq->send.uct.func = ucp_stream_progress_rndv_rts;
+    return UCS_OK;
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_stream_get_rndv_threshold(ucp_request_t *req)
+{
+    /* The receiver reads the payload directly from the send buffer, so
+     * rendezvous is used for contiguous data only */
+    if (UCP_DT_IS_CONTIG(req->send.datatype) &&
+        ucp_rndv_is_get_zcopy(req, req->send.ep->worker->context)) {
+        return ucp_ep_config(req->send.ep)->stream.rndv_thresh;
+    }
+
+    return SIZE_MAX;
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
 ucp_stream_send_req(ucp_request_t *req, size_t count,
                     const ucp_ep_msg_config_t* msg_config,
                     const ucp_request_param_t *param,
                     const ucp_request_send_proto_t *proto)
 {
+    size_t rndv_thresh  = ucp_stream_get_rndv_threshold(req);
     size_t zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
-                                                        count, SIZE_MAX);
+                                                        count, rndv_thresh);
     ssize_t max_short   = ucp_proto_get_short_max(req, msg_config);
 
     ucs_status_t status = ucp_request_send_start(req, max_short, zcopy_thresh,
-                                                 SIZE_MAX, count, msg_config,
+                                                 rndv_thresh, count, msg_config,
                                                  proto);
-    if (status != UCS_OK) {
-        return UCS_STATUS_PTR(status);
+    if (ucs_unlikely(status != UCS_OK)) {
+        if (status != UCS_ERR_NO_PROGRESS) {
+            return UCS_STATUS_PTR(status);
+        }
+
+        ucs_assert(req->send.length >= rndv_thresh);
+        status = ucp_stream_send_start_rndv(req);
+        if (status == UCS_ERR_UNSUPPORTED) {
+            zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
+                                                         count, SIZE_MAX);
+            status       = ucp_request_send_start(req, max_short, zcopy_thresh,
+                                                  SIZE_MAX, count, msg_config,
+                                                  proto);
+        }
+
+        if (status != UCS_OK) {
+            return UCS_STATUS_PTR(status);
+        }
     }
 
     /*
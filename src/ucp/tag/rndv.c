@@ -13,6 +13,7 @@
 #include "offload.h"
 
 #include <ucp/proto/proto_am.inl>
+#include <ucp/stream/stream.h>
 #include <ucs/datastruct/queue.h>
 
 static int ucp_rndv_is_recv_pipeline_needed(ucp_request_t *rndv_req,
@@ -297,7 +298,7 @@ static void ucp_rndv_req_send_ats(ucp_request_t *rndv_req, ucp_request_t *rreq,
     rndv_req->send.proto.remote_request = remote_request;
     rndv_req->send.proto.comp_cb        = ucp_request_put;
 
-    ucp_request_send(rndv_req, 0);
+    ucp_request_send(rndv_req, UCT_CB_FLAG_PRIO_HIGH);
 }
 
 UCS_PROFILE_FUNC_VOID(ucp_rndv_complete_rma_put_zcopy, (sreq),
@@ -329,7 +330,7 @@ static void ucp_rndv_send_atp(ucp_request_t *sreq, uintptr_t remote_request)
     sreq->send.proto.remote_request = remote_request;
     sreq->send.proto.comp_cb        = ucp_rndv_complete_rma_put_zcopy;
 
-    ucp_request_send(sreq, 0);
+    ucp_request_send(sreq, UCT_CB_FLAG_PRIO_HIGH);
 }
 
 UCS_PROFILE_FUNC_VOID(ucp_rndv_complete_frag_rma_put_zcopy, (fsreq),
@@ -364,13 +365,19 @@ static void ucp_rndv_send_frag_atp(ucp_request_t *fsreq, uintptr_t remote_reques
     fsreq->send.proto.remote_request = remote_request;
     fsreq->send.proto.comp_cb        = ucp_rndv_complete_frag_rma_put_zcopy;
 
-    ucp_request_send(fsreq, 0);
+    ucp_request_send(fsreq, UCT_CB_FLAG_PRIO_HIGH);
 }
 
 static void ucp_rndv_zcopy_recv_req_complete(ucp_request_t *req, ucs_status_t status)
 {
     ucp_request_recv_buffer_dereg(req);
-    ucp_request_complete_tag_recv(req, status);
+    if (ucs_unlikely(req->flags & UCP_REQUEST_FLAG_RECV_AM)) {
+        ucp_request_complete_am_recv(req, status);
+    } else if (ucs_unlikely(req->flags & UCP_REQUEST_FLAG_RECV_STREAM_RNDV)) {
+        ucp_stream_rndv_fetch_complete(req, status);
+    } else {
+        ucp_request_complete_tag_recv(req, status);
+    }
 }
 
 static void ucp_rndv_complete_rma_get_zcopy(ucp_request_t *rndv_req,
@@ -420,7 +427,7 @@ static void ucp_rndv_req_send_rtr(ucp_request_t *rndv_req, ucp_request_t *rreq,
     rndv_req->send.rndv_rtr.length         = recv_length;
     rndv_req->send.rndv_rtr.offset         = offset;
 
-    ucp_request_send(rndv_req, 0);
+    ucp_request_send(rndv_req, UCT_CB_FLAG_PRIO_HIGH);
 }
 
 static ucp_lane_index_t
@@ -1266,6 +1273,106 @@ out:
     UCS_ASYNC_UNBLOCK(&worker->async);
 }
 
+static ucp_request_t *
+ucp_rndv_am_req_get(ucp_worker_h worker, const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+{
+    ucp_request_t *rndv_req;
+
+    rndv_req = ucp_request_get(worker);
+    if (rndv_req == NULL) {
+        ucs_error("failed to allocate active message rendezvous reply");
+        return NULL;
+    }
+
+    rndv_req->send.ep           = ucp_worker_get_ep_by_ptr(worker,
+                                                           rndv_rts_hdr->sreq.ep_ptr);
+    rndv_req->flags             = 0;
+    rndv_req->send.mdesc        = NULL;
+    rndv_req->send.pending_lane = UCP_NULL_LANE;
+    return rndv_req;
+}
+
+UCS_PROFILE_FUNC_VOID(ucp_rndv_am_matched, (worker, rreq, rndv_rts_hdr),
+                      ucp_worker_h worker, ucp_request_t *rreq,
+                      const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+{
+    ucp_ep_config_t *ep_config;
+    ucp_request_t *rndv_req;
+    ucs_status_t status;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+
+    UCS_PROFILE_REQUEST_EVENT(rreq, "rndv_am_match", 0);
+
+    if (rreq->flags & UCP_REQUEST_FLAG_RECV_AM) {
+        rreq->recv.am.length = rndv_rts_hdr->size;
+    }
+
+    rndv_req = ucp_rndv_am_req_get(worker, rndv_rts_hdr);
+    if (rndv_req == NULL) {
+        ucp_rndv_zcopy_recv_req_complete(rreq, UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    ucp_trace_req(rreq,
+                  "rndv am matched remote {address 0x%"PRIx64" size %zu "
+                  "sreq 0x%lx} rndv_sreq %p", rndv_rts_hdr->address,
+                  rndv_rts_hdr->size, rndv_rts_hdr->sreq.reqptr, rndv_req);
+
+    if (ucs_unlikely(rreq->recv.length < rndv_rts_hdr->size)) {
+        ucp_trace_req(rndv_req,
+                      "rndv am truncated remote size %zu local size %zu rreq %p",
+                      rndv_rts_hdr->size, rreq->recv.length, rreq);
+        ucp_rndv_req_send_ats(rndv_req, rreq, rndv_rts_hdr->sreq.reqptr, UCS_OK);
+        ucp_rndv_zcopy_recv_req_complete(rreq, UCS_ERR_MESSAGE_TRUNCATED);
+        goto out;
+    }
+
+    /* Active message rendezvous is pull-only: the sender selects it only when
+     * it has GET lanes, and does not expect an RTR */
+    ep_config = ucp_ep_config(rndv_req->send.ep);
+    if (UCP_DT_IS_CONTIG(rreq->recv.datatype) &&
+        (rndv_rts_hdr->address != 0) &&
+        ucp_rndv_test_zcopy_scheme_support(rndv_rts_hdr->size,
+                                           ep_config->tag.rndv.min_get_zcopy,
+                                           ep_config->tag.rndv.max_get_zcopy,
+                                           ep_config->tag.rndv.get_zcopy_split)) {
+        status = ucp_rndv_req_send_rma_get(rndv_req, rreq, rndv_rts_hdr);
+        if (status == UCS_OK) {
+            goto out;
+        }
+
+        ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
+    } else {
+        status = UCS_ERR_UNSUPPORTED;
+    }
+
+    ucp_trace_req(rreq, "rndv am get_zcopy is not possible: %s",
+                  ucs_status_string(status));
+    ucp_rndv_req_send_ats(rndv_req, rreq, rndv_rts_hdr->sreq.reqptr, status);
+    ucp_rndv_zcopy_recv_req_complete(rreq, status);
+
+out:
+    UCS_ASYNC_UNBLOCK(&worker->async);
+}
+
+void ucp_rndv_am_reject(ucp_worker_h worker,
+                        const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                        ucs_status_t status)
+{
+    ucp_request_t *rndv_req;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+
+    rndv_req = ucp_rndv_am_req_get(worker, rndv_rts_hdr);
+    if (rndv_req != NULL) {
+        ucp_rndv_req_send_ats(rndv_req, NULL, rndv_rts_hdr->sreq.reqptr,
+                              status);
+    }
+
+    UCS_ASYNC_UNBLOCK(&worker->async);
+}
+
 ucs_status_t ucp_rndv_process_rts(void *arg, void *data, size_t length,
                                   unsigned tl_flags)
 {
@@ -1834,7 +1941,9 @@ static void ucp_rndv_dump(ucp_worker_h worker, uct_am_trace_type_t type,
 
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTS, ucp_rndv_rts_handler,
               ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATS, ucp_rndv_ats_handler,
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_ATS,
+              ucp_rndv_ats_handler,
               ucp_rndv_dump, 0);
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATP, ucp_rndv_atp_handler,
               ucp_rndv_dump, 0);
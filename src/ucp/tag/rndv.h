@@ -51,6 +51,13 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *req);
 void ucp_rndv_matched(ucp_worker_h worker, ucp_request_t *req,
                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr);
 
+void ucp_rndv_am_matched(ucp_worker_h worker, ucp_request_t *rreq,
+                         const ucp_rndv_rts_hdr_t *rndv_rts_hdr);
+
+void ucp_rndv_am_reject(ucp_worker_h worker,
+                        const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                        ucs_status_t status);
+
 ucs_status_t ucp_rndv_progress_rma_get_zcopy(uct_pending_req_t *self);
 
 ucs_status_t ucp_rndv_progress_rma_put_zcopy(uct_pending_req_t *self);
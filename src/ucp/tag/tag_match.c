@@ -12,34 +12,158 @@
 #include <ucp/tag/offload.h>
 
 
-ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm)
+static void ucp_tag_exp_hash_init_buckets(ucp_request_queue_t *buckets,
+                                          unsigned size_log)
 {
-    size_t hash_size, bucket;
+    size_t bucket;
 
-    hash_size = ucs_roundup_pow2(UCP_TAG_MATCH_HASH_SIZE);
+    for (bucket = 0; bucket < UCS_BIT(size_log); ++bucket) {
+        buckets[bucket].sw_count    = 0;
+        buckets[bucket].block_count = 0;
+        ucs_queue_head_init(&buckets[bucket].queue);
+    }
+}
+
+static ucs_status_t ucp_tag_exp_hash_init(ucp_tag_exp_hash_t *hash,
+                                          ucp_tag_t key_mask, const char *name)
+{
+    hash->key_mask = key_mask;
+    hash->size_log = UCP_TAG_MATCH_HASH_SIZE_LOG_MIN;
+    hash->count    = 0;
+    hash->buckets  = ucs_malloc(sizeof(*hash->buckets) << hash->size_log,
+                                name);
+    if (hash->buckets == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ucp_tag_exp_hash_init_buckets(hash->buckets, hash->size_log);
+    return UCS_OK;
+}
+
+void ucp_tag_exp_hash_grow(ucp_tag_exp_hash_t *hash)
+{
+    unsigned size_log = hash->size_log + 1;
+    ucp_request_queue_t *buckets, *req_queue;
+    ucp_request_t *req;
+    size_t bucket;
+
+    if (hash->size_log >= UCP_TAG_MATCH_HASH_SIZE_LOG_MAX) {
+        return;
+    }
+
+    buckets = ucs_malloc(sizeof(*buckets) << size_log, "ucp_tm_exp_hash");
+    if (buckets == NULL) {
+        ucs_debug("failed to grow expected hash %p to %lu buckets", hash,
+                  UCS_BIT(size_log));
+        return;
+    }
+
+    ucp_tag_exp_hash_init_buckets(buckets, size_log);
+
+    /* Move the requests in order, so every new bucket stays sorted by sequence
+     * number, and recalculate the offload counters of the new buckets */
+    for (bucket = 0; bucket < UCS_BIT(hash->size_log); ++bucket) {
+        ucs_queue_for_each_extract(req, &hash->buckets[bucket].queue,
+                                   recv.queue, 1) {
+            req_queue = &buckets[ucp_tag_match_calc_hash(req->recv.tag.tag &
+                                                         hash->key_mask,
+                                                         size_log)];
+            ucs_queue_push(&req_queue->queue, &req->recv.queue);
+            if (!(req->flags & UCP_REQUEST_FLAG_OFFLOADED)) {
+                ++req_queue->sw_count;
+                req_queue->block_count +=
+                        !!(req->flags & UCP_REQUEST_FLAG_BLOCK_OFFLOAD);
+            }
+        }
+    }
+
+    ucs_debug("grew expected hash %p to %lu buckets with %u requests", hash,
+              UCS_BIT(size_log), hash->count);
+
+    ucs_free(hash->buckets);
+    hash->buckets  = buckets;
+    hash->size_log = size_log;
+}
+
+void ucp_tag_unexp_hash_grow(ucp_tag_match_t *tm)
+{
+    unsigned size_log = tm->unexpected.size_log + 1;
+    ucp_recv_desc_t *rdesc;
+    ucs_list_link_t *hash;
+    size_t bucket;
 
-    tm->expected.sn           = 0;
-    tm->expected.sw_all_count = 0;
+    if (tm->unexpected.size_log >= UCP_TAG_MATCH_HASH_SIZE_LOG_MAX) {
+        return;
+    }
+
+    hash = ucs_malloc(sizeof(*hash) << size_log, "ucp_tm_unexp_hash");
+    if (hash == NULL) {
+        ucs_debug("failed to grow unexpected hash of tm %p to %lu buckets", tm,
+                  UCS_BIT(size_log));
+        return;
+    }
+
+    for (bucket = 0; bucket < UCS_BIT(size_log); ++bucket) {
+        ucs_list_head_init(&hash[bucket]);
+    }
+
+    /* Walk the descriptors in arrival order, to keep every bucket ordered */
+    ucs_list_for_each(rdesc, &tm->unexpected.all, tag_list[UCP_RDESC_ALL_LIST]) {
+        bucket = ucp_tag_match_calc_hash(ucp_rdesc_get_tag(rdesc), size_log);
+        ucs_list_add_tail(&hash[bucket], &rdesc->tag_list[UCP_RDESC_HASH_LIST]);
+    }
+
+    ucs_debug("grew unexpected hash of tm %p to %lu buckets with %u descriptors",
+              tm, UCS_BIT(size_log), tm->unexpected.count);
+
+    ucs_free(tm->unexpected.hash);
+    tm->unexpected.hash     = hash;
+    tm->unexpected.size_log = size_log;
+}
+
+ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm, ucp_tag_t sender_mask)
+{
+    ucs_status_t status;
+    size_t bucket;
+
+    tm->expected.sn            = 0;
+    tm->expected.sw_all_count  = 0;
+    tm->expected.wild_sw_count = 0;
     ucs_queue_head_init(&tm->expected.wildcard.queue);
+    tm->expected.wildcard.sw_count    = 0;
+    tm->expected.wildcard.block_count = 0;
     ucs_list_head_init(&tm->unexpected.all);
 
-    tm->expected.hash = ucs_malloc(sizeof(*tm->expected.hash) * hash_size,
+    status = ucp_tag_exp_hash_init(&tm->expected.hash, UCP_TAG_MASK_FULL,
                                    "ucp_tm_exp_hash");
-    if (tm->expected.hash == NULL) {
-        return UCS_ERR_NO_MEMORY;
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    if (sender_mask != 0) {
+        status = ucp_tag_exp_hash_init(&tm->expected.src_hash, sender_mask,
+                                       "ucp_tm_exp_src_hash");
+        if (status != UCS_OK) {
+            goto err_free_exp_hash;
+        }
+    } else {
+        tm->expected.src_hash.buckets  = NULL;
+        tm->expected.src_hash.key_mask = 0;
+        tm->expected.src_hash.size_log = 0;
+        tm->expected.src_hash.count    = 0;
     }
 
-    tm->unexpected.hash = ucs_malloc(sizeof(*tm->unexpected.hash) * hash_size,
-                                     "ucp_tm_unexp_hash");
+    tm->unexpected.size_log = UCP_TAG_MATCH_HASH_SIZE_LOG_MIN;
+    tm->unexpected.count    = 0;
+    tm->unexpected.hash     = ucs_malloc(sizeof(*tm->unexpected.hash) <<
+                                         tm->unexpected.size_log,
+                                         "ucp_tm_unexp_hash");
     if (tm->unexpected.hash == NULL) {
-        ucs_free(tm->expected.hash);
-        return UCS_ERR_NO_MEMORY;
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_exp_src_hash;
     }
 
-    for (bucket = 0; bucket < hash_size; ++bucket) {
-        tm->expected.hash[bucket].sw_count    = 0;
-        tm->expected.hash[bucket].block_count = 0;
-        ucs_queue_head_init(&tm->expected.hash[bucket].queue);
+    for (bucket = 0; bucket < UCS_BIT(tm->unexpected.size_log); ++bucket) {
         ucs_list_head_init(&tm->unexpected.hash[bucket]);
     }
 
@@ -50,6 +174,13 @@ ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm)
     tm->offload.zcopy_thresh = SIZE_MAX;
     tm->offload.iface        = NULL;
     return UCS_OK;
+
+err_free_exp_src_hash:
+    ucs_free(tm->expected.src_hash.buckets);
+err_free_exp_hash:
+    ucs_free(tm->expected.hash.buckets);
+err:
+    return status;
 }
 
 void ucp_tag_match_cleanup(ucp_tag_match_t *tm)
@@ -59,14 +190,15 @@ void ucp_tag_match_cleanup(ucp_tag_match_t *tm)
     ucs_list_for_each_safe(rdesc, tmp_rdesc, &tm->unexpected.all,
                            tag_list[UCP_RDESC_ALL_LIST]) {
         ucs_warn("unexpected tag-receive descriptor %p was not matched", rdesc);
-        ucp_tag_unexp_remove(rdesc);
+        ucp_tag_unexp_remove(tm, rdesc);
         ucp_recv_desc_release(rdesc);
     }
 
     kh_destroy_inplace(ucp_tag_offload_hash, &tm->offload.tag_hash);
     kh_destroy_inplace(ucp_tag_frag_hash, &tm->frag_hash);
     ucs_free(tm->unexpected.hash);
-    ucs_free(tm->expected.hash);
+    ucs_free(tm->expected.src_hash.buckets);
+    ucs_free(tm->expected.hash.buckets);
 }
 
 int ucp_tag_unexp_is_empty(ucp_tag_match_t *tm)
@@ -104,47 +236,54 @@ ucp_request_t*
 ucp_tag_exp_search_all(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                        ucp_tag_t tag)
 {
-    ucs_queue_head_t *hash_queue = &req_queue->queue;
-    ucp_request_queue_t *queue;
-    ucs_queue_iter_t hash_iter, wild_iter, *iter;
-    uint64_t hash_sn, wild_sn, *sn_p;
+    ucp_request_queue_t *queues[3];
+    ucs_queue_iter_t iters[3];
+    uint64_t sns[3];
+    unsigned i, min, num_queues;
     ucp_request_t *req;
 
-    *hash_queue->ptail                 = NULL;
-    *tm->expected.wildcard.queue.ptail = NULL;
+    /* Merge the specific tag bucket, the sender bucket and the wildcard queue
+     * by sequence number, to match the oldest posted request */
+    num_queues           = 0;
+    queues[num_queues++] = req_queue;
+    if (tm->expected.src_hash.count != 0) {
+        queues[num_queues++] = ucp_tag_exp_hash_bucket(&tm->expected.src_hash,
+                                                       tag);
+    }
+    queues[num_queues++] = &tm->expected.wildcard;
 
-    hash_iter = ucs_queue_iter_begin(hash_queue);
-    wild_iter = ucs_queue_iter_begin(&tm->expected.wildcard.queue);
+    for (i = 0; i < num_queues; ++i) {
+        *queues[i]->queue.ptail = NULL;
+        iters[i]                = ucs_queue_iter_begin(&queues[i]->queue);
+        sns[i]                  = ucp_tag_exp_req_seq(iters[i]);
+    }
 
-    hash_sn = ucp_tag_exp_req_seq(hash_iter);
-    wild_sn = ucp_tag_exp_req_seq(wild_iter);
+    for (;;) {
+        min = 0;
+        for (i = 1; i < num_queues; ++i) {
+            if (sns[i] < sns[min]) {
+                min = i;
+            }
+        }
 
-    while (hash_sn != wild_sn) {
-        if (hash_sn < wild_sn) {
-            iter  = &hash_iter;
-            sn_p  = &hash_sn;
-            queue = req_queue;
-        } else {
-            iter  = &wild_iter;
-            sn_p  = &wild_sn;
-            queue = &tm->expected.wildcard;
+        if (sns[min] == ULONG_MAX) {
+            break;
         }
 
-        req = ucs_container_of(**iter, ucp_request_t, recv.queue);
+        req = ucs_container_of(*iters[min], ucp_request_t, recv.queue);
         if (ucp_tag_is_match(tag, req->recv.tag.tag, req->recv.tag.tag_mask)) {
             ucs_trace_req("matched received tag %"PRIx64" to req %p", tag, req);
-            ucp_tag_exp_delete(req, tm, queue, *iter);
+            ucp_tag_exp_delete(req, tm, queues[min], iters[min]);
             return req;
         }
 
-        *iter = ucs_queue_iter_next(*iter);
-        *sn_p = ucp_tag_exp_req_seq(*iter);
+        iters[min] = ucs_queue_iter_next(iters[min]);
+        sns[min]   = ucp_tag_exp_req_seq(iters[min]);
     }
 
-    ucs_assertv((hash_sn == ULONG_MAX) && (wild_sn == ULONG_MAX),
-                "hash_seq=%lu wild_seq=%lu", hash_sn, wild_sn);
-    ucs_assert(ucs_queue_iter_end(hash_queue, hash_iter));
-    ucs_assert(ucs_queue_iter_end(&tm->expected.wildcard.queue, wild_iter));
+    for (i = 0; i < num_queues; ++i) {
+        ucs_assert(ucs_queue_iter_end(&queues[i]->queue, iters[i]));
+    }
     return NULL;
 }
 
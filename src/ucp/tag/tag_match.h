@@ -42,6 +42,17 @@ typedef struct {
 } ucp_request_queue_t;
 
 
+/**
+ * Resizable hash table of expected requests
+ */
+typedef struct {
+    ucp_request_queue_t   *buckets;    /* Array of 2^size_log request queues */
+    ucp_tag_t             key_mask;    /* Tag bits which select the bucket */
+    unsigned              size_log;    /* Log2 of the number of buckets */
+    unsigned              count;       /* Number of requests in the table */
+} ucp_tag_exp_hash_t;
+
+
 /**
  * Hash table entry for tag message fragments
  */
@@ -63,16 +74,25 @@ typedef struct ucp_tag_match {
     /* Expected queue */
     struct {
         ucp_request_queue_t   wildcard;   /* Expected wildcard requests */
-        ucp_request_queue_t   *hash;      /* Hash table of expected non-wild tags */
+        ucp_tag_exp_hash_t    hash;       /* Hash table of expected non-wild tags */
+        ucp_tag_exp_hash_t    src_hash;   /* Hash table of expected requests with
+                                             a specific sender and wildcard tag
+                                             bits, keyed by the sender bits. Used
+                                             only if the sender mask is set. */
         uint64_t              sn;
         unsigned              sw_all_count; /* Number of all expected requests which
                                                are not posted to offload */
+        unsigned              wild_sw_count; /* Number of expected requests with
+                                                partial tag mask which are not
+                                                posted to offload */
     } expected;
 
     /* Unexpected queue */
     struct {
         ucs_list_link_t       all;        /* Linked list of all tags */
         ucs_list_link_t       *hash;      /* Hash table of unexpected tags */
+        unsigned              size_log;   /* Log2 of the hash table size */
+        unsigned              count;      /* Number of unexpected descriptors */
     } unexpected;
 
     /* Hash for fragment assembly, the key is a globally unique tag message id */
@@ -101,7 +121,7 @@ typedef struct ucp_tag_match {
 } ucp_tag_match_t;
 
 
-ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm);
+ucs_status_t ucp_tag_match_init(ucp_tag_match_t *tm, ucp_tag_t sender_mask);
 
 void ucp_tag_match_cleanup(ucp_tag_match_t *tm);
 
@@ -109,6 +129,10 @@ int ucp_tag_exp_remove(ucp_tag_match_t *tm, ucp_request_t *req);
 
 int ucp_tag_unexp_is_empty(ucp_tag_match_t *tm);
 
+void ucp_tag_exp_hash_grow(ucp_tag_exp_hash_t *hash);
+
+void ucp_tag_unexp_hash_grow(ucp_tag_match_t *tm);
+
 ucp_request_t*
 ucp_tag_exp_search_all(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                        ucp_tag_t tag);
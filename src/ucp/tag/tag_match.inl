@@ -20,9 +20,15 @@
 #include <inttypes.h>
 
 
-/* Hash size is a prime number just below 1024. Prime number for even distribution,
- * and small enough to fit L1 cache. */
-#define UCP_TAG_MATCH_HASH_SIZE     1021
+/* Initial hash size is 1024 buckets, small enough to fit L1 cache. The tables
+ * are doubled when the average number of entries per bucket exceeds the maximal
+ * load factor, up to the maximal size. */
+#define UCP_TAG_MATCH_HASH_SIZE_LOG_MIN  10
+#define UCP_TAG_MATCH_HASH_SIZE_LOG_MAX  20
+#define UCP_TAG_MATCH_HASH_MAX_LOAD      2u
+
+/* 2^64 / golden ratio, for Fibonacci hashing */
+#define UCP_TAG_MATCH_HASH_MULT          0x9e3779b97f4a7c15ul
 
 
 static UCS_F_ALWAYS_INLINE
@@ -42,27 +48,59 @@ int ucp_tag_is_match(ucp_tag_t tag, ucp_tag_t exp_tag, ucp_tag_t tag_mask)
 }
 
 static UCS_F_ALWAYS_INLINE size_t
-ucp_tag_match_calc_hash(ucp_tag_t tag)
+ucp_tag_match_calc_hash(ucp_tag_t tag, unsigned size_log)
+{
+    /* Take the upper bits of the product, which depend on all bits of the tag.
+     * Doubling the table splits every bucket into two adjacent ones, so a
+     * rehash keeps the relative order of the entries of each bucket. */
+    return (tag * UCP_TAG_MATCH_HASH_MULT) >> (64 - size_log);
+}
+
+static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
+ucp_tag_exp_hash_bucket(ucp_tag_exp_hash_t *hash, ucp_tag_t tag)
+{
+    return &hash->buckets[ucp_tag_match_calc_hash(tag & hash->key_mask,
+                                                  hash->size_log)];
+}
+
+static UCS_F_ALWAYS_INLINE int
+ucp_tag_exp_is_src_mask(ucp_tag_match_t *tm, ucp_tag_t tag_mask)
+{
+    ucp_tag_t sender_mask = tm->expected.src_hash.key_mask;
+
+    return (sender_mask != 0) && ((tag_mask & sender_mask) == sender_mask);
+}
+
+/* Return the hash table for requests with the given mask, or NULL for requests
+ * which are kept on the wildcard queue */
+static UCS_F_ALWAYS_INLINE ucp_tag_exp_hash_t*
+ucp_tag_exp_get_hash(ucp_tag_match_t *tm, ucp_tag_t tag_mask)
 {
-    /* Compute two 32-bit modulo and combine their result */
-    return ((uint32_t)tag % UCP_TAG_MATCH_HASH_SIZE) ^
-           ((uint32_t)(tag >> 32) % UCP_TAG_MATCH_HASH_SIZE);
+    if (tag_mask == UCP_TAG_MASK_FULL) {
+        return &tm->expected.hash;
+    } else if (ucp_tag_exp_is_src_mask(tm, tag_mask)) {
+        return &tm->expected.src_hash;
+    } else {
+        return NULL;
+    }
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
 ucp_tag_exp_get_queue_for_tag(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
-    return &tm->expected.hash[ucp_tag_match_calc_hash(tag)];
+    return ucp_tag_exp_hash_bucket(&tm->expected.hash, tag);
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
 ucp_tag_exp_get_queue(ucp_tag_match_t *tm, ucp_tag_t tag, ucp_tag_t tag_mask)
 {
-    if (tag_mask == UCP_TAG_MASK_FULL) {
-        return ucp_tag_exp_get_queue_for_tag(tm, tag);
-    } else {
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_hash(tm, tag_mask);
+
+    if (hash == NULL) {
         return &tm->expected.wildcard;
     }
+
+    return ucp_tag_exp_hash_bucket(hash, tag);
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_queue_t*
@@ -71,12 +109,22 @@ ucp_tag_exp_get_req_queue(ucp_tag_match_t *tm, ucp_request_t *req)
     return ucp_tag_exp_get_queue(tm, req->recv.tag.tag, req->recv.tag.tag_mask);
 }
 
+/* Note: may resize the hash table, so req_queue must not be used afterwards */
 static UCS_F_ALWAYS_INLINE void
 ucp_tag_exp_push(ucp_tag_match_t *tm, ucp_request_queue_t *req_queue,
                  ucp_request_t *req)
 {
+    ucp_tag_exp_hash_t *hash;
+
     req->recv.tag.sn = tm->expected.sn++;
     ucs_queue_push(&req_queue->queue, &req->recv.queue);
+
+    hash = ucp_tag_exp_get_hash(tm, req->recv.tag.tag_mask);
+    if ((hash != NULL) &&
+        ucs_unlikely(++hash->count >
+                     (UCP_TAG_MATCH_HASH_MAX_LOAD << hash->size_log))) {
+        ucp_tag_exp_hash_grow(hash);
+    }
 }
 
 static UCS_F_ALWAYS_INLINE void
@@ -85,18 +133,33 @@ ucp_tag_exp_add(ucp_tag_match_t *tm, ucp_request_t *req)
     ucp_tag_exp_push(tm, ucp_tag_exp_get_req_queue(tm, req), req);
 }
 
+/* Account for a request which was removed from the expected queues */
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_exp_removed(ucp_tag_match_t *tm, ucp_request_t *req)
+{
+    ucp_tag_exp_hash_t *hash = ucp_tag_exp_get_hash(tm, req->recv.tag.tag_mask);
+
+    if (hash != NULL) {
+        ucs_assert(hash->count > 0);
+        --hash->count;
+    }
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_tag_exp_delete(ucp_request_t *req, ucp_tag_match_t *tm,
                    ucp_request_queue_t *req_queue, ucs_queue_iter_t iter)
 {
     if (!(req->flags & UCP_REQUEST_FLAG_OFFLOADED)) {
         --tm->expected.sw_all_count;
+        tm->expected.wild_sw_count -= (req->recv.tag.tag_mask !=
+                                       UCP_TAG_MASK_FULL);
         --req_queue->sw_count;
         if (req->flags & UCP_REQUEST_FLAG_BLOCK_OFFLOAD) {
             --req_queue->block_count;
         }
     }
     ucs_queue_del_iter(&req_queue->queue, iter);
+    ucp_tag_exp_removed(tm, req);
 }
 
 static UCS_F_ALWAYS_INLINE ucp_request_t *
@@ -106,12 +169,13 @@ ucp_tag_exp_search(ucp_tag_match_t *tm, ucp_tag_t tag)
     ucs_queue_iter_t iter;
     ucp_request_t *req;
 
-    if (ucs_unlikely(!ucs_queue_is_empty(&tm->expected.wildcard.queue))) {
+    if (ucs_unlikely(!ucs_queue_is_empty(&tm->expected.wildcard.queue) ||
+                     (tm->expected.src_hash.count != 0))) {
         req_queue = ucp_tag_exp_get_queue_for_tag(tm, tag);
         return ucp_tag_exp_search_all(tm, req_queue, tag);
     }
 
-    /* fast path - wildcard queue is empty, search only the specific queue */
+    /* fast path - no wildcard requests, search only the specific queue */
     req_queue = ucp_tag_exp_get_queue_for_tag(tm, tag);
     ucs_queue_for_each_safe(req, iter, &req_queue->queue, recv.queue) {
         req = ucs_container_of(*iter, ucp_request_t, recv.queue);
@@ -134,12 +198,15 @@ static UCS_F_ALWAYS_INLINE ucp_tag_t ucp_rdesc_get_tag(ucp_recv_desc_t *rdesc)
 static UCS_F_ALWAYS_INLINE ucs_list_link_t*
 ucp_tag_unexp_get_list_for_tag(ucp_tag_match_t *tm, ucp_tag_t tag)
 {
-    return &tm->unexpected.hash[ucp_tag_match_calc_hash(tag)];
+    return &tm->unexpected.hash[ucp_tag_match_calc_hash(tag,
+                                                        tm->unexpected.size_log)];
 }
 
 static UCS_F_ALWAYS_INLINE void
-ucp_tag_unexp_remove(ucp_recv_desc_t *rdesc)
+ucp_tag_unexp_remove(ucp_tag_match_t *tm, ucp_recv_desc_t *rdesc)
 {
+    ucs_assert(tm->unexpected.count > 0);
+    --tm->unexpected.count;
     ucs_list_del(&rdesc->tag_list[UCP_RDESC_HASH_LIST]);
     ucs_list_del(&rdesc->tag_list[UCP_RDESC_ALL_LIST] );
 }
@@ -153,6 +220,11 @@ ucp_tag_unexp_recv(ucp_tag_match_t *tm, ucp_recv_desc_t *rdesc, ucp_tag_t tag)
     ucs_list_add_tail(hash_list,           &rdesc->tag_list[UCP_RDESC_HASH_LIST]);
     ucs_list_add_tail(&tm->unexpected.all, &rdesc->tag_list[UCP_RDESC_ALL_LIST]);
 
+    if (ucs_unlikely(++tm->unexpected.count >
+                     (UCP_TAG_MATCH_HASH_MAX_LOAD << tm->unexpected.size_log))) {
+        ucp_tag_unexp_hash_grow(tm);
+    }
+
     ucs_trace_req("unexp "UCP_RECV_DESC_FMT" tag %"PRIx64,
                   UCP_RECV_DESC_ARG(rdesc), tag);
 }
@@ -202,7 +274,7 @@ ucp_tag_unexp_search(ucp_tag_match_t *tm, ucp_tag_t tag, uint64_t tag_mask,
                           "%s tag %"PRIx64"/%"PRIx64, UCP_RECV_DESC_ARG(rdesc),
                           title, tag, tag_mask);
             if (rem) {
-                ucp_tag_unexp_remove(rdesc);
+                ucp_tag_unexp_remove(tm, rdesc);
             }
             return rdesc;
         }
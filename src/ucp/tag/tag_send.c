@@ -33,6 +33,9 @@ ucp_tag_get_rndv_threshold(const ucp_request_t *req, size_t count,
                            size_t rndv_am_thresh)
 {
     switch (req->send.datatype & UCP_DATATYPE_CLASS_MASK) {
+    case UCP_DATATYPE_STRIDED:
+        count = ucp_dt_strided_iov_count(req->send.datatype, count);
+        /* Fall through */
     case UCP_DATATYPE_IOV:
         if ((count > max_iov) &&
             ucp_ep_is_tag_offload_enabled(ucp_ep_config(req->send.ep))) {
@@ -14,6 +14,7 @@
 #include <ucp/core/ucp_worker.h>
 #include <ucp/core/ucp_ep.inl>
 #include <ucs/arch/bitops.h>
+#include <ucs/async/async.h>
 #include <ucs/debug/log.h>
 #include <inttypes.h>
 
@@ -21,7 +22,7 @@
 /*
  * Packed address layout:
  *
- * [ header(8bit) | uuid(64bit) | worker_name(string) ]
+ * [ header(8bit) | uuid(64bit) | worker_name(string) | template_hash(64bit) ]
  * [ device1_md_index | device1_address(var) ]
  *    [ tl1_name_csum(string) | tl1_info | tl1_address(var) ]
  *    [ tl2_name_csum(string) | tl2_info | tl2_address(var) ]
@@ -30,6 +31,21 @@
  *    ...
  *
  *   * Worker name is packed if UCX_ADDRESS_DEBUG_INFO is enabled.
+ *   * Template hash is packed if UCX_ADDRESS_TEMPLATE is enabled and the address
+ *     list is not empty. It identifies the md_index, num_paths, tl_name_csum,
+ *     tl_info and number of transports of all devices in the full address of
+ *     the worker (address template), regardless of which resources are packed.
+ *     A receiver which knows the template takes the unpacked attributes of the
+ *     transports from it, after checking that their tl_info is the same.
+ *   * If the address is packed for a peer which has the same address template,
+ *     it may be packed in compact form, which replaces the device and transport
+ *     attributes with the indices of the corresponding template entries:
+ *       [ device1_template_index | device1_address_len | device1_address ]
+ *          [ tl1_template_index | tl1_address_len | tl1_address ]
+ *             [ ep1_address_len | ep1_address | ep1_lane_index ]
+ *          ...
+ *     The last device, transport and ep address are marked with the LAST flag,
+ *     and a transport with ep addresses is marked with the HAS_EP_ADDR flag.
  *   * In unified mode tl_info contains just rsc_index and iface latency overhead.
  *     For last address in the tl address list, it will have LAST flag set.
  *   * For ep address, lane index contains the LAST flag.
@@ -54,6 +70,8 @@ typedef struct {
     ucp_rsc_index_t  tl_count;
     unsigned         num_paths;
     size_t           tl_addrs_size;
+    size_t           compact_size;   /* Size of transport addresses in
+                                        compact form */
 } ucp_address_packed_device_t;
 
 
@@ -89,6 +107,27 @@ typedef struct {
 } ucp_address_unified_iface_attr_t;
 
 
+/* Address template entry, along with the packed data it was unpacked from */
+typedef struct {
+    ucp_address_entry_t  entry;     /* Unpacked entry, without addresses */
+    uint8_t              md_byte;   /* Packed md_index and MD flags */
+    uint8_t              attr[sizeof(ucp_address_packed_iface_attr_t)];
+                                    /* Packed tl_info, without address flags */
+} ucp_address_template_entry_t;
+
+
+/* Unpacked entries of the full address of a worker. Addresses which are packed
+ * in compact form refer to them by index. */
+struct ucp_address_template {
+    uint64_t                      hash;          /* Template hash */
+    unsigned                      address_count; /* Number of entries */
+    uint8_t                       rsc_entry[UCP_MAX_RESOURCES];
+                                                 /* Entry index of each local
+                                                    resource */
+    ucp_address_template_entry_t  entries[0];
+};
+
+
 #define UCP_ADDRESS_FLAG_ATOMIC32     UCS_BIT(30) /* 32bit atomic operations */
 #define UCP_ADDRESS_FLAG_ATOMIC64     UCS_BIT(31) /* 64bit atomic operations */
 
@@ -116,6 +155,13 @@ typedef struct {
 
 #define UCP_ADDRESS_HEADER_VERSION_MASK     UCS_MASK(4) /* Version - 4 bits */
 #define UCP_ADDRESS_HEADER_FLAG_DEBUG_INFO  UCS_BIT(4)  /* Address has debug info */
+#define UCP_ADDRESS_HEADER_FLAG_TEMPLATE    UCS_BIT(5)  /* Address has template hash */
+#define UCP_ADDRESS_HEADER_FLAG_COMPACT     UCS_BIT(6)  /* Address refers to
+                                                           template entries */
+
+/* FNV-1a parameters for the template hash */
+#define UCP_ADDRESS_TEMPLATE_HASH_INIT      0xcbf29ce484222325ul
+#define UCP_ADDRESS_TEMPLATE_HASH_PRIME     0x100000001b3ul
 
 /* Enumeration of UCP address versions.
  * Every release which changes the address binary format must bump this number.
@@ -134,6 +180,158 @@ static size_t ucp_address_iface_attr_size(ucp_worker_t *worker)
            sizeof(ucp_address_packed_iface_attr_t);
 }
 
+static int ucp_address_has_template(ucp_worker_h worker,
+                                    ucp_rsc_index_t num_devices)
+{
+    return (worker->address_template != NULL) && (num_devices > 0);
+}
+
+static uint64_t
+ucp_address_template_hash(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *p;
+
+    for (p = data; p < (const uint8_t*)data + size; ++p) {
+        hash = (hash ^ *p) * UCP_ADDRESS_TEMPLATE_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+/* Copy packed iface attributes, without the address flags which are packed
+ * in the same byte as the resource index in unified mode */
+static void ucp_address_template_attr(ucp_worker_h worker, uint8_t *dest,
+                                      const void *attr_ptr)
+{
+    UCS_STATIC_ASSERT(sizeof(ucp_address_unified_iface_attr_t) <=
+                      sizeof(ucp_address_packed_iface_attr_t));
+
+    memcpy(dest, attr_ptr, ucp_address_iface_attr_size(worker));
+    if (ucp_worker_unified_mode(worker)) {
+        dest[0] &= UCP_ADDRESS_FLAG_LEN_MASK;
+    }
+}
+
+static ucp_address_template_t *
+ucp_address_template_get(ucp_worker_h worker, uint64_t hash)
+{
+    ucp_address_template_t *tmpl = NULL;
+    khiter_t iter;
+
+    if ((worker->address_template != NULL) &&
+        (worker->address_template->hash == hash)) {
+        return worker->address_template;
+    }
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    iter = kh_get(ucp_worker_addr_tmpl, &worker->address_templates, hash);
+    if (iter != kh_end(&worker->address_templates)) {
+        tmpl = kh_val(&worker->address_templates, iter);
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+
+    return tmpl;
+}
+
+static int ucp_address_template_can_add(ucp_worker_h worker)
+{
+    return kh_size(&worker->address_templates) <
+           worker->context->config.ext.address_cache_size;
+}
+
+static ucp_address_template_t *
+ucp_address_template_create(ucp_worker_h worker, uint64_t hash,
+                            const ucp_address_entry_t *address_list,
+                            unsigned address_count, const uint8_t *md_bytes,
+                            const void **attr_ptrs)
+{
+    ucp_address_template_entry_t *tentry;
+    ucp_address_template_t *tmpl;
+    unsigned i;
+
+    tmpl = ucs_malloc(sizeof(*tmpl) + (address_count * sizeof(*tmpl->entries)),
+                      "ucp_address_template");
+    if (tmpl == NULL) {
+        return NULL;
+    }
+
+    tmpl->hash          = hash;
+    tmpl->address_count = address_count;
+    memset(tmpl->rsc_entry, UCP_NULL_RESOURCE, sizeof(tmpl->rsc_entry));
+    for (i = 0; i < address_count; ++i) {
+        tentry                     = &tmpl->entries[i];
+        tentry->entry              = address_list[i];
+        tentry->entry.dev_addr     = NULL;
+        tentry->entry.iface_addr   = NULL;
+        tentry->entry.num_ep_addrs = 0;
+        tentry->md_byte            = md_bytes[i];
+        ucp_address_template_attr(worker, tentry->attr, attr_ptrs[i]);
+    }
+
+    return tmpl;
+}
+
+static void
+ucp_address_template_add(ucp_worker_h worker, uint64_t hash,
+                         const ucp_address_entry_t *address_list,
+                         unsigned address_count, const uint8_t *md_bytes,
+                         const void **attr_ptrs)
+{
+    ucp_address_template_t *tmpl;
+    khiter_t iter;
+    int ret;
+
+    tmpl = ucp_address_template_create(worker, hash, address_list,
+                                       address_count, md_bytes, attr_ptrs);
+    if (tmpl == NULL) {
+        ucs_debug("failed to allocate address template");
+        return;
+    }
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    iter = kh_put(ucp_worker_addr_tmpl, &worker->address_templates, hash, &ret);
+    if ((ret == UCS_KH_PUT_FAILED) || (ret == UCS_KH_PUT_KEY_PRESENT)) {
+        /* keep the template which is already cached */
+        ucs_free(tmpl);
+    } else {
+        kh_val(&worker->address_templates, iter) = tmpl;
+        ucs_trace("worker %p: cached address template 0x%"PRIx64" with %u "
+                  "entries", worker, hash, address_count);
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+}
+
+/* Find the template entry which was unpacked from the same packed data as a
+ * transport address. Addresses list the transports in the same order as their
+ * template, so the search starts from the entry after the previous match. */
+static const ucp_address_entry_t *
+ucp_address_template_find(ucp_worker_h worker,
+                          const ucp_address_template_t *tmpl,
+                          unsigned *entry_index_p, uint8_t md_byte,
+                          unsigned dev_num_paths, uint16_t tl_name_csum,
+                          const void *attr_ptr)
+{
+    const ucp_address_template_entry_t *tentry;
+    uint8_t attr[sizeof(tentry->attr)];
+    unsigned entry_index;
+
+    ucp_address_template_attr(worker, attr, attr_ptr);
+
+    for (entry_index = *entry_index_p; entry_index < tmpl->address_count;
+         ++entry_index) {
+        tentry = &tmpl->entries[entry_index];
+        if ((tentry->md_byte             == md_byte)       &&
+            (tentry->entry.dev_num_paths == dev_num_paths) &&
+            (tentry->entry.tl_name_csum  == tl_name_csum)  &&
+            !memcmp(tentry->attr, attr, ucp_address_iface_attr_size(worker))) {
+            *entry_index_p = entry_index + 1;
+            return &tentry->entry;
+        }
+    }
+
+    return NULL;
+}
+
 static uint64_t ucp_worker_iface_can_connect(uct_iface_attr_t *attrs)
 {
     return attrs->cap.flags &
@@ -226,17 +424,24 @@ ucp_address_gather_devices(ucp_worker_h worker, ucp_ep_h ep, uint64_t tl_bitmap,
                     dev->tl_addrs_size += !ucp_worker_unified_mode(worker);
                     dev->tl_addrs_size += iface_attr->ep_addr_len;
                     dev->tl_addrs_size += sizeof(uint8_t); /* lane index */
+                    /* compact form always packs the length */
+                    dev->compact_size  += sizeof(uint8_t) +
+                                          iface_attr->ep_addr_len +
+                                          sizeof(uint8_t);
                 }
             }
         }
 
         dev->tl_addrs_size += sizeof(uint16_t); /* tl name checksum */
+        dev->compact_size  += sizeof(uint8_t);  /* template entry index */
+        dev->compact_size  += sizeof(uint8_t);  /* iface address length */
 
         if (flags & UCP_ADDRESS_PACK_FLAG_IFACE_ADDR) {
             /* iface address (its length will be packed in non-unified mode only) */
             dev->tl_addrs_size += iface_attr->iface_addr_len;
             dev->tl_addrs_size += !ucp_worker_unified_mode(worker); /* if addr length */
             dev->tl_addrs_size += ucp_address_iface_attr_size(worker);
+            dev->compact_size  += iface_attr->iface_addr_len;
         } else {
             dev->tl_addrs_size += 1; /* 0-value for valid unpacking */
         }
@@ -267,7 +472,7 @@ ucp_address_gather_devices(ucp_worker_h worker, ucp_ep_h ep, uint64_t tl_bitmap,
 static size_t ucp_address_packed_size(ucp_worker_h worker,
                                       const ucp_address_packed_device_t *devices,
                                       ucp_rsc_index_t num_devices,
-                                      uint64_t pack_flags)
+                                      uint64_t pack_flags, int compact)
 {
     size_t size = 0;
     const ucp_address_packed_device_t *dev;
@@ -284,8 +489,19 @@ static size_t ucp_address_packed_size(ucp_worker_h worker,
         size += strlen(ucp_worker_get_name(worker)) + 1;
     }
 
+    if (ucp_address_has_template(worker, num_devices)) {
+        size += sizeof(uint64_t);
+    }
+
     if (num_devices == 0) {
         size += 1;                      /* NULL md_index */
+    } else if (compact) {
+        for (dev = devices; dev < (devices + num_devices); ++dev) {
+            size += 1;                  /* template device index */
+            size += 1;                  /* device address length */
+            size += dev->dev_addr_len;  /* device address */
+            size += dev->compact_size;  /* transport addresses */
+        }
     } else {
         for (dev = devices; dev < (devices + num_devices); ++dev) {
             size += 1;                  /* device md_index */
@@ -573,17 +789,56 @@ ucp_address_unpack_length(ucp_worker_h worker, const void* flags_ptr, const void
     return UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
 }
 
+/* Pack the address header, worker UUID, worker name and template hash, and
+ * return a pointer to storage right after them */
+static void* ucp_address_pack_header(ucp_worker_h worker, void *buffer,
+                                     unsigned pack_flags, uint8_t header_flags)
+{
+    uint8_t *address_header_p;
+    void *ptr;
+
+    ptr               = buffer;
+    address_header_p  = ptr;
+    *address_header_p = UCP_ADDRESS_VERSION_CURRENT | header_flags;
+    ptr               = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+
+    if (pack_flags & UCP_ADDRESS_PACK_FLAG_WORKER_UUID) {
+        *(uint64_t*)ptr = worker->uuid;
+        ptr             = UCS_PTR_TYPE_OFFSET(ptr, worker->uuid);
+    }
+
+    if (worker->context->config.ext.address_debug_info) {
+        /* Add debug information to the packed address, and set the corresponding
+         * flag in address header.
+         */
+        *address_header_p |= UCP_ADDRESS_HEADER_FLAG_DEBUG_INFO;
+
+        if (pack_flags & UCP_ADDRESS_PACK_FLAG_WORKER_NAME) {
+            ptr            = ucp_address_pack_worker_name(worker, ptr);
+        }
+    }
+
+    if (header_flags & UCP_ADDRESS_HEADER_FLAG_TEMPLATE) {
+        *(uint64_t*)ptr = worker->address_template->hash;
+        ptr             = UCS_PTR_TYPE_OFFSET(ptr, uint64_t);
+    }
+
+    return ptr;
+}
+
 static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
                                         void *buffer, size_t size,
                                         uint64_t tl_bitmap, unsigned pack_flags,
                                         const ucp_lane_index_t *lanes2remote,
                                         const ucp_address_packed_device_t *devices,
-                                        ucp_rsc_index_t num_devices)
+                                        ucp_rsc_index_t num_devices,
+                                        uint64_t *template_hash_p)
 {
     ucp_context_h context       = worker->context;
     uint64_t md_flags_pack_mask = (UCT_MD_FLAG_REG | UCT_MD_FLAG_ALLOC);
     const ucp_address_packed_device_t *dev;
-    uint8_t *address_header_p;
+    uint64_t template_hash;
+    uint8_t header_flags;
     uct_iface_attr_t *iface_attr;
     ucp_md_index_t md_index;
     ucp_worker_iface_t *wiface;
@@ -601,28 +856,15 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
     int attr_len;
     void *ptr;
     int enable_amo;
+    uint8_t num_paths;
+    uint8_t tl_count;
 
-    ptr               = buffer;
-    addr_index        = 0;
-    address_header_p  = ptr;
-    *address_header_p = UCP_ADDRESS_VERSION_CURRENT;
-    ptr               = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
-
-    if (pack_flags & UCP_ADDRESS_PACK_FLAG_WORKER_UUID) {
-        *(uint64_t*)ptr = worker->uuid;
-        ptr             = UCS_PTR_TYPE_OFFSET(ptr, worker->uuid);
-    }
-
-    if (worker->context->config.ext.address_debug_info) {
-        /* Add debug information to the packed address, and set the corresponding
-         * flag in address header.
-         */
-        *address_header_p |= UCP_ADDRESS_HEADER_FLAG_DEBUG_INFO;
-
-        if (pack_flags & UCP_ADDRESS_PACK_FLAG_WORKER_NAME) {
-            ptr            = ucp_address_pack_worker_name(worker, ptr);
-        }
-    }
+    addr_index    = 0;
+    template_hash = UCP_ADDRESS_TEMPLATE_HASH_INIT;
+    header_flags  = ucp_address_has_template(worker, num_devices) ?
+                    UCP_ADDRESS_HEADER_FLAG_TEMPLATE : 0;
+    ptr           = ucp_address_pack_header(worker, buffer, pack_flags,
+                                            header_flags);
 
     if (num_devices == 0) {
         *((uint8_t*)ptr) = UCP_NULL_RESOURCE;
@@ -644,6 +886,11 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
                          ((dev_tl_bitmap == 0)           ? UCP_ADDRESS_FLAG_MD_EMPTY_DEV : 0) |
                          ((md_flags & UCT_MD_FLAG_ALLOC) ? UCP_ADDRESS_FLAG_MD_ALLOC     : 0) |
                          ((md_flags & UCT_MD_FLAG_REG)   ? UCP_ADDRESS_FLAG_MD_REG       : 0);
+        num_paths      = dev->num_paths;
+        template_hash  = ucp_address_template_hash(template_hash, ptr,
+                                                   sizeof(uint8_t));
+        template_hash  = ucp_address_template_hash(template_hash, &num_paths,
+                                                   sizeof(num_paths));
         ptr = UCS_PTR_TYPE_OFFSET(ptr, md_index);
 
         /* Device address length */
@@ -690,6 +937,8 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
 
             /* Transport name checksum */
             *(uint16_t*)ptr = context->tl_rscs[rsc_index].tl_name_csum;
+            template_hash   = ucp_address_template_hash(template_hash, ptr,
+                                                        sizeof(uint16_t));
             ptr = UCS_PTR_TYPE_OFFSET(ptr,
                                       context->tl_rscs[rsc_index].tl_name_csum);
 
@@ -703,6 +952,10 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
 
             ucp_address_memcheck(context, ptr, attr_len, rsc_index);
 
+            /* The address flags are not set yet */
+            template_hash = ucp_address_template_hash(template_hash, ptr,
+                                                      attr_len);
+
             if (pack_flags & UCP_ADDRESS_PACK_FLAG_IFACE_ADDR) {
                 iface_addr_len = iface_attr->iface_addr_len;
             } else {
@@ -806,6 +1059,10 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
             ucs_assert(addr_index <= UCP_MAX_RESOURCES);
         }
 
+        tl_count      = ucs_popcount(dev_tl_bitmap);
+        template_hash = ucp_address_template_hash(template_hash, &tl_count,
+                                                  sizeof(tl_count));
+
         /* flags_ptr is a valid pointer to the flags set to the last entry
          * during the above loop So, set the LAST flag for the flags_ptr
          * from the last iteration */
@@ -819,72 +1076,400 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
     }
 
 out:
+    if (template_hash_p != NULL) {
+        *template_hash_p = template_hash;
+    }
+
     ucs_assertv(UCS_PTR_BYTE_OFFSET(buffer, size) == ptr,
                 "buffer=%p size=%zu ptr=%p ptr-buffer=%zd",
                 buffer, size, ptr, UCS_PTR_BYTE_DIFF(buffer, ptr));
     return UCS_OK;
 }
 
-ucs_status_t ucp_address_pack(ucp_worker_h worker, ucp_ep_h ep,
-                              uint64_t tl_bitmap, unsigned pack_flags,
-                              const ucp_lane_index_t *lanes2remote,
-                              size_t *size_p, void **buffer_p)
+static ucs_status_t
+ucp_address_do_pack_compact(ucp_worker_h worker, ucp_ep_h ep, void *buffer,
+                            size_t size, unsigned pack_flags,
+                            const ucp_lane_index_t *lanes2remote,
+                            const ucp_address_packed_device_t *devices,
+                            ucp_rsc_index_t num_devices)
 {
-    ucp_address_packed_device_t *devices;
-    ucp_rsc_index_t num_devices;
+    const ucp_address_template_t *tmpl = worker->address_template;
+    ucp_context_h context              = worker->context;
+    const ucp_address_template_entry_t *tentry;
+    const ucp_address_packed_device_t *dev;
+    ucp_lane_index_t lane, remote_lane;
+    ucp_worker_iface_t *wiface;
+    ucp_rsc_index_t rsc_index;
+    uint8_t *iface_flags_ptr;
+    uint8_t *ep_lane_ptr;
+    size_t iface_addr_len;
+    size_t ep_addr_len;
     ucs_status_t status;
-    void *buffer;
-    size_t size;
+    void *ptr;
 
-    if (ep == NULL) {
-        pack_flags &= ~UCP_ADDRESS_PACK_FLAG_EP_ADDR;
+    ptr = ucp_address_pack_header(worker, buffer, pack_flags,
+                                  UCP_ADDRESS_HEADER_FLAG_TEMPLATE |
+                                  UCP_ADDRESS_HEADER_FLAG_COMPACT);
+
+    for (dev = devices; dev < (devices + num_devices); ++dev) {
+        /* Template device index */
+        tentry         = &tmpl->entries[tmpl->rsc_entry[dev->rsc_index]];
+        *(uint8_t*)ptr = tentry->entry.dev_index |
+                         ((dev == (devices + num_devices - 1)) ?
+                          UCP_ADDRESS_FLAG_LAST : 0);
+        ptr            = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+
+        /* Device address */
+        ucs_assert(dev->dev_addr_len <= UCP_ADDRESS_FLAG_LEN_MASK);
+        *(uint8_t*)ptr = dev->dev_addr_len;
+        ptr            = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+        if (pack_flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR) {
+            wiface = ucp_worker_iface(worker, dev->rsc_index);
+            status = uct_iface_get_device_address(wiface->iface,
+                                                  (uct_device_addr_t*)ptr);
+            if (status != UCS_OK) {
+                return status;
+            }
+
+            ucp_address_memcheck(context, ptr, dev->dev_addr_len, dev->rsc_index);
+            ptr = UCS_PTR_BYTE_OFFSET(ptr, dev->dev_addr_len);
+        }
+
+        iface_flags_ptr = NULL;
+        ucs_for_each_bit(rsc_index, dev->tl_bitmap) {
+            wiface = ucp_worker_iface(worker, rsc_index);
+
+            /* Template entry index, instead of the transport attributes */
+            iface_flags_ptr  = ptr;
+            *iface_flags_ptr = tmpl->rsc_entry[rsc_index];
+            ptr              = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+
+            /* Pack iface address */
+            if (pack_flags & UCP_ADDRESS_PACK_FLAG_IFACE_ADDR) {
+                iface_addr_len = wiface->attr.iface_addr_len;
+            } else {
+                iface_addr_len = 0;
+            }
+
+            ucs_assert(iface_addr_len <= UCP_ADDRESS_FLAG_LEN_MASK);
+            *(uint8_t*)ptr = iface_addr_len;
+            ptr            = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+            if (pack_flags & UCP_ADDRESS_PACK_FLAG_IFACE_ADDR) {
+                status = uct_iface_get_address(wiface->iface,
+                                               (uct_iface_addr_t*)ptr);
+                if (status != UCS_OK) {
+                    return status;
+                }
+
+                ucp_address_memcheck(context, ptr, iface_addr_len, rsc_index);
+                ptr = UCS_PTR_BYTE_OFFSET(ptr, iface_addr_len);
+            }
+
+            /* Pack ep addresses of all lanes which use the current resource */
+            ep_lane_ptr = NULL;
+            if (pack_flags & UCP_ADDRESS_PACK_FLAG_EP_ADDR) {
+                ucs_assert(ep != NULL);
+                ep_addr_len = wiface->attr.ep_addr_len;
+                ucs_assert(ep_addr_len <= UCP_ADDRESS_FLAG_LEN_MASK);
+
+                ucs_for_each_bit(lane, ucp_ep_config(ep)->p2p_lanes) {
+                    if (ucp_ep_get_rsc_index(ep, lane) != rsc_index) {
+                        continue;
+                    }
+
+                    *(uint8_t*)ptr = ep_addr_len;
+                    ptr            = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+
+                    status = uct_ep_get_address(ep->uct_eps[lane], ptr);
+                    if (status != UCS_OK) {
+                        return status;
+                    }
+
+                    ucp_address_memcheck(context, ptr, ep_addr_len, rsc_index);
+                    ptr = UCS_PTR_BYTE_OFFSET(ptr, ep_addr_len);
+
+                    remote_lane  = (lanes2remote == NULL) ? lane :
+                                   lanes2remote[lane];
+                    ucs_assertv(remote_lane <= UCP_ADDRESS_FLAG_LEN_MASK,
+                                "remote_lane=%d", remote_lane);
+                    ep_lane_ptr  = ptr;
+                    *ep_lane_ptr = remote_lane;
+                    ptr          = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+                }
+            }
+
+            if (ep_lane_ptr != NULL) {
+                *ep_lane_ptr     |= UCP_ADDRESS_FLAG_LAST;
+                *iface_flags_ptr |= UCP_ADDRESS_FLAG_HAS_EP_ADDR;
+            }
+
+            if (!(pack_flags & UCP_ADDRESS_PACK_FLAG_NO_TRACE)) {
+                ucs_trace("pack compact addr: "UCT_TL_RESOURCE_DESC_FMT
+                          " template entry %d",
+                          UCT_TL_RESOURCE_DESC_ARG(&context->tl_rscs[rsc_index].tl_rsc),
+                          tmpl->rsc_entry[rsc_index]);
+            }
+        }
+
+        ucs_assert(iface_flags_ptr != NULL);
+        *iface_flags_ptr |= UCP_ADDRESS_FLAG_LAST;
     }
 
-    /* Collect all devices we want to pack */
-    status = ucp_address_gather_devices(worker, ep, tl_bitmap, pack_flags,
-                                        &devices, &num_devices);
-    if (status != UCS_OK) {
-        goto out;
+    ucs_assertv(UCS_PTR_BYTE_OFFSET(buffer, size) == ptr,
+                "buffer=%p size=%zu ptr=%p ptr-buffer=%zd",
+                buffer, size, ptr, UCS_PTR_BYTE_DIFF(buffer, ptr));
+    return UCS_OK;
+}
+
+/* Check whether the address can be packed in compact form: the peer must have
+ * the same address template, and all resources must be found in it */
+static int ucp_address_is_compact(ucp_worker_h worker, unsigned pack_flags,
+                                  const ucp_address_packed_device_t *devices,
+                                  ucp_rsc_index_t num_devices)
+{
+    const ucp_address_packed_device_t *dev;
+    ucp_rsc_index_t rsc_index;
+
+    if (!(pack_flags & UCP_ADDRESS_PACK_FLAG_TEMPLATE) ||
+        !ucp_address_has_template(worker, num_devices)) {
+        return 0;
+    }
+
+    for (dev = devices; dev < (devices + num_devices); ++dev) {
+        ucs_for_each_bit(rsc_index, dev->tl_bitmap) {
+            if (worker->address_template->rsc_entry[rsc_index] ==
+                UCP_NULL_RESOURCE) {
+                return 0;
+            }
+        }
     }
 
+    return 1;
+}
+
+static ucs_status_t
+ucp_address_pack_devices(ucp_worker_h worker, ucp_ep_h ep, uint64_t tl_bitmap,
+                         unsigned pack_flags,
+                         const ucp_lane_index_t *lanes2remote,
+                         const ucp_address_packed_device_t *devices,
+                         ucp_rsc_index_t num_devices, uint64_t *template_hash_p,
+                         size_t *size_p, void **buffer_p)
+{
+    ucs_status_t status;
+    void *buffer;
+    size_t size;
+    int compact;
+
+    compact = ucp_address_is_compact(worker, pack_flags, devices, num_devices);
+
     /* Calculate packed size */
-    size = ucp_address_packed_size(worker, devices, num_devices, pack_flags);
+    size = ucp_address_packed_size(worker, devices, num_devices, pack_flags,
+                                   compact);
 
     /* Allocate address */
     buffer = ucs_malloc(size, "ucp_address");
     if (buffer == NULL) {
-        status = UCS_ERR_NO_MEMORY;
-        goto out_free_devices;
+        return UCS_ERR_NO_MEMORY;
     }
 
     memset(buffer, 0, size);
 
     /* Pack the address */
-    status = ucp_address_do_pack(worker, ep, buffer, size, tl_bitmap, pack_flags,
-                                 lanes2remote, devices, num_devices);
+    if (compact) {
+        ucs_assert(template_hash_p == NULL);
+        status = ucp_address_do_pack_compact(worker, ep, buffer, size,
+                                             pack_flags, lanes2remote, devices,
+                                             num_devices);
+    } else {
+        status = ucp_address_do_pack(worker, ep, buffer, size, tl_bitmap,
+                                     pack_flags, lanes2remote, devices,
+                                     num_devices, template_hash_p);
+    }
     if (status != UCS_OK) {
         ucs_free(buffer);
-        goto out_free_devices;
+        return status;
     }
 
     VALGRIND_CHECK_MEM_IS_DEFINED(buffer, size);
 
     *size_p   = size;
     *buffer_p = buffer;
-    status    = UCS_OK;
+    return UCS_OK;
+}
 
-out_free_devices:
+ucs_status_t ucp_address_pack(ucp_worker_h worker, ucp_ep_h ep,
+                              uint64_t tl_bitmap, unsigned pack_flags,
+                              const ucp_lane_index_t *lanes2remote,
+                              size_t *size_p, void **buffer_p)
+{
+    ucp_address_packed_device_t *devices;
+    ucp_rsc_index_t num_devices;
+    ucs_status_t status;
+
+    if (ep == NULL) {
+        pack_flags &= ~UCP_ADDRESS_PACK_FLAG_EP_ADDR;
+    }
+
+    /* Collect all devices we want to pack */
+    status = ucp_address_gather_devices(worker, ep, tl_bitmap, pack_flags,
+                                        &devices, &num_devices);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    status = ucp_address_pack_devices(worker, ep, tl_bitmap, pack_flags,
+                                      lanes2remote, devices, num_devices, NULL,
+                                      size_p, buffer_p);
     ucs_free(devices);
-out:
     return status;
 }
 
-ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
-                                unsigned unpack_flags,
-                                ucp_unpacked_address_t *unpacked_address)
+/* Unpack an address in compact form. The attributes of all entries are taken
+ * from the local address template, which is the same as the remote one. */
+static ucs_status_t
+ucp_address_unpack_compact(ucp_worker_t *worker, const void *ptr,
+                           unsigned unpack_flags,
+                           ucp_unpacked_address_t *unpacked_address)
+{
+    const ucp_address_template_t *tmpl = worker->address_template;
+    ucp_address_entry_t *address_list, *address;
+    ucp_address_entry_ep_addr_t *ep_addr;
+    int last_dev, last_tl, last_ep_addr;
+    const uct_device_addr_t *dev_addr;
+    ucp_rsc_index_t tmpl_dev_index;
+    ucp_rsc_index_t dev_index;
+    unsigned entry_index;
+    size_t dev_addr_len;
+    size_t iface_addr_len;
+    size_t ep_addr_len;
+    uint8_t iface_flags;
+
+    if ((tmpl == NULL) || (unpacked_address->template_hash != tmpl->hash)) {
+        UCS_STATS_UPDATE_COUNTER(worker->stats,
+                                 UCP_WORKER_STAT_ADDRESS_TEMPLATE_MISS, 1);
+        if (!(unpack_flags & UCP_ADDRESS_PACK_FLAG_NO_TRACE)) {
+            ucs_error("failed to unpack address: template 0x%"PRIx64" does "
+                      "not match the local address template",
+                      unpacked_address->template_hash);
+        }
+        return UCS_ERR_UNREACHABLE;
+    }
+
+    /* Every template entry is packed at most once */
+    address_list = ucs_malloc(tmpl->address_count * sizeof(*address_list),
+                              "ucp_address_list");
+    if (address_list == NULL) {
+        ucs_error("failed to allocate address list");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    address   = address_list;
+    dev_index = 0;
+
+    do {
+        /* template device index and device address */
+        tmpl_dev_index = (*(uint8_t*)ptr) & UCP_ADDRESS_FLAG_LEN_MASK;
+        last_dev       = (*(uint8_t*)ptr) & UCP_ADDRESS_FLAG_LAST;
+        ptr            = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+        dev_addr_len   = (*(uint8_t*)ptr) & UCP_ADDRESS_FLAG_LEN_MASK;
+        ptr            = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+        dev_addr       = ptr;
+        ptr            = UCS_PTR_BYTE_OFFSET(ptr, dev_addr_len);
+
+        do {
+            iface_flags = *(uint8_t*)ptr;
+            entry_index = iface_flags & UCP_ADDRESS_FLAG_LEN_MASK;
+            last_tl     = iface_flags & UCP_ADDRESS_FLAG_LAST;
+            ptr         = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+
+            if ((address >= &address_list[tmpl->address_count]) ||
+                (entry_index >= tmpl->address_count) ||
+                (tmpl->entries[entry_index].entry.dev_index != tmpl_dev_index)) {
+                if (!(unpack_flags & UCP_ADDRESS_PACK_FLAG_NO_TRACE)) {
+                    ucs_error("failed to parse address: invalid template "
+                              "entry %u on device %u", entry_index,
+                              tmpl_dev_index);
+                }
+                goto err_free;
+            }
+
+            /* Device indices are numbered as in a full address */
+            *address              = tmpl->entries[entry_index].entry;
+            address->dev_index    = dev_index;
+            address->dev_addr     = (dev_addr_len > 0) ? dev_addr : NULL;
+
+            iface_addr_len        = (*(uint8_t*)ptr) & UCP_ADDRESS_FLAG_LEN_MASK;
+            ptr                   = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+            address->iface_addr   = (iface_addr_len > 0) ? ptr : NULL;
+            ptr                   = UCS_PTR_BYTE_OFFSET(ptr, iface_addr_len);
+
+            last_ep_addr = !(iface_flags & UCP_ADDRESS_FLAG_HAS_EP_ADDR);
+            while (!last_ep_addr) {
+                if (address->num_ep_addrs >= UCP_MAX_LANES) {
+                    if (!(unpack_flags & UCP_ADDRESS_PACK_FLAG_NO_TRACE)) {
+                        ucs_error("failed to parse address: number of ep addresses"
+                                  "exceeds %d", UCP_MAX_LANES);
+                    }
+                    goto err_free;
+                }
+
+                ep_addr       = &address->ep_addrs[address->num_ep_addrs++];
+                ep_addr_len   = (*(uint8_t*)ptr) & UCP_ADDRESS_FLAG_LEN_MASK;
+                ptr           = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+                ep_addr->addr = ptr;
+                ptr           = UCS_PTR_BYTE_OFFSET(ptr, ep_addr_len);
+                ep_addr->lane = *(uint8_t*)ptr & UCP_ADDRESS_FLAG_LEN_MASK;
+                last_ep_addr  = *(uint8_t*)ptr & UCP_ADDRESS_FLAG_LAST;
+                ptr           = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+            }
+
+            if (!(unpack_flags & UCP_ADDRESS_PACK_FLAG_NO_TRACE)) {
+                ucs_trace("unpack compact addr[%d] : template entry %u eps %u",
+                          (int)(address - address_list), entry_index,
+                          address->num_ep_addrs);
+            }
+
+            ++address;
+        } while (!last_tl);
+
+        ++dev_index;
+    } while (!last_dev);
+
+    UCS_STATS_UPDATE_COUNTER(worker->stats,
+                             UCP_WORKER_STAT_ADDRESS_TEMPLATE_HIT, 1);
+
+    unpacked_address->address_count = address - address_list;
+    unpacked_address->address_list  = address_list;
+    return UCS_OK;
+
+err_free:
+    ucs_free(address_list);
+    return UCS_ERR_INVALID_PARAM;
+}
+
+/* Unpack an address in full form. If tmpl_p is not NULL, also build the
+ * address template of the unpacked address. */
+static ucs_status_t
+ucp_address_do_unpack(ucp_worker_t *worker, const void *buffer,
+                      unsigned unpack_flags,
+                      ucp_unpacked_address_t *unpacked_address,
+                      ucp_address_template_t **tmpl_p)
 {
     ucp_address_entry_t *address_list, *address;
     uint8_t address_header, address_version;
+    const ucp_address_template_t *tmpl;
+    const ucp_address_entry_t *tmpl_entry;
+    const void *attr_ptrs[UCP_MAX_RESOURCES];
+    uint8_t md_bytes[UCP_MAX_RESOURCES];
+    uint8_t attr[sizeof(ucp_address_packed_iface_attr_t)];
+    unsigned tmpl_entry_index;
+    uint64_t template_hash;
+    uint16_t tl_name_csum;
+    uint8_t num_paths;
+    uint8_t tl_count;
+    int has_template;
+    int add_template;
+    int tmpl_miss;
     ucp_address_entry_ep_addr_t *ep_addr;
     int last_dev, last_tl, last_ep_addr;
     const uct_device_addr_t *dev_addr;
@@ -905,6 +1490,7 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
     /* Initialize the unpacked address to empty */
     unpacked_address->address_count = 0;
     unpacked_address->address_list  = NULL;
+    unpacked_address->template_hash = 0;
 
     ptr                             = buffer;
     address_header                  = *(const uint8_t *)ptr;
@@ -933,11 +1519,37 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
                          sizeof(unpacked_address->name));
     }
 
+    has_template = address_header & UCP_ADDRESS_HEADER_FLAG_TEMPLATE;
+    if (has_template) {
+        unpacked_address->template_hash = *(uint64_t*)ptr;
+        ptr = UCS_PTR_TYPE_OFFSET(ptr, unpacked_address->template_hash);
+    }
+
+    if (address_header & UCP_ADDRESS_HEADER_FLAG_COMPACT) {
+        return ucp_address_unpack_compact(worker, ptr, unpack_flags,
+                                          unpacked_address);
+    }
+
     /* Empty address list */
     if (*(uint8_t*)ptr == UCP_NULL_RESOURCE) {
         return UCS_OK;
     }
 
+    /* Take the transport attributes from a known template. Otherwise, build
+     * the template of the address, and cache it if the address turns out to
+     * be the full address of its worker. */
+    tmpl         = NULL;
+    add_template = (tmpl_p != NULL);
+    if (has_template) {
+        tmpl         = ucp_address_template_get(worker,
+                                                unpacked_address->template_hash);
+        add_template = (tmpl == NULL) && ucp_address_template_can_add(worker);
+    }
+
+    tmpl_entry_index = 0;
+    tmpl_miss        = (tmpl == NULL);
+    template_hash    = UCP_ADDRESS_TEMPLATE_HASH_INIT;
+
     /* Allocate address list */
     address_list = ucs_calloc(UCP_MAX_RESOURCES, sizeof(*address_list),
                               "ucp_address_list");
@@ -973,6 +1585,15 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
         dev_addr = ptr;
         ptr      = UCS_PTR_BYTE_OFFSET(ptr, dev_addr_len);
 
+        if (add_template) {
+            num_paths     = dev_num_paths;
+            tl_count      = 0;
+            template_hash = ucp_address_template_hash(template_hash, &md_byte,
+                                                      sizeof(md_byte));
+            template_hash = ucp_address_template_hash(template_hash, &num_paths,
+                                                      sizeof(num_paths));
+        }
+
         last_tl = empty_dev;
         while (!last_tl) {
             if (address >= &address_list[UCP_MAX_RESOURCES]) {
@@ -984,19 +1605,47 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
             }
 
             /* tl_name_csum */
-            address->tl_name_csum = *(uint16_t*)ptr;
-            ptr = UCS_PTR_TYPE_OFFSET(ptr, address->tl_name_csum);
-
-            address->dev_addr      = (dev_addr_len > 0) ? dev_addr : NULL;
-            address->md_index      = md_index;
-            address->dev_index     = dev_index;
-            address->md_flags      = md_flags;
-            address->dev_num_paths = dev_num_paths;
+            tl_name_csum = *(uint16_t*)ptr;
+            ptr          = UCS_PTR_TYPE_OFFSET(ptr, tl_name_csum);
+
+            tmpl_entry = (tmpl == NULL) ? NULL :
+                         ucp_address_template_find(worker, tmpl,
+                                                   &tmpl_entry_index, md_byte,
+                                                   dev_num_paths, tl_name_csum,
+                                                   ptr);
+            if (tmpl_entry != NULL) {
+                /* The attributes were already unpacked from the same data */
+                *address = *tmpl_entry;
+                attr_len = ucp_address_iface_attr_size(worker);
+            } else {
+                tmpl_miss              = 1;
+                address->tl_name_csum  = tl_name_csum;
+                address->md_index      = md_index;
+                address->md_flags      = md_flags;
+                address->dev_num_paths = dev_num_paths;
+
+                status = ucp_address_unpack_iface_attr(worker,
+                                                       &address->iface_attr,
+                                                       ptr, unpack_flags,
+                                                       &attr_len);
+                if (status != UCS_OK) {
+                    goto err_free;
+                }
+            }
 
-            status = ucp_address_unpack_iface_attr(worker, &address->iface_attr,
-                                                   ptr, unpack_flags, &attr_len);
-            if (status != UCS_OK) {
-                goto err_free;
+            address->dev_addr  = (dev_addr_len > 0) ? dev_addr : NULL;
+            address->dev_index = dev_index;
+
+            if (add_template) {
+                md_bytes[address - address_list]  = md_byte;
+                attr_ptrs[address - address_list] = ptr;
+                ucp_address_template_attr(worker, attr, ptr);
+                template_hash = ucp_address_template_hash(template_hash,
+                                                          &tl_name_csum,
+                                                          sizeof(tl_name_csum));
+                template_hash = ucp_address_template_hash(template_hash, attr,
+                                                          attr_len);
+                ++tl_count;
             }
 
             flags_ptr = ucp_address_iface_flags_ptr(worker, (void*)ptr, attr_len);
@@ -1058,9 +1707,39 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
             ++address;
         }
 
+        if (add_template) {
+            template_hash = ucp_address_template_hash(template_hash, &tl_count,
+                                                      sizeof(tl_count));
+        }
+
         ++dev_index;
     } while (!last_dev);
 
+    if (has_template && tmpl_miss) {
+        UCS_STATS_UPDATE_COUNTER(worker->stats,
+                                 UCP_WORKER_STAT_ADDRESS_TEMPLATE_MISS, 1);
+    } else if (has_template) {
+        UCS_STATS_UPDATE_COUNTER(worker->stats,
+                                 UCP_WORKER_STAT_ADDRESS_TEMPLATE_HIT, 1);
+    }
+
+    if (tmpl_p != NULL) {
+        *tmpl_p = ucp_address_template_create(worker, template_hash,
+                                              address_list,
+                                              address - address_list, md_bytes,
+                                              attr_ptrs);
+        if (*tmpl_p == NULL) {
+            ucs_error("failed to allocate address template");
+            ucs_free(address_list);
+            return UCS_ERR_NO_MEMORY;
+        }
+    } else if (add_template &&
+               (template_hash == unpacked_address->template_hash)) {
+        /* Full address of a worker with a template which is not known yet */
+        ucp_address_template_add(worker, template_hash, address_list,
+                                 address - address_list, md_bytes, attr_ptrs);
+    }
+
     unpacked_address->address_count = address - address_list;
     unpacked_address->address_list  = address_list;
     return UCS_OK;
@@ -1069,3 +1748,105 @@ err_free:
     ucs_free(address_list);
     return UCS_ERR_INVALID_PARAM;
 }
+
+ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
+                                unsigned unpack_flags,
+                                ucp_unpacked_address_t *unpacked_address)
+{
+    return ucp_address_do_unpack(worker, buffer, unpack_flags,
+                                 unpacked_address, NULL);
+}
+
+int ucp_address_is_local_template(ucp_worker_h worker,
+                                  const ucp_unpacked_address_t *remote_address)
+{
+    return (worker->address_template != NULL) &&
+           (remote_address->template_hash == worker->address_template->hash);
+}
+
+ucs_status_t ucp_address_template_init(ucp_worker_h worker)
+{
+    unsigned pack_flags = UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR |
+                          UCP_ADDRESS_PACK_FLAG_IFACE_ADDR |
+                          UCP_ADDRESS_PACK_FLAG_NO_TRACE;
+    ucp_address_packed_device_t *devices;
+    const ucp_address_packed_device_t *dev;
+    ucp_unpacked_address_t unpacked_address;
+    ucp_address_template_t *tmpl;
+    ucp_rsc_index_t num_devices;
+    ucp_rsc_index_t rsc_index;
+    uint64_t template_hash;
+    unsigned entry_index;
+    ucs_status_t status;
+    size_t size;
+    void *buffer;
+
+    ucs_assert(worker->address_template == NULL);
+
+    if (!worker->context->config.ext.address_template) {
+        return UCS_OK;
+    }
+
+    /* Pack and unpack the full worker address, without worker UUID and name.
+     * Since the worker does not have a template yet, the address is packed
+     * without template hash. */
+    status = ucp_address_gather_devices(worker, NULL, UINT64_MAX, pack_flags,
+                                        &devices, &num_devices);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (num_devices == 0) {
+        goto out_free_devices;
+    }
+
+    status = ucp_address_pack_devices(worker, NULL, UINT64_MAX, pack_flags,
+                                      NULL, devices, num_devices,
+                                      &template_hash, &size, &buffer);
+    if (status != UCS_OK) {
+        goto out_free_devices;
+    }
+
+    status = ucp_address_do_unpack(worker, buffer, pack_flags,
+                                   &unpacked_address, &tmpl);
+    if (status != UCS_OK) {
+        goto out_free_buffer;
+    }
+
+    /* The receiver of the address calculates the same hash */
+    ucs_assertv(tmpl->hash == template_hash, "hash=0x%"PRIx64" expected=0x%"
+                PRIx64, tmpl->hash, template_hash);
+
+    /* Resources are packed in the order of devices */
+    entry_index = 0;
+    for (dev = devices; dev < (devices + num_devices); ++dev) {
+        ucs_for_each_bit(rsc_index, dev->tl_bitmap) {
+            tmpl->rsc_entry[rsc_index] = entry_index++;
+        }
+    }
+    ucs_assert(entry_index == tmpl->address_count);
+
+    ucs_debug("worker %p: address template 0x%"PRIx64" with %u entries",
+              worker, tmpl->hash, tmpl->address_count);
+    worker->address_template = tmpl;
+
+    ucs_free(unpacked_address.address_list);
+out_free_buffer:
+    ucs_free(buffer);
+out_free_devices:
+    ucs_free(devices);
+    return status;
+}
+
+void ucp_address_template_cleanup(ucp_worker_h worker)
+{
+    ucp_address_template_t *tmpl;
+
+    kh_foreach_value(&worker->address_templates, tmpl, {
+        ucs_free(tmpl);
+    })
+    kh_destroy_inplace(ucp_worker_addr_tmpl, &worker->address_templates);
+
+    ucs_free(worker->address_template);
+    worker->address_template = NULL;
+}
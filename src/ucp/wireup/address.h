@@ -54,7 +54,11 @@ enum {
      */
     UCP_ADDRESS_PACK_FLAGS_ALL        = (UCP_ADDRESS_PACK_FLAG_LAST << 1) - 3,
 
-    UCP_ADDRESS_PACK_FLAG_NO_TRACE    = UCS_BIT(16) /* Suppress debug tracing */
+    UCP_ADDRESS_PACK_FLAG_NO_TRACE    = UCS_BIT(16), /* Suppress debug tracing */
+    UCP_ADDRESS_PACK_FLAG_TEMPLATE    = UCS_BIT(17)  /* Pack in compact form if
+                                                        possible, the peer must
+                                                        have the same address
+                                                        template */
 };
 
 
@@ -101,6 +105,8 @@ struct ucp_unpacked_address {
     char                       name[UCP_WORKER_NAME_MAX]; /* Remote worker name */
     unsigned                   address_count;   /* Length of address list */
     ucp_address_entry_t        *address_list;   /* Pointer to address list */
+    uint64_t                   template_hash;   /* Remote address template hash,
+                                                   0 if not packed */
 };
 
 
@@ -165,4 +171,34 @@ ucs_status_t ucp_address_unpack(ucp_worker_h worker, const void *buffer,
                                 ucp_unpacked_address_t *unpacked_address);
 
 
+/**
+ * Check whether a remote worker has the same address template as the local
+ * worker, so addresses can be sent to it in compact form.
+ *
+ * @param [in]  worker           Worker object.
+ * @param [in]  remote_address   Unpacked remote address.
+ *
+ * @return Nonzero if the address templates are the same.
+ */
+int ucp_address_is_local_template(ucp_worker_h worker,
+                                  const ucp_unpacked_address_t *remote_address);
+
+
+/**
+ * Build the address template of a worker, if enabled by configuration.
+ *
+ * @param [in]  worker           Worker object.
+ */
+ucs_status_t ucp_address_template_init(ucp_worker_h worker);
+
+
+/**
+ * Release the address template of a worker, and the templates of remote
+ * addresses cached by it.
+ *
+ * @param [in]  worker           Worker object.
+ */
+void ucp_address_template_cleanup(ucp_worker_h worker);
+
+
 #endif
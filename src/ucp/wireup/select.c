@@ -13,6 +13,7 @@
 #include "wireup_cm.h"
 #include "address.h"
 
+#include <ucs/algorithm/crc.h>
 #include <ucs/algorithm/qsort_r.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/sys/sock.h>
@@ -87,6 +88,46 @@ typedef struct {
     unsigned                  ucp_ep_init_flags;         /* Endpoint init extra flags */
 } ucp_wireup_select_context_t;
 
+
+/**
+ * Remote address entry, as seen by lanes selection. Two remote addresses with
+ * the same signature entries get the same lanes.
+ */
+typedef struct {
+    ucp_address_iface_attr_t  iface_attr;    /* Remote interface attributes */
+    uint64_t                  md_flags;      /* Remote MD flags */
+    uint64_t                  reachable_tls; /* Local TLs which can reach the
+                                                remote address */
+    unsigned                  dev_num_paths; /* Number of paths on the device */
+    uint16_t                  tl_name_csum;  /* Checksum of transport name */
+    ucp_md_index_t            md_index;      /* Remote MD index */
+    ucp_rsc_index_t           dev_index;     /* Remote device index */
+} ucp_wireup_select_sig_entry_t;
+
+
+/**
+ * Parameters of lanes selection which do not depend on the remote address
+ */
+typedef struct {
+    uint64_t                  tl_bitmap;     /* TLs which can be selected */
+    unsigned                  ep_init_flags; /* Endpoint init flags */
+    unsigned                  err_mode;      /* Error handling mode */
+    int                       has_cm_lane;   /* Whether the endpoint has CM lane */
+    unsigned                  address_count; /* Number of remote addresses */
+} ucp_wireup_select_sig_t;
+
+
+/**
+ * Memoized result of lanes selection
+ */
+struct ucp_wireup_select_memo {
+    ucp_ep_config_key_t            key;      /* Selected lanes */
+    unsigned                       addr_indices[UCP_MAX_LANES]; /* Remote address
+                                                                   of every lane */
+    ucp_wireup_select_sig_t        sig;      /* Selection parameters */
+    ucp_wireup_select_sig_entry_t  entries[0]; /* Remote addresses signature */
+};
+
 static const char *ucp_wireup_md_flags[] = {
     [ucs_ilog2(UCT_MD_FLAG_ALLOC)]               = "memory allocation",
     [ucs_ilog2(UCT_MD_FLAG_REG)]                 = "memory registration",
@@ -1239,7 +1280,9 @@ ucp_wireup_add_rma_bw_lanes(const ucp_wireup_select_params_t *select_params,
 
     if (ep_init_flags & UCP_EP_INIT_FLAG_MEM_TYPE) {
         md_reg_flag = 0;
-    } else if (ucp_ep_get_context_features(ep) & UCP_FEATURE_TAG) {
+    } else if (ucp_ep_get_context_features(ep) & (UCP_FEATURE_TAG |
+                                                  UCP_FEATURE_AM  |
+                                                  UCP_FEATURE_STREAM)) {
         /* if needed for RNDV, need only access for remote registered memory */
         md_reg_flag = UCT_MD_FLAG_REG;
     } else {
@@ -1623,10 +1666,11 @@ ucp_wireup_construct_lanes(const ucp_wireup_select_params_t *select_params,
     key->am_bw_lanes[0] = key->am_lane;
 }
 
-ucs_status_t
-ucp_wireup_select_lanes(ucp_ep_h ep, unsigned ep_init_flags, uint64_t tl_bitmap,
-                        const ucp_unpacked_address_t *remote_address,
-                        unsigned *addr_indices, ucp_ep_config_key_t *key)
+static ucs_status_t
+ucp_wireup_select_lanes_search(ucp_ep_h ep, unsigned ep_init_flags,
+                               uint64_t tl_bitmap,
+                               const ucp_unpacked_address_t *remote_address,
+                               unsigned *addr_indices, ucp_ep_config_key_t *key)
 {
     ucp_worker_h worker         = ep->worker;
     uint64_t scalable_tl_bitmap = worker->scalable_tl_bitmap & tl_bitmap;
@@ -1661,6 +1705,188 @@ out:
     return UCS_OK;
 }
 
+/* Fill the signature of lanes selection parameters, and return its checksum */
+static uint32_t
+ucp_wireup_select_sig_init(ucp_ep_h ep, unsigned ep_init_flags,
+                           uint64_t tl_bitmap, const ucp_ep_config_key_t *key,
+                           const ucp_unpacked_address_t *remote_address,
+                           ucp_wireup_select_sig_t *sig,
+                           ucp_wireup_select_sig_entry_t *entries)
+{
+    ucp_context_h context = ep->worker->context;
+    const ucp_address_entry_t *ae;
+    ucp_wireup_select_sig_entry_t *entry;
+    ucp_rsc_index_t rsc_index;
+    uint32_t checksum;
+
+    /* zero the padding, since the signature is compared as memory */
+    memset(sig, 0, sizeof(*sig));
+    memset(entries, 0, remote_address->address_count * sizeof(*entries));
+
+    sig->tl_bitmap     = tl_bitmap & context->tl_bitmap;
+    sig->ep_init_flags = ep_init_flags;
+    sig->err_mode      = key->err_mode;
+    sig->has_cm_lane   = ucp_ep_has_cm_lane(ep);
+    sig->address_count = remote_address->address_count;
+
+    entry = entries;
+    ucp_unpacked_address_for_each(ae, remote_address) {
+        entry->iface_attr.cap_flags   = ae->iface_attr.cap_flags;
+        entry->iface_attr.event_flags = ae->iface_attr.event_flags;
+        entry->iface_attr.overhead    = ae->iface_attr.overhead;
+        entry->iface_attr.bandwidth   = ae->iface_attr.bandwidth;
+        entry->iface_attr.priority    = ae->iface_attr.priority;
+        entry->iface_attr.lat_ovh     = ae->iface_attr.lat_ovh;
+        entry->iface_attr.atomic      = ae->iface_attr.atomic;
+        entry->md_flags               = ae->md_flags;
+        entry->dev_num_paths          = ae->dev_num_paths;
+        entry->tl_name_csum           = ae->tl_name_csum;
+        entry->md_index               = ae->md_index;
+        entry->dev_index              = ae->dev_index;
+
+        /* device and interface addresses affect the selection only by
+         * reachability */
+        ucs_for_each_bit(rsc_index, sig->tl_bitmap) {
+            if (ucp_wireup_is_reachable(ep, rsc_index, ae)) {
+                entry->reachable_tls |= UCS_BIT(rsc_index);
+            }
+        }
+
+        ++entry;
+    }
+
+    checksum = ucs_crc32(0, sig, sizeof(*sig));
+    return ucs_crc32(checksum, entries,
+                     remote_address->address_count * sizeof(*entries));
+}
+
+static ucp_wireup_select_memo_t *
+ucp_wireup_select_memo_get(ucp_worker_h worker, uint32_t checksum,
+                           const ucp_wireup_select_sig_t *sig,
+                           const ucp_wireup_select_sig_entry_t *entries)
+{
+    ucp_wireup_select_memo_t *memo = NULL;
+    khiter_t iter;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    iter = kh_get(ucp_worker_select_memo, &worker->select_memo, checksum);
+    if (iter != kh_end(&worker->select_memo)) {
+        memo = kh_val(&worker->select_memo, iter);
+        if (memcmp(&memo->sig, sig, sizeof(*sig)) ||
+            memcmp(memo->entries, entries,
+                   sig->address_count * sizeof(*entries))) {
+            /* checksum collision */
+            memo = NULL;
+        }
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+
+    return memo;
+}
+
+static void
+ucp_wireup_select_memo_add(ucp_worker_h worker, uint32_t checksum,
+                           const ucp_wireup_select_sig_t *sig,
+                           const ucp_wireup_select_sig_entry_t *entries,
+                           const ucp_ep_config_key_t *key,
+                           const unsigned *addr_indices)
+{
+    ucp_wireup_select_memo_t *memo;
+    khiter_t iter;
+    int ret;
+
+    if (kh_size(&worker->select_memo) >=
+        worker->context->config.ext.lane_select_cache_size) {
+        return;
+    }
+
+    memo = ucs_malloc(sizeof(*memo) + (sig->address_count * sizeof(*entries)),
+                      "ucp_wireup_select_memo");
+    if (memo == NULL) {
+        ucs_debug("failed to allocate lane selection memo");
+        return;
+    }
+
+    memo->key = *key;
+    memo->sig = *sig;
+    memcpy(memo->addr_indices, addr_indices,
+           key->num_lanes * sizeof(*addr_indices));
+    memcpy(memo->entries, entries, sig->address_count * sizeof(*entries));
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    iter = kh_put(ucp_worker_select_memo, &worker->select_memo, checksum, &ret);
+    if ((ret == UCS_KH_PUT_FAILED) || (ret == UCS_KH_PUT_KEY_PRESENT)) {
+        ucs_free(memo);
+    } else {
+        kh_val(&worker->select_memo, iter) = memo;
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+}
+
+void ucp_wireup_select_memo_cleanup(ucp_worker_h worker)
+{
+    ucp_wireup_select_memo_t *memo;
+
+    kh_foreach_value(&worker->select_memo, memo, {
+        ucs_free(memo);
+    })
+
+    kh_destroy_inplace(ucp_worker_select_memo, &worker->select_memo);
+}
+
+ucs_status_t
+ucp_wireup_select_lanes(ucp_ep_h ep, unsigned ep_init_flags, uint64_t tl_bitmap,
+                        const ucp_unpacked_address_t *remote_address,
+                        unsigned *addr_indices, ucp_ep_config_key_t *key)
+{
+    ucp_worker_h worker                        = ep->worker;
+    ucp_wireup_select_sig_entry_t *sig_entries = NULL;
+    uint32_t checksum                          = 0;
+    ucs_time_t UCS_V_UNUSED start_time;
+    ucp_wireup_select_memo_t *memo;
+    ucp_wireup_select_sig_t sig;
+    ucs_status_t status;
+
+    UCS_STATS_START_TIME(start_time);
+
+    /* Peers with identical transports, device attributes and reachability get
+     * the same lanes, so the scoring is done once for all of them */
+    if (worker->context->config.ext.lane_select_cache_size > 0) {
+        sig_entries = ucs_alloca(remote_address->address_count *
+                                 sizeof(*sig_entries));
+        checksum    = ucp_wireup_select_sig_init(ep, ep_init_flags, tl_bitmap,
+                                                 key, remote_address, &sig,
+                                                 sig_entries);
+        memo        = ucp_wireup_select_memo_get(worker, checksum, &sig,
+                                                 sig_entries);
+        if (memo != NULL) {
+            *key = memo->key;
+            memcpy(addr_indices, memo->addr_indices,
+                   key->num_lanes * sizeof(*addr_indices));
+            UCS_STATS_UPDATE_COUNTER(worker->stats,
+                                     UCP_WORKER_STAT_LANE_SELECT_HIT, 1);
+            goto out;
+        }
+    }
+
+    status = ucp_wireup_select_lanes_search(ep, ep_init_flags, tl_bitmap,
+                                            remote_address, addr_indices, key);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    UCS_STATS_UPDATE_COUNTER(worker->stats, UCP_WORKER_STAT_LANE_SELECT_MISS, 1);
+    if (sig_entries != NULL) {
+        ucp_wireup_select_memo_add(worker, checksum, &sig, sig_entries, key,
+                                   addr_indices);
+    }
+
+out:
+    UCS_STATS_UPDATE_TIME(worker->stats, UCP_WORKER_STAT_LANE_SELECT_NSEC,
+                          start_time);
+    return UCS_OK;
+}
+
 static double ucp_wireup_aux_score_func(ucp_context_h context,
                                         const uct_md_attr_t *md_attr,
                                         const uct_iface_attr_t *iface_attr,
@@ -150,6 +150,7 @@ ucp_wireup_msg_send(ucp_ep_h ep, uint8_t type, uint64_t tl_bitmap,
                     const ucp_lane_index_t *lanes2remote)
 {
     ucp_request_t* req;
+    unsigned pack_flags;
     ucs_status_t status;
     void *address;
 
@@ -179,11 +180,17 @@ ucp_wireup_msg_send(ucp_ep_h ep, uint8_t type, uint64_t tl_bitmap,
     req->send.datatype           = ucp_dt_make_contig(1);
     ucp_request_send_state_init(req, ucp_dt_make_contig(1), 0);
 
-    /* pack all addresses */
+    /* pack all addresses, in compact form if the peer has the same address
+     * template */
+    pack_flags = UCP_ADDRESS_PACK_FLAGS_ALL;
+    if (ep->flags & UCP_EP_FLAG_ADDR_TEMPLATE) {
+        pack_flags |= UCP_ADDRESS_PACK_FLAG_TEMPLATE;
+    }
+
     status = ucp_address_pack(ep->worker,
                               ucp_wireup_is_ep_needed(ep) ? ep : NULL,
-                              tl_bitmap, UCP_ADDRESS_PACK_FLAGS_ALL,
-                              lanes2remote, &req->send.length, &address);
+                              tl_bitmap, pack_flags, lanes2remote,
+                              &req->send.length, &address);
     if (status != UCS_OK) {
         ucs_free(req);
         ucs_error("failed to pack address: %s", ucs_status_string(status));
@@ -192,7 +199,7 @@ ucp_wireup_msg_send(ucp_ep_h ep, uint8_t type, uint64_t tl_bitmap,
 
     req->send.buffer = address;
 
-    ucp_request_send(req, 0);
+    ucp_request_send(req, UCT_CB_FLAG_PRIO_HIGH);
     return UCS_OK;
 }
 
@@ -1020,6 +1027,10 @@ ucs_status_t ucp_wireup_init_lanes(ucp_ep_h ep, unsigned ep_init_flags,
         return status;
     }
 
+    if (ucp_address_is_local_template(worker, remote_address)) {
+        ep->flags |= UCP_EP_FLAG_ADDR_TEMPLATE;
+    }
+
     /* Get all reachable MDs from full remote address list and join with
      * current ep configuration
      */
@@ -1209,7 +1220,7 @@ ucs_status_t ucp_wireup_connect_remote(ucp_ep_h ep, ucp_lane_index_t lane)
         status = uct_ep_pending_add(ep->uct_eps[lane], &req->send.uct,
                                     (req->send.uct.func == ucp_wireup_msg_progress) ||
                                     (req->send.uct.func == ucp_wireup_ep_progress_pending) ?
-                                    UCT_CB_FLAG_ASYNC : 0);
+                                    (UCT_CB_FLAG_ASYNC | UCT_CB_FLAG_PRIO_HIGH) : 0);
         if (status != UCS_OK) {
             ucs_fatal("wireup proxy function must always return UCS_OK");
         }
@@ -125,6 +125,13 @@ ucp_wireup_select_lanes(ucp_ep_h ep, unsigned ep_init_flags, uint64_t tl_bitmap,
                         const ucp_unpacked_address_t *remote_address,
                         unsigned *addr_indices, ucp_ep_config_key_t *key);
 
+/**
+ * Release the lane selection results memoized by a worker.
+ *
+ * @param [in]  worker       Worker to release the memoized results of.
+ */
+void ucp_wireup_select_memo_cleanup(ucp_worker_h worker);
+
 ucs_status_t ucp_signaling_ep_create(ucp_ep_h ucp_ep, uct_ep_h uct_ep,
                                      int is_owner, uct_ep_h *signaling_ep);
 
@@ -191,7 +191,8 @@ static ucs_status_t ucp_wireup_ep_pending_add(uct_ep_h uct_ep,
         proxy_req->send.state.uct_comp.func = NULL;
 
         status = uct_ep_pending_add(wireup_msg_ep, &proxy_req->send.uct,
-                                    UCT_CB_FLAG_ASYNC);
+                                    UCT_CB_FLAG_ASYNC |
+                                    (flags & UCT_CB_FLAG_PRIO_HIGH));
         if (status == UCS_OK) {
             ucs_atomic_add32(&wireup_ep->pending_count, +1);
         } else {
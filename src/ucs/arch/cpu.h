@@ -49,7 +49,9 @@ typedef enum ucs_cpu_flag {
     UCS_CPU_FLAG_SSE42      = UCS_BIT(8),
     UCS_CPU_FLAG_AVX        = UCS_BIT(9),
     UCS_CPU_FLAG_AVX2       = UCS_BIT(10),
-    UCS_CPU_FLAG_CLWB       = UCS_BIT(11)
+    UCS_CPU_FLAG_CLWB       = UCS_BIT(11),
+    UCS_CPU_FLAG_ERMS       = UCS_BIT(12),
+    UCS_CPU_FLAG_AVX512F    = UCS_BIT(13)
 } ucs_cpu_flag_t;
 
 
@@ -0,0 +1,462 @@
+/**
+* Copyright (C) Huawei Technologies Co., Ltd. 2021.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "memcpy.h"
+
+#include <ucs/arch/cpu.h>
+#include <ucs/config/global_opts.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/math.h>
+#include <ucs/sys/string.h>
+#include <ucs/time/time.h>
+#include <ucs/type/init_once.h>
+
+#if defined(__x86_64__)
+#  include <immintrin.h>
+#elif defined(__aarch64__)
+#  include <arm_neon.h>
+#endif
+
+
+/* Buffer length used to calibrate temporal kernels, fits in L2 cache */
+#define UCS_MEMCPY_CALIB_LEN          (64 * UCS_KBYTE)
+
+/* Buffer length used to calibrate non-temporal kernels */
+#define UCS_MEMCPY_CALIB_NT_LEN       (4 * UCS_MBYTE)
+
+/* Total amount of data to copy when calibrating a single kernel */
+#define UCS_MEMCPY_CALIB_TOTAL        (16 * UCS_MBYTE)
+
+/* Default non-temporal threshold if the last level cache size is unknown */
+#define UCS_MEMCPY_NT_THRESH_DEFAULT  (8 * UCS_MBYTE)
+
+
+static void ucs_memcpy_resolve_temporal(void *dst, const void *src, size_t len);
+static void ucs_memcpy_resolve_nontemporal(void *dst, const void *src,
+                                           size_t len);
+
+
+ucs_memcpy_dispatch_t ucs_memcpy_dispatch = {
+    .temporal    = ucs_memcpy_resolve_temporal,
+    .nontemporal = ucs_memcpy_resolve_nontemporal,
+    .nt_thresh   = SIZE_MAX
+};
+
+static struct {
+    ucs_init_once_t           init_once;
+    const ucs_memcpy_kernel_t *temporal;
+    const ucs_memcpy_kernel_t *nontemporal;
+} ucs_memcpy_selection = {
+    .init_once = UCS_INIT_ONCE_INITIALIZER
+};
+
+
+static void ucs_memcpy_libc(void *dst, const void *src, size_t len)
+{
+    memcpy(dst, src, len);
+}
+
+#if defined(__x86_64__)
+
+static void ucs_memcpy_x86_erms(void *dst, const void *src, size_t len)
+{
+    asm volatile ("rep movsb"
+                  : "+D" (dst), "+S" (src), "+c" (len)
+                  :
+                  : "memory");
+}
+
+static void __attribute__((target("avx2")))
+ucs_memcpy_x86_avx2(void *dst, const void *src, size_t len)
+{
+    __m256i r0, r1, r2, r3;
+
+    for (; len >= 128; len -= 128) {
+        r0 = _mm256_loadu_si256((const __m256i*)src + 0);
+        r1 = _mm256_loadu_si256((const __m256i*)src + 1);
+        r2 = _mm256_loadu_si256((const __m256i*)src + 2);
+        r3 = _mm256_loadu_si256((const __m256i*)src + 3);
+        _mm256_storeu_si256((__m256i*)dst + 0, r0);
+        _mm256_storeu_si256((__m256i*)dst + 1, r1);
+        _mm256_storeu_si256((__m256i*)dst + 2, r2);
+        _mm256_storeu_si256((__m256i*)dst + 3, r3);
+        src = UCS_PTR_BYTE_OFFSET(src, 128);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 128);
+    }
+
+    for (; len >= 32; len -= 32) {
+        _mm256_storeu_si256((__m256i*)dst,
+                            _mm256_loadu_si256((const __m256i*)src));
+        src = UCS_PTR_BYTE_OFFSET(src, 32);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 32);
+    }
+
+    memcpy(dst, src, len);
+}
+
+static void __attribute__((target("avx2")))
+ucs_memcpy_x86_avx2_nt(void *dst, const void *src, size_t len)
+{
+    size_t head = (-(uintptr_t)dst) & 31;
+    __m256i r0, r1, r2, r3;
+
+    if (len < (head + 128)) {
+        memcpy(dst, src, len);
+        return;
+    }
+
+    /* streaming stores require an aligned destination */
+    memcpy(dst, src, head);
+    src  = UCS_PTR_BYTE_OFFSET(src, head);
+    dst  = UCS_PTR_BYTE_OFFSET(dst, head);
+    len -= head;
+
+    for (; len >= 128; len -= 128) {
+        r0 = _mm256_loadu_si256((const __m256i*)src + 0);
+        r1 = _mm256_loadu_si256((const __m256i*)src + 1);
+        r2 = _mm256_loadu_si256((const __m256i*)src + 2);
+        r3 = _mm256_loadu_si256((const __m256i*)src + 3);
+        _mm256_stream_si256((__m256i*)dst + 0, r0);
+        _mm256_stream_si256((__m256i*)dst + 1, r1);
+        _mm256_stream_si256((__m256i*)dst + 2, r2);
+        _mm256_stream_si256((__m256i*)dst + 3, r3);
+        src = UCS_PTR_BYTE_OFFSET(src, 128);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 128);
+    }
+
+    for (; len >= 32; len -= 32) {
+        _mm256_stream_si256((__m256i*)dst,
+                            _mm256_loadu_si256((const __m256i*)src));
+        src = UCS_PTR_BYTE_OFFSET(src, 32);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 32);
+    }
+
+    /* order the streaming stores with respect to following stores */
+    _mm_sfence();
+    memcpy(dst, src, len);
+}
+
+static void __attribute__((target("avx512f")))
+ucs_memcpy_x86_avx512(void *dst, const void *src, size_t len)
+{
+    __m512i r0, r1, r2, r3;
+
+    for (; len >= 256; len -= 256) {
+        r0 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 0));
+        r1 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 64));
+        r2 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 128));
+        r3 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 192));
+        _mm512_storeu_si512(UCS_PTR_BYTE_OFFSET(dst, 0), r0);
+        _mm512_storeu_si512(UCS_PTR_BYTE_OFFSET(dst, 64), r1);
+        _mm512_storeu_si512(UCS_PTR_BYTE_OFFSET(dst, 128), r2);
+        _mm512_storeu_si512(UCS_PTR_BYTE_OFFSET(dst, 192), r3);
+        src = UCS_PTR_BYTE_OFFSET(src, 256);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 256);
+    }
+
+    for (; len >= 64; len -= 64) {
+        _mm512_storeu_si512(dst, _mm512_loadu_si512(src));
+        src = UCS_PTR_BYTE_OFFSET(src, 64);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 64);
+    }
+
+    memcpy(dst, src, len);
+}
+
+static void __attribute__((target("avx512f")))
+ucs_memcpy_x86_avx512_nt(void *dst, const void *src, size_t len)
+{
+    size_t head = (-(uintptr_t)dst) & 63;
+    __m512i r0, r1, r2, r3;
+
+    if (len < (head + 256)) {
+        memcpy(dst, src, len);
+        return;
+    }
+
+    memcpy(dst, src, head);
+    src  = UCS_PTR_BYTE_OFFSET(src, head);
+    dst  = UCS_PTR_BYTE_OFFSET(dst, head);
+    len -= head;
+
+    for (; len >= 256; len -= 256) {
+        r0 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 0));
+        r1 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 64));
+        r2 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 128));
+        r3 = _mm512_loadu_si512(UCS_PTR_BYTE_OFFSET(src, 192));
+        _mm512_stream_si512(UCS_PTR_BYTE_OFFSET(dst, 0), r0);
+        _mm512_stream_si512(UCS_PTR_BYTE_OFFSET(dst, 64), r1);
+        _mm512_stream_si512(UCS_PTR_BYTE_OFFSET(dst, 128), r2);
+        _mm512_stream_si512(UCS_PTR_BYTE_OFFSET(dst, 192), r3);
+        src = UCS_PTR_BYTE_OFFSET(src, 256);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 256);
+    }
+
+    for (; len >= 64; len -= 64) {
+        _mm512_stream_si512(dst, _mm512_loadu_si512(src));
+        src = UCS_PTR_BYTE_OFFSET(src, 64);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 64);
+    }
+
+    _mm_sfence();
+    memcpy(dst, src, len);
+}
+
+static const ucs_memcpy_kernel_t ucs_memcpy_kernels_table[] = {
+    {"libc",      ucs_memcpy_libc,          0, 0},
+    {"erms",      ucs_memcpy_x86_erms,      0, UCS_CPU_FLAG_ERMS},
+    {"avx2",      ucs_memcpy_x86_avx2,      0, UCS_CPU_FLAG_AVX2},
+    {"avx512",    ucs_memcpy_x86_avx512,    0, UCS_CPU_FLAG_AVX512F},
+    {"avx2_nt",   ucs_memcpy_x86_avx2_nt,   1, UCS_CPU_FLAG_AVX2},
+    {"avx512_nt", ucs_memcpy_x86_avx512_nt, 1, UCS_CPU_FLAG_AVX512F}
+};
+
+#elif defined(__aarch64__)
+
+static void ucs_memcpy_aarch64_neon(void *dst, const void *src, size_t len)
+{
+    uint8x16_t r0, r1, r2, r3;
+
+    for (; len >= 64; len -= 64) {
+        r0 = vld1q_u8(UCS_PTR_BYTE_OFFSET(src, 0));
+        r1 = vld1q_u8(UCS_PTR_BYTE_OFFSET(src, 16));
+        r2 = vld1q_u8(UCS_PTR_BYTE_OFFSET(src, 32));
+        r3 = vld1q_u8(UCS_PTR_BYTE_OFFSET(src, 48));
+        vst1q_u8(UCS_PTR_BYTE_OFFSET(dst, 0), r0);
+        vst1q_u8(UCS_PTR_BYTE_OFFSET(dst, 16), r1);
+        vst1q_u8(UCS_PTR_BYTE_OFFSET(dst, 32), r2);
+        vst1q_u8(UCS_PTR_BYTE_OFFSET(dst, 48), r3);
+        src = UCS_PTR_BYTE_OFFSET(src, 64);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 64);
+    }
+
+    memcpy(dst, src, len);
+}
+
+static void ucs_memcpy_aarch64_neon_nt(void *dst, const void *src, size_t len)
+{
+    for (; len >= 64; len -= 64) {
+        /* store pairs with a non-temporal hint */
+        asm volatile ("ldp q0, q1, [%0]\n\t"
+                      "ldp q2, q3, [%0, #32]\n\t"
+                      "stnp q0, q1, [%1]\n\t"
+                      "stnp q2, q3, [%1, #32]"
+                      :
+                      : "r" (src), "r" (dst)
+                      : "v0", "v1", "v2", "v3", "memory");
+        src = UCS_PTR_BYTE_OFFSET(src, 64);
+        dst = UCS_PTR_BYTE_OFFSET(dst, 64);
+    }
+
+    ucs_memory_cpu_store_fence();
+    memcpy(dst, src, len);
+}
+
+#if defined(HAVE_AARCH64_THUNDERX2)
+static void ucs_memcpy_aarch64_thunderx2(void *dst, const void *src, size_t len)
+{
+    __memcpy_thunderx2(dst, src, len);
+}
+#endif
+
+static const ucs_memcpy_kernel_t ucs_memcpy_kernels_table[] = {
+    {"libc",      ucs_memcpy_libc,              0, 0},
+    {"neon",      ucs_memcpy_aarch64_neon,      0, 0},
+#if defined(HAVE_AARCH64_THUNDERX2)
+    {"thunderx2", ucs_memcpy_aarch64_thunderx2, 0, 0},
+#endif
+    {"neon_nt",   ucs_memcpy_aarch64_neon_nt,   1, 0}
+};
+
+#else
+
+static const ucs_memcpy_kernel_t ucs_memcpy_kernels_table[] = {
+    {"libc", ucs_memcpy_libc, 0, 0}
+};
+
+#endif
+
+const ucs_memcpy_kernel_t *ucs_memcpy_kernels(unsigned *count_p)
+{
+    *count_p = ucs_static_array_size(ucs_memcpy_kernels_table);
+    return ucs_memcpy_kernels_table;
+}
+
+int ucs_memcpy_kernel_is_supported(const ucs_memcpy_kernel_t *kernel)
+{
+    return (kernel->cpu_flags == 0) ||
+           ucs_test_all_flags((unsigned)ucs_arch_get_cpu_flag(),
+                              kernel->cpu_flags);
+}
+
+static double ucs_memcpy_measure(const ucs_memcpy_kernel_t *kernel, void *dst,
+                                 const void *src, size_t len)
+{
+    unsigned iters = ucs_max(UCS_MEMCPY_CALIB_TOTAL / len, 1);
+    ucs_time_t start_time, end_time;
+    unsigned i;
+
+    kernel->func(dst, src, len); /* warmup */
+
+    start_time = ucs_get_time();
+    for (i = 0; i < iters; ++i) {
+        kernel->func(dst, src, len);
+    }
+    end_time = ucs_get_time();
+
+    return (len * iters) / ucs_max(ucs_time_to_sec(end_time - start_time),
+                                   1e-9);
+}
+
+static const ucs_memcpy_kernel_t *
+ucs_memcpy_find_kernel(int nontemporal, const char *name)
+{
+    const ucs_memcpy_kernel_t *kernel;
+
+    for (kernel = ucs_memcpy_kernels_table;
+         kernel < (ucs_memcpy_kernels_table +
+                   ucs_static_array_size(ucs_memcpy_kernels_table));
+         ++kernel) {
+        if ((kernel->nontemporal == nontemporal) &&
+            ucs_memcpy_kernel_is_supported(kernel) &&
+            ((name == NULL) || !strcmp(kernel->name, name))) {
+            return kernel;
+        }
+    }
+
+    return NULL;
+}
+
+/* Select the kernel requested by the user, or the fastest one of its kind */
+static const ucs_memcpy_kernel_t *
+ucs_memcpy_select_kernel(int nontemporal, void *dst, const void *src,
+                         size_t len, const ucs_memcpy_kernel_t *reference)
+{
+    const ucs_memcpy_kernel_t *best = reference;
+    double best_bw                  = 0;
+    const ucs_memcpy_kernel_t *kernel;
+    unsigned i;
+    double bw;
+
+    for (i = 0; i < ucs_global_opts.memcpy_kernels.count; ++i) {
+        kernel = ucs_memcpy_find_kernel(nontemporal,
+                                        ucs_global_opts.memcpy_kernels.names[i]);
+        if (kernel != NULL) {
+            return kernel;
+        }
+    }
+
+    if (reference != NULL) {
+        best_bw = ucs_memcpy_measure(reference, dst, src, len);
+    }
+
+    for (kernel = ucs_memcpy_kernels_table;
+         kernel < (ucs_memcpy_kernels_table +
+                   ucs_static_array_size(ucs_memcpy_kernels_table));
+         ++kernel) {
+        if ((kernel->nontemporal != nontemporal) ||
+            !ucs_memcpy_kernel_is_supported(kernel)) {
+            continue;
+        }
+
+        bw = ucs_memcpy_measure(kernel, dst, src, len);
+        ucs_trace("memcpy kernel '%s': %zu bytes %.2f GB/s", kernel->name,
+                  len, bw / UCS_GBYTE);
+        if (bw > best_bw) {
+            best    = kernel;
+            best_bw = bw;
+        }
+    }
+
+    return best;
+}
+
+static size_t ucs_memcpy_nt_thresh()
+{
+    size_t llc_size;
+
+    if (ucs_global_opts.memcpy_nt_thresh != UCS_MEMUNITS_AUTO) {
+        return ucs_global_opts.memcpy_nt_thresh;
+    }
+
+    /* a copy larger than half of the last level cache evicts the working set
+     * of the application */
+    llc_size = ucs_cpu_get_cache_size(UCS_CPU_CACHE_L3);
+    if (llc_size == 0) {
+        llc_size = ucs_cpu_get_cache_size(UCS_CPU_CACHE_L2);
+    }
+
+    return (llc_size == 0) ? UCS_MEMCPY_NT_THRESH_DEFAULT : (llc_size / 2);
+}
+
+void ucs_memcpy_select()
+{
+    const ucs_memcpy_kernel_t *temporal, *nontemporal;
+    size_t nt_thresh;
+    void *buffer;
+
+    UCS_INIT_ONCE(&ucs_memcpy_selection.init_once) {
+        nt_thresh = ucs_max(ucs_memcpy_nt_thresh(), UCS_MEMCPY_BULK_MIN_LEN);
+        buffer    = ucs_malloc(2 * UCS_MEMCPY_CALIB_NT_LEN, "memcpy_calib");
+        if (buffer == NULL) {
+            ucs_warn("failed to allocate memcpy calibration buffer, using "
+                     "libc memcpy");
+            temporal    = ucs_memcpy_find_kernel(0, "libc");
+            nontemporal = temporal;
+        } else {
+            memset(buffer, 0, 2 * UCS_MEMCPY_CALIB_NT_LEN);
+            temporal    = ucs_memcpy_select_kernel(
+                                0, buffer,
+                                UCS_PTR_BYTE_OFFSET(buffer,
+                                                    UCS_MEMCPY_CALIB_NT_LEN),
+                                UCS_MEMCPY_CALIB_LEN, NULL);
+            /* use a non-temporal kernel only if it's faster than the
+             * temporal one for large copies */
+            nontemporal = (nt_thresh == UCS_MEMUNITS_INF) ? temporal :
+                          ucs_memcpy_select_kernel(
+                                1, buffer,
+                                UCS_PTR_BYTE_OFFSET(buffer,
+                                                    UCS_MEMCPY_CALIB_NT_LEN),
+                                UCS_MEMCPY_CALIB_NT_LEN, temporal);
+            ucs_free(buffer);
+        }
+
+        ucs_memcpy_selection.temporal    = temporal;
+        ucs_memcpy_selection.nontemporal = nontemporal;
+        ucs_memcpy_dispatch.temporal     = temporal->func;
+        ucs_memcpy_dispatch.nontemporal  = nontemporal->func;
+        ucs_memory_cpu_store_fence();
+        ucs_memcpy_dispatch.nt_thresh    = nt_thresh;
+
+        ucs_debug("memcpy kernel: '%s', non-temporal: '%s' from %zu bytes",
+                  temporal->name, nontemporal->name, nt_thresh);
+    }
+}
+
+const ucs_memcpy_kernel_t *ucs_memcpy_selected(int nontemporal)
+{
+    ucs_memcpy_select();
+    return nontemporal ? ucs_memcpy_selection.nontemporal :
+                         ucs_memcpy_selection.temporal;
+}
+
+static void ucs_memcpy_resolve_temporal(void *dst, const void *src, size_t len)
+{
+    ucs_memcpy_select();
+    ucs_memcpy_selection.temporal->func(dst, src, len);
+}
+
+static void ucs_memcpy_resolve_nontemporal(void *dst, const void *src,
+                                           size_t len)
+{
+    ucs_memcpy_select();
+    ucs_memcpy_selection.nontemporal->func(dst, src, len);
+}
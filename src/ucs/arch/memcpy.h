@@ -0,0 +1,105 @@
+/**
+* Copyright (C) Huawei Technologies Co., Ltd. 2021.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifndef UCS_ARCH_MEMCPY_H_
+#define UCS_ARCH_MEMCPY_H_
+
+#include <ucs/sys/compiler_def.h>
+#include <stddef.h>
+#include <string.h>
+
+BEGIN_C_DECLS
+
+/** @file memcpy.h */
+
+/* Copies shorter than this are always done by libc memcpy */
+#define UCS_MEMCPY_BULK_MIN_LEN  1024
+
+
+typedef void (*ucs_memcpy_func_t)(void *dst, const void *src, size_t len);
+
+
+/**
+ * Memory copy kernel.
+ */
+typedef struct ucs_memcpy_kernel {
+    const char        *name;        /* Kernel name, for config and reports */
+    ucs_memcpy_func_t func;         /* Copy function */
+    int               nontemporal;  /* Whether the kernel bypasses the cache
+                                       on store */
+    unsigned          cpu_flags;    /* Required CPU flags (ucs_cpu_flag_t) */
+} ucs_memcpy_kernel_t;
+
+
+/**
+ * Currently selected copy kernels. Until @ref ucs_memcpy_select is called,
+ * points to functions which select the kernels upon first use.
+ */
+typedef struct ucs_memcpy_dispatch {
+    ucs_memcpy_func_t temporal;     /* Kernel for copies below nt_thresh */
+    ucs_memcpy_func_t nontemporal;  /* Kernel for copies from nt_thresh */
+    size_t            nt_thresh;    /* Threshold for non-temporal copy */
+} ucs_memcpy_dispatch_t;
+
+
+extern ucs_memcpy_dispatch_t ucs_memcpy_dispatch;
+
+
+/**
+ * Get the table of copy kernels built for this architecture.
+ *
+ * @param [out] count_p  Filled with the number of entries in the table.
+ *
+ * @return Array of copy kernels, including unsupported ones.
+ */
+const ucs_memcpy_kernel_t *ucs_memcpy_kernels(unsigned *count_p);
+
+
+/**
+ * @return Whether the copy kernel can run on this CPU.
+ */
+int ucs_memcpy_kernel_is_supported(const ucs_memcpy_kernel_t *kernel);
+
+
+/**
+ * Select the copy kernels according to UCX_MEMCPY_KERNELS and
+ * UCX_MEMCPY_NT_THRESH, calibrating the ones which were not set. Should be
+ * called during initialization by components which use @ref ucs_memcpy_bulk,
+ * so the calibration does not run on the data path; otherwise it is called by
+ * the first bulk copy. Safe to call more than once.
+ */
+void ucs_memcpy_select();
+
+
+/**
+ * Get the selected copy kernel.
+ *
+ * @param [in]  nontemporal  Whether to return the non-temporal kernel.
+ *
+ * @return The selected kernel.
+ */
+const ucs_memcpy_kernel_t *ucs_memcpy_selected(int nontemporal);
+
+
+/**
+ * Copy a buffer on a data path, using the fastest copy kernel for its size.
+ * Large copies, which would thrash the cache, use a non-temporal kernel.
+ */
+static UCS_F_ALWAYS_INLINE void
+ucs_memcpy_bulk(void *dst, const void *src, size_t len)
+{
+    if (len < UCS_MEMCPY_BULK_MIN_LEN) {
+        memcpy(dst, src, len);
+    } else if (len < ucs_memcpy_dispatch.nt_thresh) {
+        ucs_memcpy_dispatch.temporal(dst, src, len);
+    } else {
+        ucs_memcpy_dispatch.nontemporal(dst, src, len);
+    }
+}
+
+END_C_DECLS
+
+#endif
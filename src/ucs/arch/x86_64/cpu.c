@@ -434,10 +434,21 @@ int ucs_arch_get_cpu_flag()
             }
         }
         if (base_value >= 7) {
-            ucs_x86_cpuid(X86_CPUID_GET_EXTD_VALUE, &_eax, &_ebx, &_ecx, &_edx);
+            ucs_x86_cpuid_ecx(X86_CPUID_GET_EXTD_VALUE, 0, &_eax, &_ebx, &_ecx,
+                              &_edx);
             if ((result & UCS_CPU_FLAG_AVX) && (_ebx & (1 << 5))) {
                 result |= UCS_CPU_FLAG_AVX2;
             }
+            if (_ebx & (1 << 9)) {
+                result |= UCS_CPU_FLAG_ERMS;
+            }
+            if ((result & UCS_CPU_FLAG_AVX) && (_ebx & (1 << 16))) {
+                /* check that the OS saves opmask and ZMM state */
+                ucs_x86_xgetbv(0, _eax, _edx);
+                if ((_eax & 0xe0) == 0xe0) {
+                    result |= UCS_CPU_FLAG_AVX512F;
+                }
+            }
         }
         cpu_flag = result;
     }
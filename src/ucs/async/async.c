@@ -27,6 +27,7 @@
 
 #define UCS_ASYNC_MISSED_QUEUE_SHIFT    32
 #define UCS_ASYNC_MISSED_QUEUE_MASK     UCS_MASK(UCS_ASYNC_MISSED_QUEUE_SHIFT)
+#define UCS_ASYNC_MISSED_BATCH          16
 
 /* Hash table for all event and timer handlers */
 KHASH_MAP_INIT_INT(ucs_async_handler, ucs_async_handler_t *);
@@ -599,17 +600,18 @@ ucs_status_t ucs_async_modify_handler(int fd, int events)
 
 void __ucs_async_poll_missed(ucs_async_context_t *async)
 {
+    uint64_t values[UCS_ASYNC_MISSED_BATCH];
     ucs_async_handler_t *handler;
     int handler_id, events;
-    ucs_status_t status;
-    uint64_t value;
+    unsigned i, count;
 
     ucs_trace_async("miss handler");
 
     while (!ucs_mpmc_queue_is_empty(&async->missed)) {
 
-        status = ucs_mpmc_queue_pull(&async->missed, &value);
-        if (status == UCS_ERR_NO_PROGRESS) {
+        count = ucs_mpmc_queue_pull_batch(&async->missed, values,
+                                          UCS_ASYNC_MISSED_BATCH);
+        if (count == 0) {
             /* TODO we should retry here if the code is change to check miss
              * only during ASYNC_UNBLOCK */
             break;
@@ -618,14 +620,17 @@ void __ucs_async_poll_missed(ucs_async_context_t *async)
         ucs_async_method_call_all(block);
         UCS_ASYNC_BLOCK(async);
 
-        ucs_async_missed_event_unpack(value, &handler_id, &events);
-        handler = ucs_async_handler_get(handler_id);
-        if (handler != NULL) {
-            ucs_assert(handler->async == async);
-            handler->missed = 0;
-            ucs_async_handler_invoke(handler, events);
-            ucs_async_handler_put(handler);
+        for (i = 0; i < count; ++i) {
+            ucs_async_missed_event_unpack(values[i], &handler_id, &events);
+            handler = ucs_async_handler_get(handler_id);
+            if (handler != NULL) {
+                ucs_assert(handler->async == async);
+                handler->missed = 0;
+                ucs_async_handler_invoke(handler, events);
+                ucs_async_handler_put(handler);
+            }
         }
+
         UCS_ASYNC_UNBLOCK(async);
         ucs_async_method_call_all(unblock);
     }
@@ -46,9 +46,15 @@ ucs_global_opts_t ucs_global_opts = {
     .profile_file          = "",
     .stats_filter          = { NULL, 0 },
     .stats_format          = UCS_STATS_FULL,
+    .stats_shm             = 0,
+    .stats_shards          = 16,
+    .stats_max_counters    = 16384,
     .rcache_check_pfn      = 0,
+    .rcache_inv_drain_thresh = 1024,
     .module_dir            = UCX_MODULE_DIR, /* defined in Makefile.am */
     .module_log_level      = UCS_LOG_LEVEL_TRACE,
+    .memcpy_kernels        = { NULL, 0 },
+    .memcpy_nt_thresh      = UCS_MEMUNITS_AUTO,
     .arch                  = UCS_ARCH_GLOBAL_OPTS_INITALIZER
 };
 
@@ -193,6 +199,25 @@ static ucs_config_field_t ucs_global_opts_table[] = {
    "  summary - all counters will be printed in the same line.",
    ucs_offsetof(ucs_global_opts_t, stats_format), UCS_CONFIG_TYPE_ENUM(ucs_stats_formats_names)},
 
+  {"STATS_SHM", "n",
+   "Publish the statistics counters in a shared memory segment named\n"
+   "/ucx_stats_<pid>, which can be sampled by the ucx_stats tool while the\n"
+   "process is running.",
+   ucs_offsetof(ucs_global_opts_t, stats_shm), UCS_CONFIG_TYPE_BOOL},
+
+  {"STATS_SHARDS", "16",
+   "Number of statistics counter shards. Every thread updates the counters of\n"
+   "its own shard, and the shards are summed when the counters are read. If\n"
+   "more threads update the counters, some of them share a shard, and their\n"
+   "concurrent updates may be lost.",
+   ucs_offsetof(ucs_global_opts_t, stats_shards), UCS_CONFIG_TYPE_UINT},
+
+  {"STATS_MAX_COUNTERS", "16384",
+   "Maximal number of sharded statistics counters. Counters of nodes created\n"
+   "after the limit is reached are not sharded, and are not published in the\n"
+   "shared memory segment.",
+   ucs_offsetof(ucs_global_opts_t, stats_max_counters), UCS_CONFIG_TYPE_UINT},
+
 #endif
 
 #ifdef ENABLE_MEMTRACK
@@ -227,6 +252,12 @@ static ucs_config_field_t ucs_global_opts_table[] = {
    "Number of pages to check, 0 - disable checking.",
    ucs_offsetof(ucs_global_opts_t, rcache_check_pfn), UCS_CONFIG_TYPE_UINT},
 
+  {"RCACHE_INV_DRAIN_THRESH", "1024",
+   "Number of pending memory invalidation ranges, queued by unmap events while\n"
+   "the registration cache was locked, which triggers draining the queue from\n"
+   "the async progress thread. 0 - drain the queue only by cache operations.",
+   ucs_offsetof(ucs_global_opts_t, rcache_inv_drain_thresh), UCS_CONFIG_TYPE_UINT},
+
   {"MODULE_DIR", UCX_MODULE_DIR,
    "Directory to search for loadable modules",
    ucs_offsetof(ucs_global_opts_t, module_dir), UCS_CONFIG_TYPE_STRING},
@@ -235,6 +266,20 @@ static ucs_config_field_t ucs_global_opts_table[] = {
    "Logging level for module loader\n",
    ucs_offsetof(ucs_global_opts_t, module_log_level), UCS_CONFIG_TYPE_ENUM(ucs_log_level_names)},
 
+  {"MEMCPY_KERNELS", "",
+   "Comma-separated list of memory copy kernels to use for bulk data copies.\n"
+   "The first supported temporal kernel and the first supported non-temporal\n"
+   "kernel in the list are used; kernels which are not set are selected by a\n"
+   "short calibration on first use. Run \"ucx_info -s\" to see the kernels\n"
+   "available on this system and their bandwidth.",
+   ucs_offsetof(ucs_global_opts_t, memcpy_kernels), UCS_CONFIG_TYPE_STRING_ARRAY},
+
+  {"MEMCPY_NT_THRESH", "auto",
+   "Minimal size of a bulk data copy which uses a non-temporal kernel, which\n"
+   "does not pollute the cache. \"auto\" sets it to half of the last level\n"
+   "cache size, \"inf\" disables non-temporal copies.",
+   ucs_offsetof(ucs_global_opts_t, memcpy_nt_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"", "", NULL,
    ucs_offsetof(ucs_global_opts_t, arch),
    UCS_CONFIG_TYPE_TABLE(ucs_arch_global_opts_table)},
@@ -115,15 +115,34 @@ typedef struct {
     /* statistics format options */
     ucs_stats_formats_t        stats_format;
 
+    /* Publish statistics counters in a shared memory segment */
+    int                        stats_shm;
+
+    /* Number of per-thread statistics counter shards */
+    unsigned                   stats_shards;
+
+    /* Maximal number of statistics counters in the counters region */
+    unsigned                   stats_max_counters;
+
     /* registration cache checks if physical pages are not moved */
     unsigned                   rcache_check_pfn;
 
+    /* registration cache invalidation queue length which triggers draining
+     * the queue from the async thread */
+    unsigned                   rcache_inv_drain_thresh;
+
     /* directory for loadable modules */
     char                       *module_dir;
 
     /* log level for module loader code */
     ucs_log_level_t            module_log_level;
 
+    /* memory copy kernels for bulk data copies */
+    ucs_config_names_array_t   memcpy_kernels;
+
+    /* threshold for non-temporal bulk data copies */
+    size_t                     memcpy_nt_thresh;
+
     /* arch-specific global options */
     ucs_arch_global_opts_t arch;
 } ucs_global_opts_t;
@@ -17,11 +17,17 @@
 void ucs_arbiter_init(ucs_arbiter_t *arbiter)
 {
     ucs_list_head_init(&arbiter->list);
+    ucs_list_head_init(&arbiter->prio_list);
 }
 
 void ucs_arbiter_group_init(ucs_arbiter_group_t *group)
 {
-    group->tail = NULL;
+    group->tail       = NULL;
+    group->prio_tail  = NULL;
+    group->deficit    = 0;
+    group->weight     = 1;
+    group->prio       = UCS_ARBITER_PRIO_NORMAL;
+    group->sched_prio = UCS_ARBITER_PRIO_NORMAL;
     UCS_ARBITER_GROUP_GUARD_INIT(group);
 }
 
@@ -46,6 +52,37 @@ static inline void ucs_arbiter_group_head_reset(ucs_arbiter_elem_t *head)
     head->list.next = NULL; /* Not scheduled yet */
 }
 
+static inline ucs_list_link_t *
+ucs_arbiter_prio_list(ucs_arbiter_t *arbiter, unsigned prio)
+{
+    return (prio == UCS_ARBITER_PRIO_HIGH) ? &arbiter->prio_list :
+                                             &arbiter->list;
+}
+
+/* Add a group head to the tail of the list of its priority class */
+static inline void ucs_arbiter_group_head_add(ucs_arbiter_t *arbiter,
+                                              ucs_arbiter_group_t *group,
+                                              ucs_arbiter_elem_t *head)
+{
+    group->sched_prio = group->prio;
+    ucs_list_add_tail(ucs_arbiter_prio_list(arbiter, group->prio),
+                      &head->list);
+}
+
+/* The group has no more high priority elements */
+static inline void ucs_arbiter_group_reset_prio(ucs_arbiter_group_t *group)
+{
+    group->prio_tail = NULL;
+    group->prio      = UCS_ARBITER_PRIO_NORMAL;
+}
+
+/* The group became empty */
+static inline void ucs_arbiter_group_set_empty(ucs_arbiter_group_t *group)
+{
+    group->tail = NULL;
+    ucs_arbiter_group_reset_prio(group);
+}
+
 static inline void ucs_arbiter_elem_set_scheduled(ucs_arbiter_elem_t *elem,
                                                   ucs_arbiter_group_t *group)
 {
@@ -104,10 +141,11 @@ void ucs_arbiter_group_purge(ucs_arbiter_t *arbiter,
 {
     ucs_arbiter_elem_t *tail            = group->tail;
     ucs_arbiter_elem_t dummy_group_head = {};
+    ucs_arbiter_elem_t *last_kept       = NULL;
     ucs_arbiter_elem_t *ptr, *next, *prev;
     ucs_arbiter_cb_result_t result;
     ucs_arbiter_elem_t *head;
-    int sched_group;
+    int sched_group, prio_elem;
 
     if (tail == NULL) {
         return; /* Empty group */
@@ -128,17 +166,28 @@ void ucs_arbiter_group_purge(ucs_arbiter_t *arbiter,
     do {
         ptr       = next;
         next      = ptr->next;
+        prio_elem = (ptr == group->prio_tail);
         /* Can't touch the element after cb is called if it gets removed. But it
          * can be reused later as well, so it's group should be NULL. */
         ucs_arbiter_elem_init(ptr);
         result    = cb(arbiter, group, ptr, cb_arg);
 
         if (result == UCS_ARBITER_CB_RESULT_REMOVE_ELEM) {
+            if (prio_elem) {
+                /* the priority is kept until the previous element, which may
+                 * not be high priority, is dispatched */
+                if (last_kept == NULL) {
+                    ucs_arbiter_group_reset_prio(group);
+                } else {
+                    group->prio_tail = last_kept;
+                }
+            }
+
             if (ptr == head) {
                 head = next;
                 if (ptr == tail) {
                     /* Last element is being removed - mark group as empty */
-                    group->tail = NULL;
+                    ucs_arbiter_group_set_empty(group);
                     if (sched_group) {
                         ucs_list_del(&dummy_group_head.list);
                     }
@@ -156,6 +205,7 @@ void ucs_arbiter_group_purge(ucs_arbiter_t *arbiter,
             /* keep the element */
             ucs_arbiter_elem_set_scheduled(ptr, group);
             prev       = ptr;
+            last_kept  = ptr;
         }
     } while (ptr != tail);
 
@@ -164,6 +214,11 @@ void ucs_arbiter_group_purge(ucs_arbiter_t *arbiter,
     if (sched_group) {
         /* restore group head (could be old or new) instead of the dummy element */
         ucs_list_replace(&dummy_group_head.list, &head->list);
+        if (group->sched_prio != group->prio) {
+            /* the last high priority element was removed */
+            ucs_list_del(&head->list);
+            ucs_arbiter_group_head_add(arbiter, group, head);
+        }
     } else {
         /* mark the group head (could be old or new) as unscheduled */
         ucs_arbiter_group_head_reset(head);
@@ -201,15 +256,6 @@ int ucs_arbiter_group_is_scheduled(ucs_arbiter_group_t *group)
     return ucs_arbiter_group_head_is_scheduled(head);
 }
 
-static void
-ucs_arbiter_schedule_head_if_not_scheduled(ucs_arbiter_t *arbiter,
-                                           ucs_arbiter_elem_t *head)
-{
-    if (!ucs_arbiter_group_head_is_scheduled(head)) {
-        ucs_list_add_tail(&arbiter->list, &head->list);
-    }
-}
-
 void ucs_arbiter_group_schedule_nonempty(ucs_arbiter_t *arbiter,
                                          ucs_arbiter_group_t *group)
 {
@@ -220,7 +266,14 @@ void ucs_arbiter_group_schedule_nonempty(ucs_arbiter_t *arbiter,
     head = tail->next;
 
     ucs_assert(head != NULL);
-    ucs_arbiter_schedule_head_if_not_scheduled(arbiter, head);
+    if (!ucs_arbiter_group_head_is_scheduled(head)) {
+        ucs_arbiter_group_head_add(arbiter, group, head);
+    } else if (ucs_unlikely(group->sched_prio != group->prio)) {
+        /* the priority class was changed, move to the other list */
+        UCS_ARBITER_GROUP_ARBITER_CHECK(group, arbiter);
+        ucs_list_del(&head->list);
+        ucs_arbiter_group_head_add(arbiter, group, head);
+    }
     UCS_ARBITER_GROUP_ARBITER_SET(group, arbiter);
 }
 
@@ -268,20 +321,34 @@ ucs_arbiter_group_head_replace(ucs_arbiter_group_t *group,
 void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
                                    ucs_arbiter_callback_t cb, void *cb_arg)
 {
+    ucs_list_link_t resched_list[UCS_ARBITER_PRIO_LAST];
     ucs_arbiter_elem_t *group_head;
     ucs_arbiter_cb_result_t result;
-    unsigned group_dispatch_count;
     ucs_arbiter_group_t *group;
-    UCS_LIST_HEAD(resched_list);
+    ucs_list_link_t *list;
     ucs_arbiter_elem_t dummy;
+    unsigned prio;
+    int prio_elem;
 
-    ucs_assert(!ucs_list_is_empty(&arbiter->list));
+    ucs_assert(!ucs_arbiter_is_empty(arbiter));
 
     ucs_arbiter_group_head_reset(&dummy);
+    for (prio = 0; prio < UCS_ARBITER_PRIO_LAST; ++prio) {
+        ucs_list_head_init(&resched_list[prio]);
+    }
 
-    do {
-        group_head = ucs_list_extract_head(&arbiter->list, ucs_arbiter_elem_t,
-                                           list);
+    for (;;) {
+        /* strict priority: take a normal group only if there are no high
+         * priority groups, including those scheduled by the callback */
+        if (!ucs_list_is_empty(&arbiter->prio_list)) {
+            list = &arbiter->prio_list;
+        } else if (!ucs_list_is_empty(&arbiter->list)) {
+            list = &arbiter->list;
+        } else {
+            break;
+        }
+
+        group_head = ucs_list_extract_head(list, ucs_arbiter_elem_t, list);
         ucs_assert(group_head != NULL);
 
         /* Reset group head to allow the group to be moved to another arbiter by
@@ -290,15 +357,19 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
          */
         ucs_arbiter_group_head_reset(group_head);
 
-        group_dispatch_count = 0;
-        group                = group_head->group;
-        dummy.group          = group;
+        group       = group_head->group;
+        dummy.group = group;
         UCS_ARBITER_GROUP_GUARD_CHECK(group);
 
+        /* start a new turn, unless the previous one was stopped */
+        if (group->deficit == 0) {
+            group->deficit = per_group * group->weight;
+        }
+
         for (;;) {
-            ucs_assert(group_head->group   == group);
-            ucs_assert(dummy.group         == group);
-            ucs_assert(group_dispatch_count < per_group);
+            ucs_assert(group_head->group == group);
+            ucs_assert(dummy.group       == group);
+            ucs_assert(group->deficit    > 0);
 
             /* reset the dispatched element here because:
              * 1. if the element is removed from the arbiter it must be kept in
@@ -314,13 +385,24 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
              */
             ucs_arbiter_group_head_replace(group, group_head, &dummy);
 
+            /* the group leaves the high priority class with its last high
+             * priority element; drop the class before the callback, which may
+             * reschedule the group, and restore it if the element stays */
+            prio_elem = (group_head == group->prio_tail);
+            if (ucs_unlikely(prio_elem)) {
+                ucs_arbiter_group_reset_prio(group);
+            }
+
             /* dispatch the element */
             ucs_trace_poll("dispatching arbiter element %p", group_head);
             UCS_ARBITER_GROUP_GUARD_ENTER(group);
             result = cb(arbiter, group, group_head, cb_arg);
             UCS_ARBITER_GROUP_GUARD_EXIT(group);
             ucs_trace_poll("dispatch result: %d", result);
-            ++group_dispatch_count;
+            if (ucs_likely(result != UCS_ARBITER_CB_RESULT_STOP)) {
+                /* a stopped element was not dispatched, keep its credit */
+                --group->deficit;
+            }
 
             /* recursive push to head (during dispatch) is not allowed */
             ucs_assert(group->tail->next == &dummy);
@@ -330,6 +412,13 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
                 /* restore group pointer */
                 ucs_arbiter_elem_set_scheduled(group_head, group);
 
+                if (ucs_unlikely(prio_elem) && (group->prio_tail == NULL)) {
+                    /* restore the priority of a kept element, unless the
+                     * callback added a later high priority element */
+                    group->prio_tail = group_head;
+                    group->prio      = UCS_ARBITER_PRIO_HIGH;
+                }
+
                 /* the head should not move, since dummy replaces it */
                 ucs_assert(!ucs_arbiter_group_head_is_scheduled(group_head));
 
@@ -352,14 +441,20 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
 
                     if (result == UCS_ARBITER_CB_RESULT_NEXT_GROUP) {
                         /* add to arbiter tail */
-                        ucs_list_add_tail(&arbiter->list, &group_head->list);
+                        ucs_arbiter_group_head_add(arbiter, group, group_head);
                     } else if (result == UCS_ARBITER_CB_RESULT_RESCHED_GROUP) {
                         /* add to resched list */
-                        ucs_list_add_tail(&resched_list, &group_head->list);
+                        group->sched_prio = group->prio;
+                        ucs_list_add_tail(&resched_list[group->prio],
+                                          &group_head->list);
                     } else if (result == UCS_ARBITER_CB_RESULT_STOP) {
                         /* exit the outmost loop and make sure that next dispatch()
-                         * will continue from the current group */
-                        ucs_list_add_head(&arbiter->list, &group_head->list);
+                         * will continue from the current group, with the rest
+                         * of its turn */
+                        group->sched_prio = group->prio;
+                        ucs_list_add_head(ucs_arbiter_prio_list(arbiter,
+                                                                group->prio),
+                                          &group_head->list);
                         goto out;
                     } else {
                         ucs_bug("unexpected return value from arbiter callback");
@@ -371,7 +466,7 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
 
             /* last element removed */
             if (dummy.next == &dummy) {
-                group->tail = NULL; /* group is empty now */
+                ucs_arbiter_group_set_empty(group);
                 group_head  = NULL; /* for debugging */
                 ucs_arbiter_remove_and_reset_if_scheduled(&dummy);
                 UCS_ARBITER_GROUP_ARBITER_SET(group, NULL);
@@ -388,37 +483,46 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
                 ucs_arbiter_group_head_reset(&dummy);
                 /* the group is already scheduled, continue to next group */
                 break;
-            } else if (group_dispatch_count >= per_group) {
-                /* add to arbiter tail and continue to next group */
-                ucs_list_add_tail(&arbiter->list, &group_head->list);
+            } else if ((group->deficit == 0) ||
+                       (group->sched_prio != group->prio)) {
+                /* add to arbiter tail and continue to next group; a group
+                 * which changed its priority class ends its turn, so that
+                 * high priority groups are not delayed by it */
+                ucs_arbiter_group_head_add(arbiter, group, group_head);
                 break;
             }
 
             /* continue with new group head */
             ucs_arbiter_group_head_reset(group_head);
         }
-    } while (!ucs_list_is_empty(&arbiter->list));
+
+        /* the turn of the group is over */
+        group->deficit = 0;
+    }
 
 out:
-    ucs_list_splice_tail(&arbiter->list, &resched_list);
+    for (prio = 0; prio < UCS_ARBITER_PRIO_LAST; ++prio) {
+        ucs_list_splice_tail(ucs_arbiter_prio_list(arbiter, prio),
+                             &resched_list[prio]);
+    }
 }
 
-void ucs_arbiter_dump(ucs_arbiter_t *arbiter, FILE *stream)
+static void ucs_arbiter_dump_list(ucs_list_link_t *list, const char *title,
+                                  FILE *stream)
 {
     static const int max_groups = 100;
     ucs_arbiter_elem_t *group_head, *elem;
     int count;
 
-    fprintf(stream, "-------\n");
-    if (ucs_list_is_empty(&arbiter->list)) {
-        fprintf(stream, "(empty)\n");
-        goto out;
+    if (ucs_list_is_empty(list)) {
+        return;
     }
 
+    fprintf(stream, "%s:\n", title);
     count = 0;
-    ucs_list_for_each(group_head, &arbiter->list, list) {
+    ucs_list_for_each(group_head, list, list) {
         elem = group_head;
-        if (ucs_list_head(&arbiter->list, ucs_arbiter_elem_t, list) == group_head) {
+        if (ucs_list_head(list, ucs_arbiter_elem_t, list) == group_head) {
             fprintf(stream, "=> ");
         } else {
             fprintf(stream, " * ");
@@ -443,7 +547,16 @@ void ucs_arbiter_dump(ucs_arbiter_t *arbiter, FILE *stream)
             break;
         }
     }
+}
 
-out:
+void ucs_arbiter_dump(ucs_arbiter_t *arbiter, FILE *stream)
+{
+    fprintf(stream, "-------\n");
+    if (ucs_arbiter_is_empty(arbiter)) {
+        fprintf(stream, "(empty)\n");
+    } else {
+        ucs_arbiter_dump_list(&arbiter->prio_list, "high priority", stream);
+        ucs_arbiter_dump_list(&arbiter->list, "normal priority", stream);
+    }
     fprintf(stream, "-------\n");
 }
@@ -11,6 +11,7 @@
 #include <ucs/datastruct/list.h>
 #include <ucs/type/status.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <ucs/debug/assert.h>
 
 /*
@@ -26,6 +27,20 @@
  * is rescheduled it's moved to the tail of the list. At any point a group head
  * can be removed from the "middle" of the list.
  *
+ * Scheduling:
+ *  - Every group belongs to a priority class. The arbiter keeps a list of
+ *    group heads per class, and groups of the high priority class are always
+ *    dispatched before groups of the normal class (strict priority).
+ *  - Within a class, groups are dispatched in deficit round-robin order: on
+ *    its turn a group is credited with (per_group * weight) dispatches, and
+ *    keeps the credit it did not use if the dispatch was stopped in the middle
+ *    of its turn.
+ *  - A group is raised to the high priority class by
+ *    ucs_arbiter_group_set_prio_elem(), and goes back to the normal class
+ *    once its last high priority element is dispatched, so normal elements
+ *    queued after it do not keep the priority. The order of elements inside
+ *    a group is not affected.
+ *
  * The groups and elements are arranged like this:
  *  - every arbitrated element points to the group (head).
  *  - first element in the group points to previous and next group (list)
@@ -82,6 +97,17 @@ typedef struct ucs_arbiter_group  ucs_arbiter_group_t;
 typedef struct ucs_arbiter_elem   ucs_arbiter_elem_t;
 
 
+/**
+ * Arbitration group priority class.
+ */
+typedef enum {
+    UCS_ARBITER_PRIO_HIGH,              /* Dispatched before any group of
+                                           normal priority */
+    UCS_ARBITER_PRIO_NORMAL,            /* Default priority */
+    UCS_ARBITER_PRIO_LAST
+} ucs_arbiter_prio_t;
+
+
 /**
  * Arbitration callback result codes.
  */
@@ -146,7 +172,8 @@ typedef ucs_arbiter_cb_result_t (*ucs_arbiter_callback_t)(ucs_arbiter_t *arbiter
  * Top-level arbiter.
  */
 struct ucs_arbiter {
-    ucs_list_link_t         list;
+    ucs_list_link_t         list;       /* Groups of normal priority */
+    ucs_list_link_t         prio_list;  /* Groups of high priority */
 };
 
 
@@ -155,6 +182,11 @@ struct ucs_arbiter {
  */
 struct ucs_arbiter_group {
     ucs_arbiter_elem_t      *tail;
+    ucs_arbiter_elem_t      *prio_tail; /* Last high priority element */
+    unsigned                deficit;    /* Dispatches left in the current turn */
+    uint16_t                weight;     /* Turn length, in units of per_group */
+    uint8_t                 prio;       /* Priority class, ucs_arbiter_prio_t */
+    uint8_t                 sched_prio; /* Class the group is scheduled on */
     UCS_ARBITER_GROUP_GUARD_DEFINE;
     UCS_ARBITER_GROUP_ARBITER_DEFINE;
 };
@@ -264,7 +296,8 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
  */
 static inline int ucs_arbiter_is_empty(ucs_arbiter_t *arbiter)
 {
-    return ucs_list_is_empty(&arbiter->list);
+    return ucs_list_is_empty(&arbiter->list) &&
+           ucs_list_is_empty(&arbiter->prio_list);
 }
 
 
@@ -287,9 +320,43 @@ static inline int ucs_arbiter_group_is_empty(ucs_arbiter_group_t *group)
 }
 
 
+/**
+ * Mark the last element of a group as high priority. The group is in the
+ * UCS_ARBITER_PRIO_HIGH class until this element is dispatched or purged, and
+ * then returns to UCS_ARBITER_PRIO_NORMAL. The new class takes effect the
+ * next time the group is scheduled, or immediately if it's already scheduled
+ * and ucs_arbiter_group_schedule() is called again.
+ *
+ * @param [in]  group    Group to raise.
+ * @param [in]  elem     High priority element, must be the tail of the group.
+ */
+static inline void ucs_arbiter_group_set_prio_elem(ucs_arbiter_group_t *group,
+                                                   ucs_arbiter_elem_t *elem)
+{
+    ucs_assert(group->tail == elem);
+    group->prio_tail = elem;
+    group->prio      = UCS_ARBITER_PRIO_HIGH;
+}
+
+
+/**
+ * Set the weight of a group within its priority class. On every turn, the
+ * group may dispatch up to per_group * weight elements.
+ *
+ * @param [in]  group    Group to set the weight for.
+ * @param [in]  weight   Group weight, must be at least 1.
+ */
+static inline void ucs_arbiter_group_set_weight(ucs_arbiter_group_t *group,
+                                                unsigned weight)
+{
+    ucs_assert((weight > 0) && (weight <= UINT16_MAX));
+    group->weight = weight;
+}
+
+
 /**
  * Schedule a group for arbitration. If the group is already there, the operation
- * will have no effect.
+ * will have no effect, except for moving it to its current priority class.
  *
  * @param [in]  arbiter  Arbiter object to schedule the group on.
  * @param [in]  group    Group to schedule.
@@ -366,15 +433,17 @@ ucs_arbiter_group_push_head_elem(ucs_arbiter_group_t *group,
 
 
 /**
- * Dispatch work elements in the arbiter. For every group, up to per_group work
- * elements are dispatched, as long as the callback returns REMOVE_ELEM or
- * NEXT_GROUP. Then, the same is done for the next group, until either the
- * arbiter becomes empty or the callback returns STOP. If a group is either out
- * of elements, or its callback returns REMOVE_GROUP, it will be removed until
- * ucs_arbiter_group_schedule() is used to put it back on the arbiter.
+ * Dispatch work elements in the arbiter. For every group, up to
+ * per_group * weight work elements are dispatched, as long as the callback
+ * returns REMOVE_ELEM or NEXT_GROUP. Then, the same is done for the next group,
+ * until either the arbiter becomes empty or the callback returns STOP. If a
+ * group is either out of elements, or its callback returns REMOVE_GROUP, it
+ * will be removed until ucs_arbiter_group_schedule() is used to put it back on
+ * the arbiter. High priority groups are dispatched first.
  *
  * @param [in]  arbiter    Arbiter object to dispatch work on.
- * @param [in]  per_group  How many elements to dispatch from each group.
+ * @param [in]  per_group  How many elements to dispatch from each group of
+ *                         weight 1.
  * @param [in]  cb         User-defined callback to be called for each element.
  * @param [in]  cb_arg     Last argument for the callback.
  */
@@ -42,7 +42,8 @@ ucs_status_t ucs_frag_list_init(ucs_frag_list_sn_t initial_sn, ucs_frag_list_t *
     ucs_queue_head_init(&frag_list->ready_list);
 
 #ifdef ENABLE_STATS
-    frag_list->prev_sn = initial_sn;
+    frag_list->prev_sn    = initial_sn;
+    frag_list->in_burst   = 0;
 #endif
     status = UCS_STATS_NODE_ALLOC(&frag_list->stats, &ucs_frag_list_stats_class,
                                  stats_parent);
@@ -93,6 +93,7 @@ typedef struct ucs_frag_list {
     UCS_STATS_NODE_DECLARE(stats)
 #ifdef ENABLE_STATS
     ucs_frag_list_sn_t prev_sn;      /*  needed to detect busrts */
+    int                in_burst;     /* a burst was already counted */
 #endif
 } ucs_frag_list_t;
 
@@ -177,11 +178,11 @@ ucs_frag_list_insert(ucs_frag_list_t *head, ucs_frag_list_elem_t *elem,
     ucs_frag_list_ooo_type_t ret;
 
     if (UCS_FRAG_LIST_SN_CMP(sn, >, head->head_sn)) {
-        if (UCS_FRAG_LIST_SN_CMP(head->prev_sn + 1, !=,sn)) {
+        /* a new burst, or the initial one */
+        if (UCS_FRAG_LIST_SN_CMP(head->prev_sn + 1, !=,sn) ||
+            ucs_unlikely(!head->in_burst)) {
             UCS_STATS_UPDATE_COUNTER(head->stats, UCS_FRAG_LIST_STAT_BURSTS, 1);
-        } else if (ucs_unlikely(UCS_STATS_GET_COUNTER(head->stats, UCS_FRAG_LIST_STAT_BURST_LEN) == 0)) {
-            /* initial burst */
-            UCS_STATS_SET_COUNTER(head->stats, UCS_FRAG_LIST_STAT_BURSTS, 1);
+            head->in_burst = 1;
         }
         UCS_STATS_UPDATE_COUNTER(head->stats, UCS_FRAG_LIST_STAT_BURST_LEN, 1);
         head->prev_sn = sn;
@@ -13,6 +13,7 @@
 
 #include <ucs/arch/atomic.h>
 #include <ucs/arch/bitops.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/debug/assert.h>
 #include <ucs/debug/memtrack.h>
 
@@ -22,8 +23,7 @@ ucs_status_t ucs_mpmc_queue_init(ucs_mpmc_queue_t *mpmc, uint32_t length)
     uint32_t i;
 
     mpmc->length   = ucs_roundup_pow2(length);
-    mpmc->shift    = ucs_ilog2(mpmc->length);
-    if (mpmc->shift >= UCS_MPMC_VALID_SHIFT) {
+    if ((mpmc->length == 0) || (mpmc->length > UCS_BIT(30))) {
         return UCS_ERR_INVALID_PARAM;
     }
 
@@ -35,7 +35,7 @@ ucs_status_t ucs_mpmc_queue_init(ucs_mpmc_queue_t *mpmc, uint32_t length)
     }
 
     for (i = 0; i < mpmc->length; ++i) {
-        mpmc->queue[i] = UCS_BIT(UCS_MPMC_VALID_SHIFT);
+        mpmc->queue[i].sn = i;
     }
 
     return UCS_OK;
@@ -46,53 +46,100 @@ void ucs_mpmc_queue_cleanup(ucs_mpmc_queue_t *mpmc)
     ucs_free(mpmc->queue);
 }
 
-static inline uint64_t __ucs_mpmc_queue_valid_bit(ucs_mpmc_queue_t *mpmc, uint32_t location)
+static UCS_F_ALWAYS_INLINE ucs_mpmc_elem_t *
+ucs_mpmc_queue_elem(ucs_mpmc_queue_t *mpmc, uint32_t location)
 {
-    return ((uint64_t)location >> mpmc->shift) & 1;
+    return &mpmc->queue[location & (mpmc->length - 1)];
 }
 
-ucs_status_t ucs_mpmc_queue_push(ucs_mpmc_queue_t *mpmc, uint64_t value)
+/* Returns how many elements, starting from 'location', are ready for the index
+ * 'location + sn_offset', up to 'max_count' */
+static UCS_F_ALWAYS_INLINE unsigned
+ucs_mpmc_queue_count_ready(ucs_mpmc_queue_t *mpmc, uint32_t location,
+                           uint32_t sn_offset, unsigned max_count)
 {
-    uint32_t location;
+    unsigned count;
+
+    for (count = 0; count < max_count; ++count) {
+        if (ucs_mpmc_queue_elem(mpmc, location + count)->sn !=
+            (location + count + sn_offset)) {
+            break;
+        }
+    }
+
+    return count;
+}
 
-    ucs_assert((value >> UCS_MPMC_VALID_SHIFT) == 0);
+unsigned ucs_mpmc_queue_push_batch(ucs_mpmc_queue_t *mpmc,
+                                   const uint64_t *values, unsigned count)
+{
+    ucs_mpmc_elem_t *elem;
+    uint32_t location;
+    unsigned i;
 
+    /* An element is free for the producer with the same index, so reserve
+     * the range of free elements */
     do {
         location = mpmc->producer;
-        if (UCS_CIRCULAR_COMPARE32(location, >=, mpmc->consumer + mpmc->length)) {
+        ucs_memory_cpu_load_fence();
+        count    = ucs_mpmc_queue_count_ready(mpmc, location, 0, count);
+        if (count == 0) {
             /* Queue is full */
-            return UCS_ERR_EXCEEDS_LIMIT;
+            return 0;
         }
-    } while (ucs_atomic_cswap32(&mpmc->producer, location, location + 1) != location);
+    } while (ucs_atomic_cswap32(&mpmc->producer, location,
+                                location + count) != location);
+
+    for (i = 0; i < count; ++i) {
+        elem        = ucs_mpmc_queue_elem(mpmc, location + i);
+        elem->value = values[i];
+        ucs_memory_cpu_store_fence();
+        elem->sn    = location + i + 1;
+    }
 
-    mpmc->queue[location & (mpmc->length - 1)] = value |
-                    (__ucs_mpmc_queue_valid_bit(mpmc, location) << UCS_MPMC_VALID_SHIFT);
-    return UCS_OK;
+    return count;
 }
 
+ucs_status_t ucs_mpmc_queue_push(ucs_mpmc_queue_t *mpmc, uint64_t value)
+{
+    return (ucs_mpmc_queue_push_batch(mpmc, &value, 1) == 1) ?
+           UCS_OK : UCS_ERR_EXCEEDS_LIMIT;
+}
 
-ucs_status_t ucs_mpmc_queue_pull(ucs_mpmc_queue_t *mpmc, uint64_t *value_p)
+unsigned ucs_mpmc_queue_pull_batch(ucs_mpmc_queue_t *mpmc, uint64_t *values,
+                                   unsigned max_count)
 {
+    ucs_mpmc_elem_t *elem;
     uint32_t location;
-    uint64_t value;
+    unsigned count, i;
 
-    location = mpmc->consumer;
-    if (location == mpmc->producer) {
-        /* Producer not started yet */
-        return UCS_ERR_NO_PROGRESS;
-    }
-
-    value = mpmc->queue[location & (mpmc->length - 1)];
-    if ((value >> UCS_MPMC_VALID_SHIFT) != __ucs_mpmc_queue_valid_bit(mpmc, location)) {
-        /* Producer not finished yet */
-        return UCS_ERR_NO_PROGRESS;
+    /* An element is filled for the consumer with the same index when its
+     * sequence number is advanced by the producer */
+    do {
+        location = mpmc->consumer;
+        ucs_memory_cpu_load_fence();
+        count    = ucs_mpmc_queue_count_ready(mpmc, location, 1, max_count);
+        if (count == 0) {
+            /* Queue is empty or producer not finished yet */
+            return 0;
+        }
+    } while (ucs_atomic_cswap32(&mpmc->consumer, location,
+                                location + count) != location);
+
+    for (i = 0; i < count; ++i) {
+        elem      = ucs_mpmc_queue_elem(mpmc, location + i);
+        ucs_memory_cpu_load_fence();
+        values[i] = elem->value;
+        /* Release the element for the producer of the next round */
+        ucs_memory_cpu_fence();
+        elem->sn  = location + i + mpmc->length;
     }
 
-    if (ucs_atomic_cswap32(&mpmc->consumer, location, location + 1) != location) {
-        /* Someone else consumed */
-        return UCS_ERR_NO_PROGRESS;
-    }
+    return count;
+}
 
-    *value_p = value & UCS_MASK(UCS_MPMC_VALID_SHIFT);
-    return UCS_OK;
+ucs_status_t ucs_mpmc_queue_pull(ucs_mpmc_queue_t *mpmc, uint64_t *value_p)
+{
+    return (ucs_mpmc_queue_pull_batch(mpmc, value_p, 1) == 1) ?
+           UCS_OK : UCS_ERR_NO_PROGRESS;
 }
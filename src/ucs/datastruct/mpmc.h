@@ -7,25 +7,42 @@
 #ifndef UCS_MPMC_H
 #define UCS_MPMC_H
 
+#include <ucs/arch/cpu.h>
 #include <ucs/type/status.h>
+#include <ucs/sys/compiler.h>
 #include <ucs/sys/math.h>
 
-#define UCS_MPMC_VALID_SHIFT        63
-#define UCS_MPMC_VALUE_MAX          UCS_BIT(UCS_MPMC_VALID_SHIFT)
 
 /**
- * A Multi-producer-multi-consumer thread-safe queue.
+ * MPMC queue element.
+ */
+typedef struct ucs_mpmc_elem {
+    volatile uint32_t  sn;          /* Producer/consumer index the element is
+                                       ready for */
+    uint64_t           value;       /* Element data */
+} ucs_mpmc_elem_t;
+
+
+/**
+ * A bounded Multi-producer-multi-consumer thread-safe queue.
  * Every push/pull is a single atomic operation in "good" scenario.
- * The queue can contain small integers up to UCS_MPMC_VALUE_MAX.
+ * The queue can contain any 64-bit values, including pointers.
+ *
+ * Every element has a sequence number which tells whether it is free for the
+ * producer or filled for the consumer with the given index. Producer and
+ * consumer indices reside on separate cache lines, so producers and consumers
+ * do not contend on them.
  *
  * TODO make the queue resizeable.
  */
 typedef struct ucs_mpmc_queue {
     uint32_t           length;      /* Array size. Rounded to power of 2. */
-    int                shift;
+    ucs_mpmc_elem_t    *queue;      /* Array of data */
+    UCS_CACHELINE_PADDING(uint32_t, ucs_mpmc_elem_t*);
     volatile uint32_t  producer;    /* Producer index */
+    UCS_CACHELINE_PADDING(uint32_t);
     volatile uint32_t  consumer;    /* Consumer index */
-    uint64_t           *queue;      /* Array of data */
+    UCS_CACHELINE_PADDING(uint32_t);
 } ucs_mpmc_queue_t;
 
 
@@ -52,16 +69,44 @@ void ucs_mpmc_queue_cleanup(ucs_mpmc_queue_t *mpmc);
 ucs_status_t ucs_mpmc_queue_push(ucs_mpmc_queue_t *mpmc, uint64_t value);
 
 
+/**
+ * Atomically push several values to the queue, using a single atomic
+ * operation in "good" scenario. The values are pushed in order, and
+ * other producers' values are not interleaved with them.
+ *
+ * @param values  Values to push.
+ * @param count   Number of values to push.
+ *
+ * @return Number of pushed values, which is less than @a count if the queue
+ *         is full.
+ */
+unsigned ucs_mpmc_queue_push_batch(ucs_mpmc_queue_t *mpmc,
+                                   const uint64_t *values, unsigned count);
+
+
 /**
  * Atomically pull a value from the queue.
  *
  * @param value_p Filled with the value, if successful.
  * @param UCS_ERR_NO_PROGRESS if there is currently no available item to retrieve,
- *                            or another thread removed the current item.
+ *                            or a producer has not finished pushing it yet.
  */
 ucs_status_t ucs_mpmc_queue_pull(ucs_mpmc_queue_t *mpmc, uint64_t *value_p);
 
 
+/**
+ * Atomically pull several values from the queue, using a single atomic
+ * operation in "good" scenario.
+ *
+ * @param values     Filled with the pulled values.
+ * @param max_count  Maximal number of values to pull.
+ *
+ * @return Number of pulled values.
+ */
+unsigned ucs_mpmc_queue_pull_batch(ucs_mpmc_queue_t *mpmc, uint64_t *values,
+                                   unsigned max_count);
+
+
 /**
  * @retrurn nonzero if queue is empty, 0 if queue *may* be non-empty.
  */
@@ -13,11 +13,30 @@
 #include "queue.h"
 
 #include <ucs/debug/log.h>
+#include <ucs/memory/numa.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/checker.h>
 #include <ucs/sys/sys.h>
 
 
+/* Free elements of a chunk, used to find idle chunks */
+typedef struct ucs_mpool_chunk_usage {
+    ucs_mpool_chunk_t      *chunk;
+    void                   *start;    /* Start of the chunk elements */
+    void                   *end;      /* End of the chunk elements */
+    unsigned               num_free;  /* Number of elements in the pool */
+} ucs_mpool_chunk_usage_t;
+
+
+const char *ucs_mpool_chunk_backing_names[] = {
+    [UCS_MPOOL_CHUNK_BACKING_HEAP]    = "heap",
+    [UCS_MPOOL_CHUNK_BACKING_MMAP]    = "mmap",
+    [UCS_MPOOL_CHUNK_BACKING_HUGETLB] = "hugetlb",
+    [UCS_MPOOL_CHUNK_BACKING_OTHER]   = "other",
+    [UCS_MPOOL_CHUNK_BACKING_LAST]    = NULL
+};
+
+
 static inline unsigned ucs_mpool_elem_total_size(ucs_mpool_data_t *data)
 {
     return ucs_align_up_pow2(data->elem_size, data->alignment);
@@ -75,7 +94,11 @@ ucs_status_t ucs_mpool_init(ucs_mpool_t *mp, size_t priv_size,
     mp->data->tail            = NULL;
     mp->data->chunks          = NULL;
     mp->data->ops             = ops;
+    mp->data->numa_node       = -1;
+    mp->data->numa_policy     = UCS_NUMA_POLICY_DEFAULT;
+    mp->data->alloc_backing   = UCS_MPOOL_CHUNK_BACKING_OTHER;
     mp->data->name            = ucs_strdup(name, "mpool_data_name");
+    memset(mp->data->backing_size, 0, sizeof(mp->data->backing_size));
 
     if (mp->data->name == NULL) {
         ucs_error("Failed to allocate memory pool data name");
@@ -186,6 +209,7 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
 
     chunk_size = sizeof(ucs_mpool_chunk_t) + data->alignment +
                  (num_elems * ucs_mpool_elem_total_size(data));
+    data->alloc_backing = UCS_MPOOL_CHUNK_BACKING_OTHER;
     status = data->ops->chunk_alloc(mp, &chunk_size, &ptr);
     if (status != UCS_OK) {
         ucs_error("Failed to allocate memory pool (name=%s) chunk: %s",
@@ -195,6 +219,8 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
 
     /* Calculate padding, and update element count according to allocated size */
     chunk            = ptr;
+    chunk->backing   = data->alloc_backing;
+    chunk->size      = chunk_size;
     chunk_padding    = ucs_padding((uintptr_t)(chunk + 1) + data->align_offset,
                                    data->alignment);
     chunk->elems     = UCS_PTR_BYTE_OFFSET(chunk + 1, chunk_padding);
@@ -218,6 +244,7 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
 
     chunk->next  = data->chunks;
     data->chunks = chunk;
+    data->backing_size[chunk->backing] += chunk->size;
 
     if (data->quota == UINT_MAX) {
         /* Infinite memory pool */
@@ -230,6 +257,176 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
     VALGRIND_MAKE_MEM_NOACCESS(chunk + 1, chunk_size - sizeof(*chunk));
 }
 
+void ucs_mpool_set_numa_node(ucs_mpool_t *mp, int policy, int node)
+{
+    mp->data->numa_policy = policy;
+    mp->data->numa_node   = node;
+}
+
+static int ucs_mpool_chunk_usage_compare(const void *elem1, const void *elem2)
+{
+    const ucs_mpool_chunk_usage_t *usage1 = elem1;
+    const ucs_mpool_chunk_usage_t *usage2 = elem2;
+
+    return ((uintptr_t)usage1->start < (uintptr_t)usage2->start) ? -1 :
+           ((uintptr_t)usage1->start > (uintptr_t)usage2->start);
+}
+
+/* Find the chunk of an element in the array sorted by address */
+static ucs_mpool_chunk_usage_t *
+ucs_mpool_chunk_usage_find(ucs_mpool_chunk_usage_t *usage, unsigned num_chunks,
+                           void *elem)
+{
+    unsigned low = 0, high = num_chunks, mid;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        if ((uintptr_t)usage[mid].start <= (uintptr_t)elem) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    ucs_assert(low > 0);
+    ucs_assert((uintptr_t)elem < (uintptr_t)usage[low - 1].end);
+    return &usage[low - 1];
+}
+
+static inline int ucs_mpool_chunk_usage_is_idle(ucs_mpool_chunk_usage_t *usage)
+{
+    return usage->num_free == usage->chunk->num_elems;
+}
+
+unsigned ucs_mpool_release_idle(ucs_mpool_t *mp)
+{
+    ucs_mpool_data_t *data = mp->data;
+    ucs_mpool_elem_t *elem, *next_elem, *last_elem;
+    ucs_mpool_chunk_usage_t *usage, *chunk_usage;
+    ucs_mpool_chunk_t *chunk, **chunk_p;
+    unsigned i, num_chunks, num_idle;
+    void *obj;
+
+    num_chunks = 0;
+    for (chunk = data->chunks; chunk != NULL; chunk = chunk->next) {
+        ++num_chunks;
+    }
+
+    if (num_chunks == 0) {
+        return 0;
+    }
+
+    usage = ucs_malloc(num_chunks * sizeof(*usage), "mpool_chunk_usage");
+    if (usage == NULL) {
+        ucs_debug("mpool %s: failed to allocate chunk usage array",
+                  ucs_mpool_name(mp));
+        return 0;
+    }
+
+    i = 0;
+    for (chunk = data->chunks; chunk != NULL; chunk = chunk->next) {
+        usage[i].chunk    = chunk;
+        usage[i].start    = chunk->elems;
+        usage[i].end      = ucs_mpool_chunk_elem(data, chunk, chunk->num_elems);
+        usage[i].num_free = 0;
+        ++i;
+    }
+    qsort(usage, num_chunks, sizeof(*usage), ucs_mpool_chunk_usage_compare);
+
+    /* Count the elements of every chunk which are in the pool */
+    for (elem = mp->freelist; elem != NULL; elem = next_elem) {
+        VALGRIND_MAKE_MEM_DEFINED(elem, sizeof *elem);
+        next_elem = elem->next;
+        VALGRIND_MAKE_MEM_NOACCESS(elem, sizeof *elem);
+        ++ucs_mpool_chunk_usage_find(usage, num_chunks, elem)->num_free;
+    }
+
+    num_idle = 0;
+    for (i = 0; i < num_chunks; ++i) {
+        num_idle += ucs_mpool_chunk_usage_is_idle(&usage[i]);
+    }
+
+    if (num_idle == 0) {
+        goto out;
+    }
+
+    /* Remove the elements of idle chunks from the freelist, keeping the order
+     * of the other elements */
+    next_elem    = mp->freelist;
+    last_elem    = NULL;
+    mp->freelist = NULL;
+    while (next_elem != NULL) {
+        elem = next_elem;
+        VALGRIND_MAKE_MEM_DEFINED(elem, sizeof *elem);
+        next_elem   = elem->next;
+        chunk_usage = ucs_mpool_chunk_usage_find(usage, num_chunks, elem);
+        if (ucs_mpool_chunk_usage_is_idle(chunk_usage)) {
+            if (data->ops->obj_cleanup != NULL) {
+                obj = elem + 1;
+                VALGRIND_MEMPOOL_ALLOC(mp, obj, data->elem_size - sizeof(ucs_mpool_elem_t));
+                VALGRIND_MAKE_MEM_DEFINED(obj, data->elem_size - sizeof(ucs_mpool_elem_t));
+                data->ops->obj_cleanup(mp, obj);
+                VALGRIND_MEMPOOL_FREE(mp, obj);
+            }
+        } else if (last_elem == NULL) {
+            mp->freelist = elem;
+            last_elem    = elem;
+        } else {
+            VALGRIND_MAKE_MEM_DEFINED(last_elem, sizeof *last_elem);
+            last_elem->next = elem;
+            VALGRIND_MAKE_MEM_NOACCESS(last_elem, sizeof *last_elem);
+            last_elem       = elem;
+        }
+        VALGRIND_MAKE_MEM_NOACCESS(elem, sizeof *elem);
+    }
+
+    if (last_elem != NULL) {
+        VALGRIND_MAKE_MEM_DEFINED(last_elem, sizeof *last_elem);
+        last_elem->next = NULL;
+        VALGRIND_MAKE_MEM_NOACCESS(last_elem, sizeof *last_elem);
+    }
+    data->tail = last_elem;
+
+    /* Release the idle chunks, and allow the pool to grow again instead */
+    chunk_p = &data->chunks;
+    while (*chunk_p != NULL) {
+        chunk       = *chunk_p;
+        chunk_usage = ucs_mpool_chunk_usage_find(usage, num_chunks,
+                                                 chunk->elems);
+        if (!ucs_mpool_chunk_usage_is_idle(chunk_usage)) {
+            chunk_p = &chunk->next;
+            continue;
+        }
+
+        *chunk_p = chunk->next;
+        data->backing_size[chunk->backing] -= chunk->size;
+        if (data->quota != UINT_MAX) {
+            data->quota += chunk->num_elems;
+        }
+
+        ucs_debug("mpool %s: releasing idle chunk %p of %zu bytes with %u "
+                  "elements", ucs_mpool_name(mp), chunk, chunk->size,
+                  chunk->num_elems);
+        data->ops->chunk_release(mp, chunk);
+    }
+
+out:
+    ucs_free(usage);
+    return num_idle;
+}
+
+size_t ucs_mpool_chunks_size(ucs_mpool_t *mp)
+{
+    size_t size = 0;
+    unsigned backing;
+
+    for (backing = 0; backing < UCS_MPOOL_CHUNK_BACKING_LAST; ++backing) {
+        size += mp->data->backing_size[backing];
+    }
+
+    return size;
+}
+
 void *ucs_mpool_get_grow(ucs_mpool_t *mp)
 {
     ucs_mpool_data_t *data = mp->data;
@@ -242,8 +439,29 @@ void *ucs_mpool_get_grow(ucs_mpool_t *mp)
     return ucs_mpool_get(mp);
 }
 
+/* Apply the NUMA policy of the pool to newly allocated chunk memory */
+static void ucs_mpool_chunk_numa_bind(ucs_mpool_t *mp, void *ptr, size_t size)
+{
+    ucs_status_t status;
+
+    status = ucs_numa_mem_bind(ptr, size, (ucs_numa_policy_t)mp->data->numa_policy,
+                               mp->data->numa_node);
+    if (status != UCS_OK) {
+        ucs_debug("mpool %s: failed to bind chunk %p to numa node %d: %s",
+                  ucs_mpool_name(mp), ptr, mp->data->numa_node,
+                  ucs_status_string(status));
+    }
+}
+
+static inline int ucs_mpool_is_numa_bound(ucs_mpool_t *mp)
+{
+    return (mp->data->numa_policy != UCS_NUMA_POLICY_DEFAULT) &&
+           (mp->data->numa_node >= 0);
+}
+
 ucs_status_t ucs_mpool_chunk_malloc(ucs_mpool_t *mp, size_t *size_p, void **chunk_p)
 {
+    mp->data->alloc_backing = UCS_MPOOL_CHUNK_BACKING_HEAP;
     *chunk_p = ucs_malloc(*size_p, ucs_mpool_name(mp));
     return (*chunk_p == NULL) ? UCS_ERR_NO_MEMORY : UCS_OK;
 }
@@ -270,6 +488,11 @@ ucs_status_t ucs_mpool_chunk_mmap(ucs_mpool_t *mp, size_t *size_p, void **chunk_
         return UCS_ERR_NO_MEMORY;
     }
 
+    if (ucs_mpool_is_numa_bound(mp)) {
+        ucs_mpool_chunk_numa_bind(mp, chunk, real_size);
+    }
+
+    mp->data->alloc_backing = UCS_MPOOL_CHUNK_BACKING_MMAP;
     chunk->size = real_size;
     *size_p     = real_size - sizeof(*chunk);
     *chunk_p    = chunk + 1;
@@ -285,7 +508,8 @@ void ucs_mpool_chunk_munmap(ucs_mpool_t *mp, void *chunk)
 
 
 typedef struct ucs_hugetlb_mpool_chunk_hdr {
-    int hugetlb;
+    unsigned backing;  /* Backing memory type */
+    size_t   size;     /* Mapped size, for mmap backing */
 } ucs_hugetlb_mpool_chunk_hdr_t;
 
 ucs_status_t ucs_mpool_hugetlb_malloc(ucs_mpool_t *mp, size_t *size_p, void **chunk_p)
@@ -306,23 +530,42 @@ ucs_status_t ucs_mpool_hugetlb_malloc(ucs_mpool_t *mp, size_t *size_p, void **ch
     status = ucs_sysv_alloc(&real_size, real_size * 2, (void**)&ptr, SHM_HUGETLB,
                             ucs_mpool_name(mp), &shmid);
     if (status == UCS_OK) {
+        if (ucs_mpool_is_numa_bound(mp)) {
+            ucs_mpool_chunk_numa_bind(mp, ptr, real_size);
+        }
         chunk = ptr;
-        chunk->hugetlb = 1;
+        chunk->backing = UCS_MPOOL_CHUNK_BACKING_HUGETLB;
         goto out_ok;
     }
 #endif
 
+    /* Heap memory may share pages with other allocations, so bind mmap-ed
+     * memory instead */
+    if (ucs_mpool_is_numa_bound(mp)) {
+        real_size = ucs_align_up(*size_p, ucs_get_page_size());
+        chunk     = ucs_mmap(NULL, real_size, PROT_READ|PROT_WRITE,
+                             MAP_PRIVATE|MAP_ANONYMOUS, -1, 0,
+                             ucs_mpool_name(mp));
+        if (chunk != MAP_FAILED) {
+            ucs_mpool_chunk_numa_bind(mp, chunk, real_size);
+            chunk->backing = UCS_MPOOL_CHUNK_BACKING_MMAP;
+            chunk->size    = real_size;
+            goto out_ok;
+        }
+    }
+
     /* Fallback to glibc */
     real_size = *size_p;
     chunk = ucs_malloc(real_size, ucs_mpool_name(mp));
     if (chunk != NULL) {
-        chunk->hugetlb = 0;
+        chunk->backing = UCS_MPOOL_CHUNK_BACKING_HEAP;
         goto out_ok;
     }
 
     return UCS_ERR_NO_MEMORY;
 
 out_ok:
+    mp->data->alloc_backing = chunk->backing;
     *size_p  = real_size - sizeof(*chunk);
     *chunk_p = chunk + 1;
     return UCS_OK;
@@ -333,9 +576,15 @@ void ucs_mpool_hugetlb_free(ucs_mpool_t *mp, void *chunk)
     ucs_hugetlb_mpool_chunk_hdr_t *hdr;
 
     hdr = (ucs_hugetlb_mpool_chunk_hdr_t*)chunk - 1;
-    if (hdr->hugetlb) {
+    switch (hdr->backing) {
+    case UCS_MPOOL_CHUNK_BACKING_HUGETLB:
         ucs_sysv_free(hdr);
-    } else {
+        break;
+    case UCS_MPOOL_CHUNK_BACKING_MMAP:
+        ucs_munmap(hdr, hdr->size);
+        break;
+    default:
         ucs_free(hdr);
+        break;
     }
 }
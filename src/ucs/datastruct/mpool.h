@@ -39,6 +39,21 @@ typedef struct ucs_mpool_ops     ucs_mpool_ops_t;
  */
 
 
+/**
+ * Type of memory which backs a memory pool chunk.
+ */
+typedef enum {
+    UCS_MPOOL_CHUNK_BACKING_HEAP,    /* Allocated by malloc() */
+    UCS_MPOOL_CHUNK_BACKING_MMAP,    /* Anonymous mmap() */
+    UCS_MPOOL_CHUNK_BACKING_HUGETLB, /* SysV shared memory on huge pages */
+    UCS_MPOOL_CHUNK_BACKING_OTHER,   /* Allocated by a user-defined allocator */
+    UCS_MPOOL_CHUNK_BACKING_LAST
+} ucs_mpool_chunk_backing_t;
+
+
+extern const char *ucs_mpool_chunk_backing_names[];
+
+
 /**
  * Memory pool element header.
  */
@@ -55,6 +70,8 @@ struct ucs_mpool_chunk {
     ucs_mpool_chunk_t      *next;      /* Next chunk */
     void                   *elems;     /* Array of elements */
     unsigned               num_elems;  /* How many elements */
+    unsigned               backing;    /* Backing memory type */
+    size_t                 size;       /* Allocated size */
 };
 
 
@@ -80,6 +97,16 @@ struct ucs_mpool_data {
     ucs_mpool_chunk_t      *chunks;         /* List of allocated chunks */
     ucs_mpool_ops_t        *ops;            /* Memory pool operations */
     char                   *name;           /* Name - used for debugging */
+    int                    numa_node;       /* NUMA node to allocate chunks on,
+                                               or -1 for no binding */
+    int                    numa_policy;     /* NUMA policy of chunks
+                                               (ucs_numa_policy_t) */
+    unsigned               alloc_backing;   /* Backing type of the chunk being
+                                               allocated, set by the built-in
+                                               chunk allocators */
+    size_t                 backing_size[UCS_MPOOL_CHUNK_BACKING_LAST];
+                                            /* Total size of allocated chunks
+                                               per backing type */
 };
 
 
@@ -226,6 +253,32 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems);
 void *ucs_mpool_get_grow(ucs_mpool_t *mp);
 
 
+/**
+ * Allocate chunks of the memory pool on a NUMA node. Applies to the mmap and
+ * hugetlb chunk allocators; chunks which were already allocated are not moved.
+ * @param mp               Memory pool structure.
+ * @param policy           NUMA policy (ucs_numa_policy_t), "default" disables
+ *                          the binding.
+ * @param node             NUMA node, or -1 to disable the binding.
+ */
+void ucs_mpool_set_numa_node(ucs_mpool_t *mp, int policy, int node);
+
+
+/**
+ * Release the chunks of the memory pool whose elements are all in the pool.
+ * @param mp               Memory pool structure.
+ * @return Number of released chunks.
+ */
+unsigned ucs_mpool_release_idle(ucs_mpool_t *mp);
+
+
+/**
+ * @param mp               Memory pool structure.
+ * @return Total size of the chunks allocated by the memory pool.
+ */
+size_t ucs_mpool_chunks_size(ucs_mpool_t *mp);
+
+
 /**
  * heap-based chunk allocator.
  */
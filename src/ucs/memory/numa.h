@@ -12,6 +12,7 @@
 #endif
 
 #include <ucs/debug/memtrack.h>
+#include <ucs/type/status.h>
 
 #if HAVE_NUMA
 #include <numaif.h>
@@ -62,4 +63,26 @@ extern const char *ucs_numa_policy_names[];
 int ucs_numa_node_of_cpu(int cpu);
 
 
+/**
+ * @return NUMA node of the CPU the calling thread is running on, or -1 if
+ *         NUMA is not supported.
+ */
+int ucs_numa_current_node(void);
+
+
+/**
+ * Set the NUMA memory policy of an address range. Must be called before the
+ * pages are touched for the first time.
+ *
+ * @param [in]  address    Start of the range, rounded down to page boundary.
+ * @param [in]  length     Length of the range, rounded up to page boundary.
+ * @param [in]  policy     Memory policy. UCS_NUMA_POLICY_DEFAULT does nothing.
+ * @param [in]  node       NUMA node to bind or prefer.
+ *
+ * @return UCS_OK, or UCS_ERR_UNSUPPORTED if NUMA is not supported.
+ */
+ucs_status_t ucs_numa_mem_bind(void *address, size_t length,
+                               ucs_numa_policy_t policy, int node);
+
+
 #endif
@@ -9,6 +9,8 @@
 #endif
 
 #include <ucs/arch/atomic.h>
+#include <ucs/arch/cpu.h>
+#include <ucs/async/async.h>
 #include <ucs/type/class.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/debug/log.h>
@@ -19,6 +21,8 @@
 #include <ucs/sys/sys.h>
 #include <ucs/type/spinlock.h>
 #include <ucm/api/ucm.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #include "rcache.h"
 #include "rcache_int.h"
@@ -72,12 +76,28 @@ typedef struct ucs_rcache_inv_entry {
 } ucs_rcache_inv_entry_t;
 
 
+typedef struct {
+    ucs_pgt_addr_t           start;
+    ucs_pgt_addr_t           end;
+} ucs_rcache_inv_range_t;
+
+
 typedef struct {
     ucs_rcache_t        *rcache;
     ucs_rcache_region_t *region;
 } ucs_rcache_region_validate_pfn_t;
 
 
+static struct {
+    pthread_once_t           once;       /* Create 'key' once */
+    pthread_key_t            key;        /* Per-thread reader slot index + 1 */
+    volatile uint32_t        next_index; /* Next reader slot index to assign */
+} ucs_rcache_readers = {
+    .once       = PTHREAD_ONCE_INIT,
+    .next_index = 0
+};
+
+
 #ifdef ENABLE_STATS
 static ucs_stats_class_t ucs_rcache_stats_class = {
     .name = "rcache",
@@ -93,6 +113,11 @@ static ucs_stats_class_t ucs_rcache_stats_class = {
         [UCS_RCACHE_PUTS]               = "puts",
         [UCS_RCACHE_REGS]               = "mem_regs",
         [UCS_RCACHE_DEREGS]             = "mem_deregs",
+        [UCS_RCACHE_EVICTS]             = "regions_evicted",
+        [UCS_RCACHE_INV_COALESCED]      = "inv_coalesced",
+        [UCS_RCACHE_INV_QUEUE_MAX]      = "inv_queue_max",
+        [UCS_RCACHE_INV_DRAINS_ASYNC]   = "inv_drains_async",
+        [UCS_RCACHE_INV_DRAIN_NSEC]     = "inv_drain_nsec",
     }
 };
 #endif
@@ -129,6 +154,128 @@ static void __ucs_rcache_region_log(const char *file, int line, const char *func
                      region_desc);
 }
 
+static void ucs_rcache_readers_key_create(void)
+{
+    pthread_key_create(&ucs_rcache_readers.key, NULL);
+}
+
+static UCS_F_ALWAYS_INLINE unsigned ucs_rcache_reader_slot_index(void)
+{
+    void *value = pthread_getspecific(ucs_rcache_readers.key);
+    unsigned index;
+
+    if (ucs_likely(value != NULL)) {
+        return (uintptr_t)value - 1;
+    }
+
+    /* First lookup from this thread - assign it a slot. If there are more
+     * threads than slots, some of them would share a slot. */
+    index = ucs_atomic_fadd32(&ucs_rcache_readers.next_index, 1) %
+            UCS_RCACHE_NUM_READER_SLOTS;
+    pthread_setspecific(ucs_rcache_readers.key, (void*)(uintptr_t)(index + 1));
+    return index;
+}
+
+/*
+ * Enter a lock-free page table lookup section. Returns NULL if the page table
+ * is being modified, and the caller has to take 'pgt_lock' for read instead.
+ */
+static UCS_F_ALWAYS_INLINE ucs_rcache_reader_slot_t *
+ucs_rcache_lookup_begin(ucs_rcache_t *rcache)
+{
+    ucs_rcache_reader_slot_t *slot;
+
+    slot = &rcache->readers[ucs_rcache_reader_slot_index()];
+    ucs_atomic_fadd32(&slot->count, 1);
+    /* Order the slot update with the following read of 'readers_blocked';
+     * paired with the fence in ucs_rcache_readers_block() */
+    ucs_memory_cpu_fence();
+    if (ucs_unlikely(rcache->readers_blocked)) {
+        ucs_atomic_fsub32(&slot->count, 1);
+        return NULL;
+    }
+
+    return slot;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucs_rcache_lookup_end(ucs_rcache_reader_slot_t *slot)
+{
+    /* Complete all page table reads before a writer is allowed to proceed */
+    ucs_memory_cpu_fence();
+    ucs_atomic_fsub32(&slot->count, 1);
+}
+
+static int ucs_rcache_readers_active(ucs_rcache_t *rcache)
+{
+    unsigned i, num_slots;
+
+    num_slots = ucs_min(ucs_rcache_readers.next_index,
+                        UCS_RCACHE_NUM_READER_SLOTS);
+    for (i = 0; i < num_slots; ++i) {
+        if (rcache->readers[i].count != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Lock must be held in write mode */
+static void ucs_rcache_readers_block(ucs_rcache_t *rcache)
+{
+    rcache->readers_blocked = 1;
+    ucs_memory_bus_fence();
+}
+
+static void ucs_rcache_readers_unblock(ucs_rcache_t *rcache)
+{
+    ucs_memory_cpu_store_fence();
+    rcache->readers_blocked = 0;
+}
+
+/*
+ * Take the page table lock for write, and wait for lock-free lookups to
+ * complete.
+ */
+static void ucs_rcache_pgt_wrlock(ucs_rcache_t *rcache)
+{
+    pthread_rwlock_wrlock(&rcache->pgt_lock);
+    ucs_rcache_readers_block(rcache);
+    while (ucs_rcache_readers_active(rcache)) {
+        ucs_memory_cpu_load_fence();
+    }
+}
+
+/*
+ * Try to take the page table lock for write. Does not wait for lock-free
+ * lookups, since it may be called from a memory event handler triggered by
+ * the thread which is doing the lookup.
+ *
+ * @return Nonzero if the lock was taken.
+ */
+static int ucs_rcache_pgt_trywrlock(ucs_rcache_t *rcache)
+{
+    if (pthread_rwlock_trywrlock(&rcache->pgt_lock)) {
+        return 0;
+    }
+
+    ucs_rcache_readers_block(rcache);
+    if (ucs_rcache_readers_active(rcache)) {
+        ucs_rcache_readers_unblock(rcache);
+        pthread_rwlock_unlock(&rcache->pgt_lock);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void ucs_rcache_pgt_wrunlock(ucs_rcache_t *rcache)
+{
+    ucs_rcache_readers_unblock(rcache);
+    pthread_rwlock_unlock(&rcache->pgt_lock);
+}
+
 static ucs_pgt_dir_t *ucs_rcache_pgt_dir_alloc(const ucs_pgtable_t *pgtable)
 {
     ucs_rcache_t *rcache = ucs_container_of(pgtable, ucs_rcache_t, pgtable);
@@ -228,7 +375,7 @@ static void ucs_rcache_region_validate_pfn_cb(unsigned page_num,
                             pfn);
 }
 
-/* Lock must be held for read */
+/* Region must be held, or page table lock must be held for read */
 static void ucs_rcache_region_validate_pfn(ucs_rcache_t *rcache,
                                            ucs_rcache_region_t *region)
 {
@@ -285,6 +432,35 @@ static void ucs_rcache_find_regions(ucs_rcache_t *rcache, ucs_pgt_addr_t from,
                              ucs_rcache_region_collect_callback, list);
 }
 
+/* Lock must be held in write mode */
+static void ucs_rcache_region_pgt_added(ucs_rcache_t *rcache,
+                                        ucs_rcache_region_t *region)
+{
+    /* Memory events for the region must be delivered from now on, before it
+     * is registered */
+    ucm_event_filter_add((void*)region->super.start,
+                         region->super.end - region->super.start);
+    region->flags       |= UCS_RCACHE_REGION_FLAG_PGTABLE;
+    rcache->total_size  += region->super.end - region->super.start;
+    ++rcache->num_regions;
+    ucs_list_add_tail(&rcache->lru.list, &region->lru_list);
+    ++rcache->lru.count;
+}
+
+/* Lock must be held in write mode */
+static void ucs_rcache_region_pgt_removed(ucs_rcache_t *rcache,
+                                          ucs_rcache_region_t *region)
+{
+    ucs_assert(rcache->num_regions > 0);
+    region->flags       &= ~UCS_RCACHE_REGION_FLAG_PGTABLE;
+    rcache->total_size  -= region->super.end - region->super.start;
+    --rcache->num_regions;
+    ucs_list_del(&region->lru_list);
+    --rcache->lru.count;
+    ucm_event_filter_remove((void*)region->super.start,
+                            region->super.end - region->super.start);
+}
+
 /* Lock must be held in write mode */
 static void ucs_mem_region_destroy_internal(ucs_rcache_t *rcache,
                                             ucs_rcache_region_t *region)
@@ -332,13 +508,13 @@ static inline void ucs_rcache_region_put_internal(ucs_rcache_t *rcache,
 
     /* Destroy region and de-register memory */
     if (flags & UCS_RCACHE_REGION_PUT_FLAG_TAKE_PGLOCK) {
-        pthread_rwlock_wrlock(&rcache->pgt_lock);
+        ucs_rcache_pgt_wrlock(rcache);
     }
 
     ucs_mem_region_destroy_internal(rcache, region);
 
     if (flags & UCS_RCACHE_REGION_PUT_FLAG_TAKE_PGLOCK) {
-        pthread_rwlock_unlock(&rcache->pgt_lock);
+        ucs_rcache_pgt_wrunlock(rcache);
     }
 }
 
@@ -360,7 +536,7 @@ static void ucs_rcache_region_invalidate(ucs_rcache_t *rcache,
             ucs_rcache_region_warn(rcache, region, "failed to remove (%s)",
                                    ucs_status_string(status));
         }
-        region->flags &= ~UCS_RCACHE_REGION_FLAG_PGTABLE;
+        ucs_rcache_region_pgt_removed(rcache, region);
     } else {
         ucs_assert(!(flags & UCS_RCACHE_REGION_PUT_FLAG_IN_PGTABLE));
     }
@@ -386,17 +562,68 @@ static void ucs_rcache_invalidate_range(ucs_rcache_t *rcache, ucs_pgt_addr_t sta
     }
 }
 
+/*
+ * Sort the ranges by start address and merge the overlapping and adjacent ones.
+ * The batch is small and mostly ordered, so insertion sort is good enough.
+ * Returns the number of ranges after merging.
+ */
+static unsigned ucs_rcache_inv_ranges_merge(ucs_rcache_inv_range_t *ranges,
+                                            unsigned count)
+{
+    ucs_rcache_inv_range_t range;
+    unsigned i, j, num_merged;
+
+    for (i = 1; i < count; ++i) {
+        range = ranges[i];
+        for (j = i; (j > 0) && (ranges[j - 1].start > range.start); --j) {
+            ranges[j] = ranges[j - 1];
+        }
+        ranges[j] = range;
+    }
+
+    num_merged = 0;
+    for (i = 1; i < count; ++i) {
+        if (ranges[i].start <= ranges[num_merged].end) {
+            ranges[num_merged].end = ucs_max(ranges[num_merged].end,
+                                             ranges[i].end);
+        } else {
+            ranges[++num_merged] = ranges[i];
+        }
+    }
+
+    return num_merged + 1;
+}
+
 /* Lock must be held in write mode */
 static void ucs_rcache_check_inv_queue(ucs_rcache_t *rcache, unsigned flags)
 {
+    ucs_rcache_inv_range_t ranges[UCS_RCACHE_INV_BATCH_SIZE];
     ucs_rcache_inv_entry_t *entry;
+    unsigned i, count, num_ranges;
+    ucs_time_t UCS_V_UNUSED start_time;
 
     ucs_trace_func("rcache=%s", rcache->name);
 
+    if (ucs_queue_is_empty(&rcache->inv_q)) {
+        return;
+    }
+
+    UCS_STATS_START_TIME(start_time);
+
     ucs_spin_lock(&rcache->lock);
     while (!ucs_queue_is_empty(&rcache->inv_q)) {
-        entry = ucs_queue_pull_elem_non_empty(&rcache->inv_q,
-                                              ucs_rcache_inv_entry_t, queue);
+        count = 0;
+        do {
+            entry = ucs_queue_pull_elem_non_empty(&rcache->inv_q,
+                                                  ucs_rcache_inv_entry_t,
+                                                  queue);
+            ranges[count].start = entry->start;
+            ranges[count].end   = entry->end;
+            ucs_mpool_put(entry); /* Must be done with the lock held */
+            ++count;
+        } while (!ucs_queue_is_empty(&rcache->inv_q) &&
+                 (count < UCS_RCACHE_INV_BATCH_SIZE));
+        rcache->inv_q_length -= count;
 
         /* We need to drop the lock since the following code may trigger memory
          * operations, which could trigger vm_unmapped event which also takes
@@ -404,13 +631,19 @@ static void ucs_rcache_check_inv_queue(ucs_rcache_t *rcache, unsigned flags)
          */
         ucs_spin_unlock(&rcache->lock);
 
-        ucs_rcache_invalidate_range(rcache, entry->start, entry->end, flags);
+        num_ranges = ucs_rcache_inv_ranges_merge(ranges, count);
+        UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_INV_COALESCED,
+                                 count - num_ranges);
+        for (i = 0; i < num_ranges; ++i) {
+            ucs_rcache_invalidate_range(rcache, ranges[i].start,
+                                        ranges[i].end, flags);
+        }
 
         ucs_spin_lock(&rcache->lock);
-
-        ucs_mpool_put(entry); /* Must be done with the lock held */
     }
     ucs_spin_unlock(&rcache->lock);
+
+    UCS_STATS_UPDATE_TIME(rcache->stats, UCS_RCACHE_INV_DRAIN_NSEC, start_time);
 }
 
 /* Lock must be held in write mode */
@@ -438,12 +671,29 @@ static void ucs_rcache_check_gc_list(ucs_rcache_t *rcache)
     ucs_spin_unlock(&rcache->lock);
 }
 
+static void ucs_rcache_inv_drain_signal(ucs_rcache_t *rcache)
+{
+    uint64_t dummy = 1;
+    int ret;
+
+    do {
+        ret = write(rcache->inv_drain_fd, &dummy, sizeof(dummy));
+    } while ((ret == -1) && (errno == EINTR));
+
+    /* EAGAIN means the counter is saturated, so it was signaled anyway */
+    if ((ret == -1) && (errno != EAGAIN)) {
+        ucs_warn("%s: failed to signal invalidation queue drain: %m",
+                 rcache->name);
+    }
+}
+
 static void ucs_rcache_unmapped_callback(ucm_event_type_t event_type,
                                          ucm_event_t *event, void *arg)
 {
     ucs_rcache_t *rcache = arg;
     ucs_rcache_inv_entry_t *entry;
     ucs_pgt_addr_t start, end;
+    int signal_drain;
 
     ucs_assert(event_type == UCM_EVENT_VM_UNMAPPED ||
                event_type == UCM_EVENT_MEM_TYPE_FREE);
@@ -466,28 +716,129 @@ static void ucs_rcache_unmapped_callback(ucm_event_type_t event_type,
      * This way we avoid queuing endless events on the invalidation queue when
      * no rcache operations are performed to clean it.
      */
-    if (!pthread_rwlock_trywrlock(&rcache->pgt_lock)) {
+    if (ucs_rcache_pgt_trywrlock(rcache)) {
         ucs_rcache_invalidate_range(rcache, start, end,
                                     UCS_RCACHE_REGION_PUT_FLAG_ADD_TO_GC);
         UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_UNMAPS, 1);
         ucs_rcache_check_inv_queue(rcache, UCS_RCACHE_REGION_PUT_FLAG_ADD_TO_GC);
-        pthread_rwlock_unlock(&rcache->pgt_lock);
+        ucs_rcache_pgt_wrunlock(rcache);
         return;
     }
 
-    /* Could not lock - add region to invalidation queue */
+    /* Could not lock - add region to invalidation queue. Unmapping a large
+     * buffer piece by piece generates adjacent ranges, so extend the last
+     * queued range if possible. */
     ucs_spin_lock(&rcache->lock);
+    UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_UNMAPS, 1);
+    if (!ucs_queue_is_empty(&rcache->inv_q)) {
+        entry = ucs_queue_tail_elem_non_empty(&rcache->inv_q,
+                                              ucs_rcache_inv_entry_t, queue);
+        if ((start <= entry->end) && (end >= entry->start)) {
+            entry->start = ucs_min(entry->start, start);
+            entry->end   = ucs_max(entry->end, end);
+            UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_INV_COALESCED,
+                                     1);
+            ucs_spin_unlock(&rcache->lock);
+            return;
+        }
+    }
+
     entry = ucs_mpool_get(&rcache->mp);
-    if (entry != NULL) {
-        entry->start = start;
-        entry->end   = end;
-        ucs_queue_push(&rcache->inv_q, &entry->queue);
-        UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_UNMAPS, 1);
-    } else {
+    if (entry == NULL) {
+        ucs_spin_unlock(&rcache->lock);
         ucs_error("Failed to allocate invalidation entry for 0x%lx..0x%lx, "
                   "data corruption may occur", start, end);
+        return;
+    }
+
+    entry->start = start;
+    entry->end   = end;
+    ucs_queue_push(&rcache->inv_q, &entry->queue);
+    ++rcache->inv_q_length;
+    UCS_STATS_UPDATE_MAX(rcache->stats, UCS_RCACHE_INV_QUEUE_MAX,
+                         rcache->inv_q_length);
+
+    /* Too many pending ranges hold memory and slow down the next cache
+     * operation - let the async thread drain the queue */
+    signal_drain = (rcache->inv_drain_fd != -1) &&
+                   !rcache->inv_drain_signaled &&
+                   (rcache->inv_q_length >=
+                    ucs_global_opts.rcache_inv_drain_thresh);
+    if (signal_drain) {
+        rcache->inv_drain_signaled = 1;
     }
     ucs_spin_unlock(&rcache->lock);
+
+    if (signal_drain) {
+        ucs_rcache_inv_drain_signal(rcache);
+    }
+}
+
+static void ucs_rcache_inv_drain_handler(int id, int events, void *arg)
+{
+    ucs_rcache_t *rcache = arg;
+    uint64_t dummy;
+    int ret;
+
+    do {
+        ret = read(rcache->inv_drain_fd, &dummy, sizeof(dummy));
+    } while ((ret == -1) && (errno == EINTR));
+
+    ucs_spin_lock(&rcache->lock);
+    rcache->inv_drain_signaled = 0;
+    ucs_spin_unlock(&rcache->lock);
+
+    ucs_trace("%s: draining invalidation queue", rcache->name);
+
+    ucs_rcache_pgt_wrlock(rcache);
+    ucs_rcache_check_inv_queue(rcache, 0);
+    ucs_rcache_check_gc_list(rcache);
+    ucs_rcache_pgt_wrunlock(rcache);
+
+    UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_INV_DRAINS_ASYNC, 1);
+}
+
+static void ucs_rcache_inv_drain_init(ucs_rcache_t *rcache)
+{
+    ucs_status_t status;
+
+    rcache->inv_drain_fd       = -1;
+    rcache->inv_drain_signaled = 0;
+
+    if ((ucs_global_opts.rcache_inv_drain_thresh == 0) ||
+        !(rcache->params.ucm_events & UCM_EVENT_VM_UNMAPPED)) {
+        return;
+    }
+
+    rcache->inv_drain_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (rcache->inv_drain_fd == -1) {
+        ucs_debug("%s: eventfd() failed: %m, invalidation queue will not be "
+                  "drained asynchronously", rcache->name);
+        return;
+    }
+
+    status = ucs_async_set_event_handler(UCS_ASYNC_THREAD_LOCK_TYPE,
+                                         rcache->inv_drain_fd,
+                                         UCS_EVENT_SET_EVREAD,
+                                         ucs_rcache_inv_drain_handler, rcache,
+                                         NULL);
+    if (status != UCS_OK) {
+        ucs_debug("%s: failed to set invalidation queue drain handler: %s",
+                  rcache->name, ucs_status_string(status));
+        close(rcache->inv_drain_fd);
+        rcache->inv_drain_fd = -1;
+    }
+}
+
+static void ucs_rcache_inv_drain_cleanup(ucs_rcache_t *rcache)
+{
+    if (rcache->inv_drain_fd == -1) {
+        return;
+    }
+
+    ucs_async_remove_handler(rcache->inv_drain_fd, 1);
+    close(rcache->inv_drain_fd);
+    rcache->inv_drain_fd = -1;
 }
 
 /* Clear all regions
@@ -505,7 +856,7 @@ static void ucs_rcache_purge(ucs_rcache_t *rcache)
                       &region_list);
     ucs_list_for_each_safe(region, tmp, &region_list, list) {
         if (region->flags & UCS_RCACHE_REGION_FLAG_PGTABLE) {
-            region->flags &= ~UCS_RCACHE_REGION_FLAG_PGTABLE;
+            ucs_rcache_region_pgt_removed(rcache, region);
             ucs_atomic_add32(&region->refcount, (uint32_t)-1);
         }
         if (region->refcount > 0) {
@@ -638,11 +989,68 @@ static ucs_status_t ucs_rcache_fill_pfn(ucs_rcache_region_t *region)
                              ucs_rcache_region_pfn_ptr(region));
     if (status != UCS_OK) {
         ucs_free(ucs_rcache_region_pfn_ptr(region));
+        ucs_rcache_region_pfn_ptr(region) = NULL;
     }
 
     return status;
 }
 
+static int ucs_rcache_is_over_limit(ucs_rcache_t *rcache)
+{
+    return (rcache->num_regions > rcache->params.max_regions) ||
+           (rcache->total_size > rcache->params.max_size);
+}
+
+/*
+ * Evict unused regions until the cache is within its limits, using the
+ * second-chance (clock) approximation of LRU: recently used regions and
+ * regions which are in use are moved to the tail of the list.
+ *
+ * Lock must be held in write mode.
+ */
+static void ucs_rcache_lru_evict(ucs_rcache_t *rcache)
+{
+    unsigned num_evicted, num_skipped;
+    ucs_rcache_region_t *region;
+    unsigned long num_scan;
+
+    num_evicted = 0;
+    num_skipped = 0;
+    num_scan    = 2 * rcache->lru.count;
+
+    while ((num_scan-- > 0) && !ucs_list_is_empty(&rcache->lru.list) &&
+           ucs_rcache_is_over_limit(rcache)) {
+        region = ucs_list_head(&rcache->lru.list, ucs_rcache_region_t,
+                               lru_list);
+        ucs_assert(region->flags & UCS_RCACHE_REGION_FLAG_PGTABLE);
+
+        if ((region->refcount > 1) ||
+            (region->lru_flags & UCS_RCACHE_LRU_FLAG_RECENTLY_USED)) {
+            region->lru_flags &= ~UCS_RCACHE_LRU_FLAG_RECENTLY_USED;
+            ucs_list_del(&region->lru_list);
+            ucs_list_add_tail(&rcache->lru.list, &region->lru_list);
+            ++num_skipped;
+            continue;
+        }
+
+        /* The only reference is held by the page table, so the region is
+         * destroyed immediately */
+        ucs_rcache_region_trace(rcache, region, "evict");
+        ucs_rcache_region_invalidate(rcache, region,
+                                     UCS_RCACHE_REGION_PUT_FLAG_IN_PGTABLE |
+                                     UCS_RCACHE_REGION_PUT_FLAG_MUST_DESTROY);
+        ++num_evicted;
+    }
+
+    UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_EVICTS, num_evicted);
+
+    if (num_evicted || num_skipped) {
+        ucs_debug("%s: evicted %u regions, skipped %u, now %lu regions, "
+                  "total size %zu", rcache->name, num_evicted, num_skipped,
+                  rcache->num_regions, rcache->total_size);
+    }
+}
+
 static ucs_status_t
 ucs_rcache_create_region(ucs_rcache_t *rcache, void *address, size_t length,
                          int prot, void *arg, ucs_rcache_region_t **region_p)
@@ -655,7 +1063,7 @@ ucs_rcache_create_region(ucs_rcache_t *rcache, void *address, size_t length,
     ucs_trace_func("rcache=%s, address=%p, length=%zu", rcache->name, address,
                    length);
 
-    pthread_rwlock_wrlock(&rcache->pgt_lock);
+    ucs_rcache_pgt_wrlock(rcache);
 
 retry:
     /* Align to page size */
@@ -713,8 +1121,8 @@ retry:
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_REGS, 1);
 
     region->prot     = prot;
-    region->flags    = UCS_RCACHE_REGION_FLAG_PGTABLE;
     region->refcount = 1;
+    ucs_rcache_region_pgt_added(rcache, region);
     region->status = status =
         UCS_PROFILE_NAMED_CALL("mem_reg", rcache->params.ops->mem_reg,
                                rcache->params.context, rcache, arg, region,
@@ -747,7 +1155,12 @@ retry:
         status = ucs_rcache_fill_pfn(region);
         if (status != UCS_OK) {
             ucs_error("failed to allocate pfn list");
-            ucs_free(region);
+            /* Drop the user reference and remove the region from the page
+             * table, which also deregisters it */
+            region->refcount = 1;
+            ucs_rcache_region_invalidate(rcache, region,
+                                         UCS_RCACHE_REGION_PUT_FLAG_IN_PGTABLE |
+                                         UCS_RCACHE_REGION_PUT_FLAG_MUST_DESTROY);
             goto out_unlock;
         }
     }
@@ -756,10 +1169,12 @@ retry:
 
     ucs_rcache_region_trace(rcache, region, "created");
 
+    ucs_rcache_lru_evict(rcache);
+
 out_set_region:
     *region_p = region;
 out_unlock:
-    pthread_rwlock_unlock(&rcache->pgt_lock);
+    ucs_rcache_pgt_wrunlock(rcache);
     return status;
 }
 
@@ -769,36 +1184,69 @@ void ucs_rcache_region_hold(ucs_rcache_t *rcache, ucs_rcache_region_t *region)
     ucs_rcache_region_trace(rcache, region, "hold");
 }
 
+/* Page table must be protected from modifications */
+static UCS_F_ALWAYS_INLINE ucs_rcache_region_t *
+ucs_rcache_lookup(ucs_rcache_t *rcache, ucs_pgt_addr_t start, size_t length,
+                  int prot)
+{
+    ucs_pgt_region_t *pgt_region;
+    ucs_rcache_region_t *region;
+
+    if (!ucs_queue_is_empty(&rcache->inv_q)) {
+        return NULL;
+    }
+
+    pgt_region = UCS_PROFILE_CALL(ucs_pgtable_lookup, &rcache->pgtable, start);
+    if (ucs_unlikely(pgt_region == NULL)) {
+        return NULL;
+    }
+
+    region = ucs_derived_of(pgt_region, ucs_rcache_region_t);
+    if (((start + length) > region->super.end) ||
+        !ucs_rcache_region_test(region, prot)) {
+        return NULL;
+    }
+
+    if (!(region->lru_flags & UCS_RCACHE_LRU_FLAG_RECENTLY_USED)) {
+        region->lru_flags |= UCS_RCACHE_LRU_FLAG_RECENTLY_USED;
+    }
+
+    ucs_rcache_region_hold(rcache, region);
+    return region;
+}
+
 ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
                             int prot, void *arg, ucs_rcache_region_t **region_p)
 {
     ucs_pgt_addr_t start = (uintptr_t)address;
-    ucs_pgt_region_t *pgt_region;
+    ucs_rcache_reader_slot_t *slot;
     ucs_rcache_region_t *region;
 
     ucs_trace_func("rcache=%s, address=%p, length=%zu", rcache->name, address,
                    length);
 
-    pthread_rwlock_rdlock(&rcache->pgt_lock);
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_GETS, 1);
-    if (ucs_queue_is_empty(&rcache->inv_q)) {
-        pgt_region = UCS_PROFILE_CALL(ucs_pgtable_lookup, &rcache->pgtable,
-                                      start);
-        if (ucs_likely(pgt_region != NULL)) {
-            region = ucs_derived_of(pgt_region, ucs_rcache_region_t);
-            if (((start + length) <= region->super.end) &&
-                ucs_rcache_region_test(region, prot))
-            {
-                ucs_rcache_region_hold(rcache, region);
-                ucs_rcache_region_validate_pfn(rcache, region);
-                *region_p = region;
-                UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_HITS_FAST, 1);
-                pthread_rwlock_unlock(&rcache->pgt_lock);
-                return UCS_OK;
-            }
-        }
+
+    /* Lock-free lookup, unless the page table is being modified. Regions can
+     * be destroyed only when the page table lock is held for write, so the
+     * region stays valid until we take a reference on it. */
+    slot = ucs_rcache_lookup_begin(rcache);
+    if (ucs_likely(slot != NULL)) {
+        region = ucs_rcache_lookup(rcache, start, length, prot);
+        ucs_rcache_lookup_end(slot);
+    } else {
+        pthread_rwlock_rdlock(&rcache->pgt_lock);
+        region = ucs_rcache_lookup(rcache, start, length, prot);
+        pthread_rwlock_unlock(&rcache->pgt_lock);
+    }
+
+    if (ucs_likely(region != NULL)) {
+        /* The region is held, so it's safe to use it without the lock */
+        ucs_rcache_region_validate_pfn(rcache, region);
+        *region_p = region;
+        UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_HITS_FAST, 1);
+        return UCS_OK;
     }
-    pthread_rwlock_unlock(&rcache->pgt_lock);
 
     /* Fall back to slow version (with rw lock) in following cases:
      * - invalidation list not empty
@@ -821,13 +1269,15 @@ static UCS_CLASS_INIT_FUNC(ucs_rcache_t, const ucs_rcache_params_t *params,
 {
     ucs_status_t status, spinlock_status;
     size_t mp_obj_size, mp_align;
-    int ret;
+    int ucm_events, ret;
 
     if (params->region_struct_size < sizeof(ucs_rcache_region_t)) {
         status = UCS_ERR_INVALID_PARAM;
         goto err;
     }
 
+    pthread_once(&ucs_rcache_readers.once, ucs_rcache_readers_key_create);
+
     if (!ucs_is_pow2(params->alignment) ||
         (params->alignment < UCS_PGT_ADDR_ALIGN) ||
         (params->alignment > params->max_alignment))
@@ -881,15 +1331,34 @@ static UCS_CLASS_INIT_FUNC(ucs_rcache_t, const ucs_rcache_params_t *params,
 
     ucs_queue_head_init(&self->inv_q);
     ucs_list_head_init(&self->gc_list);
+    self->inv_q_length = 0;
+    ucs_list_head_init(&self->lru.list);
+    memset(self->readers, 0, sizeof(self->readers));
+    self->readers_blocked = 0;
+    self->lru.count   = 0;
+    self->num_regions = 0;
+    self->total_size  = 0;
+
+    /* Unmap events are needed only for ranges with regions in the page table,
+     * which are added to the memory events filter */
+    ucm_events = params->ucm_events;
+    if (ucm_events & UCM_EVENT_VM_UNMAPPED) {
+        ucm_events |= UCM_EVENT_FLAG_ADDR_FILTER;
+    }
+
+    /* Must be set up before memory events can queue invalidations */
+    ucs_rcache_inv_drain_init(self);
 
-    status = ucm_set_event_handler(params->ucm_events, params->ucm_event_priority,
+    status = ucm_set_event_handler(ucm_events, params->ucm_event_priority,
                                    ucs_rcache_unmapped_callback, self);
     if (status != UCS_OK) {
-        goto err_destroy_mp;
+        goto err_cleanup_inv_drain;
     }
 
     return UCS_OK;
 
+err_cleanup_inv_drain:
+    ucs_rcache_inv_drain_cleanup(self);
 err_destroy_mp:
     ucs_mpool_cleanup(&self->mp, 1);
 err_cleanup_pgtable:
@@ -915,6 +1384,7 @@ static UCS_CLASS_CLEANUP_FUNC(ucs_rcache_t)
 
     ucm_unset_event_handler(self->params.ucm_events, ucs_rcache_unmapped_callback,
                             self);
+    ucs_rcache_inv_drain_cleanup(self);
     ucs_rcache_check_inv_queue(self, 0);
     ucs_rcache_check_gc_list(self);
     ucs_rcache_purge(self);
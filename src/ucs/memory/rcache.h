@@ -39,6 +39,14 @@ enum {
     UCS_RCACHE_REGION_FLAG_PGTABLE    = UCS_BIT(1)  /**< In the page table */
 };
 
+/*
+ * Memory region LRU flags.
+ */
+enum {
+    UCS_RCACHE_LRU_FLAG_RECENTLY_USED = UCS_BIT(0) /**< Found by a lookup since
+                                                        the last eviction scan */
+};
+
 /*
  * Memory registration flags.
  */
@@ -121,16 +129,25 @@ struct ucs_rcache_params {
     void                   *context;            /**< User-defined context that will
                                                      be passed to mem_reg/mem_dereg */
     int                    flags;               /**< Flags */
+    unsigned long          max_regions;         /**< Maximal number of regions
+                                                     to keep in the cache. Once
+                                                     exceeded, least recently
+                                                     used unreferenced regions
+                                                     are evicted. */
+    size_t                 max_size;            /**< Maximal total size of
+                                                     registered regions */
 };
 
 
 struct ucs_rcache_region {
     ucs_pgt_region_t       super;    /**< Base class - page table region */
     ucs_list_link_t        list;     /**< List element */
+    ucs_list_link_t        lru_list; /**< LRU list element */
     volatile uint32_t      refcount; /**< Reference count, including +1 if it's
                                           in the page table */
     ucs_status_t           status;   /**< Current status code */
     uint8_t                prot;     /**< Protection bits */
+    uint8_t                lru_flags; /**< LRU flags */
     uint16_t               flags;    /**< Status flags. Protected by page table lock. */
     union {
         uint64_t           priv;     /**< Used internally */
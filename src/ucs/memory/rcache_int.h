@@ -8,6 +8,16 @@
 #define UCS_REG_CACHE_INT_H_
 
 #include <ucs/type/spinlock.h>
+#include <ucs/arch/cpu.h>
+#include <ucs/sys/compiler.h>
+
+
+/* Number of slots for threads doing lock-free page table lookups */
+#define UCS_RCACHE_NUM_READER_SLOTS    64
+
+/* Maximal number of pending invalidation ranges which are sorted and merged
+ * together before looking them up in the page table */
+#define UCS_RCACHE_INV_BATCH_SIZE      64
 
 
 /* Names of rcache stats counters */
@@ -23,19 +33,50 @@ enum {
     UCS_RCACHE_PUTS,                /* number of put operations */
     UCS_RCACHE_REGS,                /* number of memory registrations */
     UCS_RCACHE_DEREGS,              /* number of memory deregistrations */
+    UCS_RCACHE_EVICTS,              /* number of regions evicted from the
+                                       LRU list because of cache limits */
+    UCS_RCACHE_INV_COALESCED,       /* number of pending invalidation ranges
+                                       merged into another pending range */
+    UCS_RCACHE_INV_QUEUE_MAX,       /* maximal invalidation queue length */
+    UCS_RCACHE_INV_DRAINS_ASYNC,    /* number of times the invalidation queue
+                                       was drained by the async thread */
+    UCS_RCACHE_INV_DRAIN_NSEC,      /* time spent draining the invalidation
+                                       queue */
     UCS_RCACHE_STAT_LAST
 };
 
 
+/*
+ * Counter of threads which are currently doing a lock-free lookup. Every slot
+ * resides on a separate cache line, so lookups from different threads do not
+ * write to a shared cache line.
+ */
+typedef struct ucs_rcache_reader_slot {
+    volatile uint32_t        count;
+    UCS_CACHELINE_PADDING(uint32_t);
+} ucs_rcache_reader_slot_t;
+
+
 struct ucs_rcache {
     ucs_rcache_params_t      params;   /**< rcache parameters (immutable) */
 
     pthread_rwlock_t         pgt_lock; /**< Protects the page table and all
-                                            regions whose refcount is 0 */
+                                            regions whose refcount is 0.
+                                            Lookups take it for read only if
+                                            the page table is being modified;
+                                            otherwise they are tracked by
+                                            'readers' slots. */
     ucs_pgtable_t            pgtable;  /**< page table to hold the regions */
 
+    volatile int             readers_blocked; /**< Set while 'pgt_lock' is
+                                                   held for write, forcing
+                                                   lookups to take the lock */
+    ucs_rcache_reader_slot_t readers[UCS_RCACHE_NUM_READER_SLOTS];
+                                       /**< Lock-free lookups in progress */
+
 
-    ucs_spinlock_t           lock;     /**< Protects 'mp', 'inv_q' and 'gc_list'.
+    ucs_spinlock_t           lock;     /**< Protects 'mp', 'inv_q', 'gc_list'
+                                            and the related counters.
                                             This is a separate lock because we
                                             may want to invalidate regions
                                             while the page table lock is held by
@@ -49,9 +90,33 @@ struct ucs_rcache {
                                             which does not generate memory events */
     ucs_queue_head_t         inv_q;    /**< Regions which were invalidated during
                                             memory events */
+    unsigned long            inv_q_length; /**< Number of entries in 'inv_q' */
+    int                      inv_drain_fd; /**< Event fd to wake up the async
+                                                thread to drain 'inv_q', or
+                                                -1 if disabled */
+    int                      inv_drain_signaled; /**< Whether 'inv_drain_fd'
+                                                      was signaled and not
+                                                      handled yet */
     ucs_list_link_t          gc_list;  /**< list for regions to destroy, regions
                                             could not be destroyed from memhook */
 
+    unsigned long            num_regions; /**< Total number of regions in the
+                                               page table. Protected by
+                                               'pgt_lock'. */
+    size_t                   total_size;  /**< Total size of regions in the
+                                               page table. Protected by
+                                               'pgt_lock'. */
+
+    struct {
+        ucs_list_link_t      list;     /**< All regions in the page table, in
+                                            eviction order. Lookups only mark
+                                            the region as recently used, and
+                                            eviction gives such regions a
+                                            second chance. Protected by
+                                            'pgt_lock'. */
+        unsigned long        count;    /**< Number of regions on the list */
+    } lru;
+
     char                     *name;    /**< Name of the cache, for debug purpose */
     UCS_STATS_NODE_DECLARE(stats)
 };
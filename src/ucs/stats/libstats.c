@@ -63,6 +63,9 @@ ucs_status_t ucs_stats_node_initv(ucs_stats_node_t *node, ucs_stats_class_t *cls
     ucs_list_head_init(&node->children[UCS_STATS_INACTIVE_CHILDREN]);
     ucs_list_head_init(&node->children[UCS_STATS_ACTIVE_CHILDREN]);
     memset(node->counters, 0, cls->num_counters * sizeof(ucs_stats_counter_t));
+    node->shards       = node->counters;
+    node->shard_stride = 0;
+    node->shm_index    = -1;
 
     return UCS_OK;
 }
@@ -127,7 +127,14 @@ struct ucs_stats_node {
     ucs_list_link_t          type_list;          /* nodes with same class/es
                                                     hierarchy */
     ucs_stats_filter_node_t  *filter_node;       /* ptr to type list head */
-    ucs_stats_counter_t      counters[1];        /* instance counters */
+    ucs_stats_counter_t      *shards;            /* counters of shard 0 */
+    size_t                   shard_stride;       /* distance between the
+                                                    counters of consecutive
+                                                    shards, 0 if not sharded */
+    int                      shm_index;          /* entry in the counters
+                                                    region, or -1 */
+    ucs_stats_counter_t      counters[1];        /* instance counters, or sum
+                                                    of the shards when reported */
 };
 
 struct ucs_stats_filter_node {
@@ -458,6 +458,9 @@ ucs_stats_deserialize_recurs(FILE *stream, ucs_stats_class_t **classes,
     node->name[namelen] = '\0';
     ucs_list_head_init(&node->children[UCS_STATS_INACTIVE_CHILDREN]);
     ucs_list_head_init(&node->children[UCS_STATS_ACTIVE_CHILDREN]);
+    node->shards       = node->counters;
+    node->shard_stride = 0;
+    node->shm_index    = -1;
 
     /* Read counters */
     ucs_stats_read_counters(node->counters, cls->num_counters, stream);
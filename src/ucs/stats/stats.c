@@ -9,6 +9,7 @@
 #endif
 
 #include "stats.h"
+#include "stats_shm.h"
 
 #include <ucs/debug/log.h>
 #include <ucs/time/time.h>
@@ -16,9 +17,14 @@
 #include <ucs/config/parser.h>
 #include <ucs/type/status.h>
 #include <ucs/sys/sys.h>
+#include <ucs/sys/string.h>
 #include <ucs/datastruct/khash.h>
+#include <ucs/arch/atomic.h>
+#include <ucs/debug/memtrack.h>
 
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #ifdef HAVE_LINUX_FUTEX_H
 #include <linux/futex.h>
 #endif
@@ -41,8 +47,13 @@ enum {
     UCS_STATS_FLAG_STREAM         = UCS_BIT(9),
     UCS_STATS_FLAG_STREAM_CLOSE   = UCS_BIT(10),
     UCS_STATS_FLAG_STREAM_BINARY  = UCS_BIT(11),
+    UCS_STATS_FLAG_SHM            = UCS_BIT(12),
 };
 
+/* Counter ranges of released node table entries are reused only by nodes with
+ * the same number of counters, up to this size */
+#define UCS_STATS_REGION_REUSE_MAX  64
+
 enum {
     UCS_ROOT_STATS_RUNTIME,
     UCS_ROOT_STATS_LAST
@@ -75,6 +86,16 @@ typedef struct {
     pthread_cond_t       cv;
 #endif
     pthread_t            thread;
+
+    /* Sharded counters region */
+    struct {
+        ucs_stats_shm_header_t *hdr;
+        uint32_t         num_counters;   /* Counter slots in use */
+        uint32_t         num_threads;    /* Threads which were given a shard */
+        uint32_t         *next_free;     /* Free lists of node table entries */
+        uint32_t         free_head[UCS_STATS_REGION_REUSE_MAX + 1];
+        char             shm_name[UCS_STATS_SHM_NAME_LEN];
+    } region;
 } ucs_stats_context_t;
 
 static ucs_stats_context_t ucs_stats_context = {
@@ -85,9 +106,14 @@ static ucs_stats_context_t ucs_stats_context = {
 #ifndef HAVE_LINUX_FUTEX_H
     .cv               = PTHREAD_COND_INITIALIZER,
 #endif
-    .thread           = (pthread_t)-1
+    .thread           = (pthread_t)-1,
+    .region           = {
+        .hdr          = NULL
+    }
 };
 
+pthread_key_t ucs_stats_shard_key;
+
 static ucs_stats_class_t ucs_stats_root_node_class = {
     .name          = "",
     .num_counters  = UCS_ROOT_STATS_LAST,
@@ -106,6 +132,320 @@ ucs_sys_futex(volatile void *addr1, int op, int val1, struct timespec *timeout,
 }
 #endif
 
+static void ucs_stats_region_init()
+{
+    unsigned num_shards   = ucs_max(ucs_global_opts.stats_shards, 1);
+    unsigned max_counters = ucs_global_opts.stats_max_counters;
+    unsigned max_nodes    = ucs_max(max_counters / 4, 1);
+    size_t nodes_offset, names_offset, shards_offset, size;
+    ucs_stats_shm_header_t *hdr;
+    unsigned i;
+    int fd;
+
+    if (max_counters == 0) {
+        return;
+    }
+
+    nodes_offset  = ucs_align_up_pow2(sizeof(*hdr), UCS_SYS_CACHE_LINE_SIZE);
+    names_offset  = ucs_align_up_pow2(nodes_offset +
+                                      (max_nodes * sizeof(ucs_stats_shm_node_t)),
+                                      UCS_SYS_CACHE_LINE_SIZE);
+    shards_offset = ucs_align_up_pow2(names_offset +
+                                      (max_counters *
+                                       sizeof(ucs_stats_shm_counter_name_t)),
+                                      UCS_SYS_CACHE_LINE_SIZE);
+    size          = ucs_align_up(shards_offset + ((size_t)num_shards *
+                                                  max_counters *
+                                                  sizeof(ucs_stats_counter_t)),
+                                 ucs_get_page_size());
+
+    ucs_stats_context.region.shm_name[0] = '\0';
+    if (ucs_stats_context.flags & UCS_STATS_FLAG_SHM) {
+        ucs_snprintf_zero(ucs_stats_context.region.shm_name,
+                          sizeof(ucs_stats_context.region.shm_name),
+                          UCS_STATS_SHM_NAME_FMT, getpid());
+        fd = shm_open(ucs_stats_context.region.shm_name,
+                      O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR);
+        if (fd < 0) {
+            ucs_warn("shm_open(%s) failed: %m, statistics counters are not "
+                     "published", ucs_stats_context.region.shm_name);
+            return;
+        }
+
+        if (ftruncate(fd, size) < 0) {
+            ucs_warn("ftruncate(%s, %zu) failed: %m",
+                     ucs_stats_context.region.shm_name, size);
+            close(fd);
+            goto err_unlink;
+        }
+
+        hdr = ucs_mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0,
+                       "stats region");
+        close(fd);
+        if (hdr == MAP_FAILED) {
+            ucs_warn("failed to map statistics region %s: %m",
+                     ucs_stats_context.region.shm_name);
+            goto err_unlink;
+        }
+    } else {
+        hdr = ucs_mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0, "stats region");
+        if (hdr == MAP_FAILED) {
+            ucs_warn("failed to allocate statistics region: %m");
+            return;
+        }
+    }
+
+    ucs_stats_context.region.next_free = ucs_malloc(max_nodes *
+                                                    sizeof(uint32_t),
+                                                    "stats region free list");
+    if (ucs_stats_context.region.next_free == NULL) {
+        ucs_warn("failed to allocate statistics region free list");
+        goto err_unmap;
+    }
+
+    if (pthread_key_create(&ucs_stats_shard_key, NULL) != 0) {
+        ucs_warn("failed to create statistics shard key: %m");
+        goto err_free;
+    }
+
+    for (i = 0; i <= UCS_STATS_REGION_REUSE_MAX; ++i) {
+        ucs_stats_context.region.free_head[i] = UCS_STATS_SHM_NO_PARENT;
+    }
+
+    ucs_stats_context.region.num_counters = 0;
+    ucs_stats_context.region.num_threads  = 0;
+
+    hdr->version       = UCS_STATS_SHM_VERSION;
+    hdr->pid           = getpid();
+    hdr->size          = size;
+    hdr->num_shards    = num_shards;
+    hdr->max_nodes     = max_nodes;
+    hdr->max_counters  = max_counters;
+    hdr->num_nodes     = 0;
+    hdr->generation    = 0;
+    hdr->nodes_offset  = nodes_offset;
+    hdr->names_offset  = names_offset;
+    hdr->shards_offset = shards_offset;
+
+    /* readers check the magic before anything else */
+    ucs_memory_cpu_store_fence();
+    hdr->magic         = UCS_STATS_SHM_MAGIC;
+
+    ucs_stats_context.region.hdr = hdr;
+    ucs_debug("statistics region %s: %u shards of %u counters, %zu bytes",
+              (ucs_stats_context.region.shm_name[0] != '\0') ?
+              ucs_stats_context.region.shm_name : "(private)",
+              num_shards, max_counters, size);
+    return;
+
+err_free:
+    ucs_free(ucs_stats_context.region.next_free);
+err_unmap:
+    ucs_munmap(hdr, size);
+err_unlink:
+    if (ucs_stats_context.region.shm_name[0] != '\0') {
+        shm_unlink(ucs_stats_context.region.shm_name);
+        ucs_stats_context.region.shm_name[0] = '\0';
+    }
+}
+
+static void ucs_stats_region_cleanup()
+{
+    ucs_stats_shm_header_t *hdr = ucs_stats_context.region.hdr;
+
+    if (hdr == NULL) {
+        return;
+    }
+
+    ucs_stats_context.region.hdr = NULL;
+    pthread_key_delete(ucs_stats_shard_key);
+    ucs_free(ucs_stats_context.region.next_free);
+    ucs_munmap(hdr, hdr->size);
+
+    if (ucs_stats_context.region.shm_name[0] != '\0') {
+        shm_unlink(ucs_stats_context.region.shm_name);
+        ucs_stats_context.region.shm_name[0] = '\0';
+    }
+}
+
+/* Node table updates are published with a sequence lock: readers retry if the
+ * generation was odd, or changed while they copied the table */
+static void ucs_stats_region_update_begin(ucs_stats_shm_header_t *hdr)
+{
+    ++hdr->generation;
+    ucs_memory_cpu_store_fence();
+}
+
+static void ucs_stats_region_update_end(ucs_stats_shm_header_t *hdr)
+{
+    ucs_memory_cpu_store_fence();
+    ++hdr->generation;
+}
+
+static void ucs_stats_region_add_node(ucs_stats_node_t *node)
+{
+    ucs_stats_shm_header_t *hdr = ucs_stats_context.region.hdr;
+    unsigned num_counters       = node->cls->num_counters;
+    ucs_stats_shm_counter_name_t *names;
+    ucs_stats_shm_node_t *entry;
+    uint32_t index, *free_head;
+    unsigned i, shard;
+
+    /* Assume locked */
+
+    if (hdr == NULL) {
+        return;
+    }
+
+    free_head = (num_counters <= UCS_STATS_REGION_REUSE_MAX) ?
+                &ucs_stats_context.region.free_head[num_counters] : NULL;
+    if ((free_head != NULL) && (*free_head != UCS_STATS_SHM_NO_PARENT)) {
+        index      = *free_head;
+        *free_head = ucs_stats_context.region.next_free[index];
+        entry      = &ucs_stats_shm_nodes(hdr)[index];
+        ucs_assert(entry->num_counters == num_counters);
+    } else if ((hdr->num_nodes < hdr->max_nodes) &&
+               (ucs_stats_context.region.num_counters + num_counters <=
+                hdr->max_counters)) {
+        index                = hdr->num_nodes;
+        entry                = &ucs_stats_shm_nodes(hdr)[index];
+        entry->first_counter = ucs_stats_context.region.num_counters;
+        entry->num_counters  = num_counters;
+        ucs_stats_context.region.num_counters += num_counters;
+    } else {
+        ucs_debug("statistics region is full, node '"UCS_STATS_NODE_FMT"' "
+                  "is not sharded", UCS_STATS_NODE_ARG(node));
+        return;
+    }
+
+    /* counters of a reused entry keep the values of the previous node */
+    for (shard = 0; shard < hdr->num_shards; ++shard) {
+        memset(ucs_stats_shm_shard(hdr, shard) + entry->first_counter, 0,
+               num_counters * sizeof(ucs_stats_counter_t));
+    }
+
+    ucs_stats_region_update_begin(hdr);
+    names = ucs_stats_shm_counter_names(hdr) + entry->first_counter;
+    for (i = 0; i < num_counters; ++i) {
+        ucs_strncpy_zero(names[i], node->cls->counter_names[i],
+                         sizeof(names[i]));
+    }
+    ucs_strncpy_zero(entry->cls_name, node->cls->name, sizeof(entry->cls_name));
+    ucs_strncpy_zero(entry->name, node->name, sizeof(entry->name));
+    entry->parent = ((node->parent == NULL) || (node->parent->shm_index < 0)) ?
+                    UCS_STATS_SHM_NO_PARENT : node->parent->shm_index;
+    entry->state  = UCS_STATS_SHM_NODE_ACTIVE;
+    if (index == hdr->num_nodes) {
+        ++hdr->num_nodes;
+    }
+    ucs_stats_region_update_end(hdr);
+
+    node->shm_index    = index;
+    node->shards       = ucs_stats_shm_shard(hdr, 0) + entry->first_counter;
+    node->shard_stride = hdr->max_counters;
+}
+
+static void ucs_stats_region_remove_node(ucs_stats_node_t *node,
+                                         int make_inactive)
+{
+    ucs_stats_shm_header_t *hdr = ucs_stats_context.region.hdr;
+    ucs_stats_shm_node_t *entry;
+    uint32_t *free_head;
+
+    /* Assume locked */
+
+    if (node->shm_index < 0) {
+        return;
+    }
+
+    entry = &ucs_stats_shm_nodes(hdr)[node->shm_index];
+    ucs_stats_region_update_begin(hdr);
+    if (make_inactive) {
+        entry->state = UCS_STATS_SHM_NODE_INACTIVE;
+    } else {
+        entry->state = UCS_STATS_SHM_NODE_FREE;
+    }
+    ucs_stats_region_update_end(hdr);
+
+    if (make_inactive) {
+        return;
+    }
+
+    /* entries with many counters are not reused, to avoid searching for a
+     * matching counters range */
+    if (entry->num_counters <= UCS_STATS_REGION_REUSE_MAX) {
+        free_head = &ucs_stats_context.region.free_head[entry->num_counters];
+        ucs_stats_context.region.next_free[node->shm_index] = *free_head;
+        *free_head = node->shm_index;
+    }
+
+    node->shm_index = -1;
+}
+
+unsigned ucs_stats_thread_shard_init()
+{
+    unsigned num_shards = ucs_stats_context.region.hdr->num_shards;
+    uint32_t thread_index;
+    unsigned shard;
+
+    thread_index = ucs_atomic_fadd32(&ucs_stats_context.region.num_threads, 1);
+    if (thread_index == num_shards) {
+        ucs_warn("more than %u threads update statistics counters, concurrent "
+                 "updates may be lost (increase UCX_STATS_SHARDS)", num_shards);
+    }
+
+    shard = thread_index % num_shards;
+    pthread_setspecific(ucs_stats_shard_key, (void*)(uintptr_t)(shard + 1));
+    return shard;
+}
+
+ucs_stats_counter_t ucs_stats_node_get_counter(ucs_stats_node_t *node,
+                                               unsigned index)
+{
+    ucs_stats_counter_t value = 0;
+    unsigned shard;
+
+    if (node->shard_stride == 0) {
+        return node->shards[index];
+    }
+
+    for (shard = 0; shard < ucs_stats_context.region.hdr->num_shards; ++shard) {
+        value += node->shards[(shard * node->shard_stride) + index];
+    }
+    return value;
+}
+
+void ucs_stats_node_set_counter_sharded(ucs_stats_node_t *node, unsigned index,
+                                        ucs_stats_counter_t value)
+{
+    unsigned shard;
+
+    for (shard = 1; shard < ucs_stats_context.region.hdr->num_shards; ++shard) {
+        node->shards[(shard * node->shard_stride) + index] = 0;
+    }
+    node->shards[index] = value;
+}
+
+/* Sum the shards of sharded nodes into their counters, for reporting */
+static void ucs_stats_node_snapshot(ucs_stats_node_t *node)
+{
+    ucs_stats_node_t *child;
+    unsigned i, sel;
+
+    if (node->shard_stride != 0) {
+        for (i = 0; i < node->cls->num_counters; ++i) {
+            node->counters[i] = ucs_stats_node_get_counter(node, i);
+        }
+    }
+
+    for (sel = 0; sel < UCS_STATS_CHILDREN_LAST; ++sel) {
+        ucs_list_for_each(child, &node->children[sel], list) {
+            ucs_stats_node_snapshot(child);
+        }
+    }
+}
+
 static void ucs_stats_clean_node(ucs_stats_node_t *node) {
     ucs_stats_filter_node_t * temp_filter_node;
     ucs_stats_filter_node_t * filter_node;
@@ -222,6 +562,7 @@ static void ucs_stats_node_remove(ucs_stats_node_t *node, int make_inactive)
     } else {
         ucs_stats_clean_node(node); 
     }
+    ucs_stats_region_remove_node(node, make_inactive);
 
     pthread_mutex_unlock(&ucs_stats_context.lock);
 
@@ -386,6 +727,7 @@ static ucs_status_t ucs_stats_node_add(ucs_stats_node_t *node,
     ucs_list_add_tail(&parent->children[UCS_STATS_ACTIVE_CHILDREN], &node->list);
     node->parent = parent;
     ucs_stats_add_to_filter(node, filter_node);
+    ucs_stats_region_add_node(node);
 
     pthread_mutex_unlock(&ucs_stats_context.lock);
 
@@ -467,6 +809,7 @@ static void __ucs_stats_dump(int inactive)
 
     UCS_STATS_SET_TIME(&ucs_stats_context.root_node, UCS_ROOT_STATS_RUNTIME,
                        ucs_stats_context.start_time);
+    ucs_stats_node_snapshot(&ucs_stats_context.root_node);
 
     if (ucs_stats_context.flags & UCS_STATS_FLAG_SOCKET) {
         status = ucs_stats_client_send(ucs_stats_context.client,
@@ -704,24 +1047,33 @@ void ucs_stats_init()
     ucs_assert(ucs_stats_context.flags == 0);
     ucs_stats_open_dest();
 
+    if (ucs_global_opts.stats_shm) {
+        /* the shared memory segment is a destination by itself */
+        ucs_stats_context.flags |= UCS_STATS_FLAG_SHM;
+    }
+
     if (!ucs_stats_is_active()) {
         ucs_trace("statistics disabled");
         return;
     }
 
+    ucs_stats_region_init();
+
     UCS_STATS_START_TIME(ucs_stats_context.start_time);
     ucs_stats_node_init_root("%s:%d", ucs_get_host_name(), getpid());
+    ucs_stats_region_add_node(&ucs_stats_context.root_node);
     ucs_stats_set_trigger();
     kh_init_inplace(ucs_stats_cls, &ucs_stats_context.cls);
 
-    ucs_debug("statistics enabled, flags: %c%c%c%c%c%c%c",
+    ucs_debug("statistics enabled, flags: %c%c%c%c%c%c%c%c",
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_TIMER)      ? 't' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_EXIT)       ? 'e' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_SIGNAL)     ? 's' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_SOCKET)        ? 'u' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM)        ? 'f' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_BINARY) ? 'b' : '-',
-              (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_CLOSE)  ? 'c' : '-');
+              (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_CLOSE)  ? 'c' : '-',
+              (ucs_stats_context.flags & UCS_STATS_FLAG_SHM)           ? 'm' : '-');
 }
 
 void ucs_stats_cleanup()
@@ -735,6 +1087,8 @@ void ucs_stats_cleanup()
     ucs_stats_unset_trigger();
     ucs_stats_clean_node_recurs(&ucs_stats_context.root_node);
     ucs_stats_close_dest();
+    ucs_stats_region_cleanup();
+    ucs_stats_context.flags &= ~UCS_STATS_FLAG_SHM;
     ucs_assert(ucs_stats_context.flags == 0);
 
     kh_foreach_value(&ucs_stats_context.cls, cls, {
@@ -753,7 +1107,8 @@ void ucs_stats_dump()
 
 int ucs_stats_is_active()
 {
-    return ucs_stats_context.flags & (UCS_STATS_FLAG_SOCKET|UCS_STATS_FLAG_STREAM);
+    return ucs_stats_context.flags & (UCS_STATS_FLAG_SOCKET|UCS_STATS_FLAG_STREAM|
+                                      UCS_STATS_FLAG_SHM);
 }
 
 ucs_stats_node_t * ucs_stats_get_root() {
@@ -28,6 +28,8 @@ int ucs_stats_is_active();
 
 #include "libstats.h"
 
+#include <pthread.h>
+
 /**
  * Allocate statistics node.
  *
@@ -40,6 +42,87 @@ ucs_status_t ucs_stats_node_alloc(ucs_stats_node_t** p_node, ucs_stats_class_t *
                                  ucs_stats_node_t *parent, const char *name, ...);
 void ucs_stats_node_free(ucs_stats_node_t *node);
 
+
+/**
+ * Get the value of a statistics counter, summed over all shards.
+ *
+ * @param node           Statistics node.
+ * @param index          Counter index.
+ */
+ucs_stats_counter_t ucs_stats_node_get_counter(ucs_stats_node_t *node,
+                                               unsigned index);
+
+
+/**
+ * Set the value of a sharded statistics counter. Shard 0 is set to the value
+ * and the other shards are cleared, so the summed value is the one set.
+ *
+ * @param node           Statistics node.
+ * @param index          Counter index.
+ * @param value          Value to set.
+ */
+void ucs_stats_node_set_counter_sharded(ucs_stats_node_t *node, unsigned index,
+                                        ucs_stats_counter_t value);
+
+
+/* Key of the counters shard used by the current thread, plus 1 */
+extern pthread_key_t ucs_stats_shard_key;
+
+unsigned ucs_stats_thread_shard_init();
+
+
+/**
+ * @return Counters shard used by the current thread.
+ */
+static UCS_F_ALWAYS_INLINE unsigned ucs_stats_thread_shard()
+{
+    uintptr_t shard = (uintptr_t)pthread_getspecific(ucs_stats_shard_key);
+
+    if (ucs_unlikely(shard == 0)) {
+        return ucs_stats_thread_shard_init();
+    }
+
+    return shard - 1;
+}
+
+
+/**
+ * @return Node counters which are updated by the current thread.
+ */
+static UCS_F_ALWAYS_INLINE ucs_stats_counter_t *
+ucs_stats_node_thread_counters(ucs_stats_node_t *node)
+{
+    if (node->shard_stride == 0) {
+        return node->shards;
+    }
+
+    return node->shards + (node->shard_stride * ucs_stats_thread_shard());
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucs_stats_node_set_counter(ucs_stats_node_t *node, unsigned index,
+                           ucs_stats_counter_t value)
+{
+    if (node->shard_stride == 0) {
+        node->shards[index] = value;
+    } else {
+        ucs_stats_node_set_counter_sharded(node, index, value);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucs_stats_node_update_max(ucs_stats_node_t *node, unsigned index,
+                          ucs_stats_counter_t value)
+{
+    if (node->shard_stride == 0) {
+        if (node->shards[index] < value) {
+            node->shards[index] = value;
+        }
+    } else if (ucs_stats_node_get_counter(node, index) < value) {
+        ucs_stats_node_set_counter_sharded(node, index, value);
+    }
+}
+
 #define UCS_STATS_ARG(_arg) , _arg
 
 #define UCS_STATS_RVAL(_rval) _rval
@@ -55,23 +138,21 @@ void ucs_stats_node_free(ucs_stats_node_t *node);
 
 #define UCS_STATS_UPDATE_COUNTER(_node, _index, _delta) \
     if (((_delta) != 0) && ((_node) != NULL)) { \
-        (_node)->counters[(_index)] += (_delta); \
+        ucs_stats_node_thread_counters(_node)[(_index)] += (_delta); \
     }
 
 #define UCS_STATS_SET_COUNTER(_node, _index, _value) \
     if ((_node) != NULL) { \
-        (_node)->counters[(_index)] = (_value); \
+        ucs_stats_node_set_counter(_node, _index, _value); \
     }
 
 #define UCS_STATS_GET_COUNTER(_node, _index) \
     (((_node) != NULL) ?  \
-    (_node)->counters[(_index)] : 0)
+    ucs_stats_node_get_counter(_node, _index) : 0)
 
 #define UCS_STATS_UPDATE_MAX(_node, _index, _value) \
     if ((_node) != NULL) { \
-        if ((_node)->counters[(_index)] < (_value)) { \
-            (_node)->counters[(_index)] = (_value); \
-        } \
+        ucs_stats_node_update_max(_node, _index, _value); \
     }
 
 #define UCS_STATS_START_TIME(_start_time) \
@@ -0,0 +1,115 @@
+/**
+* Copyright (C) Huawei Technologies Co., Ltd. 2021.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifndef UCS_STATS_SHM_H_
+#define UCS_STATS_SHM_H_
+
+#include <ucs/stats/stats_fwd.h>
+#include <ucs/sys/compiler_def.h>
+#include <stddef.h>
+#include <stdint.h>
+
+BEGIN_C_DECLS
+
+/** @file stats_shm.h */
+
+/*
+ * Layout of the statistics counters region. When UCX_STATS_SHM is enabled,
+ * the region is a shared memory segment named by UCS_STATS_SHM_NAME_FMT, which
+ * external readers (ucx_stats) may map and sample without involving the
+ * process.
+ *
+ *  +----------------------------+
+ *  | header                     |
+ *  +----------------------------+
+ *  | node table [max_nodes]     |  guarded by header.generation (seqlock)
+ *  +----------------------------+
+ *  | counter names              |  name of every counter slot
+ *  | [max_counters]             |
+ *  +----------------------------+
+ *  | shard 0 [max_counters]     |  counter values, updated by the threads
+ *  | ...                        |  which use the shard; the value of a counter
+ *  | shard N-1 [max_counters]   |  is the sum over all shards
+ *  +----------------------------+
+ */
+
+#define UCS_STATS_SHM_MAGIC       0x5441545358435500ull /* "\0UCXSTAT" */
+#define UCS_STATS_SHM_VERSION     1
+#define UCS_STATS_SHM_NAME_FMT    "/ucx_stats_%d"       /* shm_open name, pid */
+#define UCS_STATS_SHM_NAME_LEN    40                    /* UCS_STAT_NAME_MAX + 1 */
+#define UCS_STATS_SHM_NO_PARENT   ((uint32_t)-1)
+
+
+/**
+ * Node table entry state.
+ */
+typedef enum {
+    UCS_STATS_SHM_NODE_FREE,      /* Entry is not used */
+    UCS_STATS_SHM_NODE_ACTIVE,    /* Node is active */
+    UCS_STATS_SHM_NODE_INACTIVE   /* Node was released, and kept for report */
+} ucs_stats_shm_node_state_t;
+
+
+/**
+ * Statistics region header.
+ */
+typedef struct ucs_stats_shm_header {
+    uint64_t          magic;          /* UCS_STATS_SHM_MAGIC */
+    uint32_t          version;        /* UCS_STATS_SHM_VERSION */
+    uint32_t          pid;            /* Process which owns the region */
+    uint64_t          size;           /* Total region size */
+    uint32_t          num_shards;     /* Number of counter shards */
+    uint32_t          max_nodes;      /* Size of the node table */
+    uint32_t          max_counters;   /* Number of counters in every shard */
+    uint32_t          num_nodes;      /* Number of node table entries in use */
+    volatile uint64_t generation;     /* Odd while the node table is updated */
+    uint64_t          nodes_offset;   /* Offset of the node table */
+    uint64_t          names_offset;   /* Offset of counter names */
+    uint64_t          shards_offset;  /* Offset of shard 0 */
+} ucs_stats_shm_header_t;
+
+
+/**
+ * Node table entry.
+ */
+typedef struct ucs_stats_shm_node {
+    char              cls_name[UCS_STATS_SHM_NAME_LEN];
+    char              name[UCS_STATS_SHM_NAME_LEN];
+    uint32_t          parent;         /* Parent entry, or UCS_STATS_SHM_NO_PARENT */
+    uint32_t          state;          /* ucs_stats_shm_node_state_t */
+    uint32_t          first_counter;  /* Slot of the first counter */
+    uint32_t          num_counters;   /* Number of counter slots */
+} ucs_stats_shm_node_t;
+
+
+typedef char ucs_stats_shm_counter_name_t[UCS_STATS_SHM_NAME_LEN];
+
+
+static inline ucs_stats_shm_node_t *
+ucs_stats_shm_nodes(const ucs_stats_shm_header_t *hdr)
+{
+    return (ucs_stats_shm_node_t*)UCS_PTR_BYTE_OFFSET(hdr, hdr->nodes_offset);
+}
+
+
+static inline ucs_stats_shm_counter_name_t *
+ucs_stats_shm_counter_names(const ucs_stats_shm_header_t *hdr)
+{
+    return (ucs_stats_shm_counter_name_t*)UCS_PTR_BYTE_OFFSET(hdr,
+                                                              hdr->names_offset);
+}
+
+
+static inline ucs_stats_counter_t *
+ucs_stats_shm_shard(const ucs_stats_shm_header_t *hdr, unsigned shard)
+{
+    return (ucs_stats_counter_t*)UCS_PTR_BYTE_OFFSET(hdr, hdr->shards_offset) +
+           ((size_t)shard * hdr->max_counters);
+}
+
+END_C_DECLS
+
+#endif
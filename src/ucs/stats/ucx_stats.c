@@ -0,0 +1,311 @@
+/**
+* Copyright (C) Huawei Technologies Co., Ltd. 2021.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "stats_shm.h"
+
+#include <ucs/arch/cpu.h>
+#include <ucs/sys/math.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Print the statistics counters of a running process, which was started with
+ * UCX_STATS_SHM=y. The counters are read from the shared memory segment of the
+ * process, without interrupting it.
+ *
+ * Usage: ucx_stats [ -a ] [ -i <interval> ] [ -n <count> ] <pid>
+ */
+
+#define UCX_STATS_MAX_DEPTH  64
+
+
+typedef struct {
+    const ucs_stats_shm_header_t *hdr;       /* Mapped region */
+    ucs_stats_shm_node_t         *nodes;     /* Copy of the node table */
+    ucs_stats_shm_counter_name_t *names;     /* Copy of the counter names */
+    ucs_stats_counter_t          *values;    /* Current counter values */
+    ucs_stats_counter_t          *prev;      /* Values of previous sample */
+    uint32_t                     *child;     /* First child of every node */
+    uint32_t                     *sibling;   /* Next sibling of every node */
+    uint32_t                     num_nodes;
+    int                          inactive;   /* Show released nodes */
+    int                          delta;      /* Show the change since the
+                                                previous sample */
+} ucx_stats_reader_t;
+
+
+static int ucx_stats_map(pid_t pid, const ucs_stats_shm_header_t **p_hdr)
+{
+    char name[UCS_STATS_SHM_NAME_LEN];
+    const ucs_stats_shm_header_t *hdr;
+    struct stat st;
+    int fd;
+
+    snprintf(name, sizeof(name), UCS_STATS_SHM_NAME_FMT, (int)pid);
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "failed to open %s: %m (was the process started with "
+                "UCX_STATS_SHM=y?)\n", name);
+        return -1;
+    }
+
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "failed to stat %s: %m\n", name);
+        goto err_close;
+    }
+
+    if ((size_t)st.st_size < sizeof(*hdr)) {
+        fprintf(stderr, "%s is not initialized\n", name);
+        goto err_close;
+    }
+
+    hdr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (hdr == MAP_FAILED) {
+        fprintf(stderr, "failed to map %s: %m\n", name);
+        goto err_close;
+    }
+
+    close(fd);
+
+    if ((hdr->magic != UCS_STATS_SHM_MAGIC) ||
+        (hdr->version != UCS_STATS_SHM_VERSION) ||
+        (hdr->size > (size_t)st.st_size)) {
+        fprintf(stderr, "%s has unsupported format (version %u)\n", name,
+                hdr->version);
+        munmap((void*)hdr, st.st_size);
+        return -1;
+    }
+
+    *p_hdr = hdr;
+    return 0;
+
+err_close:
+    close(fd);
+    return -1;
+}
+
+/* Copy the node table and counter names, consistent with a single
+ * generation of the table */
+static void ucx_stats_read_nodes(ucx_stats_reader_t *reader)
+{
+    const ucs_stats_shm_header_t *hdr = reader->hdr;
+    uint64_t generation;
+
+    for (;;) {
+        generation = hdr->generation;
+        if (generation & 1) {
+            sched_yield();
+            continue;
+        }
+
+        ucs_memory_cpu_load_fence();
+        reader->num_nodes = ucs_min(hdr->num_nodes, hdr->max_nodes);
+        memcpy(reader->nodes, ucs_stats_shm_nodes(hdr),
+               reader->num_nodes * sizeof(*reader->nodes));
+        memcpy(reader->names, ucs_stats_shm_counter_names(hdr),
+               hdr->max_counters * sizeof(*reader->names));
+        ucs_memory_cpu_load_fence();
+
+        if (hdr->generation == generation) {
+            break;
+        }
+    }
+}
+
+static int ucx_stats_node_is_valid(ucx_stats_reader_t *reader, uint32_t index)
+{
+    const ucs_stats_shm_node_t *node = &reader->nodes[index];
+
+    return (node->state == UCS_STATS_SHM_NODE_ACTIVE) ||
+           ((node->state == UCS_STATS_SHM_NODE_INACTIVE) && reader->inactive);
+}
+
+static void ucx_stats_build_tree(ucx_stats_reader_t *reader)
+{
+    const ucs_stats_shm_header_t *hdr = reader->hdr;
+    const ucs_stats_shm_node_t *node;
+    uint32_t i, parent, slot, shard;
+
+    for (i = 0; i < reader->num_nodes; ++i) {
+        reader->child[i]   = UCS_STATS_SHM_NO_PARENT;
+        reader->sibling[i] = UCS_STATS_SHM_NO_PARENT;
+    }
+
+    /* link in reverse order, so children are printed in creation order */
+    for (i = reader->num_nodes; i-- > 0; ) {
+        node = &reader->nodes[i];
+        if (!ucx_stats_node_is_valid(reader, i)) {
+            continue;
+        }
+
+        for (slot = node->first_counter;
+             slot < node->first_counter + node->num_counters; ++slot) {
+            reader->values[slot] = 0;
+            for (shard = 0; shard < hdr->num_shards; ++shard) {
+                reader->values[slot] += ucs_stats_shm_shard(hdr, shard)[slot];
+            }
+        }
+
+        parent = node->parent;
+        if ((parent < reader->num_nodes) &&
+            ucx_stats_node_is_valid(reader, parent)) {
+            reader->sibling[i]    = reader->child[parent];
+            reader->child[parent] = i;
+        }
+    }
+}
+
+static void ucx_stats_print_node(ucx_stats_reader_t *reader, uint32_t index,
+                                 unsigned indent)
+{
+    const ucs_stats_shm_node_t *node = &reader->nodes[index];
+    uint32_t slot, child;
+
+    printf("%*s%s%s%s:\n", indent * 2, "", node->cls_name, node->name,
+           (node->state == UCS_STATS_SHM_NODE_INACTIVE) ? " (released)" : "");
+
+    for (slot = node->first_counter;
+         slot < node->first_counter + node->num_counters; ++slot) {
+        printf("%*s%s: %"PRIu64, (indent + 1) * 2, "",
+               reader->names[slot], reader->values[slot]);
+        if (reader->delta) {
+            printf(" (%+"PRId64")",
+                   (int64_t)(reader->values[slot] - reader->prev[slot]));
+        }
+        printf("\n");
+    }
+
+    if (indent >= UCX_STATS_MAX_DEPTH) {
+        return;
+    }
+
+    for (child = reader->child[index]; child != UCS_STATS_SHM_NO_PARENT;
+         child = reader->sibling[child]) {
+        ucx_stats_print_node(reader, child, indent + 1);
+    }
+}
+
+static void ucx_stats_sample(ucx_stats_reader_t *reader)
+{
+    uint32_t i, parent;
+
+    ucx_stats_read_nodes(reader);
+    ucx_stats_build_tree(reader);
+
+    for (i = 0; i < reader->num_nodes; ++i) {
+        parent = reader->nodes[i].parent;
+        if (ucx_stats_node_is_valid(reader, i) &&
+            ((parent >= reader->num_nodes) ||
+             !ucx_stats_node_is_valid(reader, parent))) {
+            ucx_stats_print_node(reader, i, 0);
+        }
+    }
+
+    fflush(stdout);
+    memcpy(reader->prev, reader->values,
+           reader->hdr->max_counters * sizeof(*reader->values));
+}
+
+static void usage()
+{
+    printf("Usage: ucx_stats [options] <pid>\n");
+    printf("Print the statistics counters of a running process, which was\n");
+    printf("started with UCX_STATS_SHM=y.\n\n");
+    printf("  -a             Show released nodes which are kept for the report\n");
+    printf("  -i <seconds>   Sample every <seconds>, show the change since the\n");
+    printf("                 previous sample\n");
+    printf("  -n <count>     Number of samples to print (default: 1, or\n");
+    printf("                 unlimited if -i is given)\n");
+    printf("  -h             Show this help message\n");
+}
+
+int main(int argc, char **argv)
+{
+    ucx_stats_reader_t reader = {};
+    double interval           = 0;
+    long count                = -1;
+    long sample;
+    pid_t pid;
+    int c;
+
+    while ((c = getopt(argc, argv, "ai:n:h")) != -1) {
+        switch (c) {
+        case 'a':
+            reader.inactive = 1;
+            break;
+        case 'i':
+            interval = atof(optarg);
+            break;
+        case 'n':
+            count = atol(optarg);
+            break;
+        case 'h':
+            usage();
+            return 0;
+        default:
+            usage();
+            return -1;
+        }
+    }
+
+    if (optind != (argc - 1)) {
+        usage();
+        return -1;
+    }
+
+    pid = atoi(argv[optind]);
+    if (count < 0) {
+        count = (interval > 0) ? 0 : 1;
+    }
+
+    if (ucx_stats_map(pid, &reader.hdr) < 0) {
+        return -1;
+    }
+
+    reader.nodes   = calloc(reader.hdr->max_nodes, sizeof(*reader.nodes));
+    reader.child   = calloc(reader.hdr->max_nodes, sizeof(*reader.child));
+    reader.sibling = calloc(reader.hdr->max_nodes, sizeof(*reader.sibling));
+    reader.names   = calloc(reader.hdr->max_counters, sizeof(*reader.names));
+    reader.values  = calloc(reader.hdr->max_counters, sizeof(*reader.values));
+    reader.prev    = calloc(reader.hdr->max_counters, sizeof(*reader.prev));
+    if ((reader.nodes == NULL) || (reader.child == NULL) ||
+        (reader.sibling == NULL) || (reader.names == NULL) ||
+        (reader.values == NULL) || (reader.prev == NULL)) {
+        fprintf(stderr, "failed to allocate memory\n");
+        return -1;
+    }
+
+    for (sample = 0; (count == 0) || (sample < count); ++sample) {
+        if (sample > 0) {
+            usleep((useconds_t)(interval * 1e6));
+            printf("\n");
+        }
+
+        reader.delta = (sample > 0);
+        ucx_stats_sample(&reader);
+    }
+
+    free(reader.prev);
+    free(reader.values);
+    free(reader.names);
+    free(reader.sibling);
+    free(reader.child);
+    free(reader.nodes);
+    munmap((void*)reader.hdr, reader.hdr->size);
+    return 0;
+}
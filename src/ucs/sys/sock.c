@@ -20,6 +20,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
 #include <ifaddrs.h>
 #include <unistd.h>
 #include <errno.h>
@@ -29,6 +30,16 @@
 #define UCS_NETIF_BOND_AD_NUM_PORTS_FMT  "/sys/class/net/%s/bonding/ad_num_ports"
 #define UCS_SOCKET_MAX_CONN_PATH         "/proc/sys/net/core/somaxconn"
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#  include <linux/errqueue.h>
+#  ifdef SO_EE_ORIGIN_ZEROCOPY
+#    define UCS_SOCKET_ZCOPY_SUPPORTED 1
+#  endif
+#endif
+#ifndef UCS_SOCKET_ZCOPY_SUPPORTED
+#  define UCS_SOCKET_ZCOPY_SUPPORTED 0
+#endif
+
 
 typedef ssize_t (*ucs_socket_io_func_t)(int fd, void *data,
                                         size_t size, int flags);
@@ -596,6 +607,100 @@ ucs_socket_sendv_nb(int fd, struct iovec *iov, size_t iov_cnt, size_t *length_p,
                                 "sendv", err_cb, err_cb_arg);
 }
 
+ucs_status_t ucs_socket_set_zcopy(int fd)
+{
+#if UCS_SOCKET_ZCOPY_SUPPORTED
+    int enable = 1;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) < 0) {
+        ucs_debug("failed to set SO_ZEROCOPY on fd %d: %m", fd);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    return UCS_OK;
+#else
+    return UCS_ERR_UNSUPPORTED;
+#endif
+}
+
+ucs_status_t
+ucs_socket_sendv_zcopy_nb(int fd, struct iovec *iov, size_t iov_cnt,
+                          size_t *length_p, ucs_socket_io_err_cb_t err_cb,
+                          void *err_cb_arg)
+{
+#if UCS_SOCKET_ZCOPY_SUPPORTED
+    struct msghdr msg = {
+        .msg_iov    = iov,
+        .msg_iovlen = iov_cnt
+    };
+    ssize_t ret;
+
+    ret = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_ZEROCOPY);
+    if ((ret < 0) && (errno == ENOBUFS)) {
+        /* The limit of locked memory or pending notifications is reached,
+         * need to try again after reading completions from the error queue */
+        *length_p = 0;
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    return ucs_socket_handle_io(fd, iov, iov_cnt, length_p, 1, ret, errno,
+                                "sendv_zcopy", err_cb, err_cb_arg);
+#else
+    return UCS_ERR_UNSUPPORTED;
+#endif
+}
+
+ucs_status_t ucs_socket_zcopy_completion(int fd, uint32_t *first_p,
+                                         uint32_t *last_p)
+{
+#if UCS_SOCKET_ZCOPY_SUPPORTED
+    char control[128];
+    struct sock_extended_err *serr;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    ssize_t ret;
+
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        ret = recvmsg(fd, &msg, MSG_ERRQUEUE);
+        if (ret < 0) {
+            if (ucs_socket_check_errno(errno) == UCS_ERR_NO_PROGRESS) {
+                return UCS_ERR_NO_PROGRESS;
+            }
+
+            ucs_error("recvmsg(fd=%d, MSG_ERRQUEUE) failed: %m", fd);
+            return UCS_ERR_IO_ERROR;
+        }
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+             cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(((cmsg->cmsg_level == SOL_IP) &&
+                   (cmsg->cmsg_type == IP_RECVERR)) ||
+                  ((cmsg->cmsg_level == SOL_IPV6) &&
+                   (cmsg->cmsg_type == IPV6_RECVERR)))) {
+                continue;
+            }
+
+            serr = (struct sock_extended_err*)CMSG_DATA(cmsg);
+            if ((serr->ee_errno == 0) &&
+                (serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY)) {
+                *first_p = serr->ee_info;
+                *last_p  = serr->ee_data;
+                return UCS_OK;
+            }
+        }
+
+        /* not a zero-copy notification, skip it */
+        ucs_trace("fd %d: skipped error queue message", fd);
+    }
+#else
+    return UCS_ERR_UNSUPPORTED;
+#endif
+}
+
 ucs_status_t ucs_sockaddr_sizeof(const struct sockaddr *addr, size_t *size_p)
 {
     switch (addr->sa_family) {
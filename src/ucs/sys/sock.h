@@ -348,6 +348,64 @@ ucs_status_t ucs_socket_sendv_nb(int fd, struct iovec *iov, size_t iov_cnt,
                                  void *err_cb_arg);
 
 
+/**
+ * Enable zero-copy transmission (SO_ZEROCOPY) on the socket referred to by
+ * the file descriptor `fd`.
+ *
+ * @param [in]      fd              Socket fd.
+ *
+ * @return UCS_OK on success, UCS_ERR_UNSUPPORTED if the system does not
+ *         support zero-copy transmission on this socket.
+ */
+ucs_status_t ucs_socket_set_zcopy(int fd);
+
+
+/**
+ * Non-blocking zero-copy vector send operation (sendmsg() with MSG_ZEROCOPY).
+ * The kernel may keep referencing the user buffers after the function returns,
+ * until a completion notification is read by @ref ucs_socket_zcopy_completion.
+ * Every call which transmits any data is identified by a 32-bit counter which
+ * starts from 0 and is incremented by the kernel for each such call.
+ * Zero-copy has to be enabled on the socket by @ref ucs_socket_set_zcopy.
+ *
+ * @param [in]      fd              Socket fd.
+ * @param [in]      iov             A pointer to an array of iovec buffers.
+ * @param [in]      iov_cnt         The number of buffers pointed to by
+ *                                  the iov parameter.
+ * @param [out]     length_p        The amount of data transmitted is written to
+ *                                  this argument.
+ * @param [in]      err_cb          Error callback.
+ * @param [in]      err_cb_arg      User's argument for the error callback.
+ *
+ * @return Same as @ref ucs_socket_sendv_nb, UCS_ERR_NO_RESOURCE if the limit
+ *         of pinned memory or pending notifications is reached and no data
+ *         was sent, or UCS_ERR_UNSUPPORTED if zero-copy send is not supported
+ *         by the system.
+ */
+ucs_status_t ucs_socket_sendv_zcopy_nb(int fd, struct iovec *iov, size_t iov_cnt,
+                                       size_t *length_p,
+                                       ucs_socket_io_err_cb_t err_cb,
+                                       void *err_cb_arg);
+
+
+/**
+ * Read a single zero-copy send completion notification from the error queue
+ * of the socket referred to by the file descriptor `fd`. The notification
+ * reports that the kernel has released the buffers of the zero-copy send
+ * calls in the range [first, last].
+ *
+ * @param [in]      fd              Socket fd.
+ * @param [out]     first_p         Identifier of the first completed call.
+ * @param [out]     last_p          Identifier of the last completed call.
+ *
+ * @return UCS_OK if a notification was read, UCS_ERR_NO_PROGRESS if the
+ *         error queue is empty, UCS_ERR_IO_ERROR on failure, or
+ *         UCS_ERR_UNSUPPORTED if zero-copy send is not supported.
+ */
+ucs_status_t ucs_socket_zcopy_completion(int fd, uint32_t *first_p,
+                                         uint32_t *last_p);
+
+
 /**
  * Blocking receive operation receives data from the connected (or bound
  * connectionless) socket referred to by the file descriptor `fd`.
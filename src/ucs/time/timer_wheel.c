@@ -10,12 +10,156 @@
 
 #include <ucs/time/timer_wheel.h>
 
+#include <ucs/arch/bitops.h>
 #include <ucs/debug/assert.h>
 #include <ucs/debug/log.h>
 #include <ucs/debug/memtrack.h>
 #include <ucs/sys/math.h>
 
 
+#define UCS_TWHEEL_SLOT_MASK  (UCS_TWHEEL_LEVEL_SLOTS - 1)
+
+
+static UCS_F_ALWAYS_INLINE unsigned ucs_twheel_level_shift(unsigned level)
+{
+    return level * UCS_TWHEEL_LEVEL_BITS;
+}
+
+static UCS_F_ALWAYS_INLINE ucs_list_link_t *
+ucs_twheel_slot(ucs_twheel_t *t, unsigned level, unsigned index)
+{
+    return &t->wheel[(level * UCS_TWHEEL_LEVEL_SLOTS) + index];
+}
+
+static UCS_F_ALWAYS_INLINE unsigned
+ucs_twheel_slot_index(uint64_t tick, unsigned level)
+{
+    return (tick >> ucs_twheel_level_shift(level)) & UCS_TWHEEL_SLOT_MASK;
+}
+
+/* Tick at which the slot holding the timer is expired or cascaded */
+static UCS_F_ALWAYS_INLINE uint64_t
+ucs_twheel_slot_tick(uint64_t expires, unsigned level)
+{
+    unsigned shift = ucs_twheel_level_shift(level);
+
+    return (expires >> shift) << shift;
+}
+
+static void ucs_twheel_insert(ucs_twheel_t *t, ucs_wtimer_t *timer)
+{
+    unsigned level = 0;
+    unsigned shift, index;
+
+    /* find the lowest level which covers the expiration tick, so that every
+     * slot of the wheel holds timers of a single range */
+    for (;;) {
+        shift = ucs_twheel_level_shift(level);
+        if (((timer->expires >> shift) - (t->current >> shift)) <
+            UCS_TWHEEL_LEVEL_SLOTS) {
+            break;
+        }
+
+        if (++level == (UCS_TWHEEL_NUM_LEVELS - 1)) {
+            break;
+        }
+    }
+
+    index        = ucs_twheel_slot_index(timer->expires, level);
+    timer->level = level;
+    ucs_list_add_tail(ucs_twheel_slot(t, level, index), &timer->list);
+    t->bitmap[level] |= UCS_BIT(index);
+    t->next_tick      = ucs_min(t->next_tick,
+                                ucs_twheel_slot_tick(timer->expires, level));
+}
+
+static void ucs_twheel_update_next_tick(ucs_twheel_t *t)
+{
+    uint64_t next_tick = UINT64_MAX;
+    uint64_t bitmap, base;
+    unsigned level, shift, index;
+
+    for (level = 0; level < UCS_TWHEEL_NUM_LEVELS; ++level) {
+        bitmap = t->bitmap[level];
+        if (bitmap == 0) {
+            continue;
+        }
+
+        /* rotate the bitmap to start from the slot after the current one, the
+         * current slot of a level was already processed */
+        shift  = ucs_twheel_level_shift(level);
+        base   = t->current >> shift;
+        index  = (base + 1) & UCS_TWHEEL_SLOT_MASK;
+        bitmap = (bitmap >> index) |
+                 (bitmap << ((UCS_TWHEEL_LEVEL_SLOTS - index) &
+                             UCS_TWHEEL_SLOT_MASK));
+        next_tick = ucs_min(next_tick,
+                            (base + 1 + ucs_count_trailing_zero_bits(bitmap))
+                            << shift);
+    }
+
+    t->next_tick = next_tick;
+}
+
+static void ucs_twheel_cascade(ucs_twheel_t *t, unsigned level, unsigned index)
+{
+    ucs_list_link_t timers;
+    ucs_wtimer_t *timer;
+
+    ucs_list_head_init(&timers);
+    ucs_list_splice_tail(&timers, ucs_twheel_slot(t, level, index));
+    ucs_list_head_init(ucs_twheel_slot(t, level, index));
+    t->bitmap[level] &= ~UCS_BIT(index);
+
+    while (!ucs_list_is_empty(&timers)) {
+        timer = ucs_list_extract_head(&timers, ucs_wtimer_t, list);
+        ucs_assert(timer->expires >= t->current);
+        ucs_twheel_insert(t, timer);
+        ucs_assert(timer->level < level);
+    }
+}
+
+static void ucs_twheel_process_tick(ucs_twheel_t *t)
+{
+    uint64_t tick = t->current;
+    ucs_list_link_t expired;
+    ucs_wtimer_t *timer;
+    unsigned level, index;
+
+    /* move the timers of higher level slots which start at this tick to the
+     * lower levels, they may expire now */
+    for (level = UCS_TWHEEL_NUM_LEVELS - 1; level > 0; --level) {
+        if (tick & UCS_MASK(ucs_twheel_level_shift(level))) {
+            continue;
+        }
+
+        index = ucs_twheel_slot_index(tick, level);
+        if (t->bitmap[level] & UCS_BIT(index)) {
+            ucs_twheel_cascade(t, level, index);
+        }
+    }
+
+    index = ucs_twheel_slot_index(tick, 0);
+    if (!(t->bitmap[0] & UCS_BIT(index))) {
+        return;
+    }
+
+    /* dispatch from a private list, since the callbacks may add or remove
+     * timers */
+    ucs_list_head_init(&expired);
+    ucs_list_splice_tail(&expired, ucs_twheel_slot(t, 0, index));
+    ucs_list_head_init(ucs_twheel_slot(t, 0, index));
+    t->bitmap[0] &= ~UCS_BIT(index);
+
+    while (!ucs_list_is_empty(&expired)) {
+        timer = ucs_list_extract_head(&expired, ucs_wtimer_t, list);
+        ucs_assert(timer->expires == tick);
+        timer->is_active = 0;
+        t->count--;
+        timer->cb(timer);
+    }
+}
+
 ucs_status_t ucs_twheel_init(ucs_twheel_t *twheel, ucs_time_t resolution,
                              ucs_time_t current_time)
 {
@@ -23,20 +167,25 @@ ucs_status_t ucs_twheel_init(ucs_twheel_t *twheel, ucs_time_t resolution,
 
     twheel->res         = ucs_roundup_pow2(resolution);
     twheel->res_order   = (unsigned) ucs_log2(twheel->res);
-    twheel->num_slots   = 1024;
-    twheel->current     = 0;
     twheel->now         = current_time;
-    twheel->wheel       = ucs_malloc(sizeof(*twheel->wheel) * twheel->num_slots,
-                                     "twheel");
+    twheel->current     = current_time >> twheel->res_order;
+    twheel->next_tick   = UINT64_MAX;
+    twheel->wheel       = ucs_malloc(sizeof(*twheel->wheel) *
+                                     UCS_TWHEEL_NUM_LEVELS *
+                                     UCS_TWHEEL_LEVEL_SLOTS, "twheel");
     twheel->count       = 0;
     if (twheel->wheel == NULL) {
         return UCS_ERR_NO_MEMORY;
     }
 
-    for (i = 0; i < twheel->num_slots; i++) {
+    for (i = 0; i < UCS_TWHEEL_NUM_LEVELS * UCS_TWHEEL_LEVEL_SLOTS; i++) {
         ucs_list_head_init(&twheel->wheel[i]);
     }
 
+    for (i = 0; i < UCS_TWHEEL_NUM_LEVELS; i++) {
+        twheel->bitmap[i] = 0;
+    }
+
     ucs_debug("high res timer created log=%d resolution=%lf usec wanted: %lf usec",
               twheel->res_order, ucs_time_to_usec(twheel->res), ucs_time_to_usec(resolution));
     return UCS_OK;
@@ -56,50 +205,62 @@ ucs_status_t ucs_wtimer_init(ucs_wtimer_t *t, ucs_twheel_callback_t cb)
 
 void __ucs_wtimer_add(ucs_twheel_t *t, ucs_wtimer_t *timer, ucs_time_t delta)
 {
-    uint64_t slot;
+    uint64_t ticks;
 
-    timer->is_active = 1;
-    slot = delta>>t->res_order;
-    if (ucs_unlikely(slot == 0)) {
+    ticks = delta >> t->res_order;
+    if (ucs_unlikely(ticks == 0)) {
         /* nothing really wrong with adding timer to the current slot. However
          * we want to guard against the case we spend to much time in hi res
          * timer processing */
         ucs_fatal("Timer resolution is too low. Min resolution %lf usec, wanted %lf usec",
                 ucs_time_to_usec(t->res), ucs_time_to_usec(delta));
     }
-    ucs_assert(slot > 0);
 
-    if (ucs_unlikely(slot >= t->num_slots)) {
-        slot = t->num_slots - 1;
+    if (t->count == 0) {
+        /* users may skip sweeping an empty wheel, so its time may be stale;
+         * move it to the current time, otherwise the new timer could expire
+         * early. There are no timers, so the wheel can jump forward. */
+        t->now       = ucs_max(t->now, ucs_get_time());
+        t->current   = ucs_max(t->current, t->now >> t->res_order);
+        t->next_tick = UINT64_MAX;
     }
 
-    slot = (t->current + slot) % t->num_slots;
-    ucs_assert(slot != t->current);
-
-    ucs_list_add_tail(&t->wheel[slot], &timer->list);
+    /* the delay is relative to the last sweep time, which may be ahead of the
+     * current tick if called from a timer callback */
+    timer->is_active = 1;
+    timer->expires   = ucs_max(t->now >> t->res_order, t->current) +
+                       ucs_min(ticks, UCS_TWHEEL_MAX_TICKS);
+    ucs_twheel_insert(t, timer);
     t->count++;
 }
 
-void __ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time)
+void __ucs_wtimer_remove(ucs_twheel_t *t, ucs_wtimer_t *timer)
 {
-    ucs_wtimer_t *timer;
-    uint64_t slot;
+    unsigned index = ucs_twheel_slot_index(timer->expires, timer->level);
 
-    slot   = (current_time - t->now) >> t->res_order;
-    t->now = current_time;
+    ucs_list_del(&timer->list);
+    timer->is_active = 0;
+    t->count--;
 
-    if (ucs_unlikely(slot >= t->num_slots)) {
-        slot = t->num_slots - 1;
+    /* the cached next tick may be earlier than needed now, which only costs
+     * an empty sweep */
+    if (ucs_list_is_empty(ucs_twheel_slot(t, timer->level, index))) {
+        t->bitmap[timer->level] &= ~UCS_BIT(index);
     }
+}
+
+void __ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time)
+{
+    uint64_t target = current_time >> t->res_order;
 
-    slot = (t->current + slot) % t->num_slots;
+    t->now = current_time;
 
-    for (; t->current != slot; t->current = (t->current+1) % t->num_slots) {
-        while (!ucs_list_is_empty(&t->wheel[t->current])) {
-            timer = ucs_list_extract_head(&t->wheel[t->current], ucs_wtimer_t, list);
-            timer->is_active = 0;
-            timer->cb(timer);
-            t->count--;
-        }
+    /* jump between ticks which have work, skipping empty slots */
+    while (t->next_tick <= target) {
+        t->current = t->next_tick;
+        ucs_twheel_process_tick(t);
+        ucs_twheel_update_next_tick(t);
     }
+
+    t->current = ucs_max(t->current, target);
 }
@@ -12,6 +12,21 @@
 #include <ucs/debug/log.h>
 
 
+/* Number of bits of the expiration tick handled by every level of the wheel */
+#define UCS_TWHEEL_LEVEL_BITS    6
+
+/* Number of slots in every level of the wheel */
+#define UCS_TWHEEL_LEVEL_SLOTS   UCS_BIT(UCS_TWHEEL_LEVEL_BITS)
+
+/* Number of levels in the wheel */
+#define UCS_TWHEEL_NUM_LEVELS    5
+
+/* Maximal timer delay, in resolution ticks. Longer timers are clamped. */
+#define UCS_TWHEEL_MAX_TICKS     ((UCS_TWHEEL_LEVEL_SLOTS - 1) << \
+                                  ((UCS_TWHEEL_NUM_LEVELS - 1) * \
+                                   UCS_TWHEEL_LEVEL_BITS))
+
+
 /* Forward declarations */
 typedef struct ucs_wtimer       ucs_wtimer_t;
 typedef struct ucs_timer_wheel  ucs_twheel_t;
@@ -29,17 +44,29 @@ typedef void (*ucs_twheel_callback_t)(ucs_wtimer_t *self);
 struct ucs_wtimer {
     ucs_twheel_callback_t  cb;         /* User callback */
     ucs_list_link_t        list;       /* Link in the list of timers */
+    uint64_t               expires;    /* Expiration tick */
+    uint8_t                level;      /* Wheel level the timer is on */
     int                    is_active;
 };
 
 
+/**
+ * Hierarchical timer wheel. Level 0 holds timers which expire in the next
+ * UCS_TWHEEL_LEVEL_SLOTS ticks, one slot per tick. Every slot of level N
+ * covers UCS_TWHEEL_LEVEL_SLOTS slots of level N-1, and its timers are moved
+ * (cascaded) to the lower levels only when the wheel reaches it. Occupied
+ * slots are tracked by a bitmap per level, so the next tick which has work is
+ * found without walking empty slots.
+ */
 struct ucs_timer_wheel {
     ucs_time_t             res;
     ucs_time_t             now;        /* when wheel was last updated */
-    uint64_t               current;
-    ucs_list_link_t        *wheel;
+    uint64_t               current;    /* Current tick, now >> res_order */
+    uint64_t               next_tick;  /* No work to do before this tick */
+    ucs_list_link_t        *wheel;     /* Slots, UCS_TWHEEL_LEVEL_SLOTS for
+                                          every level */
+    uint64_t               bitmap[UCS_TWHEEL_NUM_LEVELS]; /* Non-empty slots */
     unsigned               res_order;
-    unsigned               num_slots;
     unsigned               count;
 };
 
@@ -48,7 +75,8 @@ struct ucs_timer_wheel {
  * Initialize the timer queue.
  *
  * @param twheel        Timer queue to initialize.
- * @param resolution    Timer resolution. Timer wheel range is from now to now + UCS_TWHEEL_NSLOTS * res
+ * @param resolution    Timer resolution. Timer wheel range is from now to
+ *                      now + UCS_TWHEEL_MAX_TICKS * res
  * @param current_time  Current time to initialize the timer with.
  */
 ucs_status_t ucs_twheel_init(ucs_twheel_t *twheel, ucs_time_t resolution,
@@ -83,9 +111,18 @@ ucs_status_t ucs_wtimer_init(ucs_wtimer_t *t, ucs_twheel_callback_t cb);
 void __ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time);
 static inline void ucs_twheel_sweep(ucs_twheel_t *t, ucs_time_t current_time)
 {
-    if (ucs_unlikely(current_time - t->now >= t->res)) {
+    uint64_t target = current_time >> t->res_order;
+
+    if (ucs_unlikely(target >= t->next_tick)) {
         __ucs_twheel_sweep(t, current_time);
+        return;
     }
+
+    /* no work before next_tick, so the wheel can move forward without
+     * processing; this keeps the base of new timers and the time reported by
+     * ucs_twheel_get_time() up to date when the wheel is idle */
+    t->now     = current_time;
+    t->current = ucs_max(t->current, target);
 }
 
 /**
@@ -109,7 +146,8 @@ static UCS_F_ALWAYS_INLINE int ucs_twheel_is_empty(ucs_twheel_t *t)
  *
  * @param twheel     Timer queue to schedule on.
  * @param timer      Timer callback to invoke every time.
- * @param delta      Invocation time
+ * @param delta      Invocation time, relative to the last sweep time. If the
+ *                   wheel is empty, it is first moved to the current time.
  *
  * NOTE: adding timer already in queue will do nothing
  */
@@ -132,12 +170,11 @@ static inline ucs_status_t ucs_wtimer_add(ucs_twheel_t *t, ucs_wtimer_t *timer,
  *
  * @param timer      timer to remove.
  */
+void __ucs_wtimer_remove(ucs_twheel_t *t, ucs_wtimer_t *timer);
 static inline void ucs_wtimer_remove(ucs_twheel_t *t, ucs_wtimer_t *timer)
 {
     if (ucs_likely(timer->is_active)) {
-        ucs_list_del(&timer->list);
-        timer->is_active = 0;
-        t->count--;
+        __ucs_wtimer_remove(t, timer);
     }
 }
 
@@ -545,7 +545,7 @@ enum uct_msg_flags {
  */
 enum uct_cb_flags {
     UCT_CB_FLAG_RESERVED = UCS_BIT(1), /**< Reserved for future use. */
-    UCT_CB_FLAG_ASYNC    = UCS_BIT(2)  /**< Callback is allowed to be called
+    UCT_CB_FLAG_ASYNC    = UCS_BIT(2), /**< Callback is allowed to be called
                                             from any thread in the process, and
                                             therefore should be thread-safe. For
                                             example, it may be called from a
@@ -560,6 +560,15 @@ enum uct_cb_flags {
                                             the callback will be invoked only
                                             from the context that called @ref
                                             uct_iface_progress). */
+    UCT_CB_FLAG_PRIO_HIGH = UCS_BIT(3) /**< Only for @ref uct_ep_pending_add:
+                                             the request is latency sensitive,
+                                             so the endpoint is dispatched
+                                             before endpoints which have only
+                                             normal priority requests. Requests
+                                             of the same endpoint are still
+                                             dispatched in order. Transports
+                                             which do not support priorities
+                                             ignore this flag. */
 };
 
 
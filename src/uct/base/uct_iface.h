@@ -418,13 +418,18 @@ uct_pending_req_priv_arb_elem(uct_pending_req_t *req)
 
 
 /**
- * Add a pending request to the arbiter.
+ * Add a pending request to the arbiter. If the request is high priority, the
+ * group is raised to the high priority class until the request is dispatched.
  */
-#define uct_pending_req_arb_group_push(_arbiter_group, _req) \
+#define uct_pending_req_arb_group_push(_arbiter_group, _req, _flags) \
     do { \
         ucs_arbiter_elem_init(uct_pending_req_priv_arb_elem(_req)); \
         ucs_arbiter_group_push_elem_always(_arbiter_group, \
                                            uct_pending_req_priv_arb_elem(_req)); \
+        if ((_flags) & UCT_CB_FLAG_PRIO_HIGH) { \
+            ucs_arbiter_group_set_prio_elem(_arbiter_group, \
+                                            uct_pending_req_priv_arb_elem(_req)); \
+        } \
     } while (0)
 
 
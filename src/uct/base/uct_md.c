@@ -39,6 +39,18 @@ ucs_config_field_t uct_md_config_rcache_table[] = {
      "between "UCS_PP_MAKE_STRING(UCS_PGT_ADDR_ALIGN)"and system page size",
      ucs_offsetof(uct_md_rcache_config_t, alignment), UCS_CONFIG_TYPE_UINT},
 
+    {"RCACHE_MAX_REGIONS", "inf",
+     "Maximal number of regions in the registration cache. When the limit is\n"
+     "exceeded, least recently used regions which are not in use are\n"
+     "deregistered.",
+     ucs_offsetof(uct_md_rcache_config_t, max_regions), UCS_CONFIG_TYPE_ULUNITS},
+
+    {"RCACHE_MAX_SIZE", "inf",
+     "Maximal total size of registered regions in the registration cache.\n"
+     "When the limit is exceeded, least recently used regions which are not\n"
+     "in use are deregistered.",
+     ucs_offsetof(uct_md_rcache_config_t, max_size), UCS_CONFIG_TYPE_MEMUNITS},
+
     {NULL}
 };
 
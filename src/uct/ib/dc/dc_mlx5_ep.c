@@ -1039,7 +1039,7 @@ void uct_dc_mlx5_ep_pending_common(uct_dc_mlx5_iface_t *iface,
                                             uct_dc_mlx5_iface_tx_waitq(iface),
                                             group, r);
     } else {
-        uct_pending_req_arb_group_push(group, r);
+        uct_pending_req_arb_group_push(group, r, flags);
     }
 
     if (no_dci) {
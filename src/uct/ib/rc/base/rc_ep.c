@@ -235,7 +235,7 @@ ucs_status_t uct_rc_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n,
 
     UCS_STATIC_ASSERT(sizeof(uct_pending_req_priv_arb_t) <=
                       UCT_PENDING_REQ_PRIV_LEN);
-    uct_pending_req_arb_group_push(&ep->arb_group, n);
+    uct_pending_req_arb_group_push(&ep->arb_group, n, flags);
     UCT_TL_EP_STAT_PEND(&ep->super);
 
     if (uct_rc_ep_has_tx_resources(ep)) {
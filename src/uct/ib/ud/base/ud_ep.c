@@ -1510,7 +1510,7 @@ add_req:
                       UCT_PENDING_REQ_PRIV_LEN);
     uct_ud_pending_req_priv(req)->flags = flags;
     uct_ud_ep_set_has_pending_flag(ep);
-    uct_pending_req_arb_group_push(&ep->tx.pending.group, req);
+    uct_pending_req_arb_group_push(&ep->tx.pending.group, req, flags);
     ucs_arbiter_group_schedule(&iface->tx.pending_q, &ep->tx.pending.group);
     ucs_trace_data("ud ep %p: added pending req %p tx_psn %d acked_psn %d cwnd %d",
                    ep, req, ep->tx.psn, ep->tx.acked_psn, ep->ca.cwnd);
@@ -1589,10 +1589,12 @@ void uct_ud_ep_disconnect(uct_ep_h tl_ep)
     /* the EP will be destroyed by interface destroy or timeout in
      * uct_ud_ep_timer
      */
-    ep->close_time = ucs_twheel_get_time(&iface->tx.timer);
     ep->flags |= UCT_UD_EP_FLAG_DISCONNECTED;
     ucs_wtimer_add(&iface->tx.timer, &ep->timer,
                    UCT_UD_SLOW_TIMER_MAX_TICK(iface));
+    /* read the time after adding the timer, which moves an empty wheel to the
+     * current time */
+    ep->close_time = ucs_twheel_get_time(&iface->tx.timer);
 
     uct_ud_leave(iface);
 }
@@ -515,6 +515,8 @@ uct_ud_iface_twheel_sweep(uct_ud_iface_t *iface)
         return;
     }
 
+    /* avoid reading the clock if no timers are scheduled, the wheel moves its
+     * time forward when a timer is added to it */
     if (ucs_twheel_is_empty(&iface->tx.timer)) {
         return;
     }
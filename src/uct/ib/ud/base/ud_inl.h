@@ -167,7 +167,9 @@ uct_ud_iface_complete_tx(uct_ud_iface_t *iface, uct_ud_ep_t *ep,
                          const void *buffer, unsigned length)
 {
     ucs_time_t now = uct_ud_iface_get_time(iface);
-    iface->tx.skb  = ucs_mpool_get(&iface->tx.mp);
+    ucs_time_t delta;
+
+    iface->tx.skb = ucs_mpool_get(&iface->tx.mp);
     ep->tx.psn++;
 
     if (has_data) {
@@ -179,8 +181,13 @@ uct_ud_iface_complete_tx(uct_ud_iface_t *iface, uct_ud_ep_t *ep,
     ep->tx.tick = iface->tx.tick;
 
     if (!iface->async.disable) {
-        ucs_wtimer_add(&iface->tx.timer, &ep->timer,
-                       now - ucs_twheel_get_time(&iface->tx.timer) + ep->tx.tick);
+        /* the delay is counted from the last sweep, unless the wheel is empty
+         * and is moved to the current time by the add */
+        delta = ep->tx.tick;
+        if (!ucs_twheel_is_empty(&iface->tx.timer)) {
+            delta += now - ucs_twheel_get_time(&iface->tx.timer);
+        }
+        ucs_wtimer_add(&iface->tx.timer, &ep->timer, delta);
     }
 
     ep->tx.send_time = now;
@@ -52,6 +52,9 @@
 
 #define UCT_TCP_CONFIG_MAX_CONN_RETRIES      "MAX_CONN_RETRIES"
 
+/* Maximum number of sockets (streams) which can be used by an endpoint */
+#define UCT_TCP_EP_MAX_STREAMS               16
+
 /* TX and RX caps */
 #define UCT_TCP_EP_CTX_CAPS                  (UCS_BIT(UCT_TCP_EP_CTX_TYPE_TX) | \
                                               UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX))
@@ -80,7 +83,11 @@ typedef enum uct_tcp_ep_ctx_type {
     UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK,
     /* - PUT RX operation is waiting for resources to send an ACK
      *   for received PUT operations on a given EP */
-    UCT_TCP_EP_CTX_TYPE_PUT_RX_SENDING_ACK
+    UCT_TCP_EP_CTX_TYPE_PUT_RX_SENDING_ACK,
+    /* - EP is an auxiliary stream of an EP which is used by a user. It
+     *   is not matched with other connections to/from the peer, and it is
+     *   hidden from the user */
+    UCT_TCP_EP_CTX_TYPE_AUX_STREAM
 } uct_tcp_ep_ctx_type_t;
 
 
@@ -193,6 +200,15 @@ typedef enum uct_tcp_cm_conn_event {
 } uct_tcp_cm_conn_event_t;
 
 
+/**
+ * TCP connection request flags
+ */
+enum {
+    /* Connection is an auxiliary stream of the peer's EP */
+    UCT_TCP_CM_CONN_REQ_FLAG_AUX_STREAM = UCS_BIT(0)
+};
+
+
 /**
  * TCP connection request packet
  */
@@ -202,6 +218,17 @@ typedef struct uct_tcp_cm_conn_req_pkt {
 } UCS_S_PACKED uct_tcp_cm_conn_req_pkt_t;
 
 
+/**
+ * TCP connection request packet with flags. It is sent only when some flags
+ * are set, so a regular connection request is understood by peers which
+ * don't support the flags.
+ */
+typedef struct uct_tcp_cm_conn_req_ext_pkt {
+    uct_tcp_cm_conn_req_pkt_t     super;      /* Connection request */
+    uint8_t                       flags;      /* Connection request flags */
+} UCS_S_PACKED uct_tcp_cm_conn_req_ext_pkt_t;
+
+
 /**
  * TCP active message header
  */
@@ -256,6 +283,35 @@ typedef struct uct_tcp_ep_put_completion {
 } uct_tcp_ep_put_completion_t;
 
 
+/**
+ * TCP MSG_ZEROCOPY send completion
+ */
+typedef struct uct_tcp_ep_zcopy_completion {
+    uct_completion_t              *comp;           /* User's completion passed to
+                                                    * Zcopy operation or uct_ep_flush */
+    uint32_t                      sn;              /* Number of MSG_ZEROCOPY sends which
+                                                    * have to be completed by the kernel
+                                                    * before the completion is invoked */
+    ucs_queue_elem_t              elem;            /* Element to insert completion into
+                                                    * TCP EP MSG_ZEROCOPY completion queue */
+} uct_tcp_ep_zcopy_completion_t;
+
+
+/**
+ * TCP PUT Zcopy striped across several streams completion
+ */
+typedef struct uct_tcp_ep_stripe_completion {
+    uct_completion_t              super;           /* Invoked by every stream which
+                                                    * the operation was striped to */
+    uct_completion_t              *comp;           /* User's completion passed to
+                                                    * PUT Zcopy operation */
+    unsigned                      count;           /* Number of streams which did
+                                                    * not complete yet */
+    ucs_status_t                  status;          /* First error reported by the
+                                                    * streams, or UCS_OK */
+} uct_tcp_ep_stripe_completion_t;
+
+
 /**
  * TCP endpoint communication context
  */
@@ -278,6 +334,11 @@ typedef struct uct_tcp_ep_zcopy_tx {
     uct_completion_t              *comp;     /* Local UCT completion object */
     size_t                        iov_index; /* Current IOV index */
     size_t                        iov_cnt;   /* Number of IOVs that should be sent */
+    size_t                        msg_zcopy_iov_index; /* Index of the first IOV which
+                                                        * is sent using MSG_ZEROCOPY,
+                                                        * or iov_cnt if none */
+    uct_tcp_ep_zcopy_completion_t *msg_zcopy_comp;     /* Completion to be queued upon
+                                                        * sending MSG_ZEROCOPY data */
     struct iovec                  iov[0];    /* IOVs that should be sent */
 } uct_tcp_ep_zcopy_tx_t;
 
@@ -292,12 +353,34 @@ struct uct_tcp_ep {
     uct_tcp_ep_conn_state_t       conn_state;       /* State of connection with peer */
     unsigned                      conn_retries;     /* Number of connection attempts done */
     int                           events;           /* Current notifications */
+    int                           ready_events;     /* Events reported by the event
+                                                     * set in edge-triggered mode and
+                                                     * not consumed yet */
+    ucs_list_link_t               ready_list;       /* Element in the iface list of
+                                                     * EPs ready for progress */
     uct_tcp_ep_ctx_t              tx;               /* TX resources */
     uct_tcp_ep_ctx_t              rx;               /* RX resources */
     struct sockaddr_in            peer_addr;        /* Remote iface addr */
     ucs_queue_head_t              pending_q;        /* Pending operations */
     ucs_queue_head_t              put_comp_q;       /* Flush completions waiting for
                                                      * outstanding PUTs acknowledgment */
+    unsigned                      fence_beat;       /* Fence sequence number */
+    struct {
+        uct_tcp_ep_t              *parent;          /* EP which owns this auxiliary
+                                                     * stream, or NULL */
+        uct_tcp_ep_t              **aux;            /* Auxiliary streams to the peer */
+        unsigned                  aux_count;        /* Number of auxiliary streams */
+    } stream;
+    struct {
+        uint32_t                  tx_sn;            /* Number of MSG_ZEROCOPY sends */
+        uint32_t                  comp_sn;          /* Number of MSG_ZEROCOPY sends
+                                                     * completed by the kernel */
+        ucs_queue_head_t          comp_q;           /* Completions waiting for the
+                                                     * kernel to release user buffers */
+        int                       nobufs;           /* MSG_ZEROCOPY send failed with
+                                                     * ENOBUFS, TX waits for
+                                                     * completions */
+    } msg_zcopy;
     ucs_list_link_t               list;             /* List element to insert into TCP EP list */
 };
 
@@ -313,12 +396,21 @@ typedef struct uct_tcp_iface {
     ucs_list_link_t               ep_list;           /* List of endpoints */
     char                          if_name[IFNAMSIZ]; /* Network interface name */
     ucs_sys_event_set_t           *event_set;        /* Event set identifier */
+    struct {
+        ucs_list_link_t           list;              /* EPs which have events to
+                                                      * progress in edge-triggered mode */
+        uct_tcp_ep_t              *cur_ep;           /* EP which is being progressed, reset
+                                                      * to NULL if it is destroyed */
+    } ready;
     ucs_mpool_t                   tx_mpool;          /* TX memory pool */
     ucs_mpool_t                   rx_mpool;          /* RX memory pool */
+    unsigned                      fence_beat;        /* Fence sequence number */
     size_t                        outstanding;       /* How much data in the EP send buffers
                                                       * + how many non-blocking connections
                                                       * are in progress + how many EPs are
                                                       * waiting for PUT Zcopy operation ACKs
+                                                      * (0/1 for each EP) + how many EPs are
+                                                      * waiting for MSG_ZEROCOPY completions
                                                       * (0/1 for each EP) */
 
     struct {
@@ -333,12 +425,20 @@ typedef struct uct_tcp_iface {
             size_t                max_hdr;           /* Maximum supported AM Zcopy header */
             size_t                hdr_offset;        /* Offset in TX buffer to empty space that
                                                       * can be used for AM Zcopy header */
+            size_t                msg_zcopy_thresh;  /* Minimum size of user's payload from which
+                                                      * MSG_ZEROCOPY send should be used */
         } zcopy;
         struct sockaddr_in        ifaddr;            /* Network address */
         struct sockaddr_in        netmask;           /* Network address mask */
         int                       prefer_default;    /* Prefer default gateway */
         int                       put_enable;        /* Enable PUT Zcopy operation support */
+        struct {
+            unsigned              count;             /* Number of sockets per EP */
+            size_t                stripe_thresh;     /* Minimum size of PUT Zcopy payload
+                                                      * which is striped across sockets */
+        } streams;
         int                       conn_nb;           /* Use non-blocking connect() */
+        int                       edge_triggered;    /* Use edge-triggered notifications */
         unsigned                  max_poll;          /* Number of events to poll per socket*/
         unsigned                  max_conn_retries;  /* How many connection establishment attmepts
                                                       * should be done if dropped connection was
@@ -365,9 +465,13 @@ typedef struct uct_tcp_iface_config {
     size_t                         rx_seg_size;
     size_t                         max_iov;
     size_t                         sendv_thresh;
+    size_t                         msg_zcopy_thresh;
+    unsigned                       num_streams;
+    size_t                         stripe_thresh;
     int                            prefer_default;
     int                            put_enable;
     int                            conn_nb;
+    int                            edge_triggered;
     unsigned                       max_poll;
     unsigned                       max_conn_retries;
     int                            sockopt_nodelay;
@@ -441,8 +545,14 @@ void uct_tcp_ep_add(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep);
 
 void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, int add, int remove);
 
+void uct_tcp_ep_set_ready(uct_tcp_ep_t *ep, int events);
+
+unsigned uct_tcp_ep_progress_ready(uct_tcp_ep_t *ep);
+
 void uct_tcp_ep_pending_queue_dispatch(uct_tcp_ep_t *ep);
 
+unsigned uct_tcp_ep_progress_msg_zcopy(uct_tcp_ep_t *ep);
+
 ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header,
                                  const void *payload, unsigned length);
 
@@ -465,6 +575,8 @@ ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req,
 void uct_tcp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_purge_callback_t cb,
                               void *arg);
 
+ucs_status_t uct_tcp_ep_fence(uct_ep_h tl_ep, unsigned flags);
+
 ucs_status_t uct_tcp_ep_flush(uct_ep_h tl_ep, unsigned flags,
                               uct_completion_t *comp);
 
@@ -150,9 +150,10 @@ ucs_status_t uct_tcp_cm_send_event(uct_tcp_ep_t *ep, uct_tcp_cm_conn_event_t eve
     uct_tcp_iface_t *iface     = ucs_derived_of(ep->super.super.iface,
                                                 uct_tcp_iface_t);
     size_t magic_number_length = 0;
+    uint8_t conn_flags         = 0;
     void *pkt_buf;
     size_t pkt_length, cm_pkt_length;
-    uct_tcp_cm_conn_req_pkt_t *conn_pkt;
+    uct_tcp_cm_conn_req_ext_pkt_t *conn_pkt;
     uct_tcp_cm_conn_event_t *pkt_event;
     uct_tcp_am_hdr_t *pkt_hdr;
     ucs_status_t status;
@@ -167,7 +168,11 @@ ucs_status_t uct_tcp_cm_send_event(uct_tcp_ep_t *ep, uct_tcp_cm_conn_event_t eve
 
     pkt_length                  = sizeof(*pkt_hdr);
     if (event == UCT_TCP_CM_CONN_REQ) {
-        cm_pkt_length           = sizeof(*conn_pkt);
+        conn_flags              = (ep->ctx_caps &
+                                   UCS_BIT(UCT_TCP_EP_CTX_TYPE_AUX_STREAM)) ?
+                                  UCT_TCP_CM_CONN_REQ_FLAG_AUX_STREAM : 0;
+        cm_pkt_length           = (conn_flags != 0) ? sizeof(*conn_pkt) :
+                                  sizeof(conn_pkt->super);
 
         if (ep->conn_state == UCT_TCP_EP_CONN_STATE_CONNECTING) {
             magic_number_length = sizeof(uint64_t);
@@ -189,9 +194,14 @@ ucs_status_t uct_tcp_cm_send_event(uct_tcp_ep_t *ep, uct_tcp_cm_conn_event_t eve
             *(uint64_t*)pkt_buf = UCT_TCP_MAGIC_NUMBER;
         }
 
-        conn_pkt             = (uct_tcp_cm_conn_req_pkt_t*)(pkt_hdr + 1);
-        conn_pkt->event      = UCT_TCP_CM_CONN_REQ;
-        conn_pkt->iface_addr = iface->config.ifaddr;
+        conn_pkt                   = (uct_tcp_cm_conn_req_ext_pkt_t*)
+                                     (pkt_hdr + 1);
+        conn_pkt->super.event      = UCT_TCP_CM_CONN_REQ;
+        conn_pkt->super.iface_addr = iface->config.ifaddr;
+        if (conn_flags != 0) {
+            /* Only the extended request carries the flags */
+            conn_pkt->flags        = conn_flags;
+        }
     } else {
         pkt_event            = (uct_tcp_cm_conn_event_t*)(pkt_hdr + 1);
         *pkt_event           = event;
@@ -407,7 +417,8 @@ static unsigned uct_tcp_cm_handle_simult_conn(uct_tcp_iface_t *iface,
 
 static unsigned
 uct_tcp_cm_handle_conn_req(uct_tcp_ep_t **ep_p,
-                           const uct_tcp_cm_conn_req_pkt_t *cm_req_pkt)
+                           const uct_tcp_cm_conn_req_pkt_t *cm_req_pkt,
+                           uint8_t conn_flags)
 {
     uct_tcp_ep_t *ep        = *ep_p;
     uct_tcp_iface_t *iface  = ucs_derived_of(ep->super.super.iface,
@@ -420,6 +431,13 @@ uct_tcp_cm_handle_conn_req(uct_tcp_ep_t **ep_p,
     uct_tcp_cm_trace_conn_pkt(ep, UCS_LOG_LEVEL_TRACE,
                               "%s received from", UCT_TCP_CM_CONN_REQ);
 
+    if (conn_flags & UCT_TCP_CM_CONN_REQ_FLAG_AUX_STREAM) {
+        /* Auxiliary stream of the peer's EP is used only to receive
+         * data, so it mustn't be matched with our connections */
+        uct_tcp_ep_change_ctx_caps(ep, ep->ctx_caps |
+                                   UCS_BIT(UCT_TCP_EP_CTX_TYPE_AUX_STREAM));
+    }
+
     status = uct_tcp_ep_add_ctx_cap(ep, UCT_TCP_EP_CTX_TYPE_RX);
     if (status != UCS_OK) {
         goto out;
@@ -433,6 +451,7 @@ uct_tcp_cm_handle_conn_req(uct_tcp_ep_t **ep_p,
                 "ep %p mustn't have TX cap", ep);
 
     if (!uct_tcp_ep_is_self(ep) &&
+        !(ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_AUX_STREAM)) &&
         (peer_ep = uct_tcp_cm_search_ep(iface, &ep->peer_addr,
                                         UCT_TCP_EP_CTX_TYPE_TX))) {
         progress_count = uct_tcp_cm_handle_simult_conn(iface, ep, peer_ep);
@@ -476,6 +495,7 @@ unsigned uct_tcp_cm_handle_conn_pkt(uct_tcp_ep_t **ep_p, void *pkt, uint32_t len
     uct_tcp_cm_conn_event_t cm_event;
     uct_tcp_cm_conn_req_pkt_t *cm_req_pkt;
     uct_tcp_ep_conn_state_t new_conn_state;
+    uint8_t conn_flags;
 
     ucs_assertv(length >= sizeof(cm_event), "ep=%p", *ep_p);
 
@@ -485,9 +505,13 @@ unsigned uct_tcp_cm_handle_conn_pkt(uct_tcp_ep_t **ep_p, void *pkt, uint32_t len
     case UCT_TCP_CM_CONN_REQ:
         /* Don't trace received CM packet here, because
          * EP doesn't contain the peer address */
-        ucs_assertv(length == sizeof(*cm_req_pkt), "ep=%p", *ep_p);
+        ucs_assertv((length == sizeof(*cm_req_pkt)) ||
+                    (length == sizeof(uct_tcp_cm_conn_req_ext_pkt_t)),
+                    "ep=%p", *ep_p);
         cm_req_pkt = (uct_tcp_cm_conn_req_pkt_t*)pkt;
-        return uct_tcp_cm_handle_conn_req(ep_p, cm_req_pkt);
+        conn_flags = (length == sizeof(*cm_req_pkt)) ? 0 :
+                     ((uct_tcp_cm_conn_req_ext_pkt_t*)pkt)->flags;
+        return uct_tcp_cm_handle_conn_req(ep_p, cm_req_pkt, conn_flags);
     case UCT_TCP_CM_CONN_ACK_WITH_WAIT_REQ:
         if (!((*ep_p)->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX))) {
             new_conn_state = UCT_TCP_EP_CONN_STATE_WAITING_REQ;
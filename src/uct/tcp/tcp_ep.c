@@ -16,6 +16,9 @@
 static unsigned uct_tcp_ep_progress_data_tx(uct_tcp_ep_t *ep);
 static unsigned uct_tcp_ep_progress_data_rx(uct_tcp_ep_t *ep);
 static unsigned uct_tcp_ep_progress_magic_number_rx(uct_tcp_ep_t *ep);
+static inline void uct_tcp_ep_comp_zcopy(uct_tcp_ep_t *ep,
+                                         uct_tcp_ep_zcopy_tx_t *ctx,
+                                         ucs_status_t status);
 
 const uct_tcp_cm_state_t uct_tcp_ep_cm_state[] = {
     [UCT_TCP_EP_CONN_STATE_CLOSED]      = {
@@ -69,8 +72,31 @@ static inline int uct_tcp_ep_ctx_buf_need_progress(uct_tcp_ep_ctx_t *ctx)
     return ctx->offset < ctx->length;
 }
 
+static ucs_status_t uct_tcp_ep_check_fence(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    unsigned i;
+
+    /* PUT operations on auxiliary streams are ordered with the following
+     * operations only after they are acknowledged by the peer */
+    for (i = 0; i < ep->stream.aux_count; ++i) {
+        if ((ep->stream.aux[i] != NULL) &&
+            (ep->stream.aux[i]->ctx_caps &
+             UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK))) {
+            return UCS_ERR_NO_RESOURCE;
+        }
+    }
+
+    ep->fence_beat = iface->fence_beat;
+    return UCS_OK;
+}
+
 static inline ucs_status_t uct_tcp_ep_check_tx_res(uct_tcp_ep_t *ep)
 {
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
     if (ucs_unlikely(ep->conn_state != UCT_TCP_EP_CONN_STATE_CONNECTED)) {
         if (ep->conn_state == UCT_TCP_EP_CONN_STATE_CLOSED) {
             return UCS_ERR_UNREACHABLE;
@@ -83,7 +109,16 @@ static inline ucs_status_t uct_tcp_ep_check_tx_res(uct_tcp_ep_t *ep)
         return UCS_ERR_NO_RESOURCE;
     }
 
-    return uct_tcp_ep_ctx_buf_empty(&ep->tx) ? UCS_OK : UCS_ERR_NO_RESOURCE;
+    if (!uct_tcp_ep_ctx_buf_empty(&ep->tx) ||
+        ucs_unlikely(ep->msg_zcopy.nobufs)) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    if (ucs_unlikely(ep->fence_beat != iface->fence_beat)) {
+        return uct_tcp_ep_check_fence(ep);
+    }
+
+    return UCS_OK;
 }
 
 static inline void uct_tcp_ep_ctx_rewind(uct_tcp_ep_ctx_t *ctx)
@@ -136,11 +171,22 @@ unsigned uct_tcp_ep_is_self(const uct_tcp_ep_t *ep)
     return !cmp;
 }
 
+static int uct_tcp_ep_is_cm_managed(const uct_tcp_ep_t *ep)
+{
+    /* EPs connected to the own iface and auxiliary streams are not
+     * matched with other connections to/from the peer */
+    return !(ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_AUX_STREAM)) &&
+           !uct_tcp_ep_is_self(ep);
+}
+
 static void uct_tcp_ep_cleanup(uct_tcp_ep_t *ep)
 {
     uct_tcp_ep_addr_cleanup(&ep->peer_addr);
 
     if (ep->tx.buf != NULL) {
+        if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_ZCOPY_TX)) {
+            ucs_free(((uct_tcp_ep_zcopy_tx_t*)ep->tx.buf)->msg_zcopy_comp);
+        }
         uct_tcp_ep_ctx_reset(&ep->tx);
     }
 
@@ -169,15 +215,25 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_tcp_iface_t *iface,
     uct_tcp_ep_ctx_init(&self->tx);
     uct_tcp_ep_ctx_init(&self->rx);
 
-    self->events        = 0;
-    self->conn_retries  = 0;
-    self->fd            = fd;
-    self->ctx_caps      = 0;
-    self->conn_state    = UCT_TCP_EP_CONN_STATE_CLOSED;
+    self->events           = 0;
+    self->ready_events     = 0;
+    self->conn_retries     = 0;
+    self->fd               = fd;
+    self->ctx_caps         = 0;
+    self->conn_state       = UCT_TCP_EP_CONN_STATE_CLOSED;
+    self->fence_beat       = iface->fence_beat;
+    self->stream.parent    = NULL;
+    self->stream.aux       = NULL;
+    self->stream.aux_count = 0;
+    ucs_list_head_init(&self->ready_list);
 
     ucs_list_head_init(&self->list);
     ucs_queue_head_init(&self->pending_q);
     ucs_queue_head_init(&self->put_comp_q);
+    ucs_queue_head_init(&self->msg_zcopy.comp_q);
+    self->msg_zcopy.tx_sn   = 0;
+    self->msg_zcopy.comp_sn = 0;
+    self->msg_zcopy.nobufs  = 0;
 
     /* Make a socket non-blocking if an EP is created during accepting
      * a connection or non-blocking connection mode is requested */
@@ -205,6 +261,122 @@ err_cleanup:
     return status;
 }
 
+static void
+uct_tcp_ep_push_msg_zcopy_comp(uct_tcp_ep_t *ep,
+                               uct_tcp_ep_zcopy_completion_t *zcopy_comp,
+                               uct_completion_t *comp)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    if (ucs_queue_is_empty(&ep->msg_zcopy.comp_q)) {
+        /* Increment iface outstanding operations counter to ensure returning
+         * UCS_INPROGRESS from iface flush until the kernel releases all
+         * buffers, and get notified about completions in the error queue */
+        uct_tcp_iface_outstanding_inc(iface);
+        uct_tcp_ep_mod_events(ep, UCS_EVENT_SET_EVERR, 0);
+    }
+
+    zcopy_comp->comp = comp;
+    zcopy_comp->sn   = ep->msg_zcopy.tx_sn;
+    ucs_queue_push(&ep->msg_zcopy.comp_q, &zcopy_comp->elem);
+}
+
+static void uct_tcp_ep_msg_zcopy_comp_q_empty(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    uct_tcp_iface_outstanding_dec(iface);
+    uct_tcp_ep_mod_events(ep, 0, UCS_EVENT_SET_EVERR);
+}
+
+static void uct_tcp_ep_purge_msg_zcopy(uct_tcp_ep_t *ep, ucs_status_t status)
+{
+    uct_tcp_ep_zcopy_completion_t *zcopy_comp;
+
+    if (ucs_queue_is_empty(&ep->msg_zcopy.comp_q)) {
+        return;
+    }
+
+    ucs_queue_for_each_extract(zcopy_comp, &ep->msg_zcopy.comp_q, elem, 1) {
+        if (zcopy_comp->comp != NULL) {
+            uct_invoke_completion(zcopy_comp->comp, status);
+        }
+        ucs_free(zcopy_comp);
+    }
+
+    uct_tcp_ep_msg_zcopy_comp_q_empty(ep);
+}
+
+unsigned uct_tcp_ep_progress_msg_zcopy(uct_tcp_ep_t *ep)
+{
+    unsigned count = 0;
+    uct_tcp_ep_zcopy_completion_t *zcopy_comp;
+    uint32_t first, last;
+
+    /* The kernel reports ranges of completed MSG_ZEROCOPY sends, the ranges
+     * are reported in order for TCP sockets */
+    while (ucs_socket_zcopy_completion(ep->fd, &first, &last) == UCS_OK) {
+        ucs_trace_data("tcp_ep %p: MSG_ZEROCOPY sends [%u..%u] completed",
+                       ep, first, last);
+        if (UCS_CIRCULAR_COMPARE32(last + 1, >, ep->msg_zcopy.comp_sn)) {
+            ep->msg_zcopy.comp_sn = last + 1;
+        }
+    }
+
+    ucs_queue_for_each_extract(zcopy_comp, &ep->msg_zcopy.comp_q, elem,
+                               UCS_CIRCULAR_COMPARE32(zcopy_comp->sn, <=,
+                                                      ep->msg_zcopy.comp_sn)) {
+        if (zcopy_comp->comp != NULL) {
+            uct_invoke_completion(zcopy_comp->comp, UCS_OK);
+        }
+        ucs_free(zcopy_comp);
+        ++count;
+    }
+
+    if ((count > 0) && ucs_queue_is_empty(&ep->msg_zcopy.comp_q)) {
+        uct_tcp_ep_msg_zcopy_comp_q_empty(ep);
+    }
+
+    if ((count > 0) && ep->msg_zcopy.nobufs) {
+        /* The kernel released buffers, resume sending the outstanding data
+         * and dispatching pending operations */
+        ep->msg_zcopy.nobufs = 0;
+        uct_tcp_ep_mod_events(ep, UCS_EVENT_SET_EVWRITE, 0);
+    }
+
+    return count;
+}
+
+/* Complete the operations which wait for the data sent by the EP to be
+ * transmitted or acknowledged by the peer */
+static void uct_tcp_ep_purge_tx(uct_tcp_ep_t *ep, ucs_status_t status)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_ep_put_completion_t *put_comp;
+
+    if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_ZCOPY_TX)) {
+        /* The remaining data of a Zcopy operation will never be sent */
+        uct_tcp_ep_comp_zcopy(ep, (uct_tcp_ep_zcopy_tx_t*)ep->tx.buf,
+                              status);
+    }
+
+    if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK)) {
+        /* PUT ACKs will never be received */
+        ep->ctx_caps &= ~UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK);
+        uct_tcp_iface_outstanding_dec(iface);
+    }
+
+    ucs_queue_for_each_extract(put_comp, &ep->put_comp_q, elem, 1) {
+        uct_invoke_completion(put_comp->comp, status);
+        ucs_free(put_comp);
+    }
+
+    uct_tcp_ep_purge_msg_zcopy(ep, status);
+}
+
 const char *uct_tcp_ep_ctx_caps_str(uint8_t ep_ctx_caps, char *str_buffer)
 {
     ucs_snprintf_zero(str_buffer, UCT_TCP_EP_CTX_CAPS_STR_MAX, "[%s:%s]",
@@ -236,7 +408,7 @@ ucs_status_t uct_tcp_ep_add_ctx_cap(uct_tcp_ep_t *ep,
     uint8_t prev_caps      = ep->ctx_caps;
 
     uct_tcp_ep_change_ctx_caps(ep, ep->ctx_caps | UCS_BIT(cap));
-    if (!uct_tcp_ep_is_self(ep) && (prev_caps != ep->ctx_caps)) {
+    if (uct_tcp_ep_is_cm_managed(ep) && (prev_caps != ep->ctx_caps)) {
         if (!(prev_caps & UCT_TCP_EP_CTX_CAPS)) {
             return uct_tcp_cm_add_ep(iface, ep);
         } else if (ucs_test_all_flags(ep->ctx_caps, UCT_TCP_EP_CTX_CAPS)) {
@@ -255,7 +427,7 @@ ucs_status_t uct_tcp_ep_remove_ctx_cap(uct_tcp_ep_t *ep,
     uint8_t prev_caps      = ep->ctx_caps;
 
     uct_tcp_ep_change_ctx_caps(ep, ep->ctx_caps & ~UCS_BIT(cap));
-    if (!uct_tcp_ep_is_self(ep)) {
+    if (uct_tcp_ep_is_cm_managed(ep)) {
         if (ucs_test_all_flags(prev_caps, UCT_TCP_EP_CTX_CAPS)) {
             return uct_tcp_cm_add_ep(iface, ep);
         } else if (!(ep->ctx_caps & UCT_TCP_EP_CTX_CAPS)) {
@@ -281,12 +453,33 @@ ucs_status_t uct_tcp_ep_move_ctx_cap(uct_tcp_ep_t *from_ep, uct_tcp_ep_t *to_ep,
 
 static UCS_CLASS_CLEANUP_FUNC(uct_tcp_ep_t)
 {
-    uct_tcp_iface_t UCS_V_UNUSED *iface =
-        ucs_derived_of(self->super.super.iface, uct_tcp_iface_t);
-    uct_tcp_ep_put_completion_t *put_comp;
+    uct_tcp_iface_t *iface = ucs_derived_of(self->super.super.iface,
+                                            uct_tcp_iface_t);
+    unsigned i;
+
+    for (i = 0; i < self->stream.aux_count; ++i) {
+        if (self->stream.aux[i] != NULL) {
+            uct_tcp_ep_destroy_internal(&self->stream.aux[i]->super.super);
+        }
+    }
+    ucs_free(self->stream.aux);
+
+    if (self->stream.parent != NULL) {
+        /* Detach from the parent EP */
+        for (i = 0; i < self->stream.parent->stream.aux_count; ++i) {
+            if (self->stream.parent->stream.aux[i] == self) {
+                self->stream.parent->stream.aux[i] = NULL;
+            }
+        }
+    }
 
     uct_tcp_ep_mod_events(self, 0, self->events);
 
+    ucs_list_del(&self->ready_list);
+    if (iface->ready.cur_ep == self) {
+        iface->ready.cur_ep = NULL;
+    }
+
     if (self->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_TX)) {
         uct_tcp_ep_remove_ctx_cap(self, UCT_TCP_EP_CTX_TYPE_TX);
     }
@@ -297,9 +490,7 @@ static UCS_CLASS_CLEANUP_FUNC(uct_tcp_ep_t)
 
     ucs_assertv(!(self->ctx_caps & UCT_TCP_EP_CTX_CAPS), "ep=%p", self);
 
-    ucs_queue_for_each_extract(put_comp, &self->put_comp_q, elem, 1) {
-        ucs_free(put_comp);
-    }
+    uct_tcp_ep_purge_tx(self, UCS_ERR_CANCELED);
 
     uct_tcp_iface_remove_ep(self);
 
@@ -323,6 +514,18 @@ UCS_CLASS_DEFINE_NAMED_DELETE_FUNC(uct_tcp_ep_destroy_internal,
 void uct_tcp_ep_destroy(uct_ep_h tl_ep)
 {
     uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    unsigned i;
+
+    /* Auxiliary streams are used only to send data, so they are not needed
+     * anymore */
+    for (i = 0; i < ep->stream.aux_count; ++i) {
+        if (ep->stream.aux[i] != NULL) {
+            uct_tcp_ep_destroy_internal(&ep->stream.aux[i]->super.super);
+        }
+    }
+    ucs_free(ep->stream.aux);
+    ep->stream.aux       = NULL;
+    ep->stream.aux_count = 0;
 
     if ((ep->conn_state == UCT_TCP_EP_CONN_STATE_CONNECTED) &&
         ucs_test_all_flags(ep->ctx_caps, UCT_TCP_EP_CTX_CAPS)) {
@@ -337,11 +540,30 @@ void uct_tcp_ep_set_failed(uct_tcp_ep_t *ep)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
                                             uct_tcp_iface_t);
+    unsigned i;
+
+    if (ep->stream.parent != NULL) {
+        /* Auxiliary stream is not exposed to the user, and the data striped
+         * to it is lost, so fail the parent EP. The stream is destroyed
+         * together with the parent EP. */
+        ucs_debug("tcp_ep %p: auxiliary stream of tcp_ep %p failed", ep,
+                  ep->stream.parent);
+        ep = ep->stream.parent;
+    }
 
     if (ep->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED) {
         uct_tcp_cm_change_conn_state(ep, UCT_TCP_EP_CONN_STATE_CLOSED);
     }
 
+    /* Complete the operations on all streams with the error before the EP
+     * cleanup cancels them */
+    for (i = 0; i < ep->stream.aux_count; ++i) {
+        if (ep->stream.aux[i] != NULL) {
+            uct_tcp_ep_purge_tx(ep->stream.aux[i], UCS_ERR_UNREACHABLE);
+        }
+    }
+    uct_tcp_ep_purge_tx(ep, UCS_ERR_UNREACHABLE);
+
     uct_set_ep_failed(&UCS_CLASS_NAME(uct_tcp_ep_t),
                       &ep->super.super, &iface->super.super,
                       UCS_ERR_UNREACHABLE);
@@ -375,6 +597,16 @@ uct_tcp_ep_create_socket_and_connect(uct_tcp_iface_t *iface,
     } else {
         ep     = *ep_p;
         ep->fd = fd;
+
+        /* MSG_ZEROCOPY sends are counted by the kernel per socket */
+        ucs_assertv(ucs_queue_is_empty(&ep->msg_zcopy.comp_q), "ep=%p", ep);
+        ep->msg_zcopy.tx_sn   = 0;
+        ep->msg_zcopy.comp_sn = 0;
+
+        status = uct_tcp_iface_set_sockopt(iface, ep->fd);
+        if (status != UCS_OK) {
+            goto err_ep_destroy;
+        }
     }
 
     status = uct_tcp_cm_conn_start(ep);
@@ -423,6 +655,51 @@ err_ep_destroy:
     return status;
 }
 
+static ucs_status_t uct_tcp_ep_create_streams(uct_tcp_iface_t *iface,
+                                              uct_tcp_ep_t *ep)
+{
+    unsigned count = iface->config.streams.count - 1;
+    uct_tcp_ep_t *aux_ep;
+    ucs_status_t status;
+    int fd;
+
+    ep->stream.aux = ucs_calloc(count, sizeof(*ep->stream.aux),
+                                "tcp_ep_streams");
+    if (ep->stream.aux == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    for (ep->stream.aux_count = 0; ep->stream.aux_count < count;
+         ++ep->stream.aux_count) {
+        status = ucs_socket_create(AF_INET, SOCK_STREAM, &fd);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        status = uct_tcp_ep_init(iface, fd, &ep->peer_addr, &aux_ep);
+        if (status != UCS_OK) {
+            ucs_close_fd(&fd);
+            return status;
+        }
+
+        /* The flag has to be set prior starting the connection establishment,
+         * since the connection request is sent to the peer with it */
+        uct_tcp_ep_change_ctx_caps(aux_ep,
+                                   UCS_BIT(UCT_TCP_EP_CTX_TYPE_TX) |
+                                   UCS_BIT(UCT_TCP_EP_CTX_TYPE_AUX_STREAM));
+        aux_ep->stream.parent                = ep;
+        ep->stream.aux[ep->stream.aux_count] = aux_ep;
+
+        status = uct_tcp_cm_conn_start(aux_ep);
+        if (status != UCS_OK) {
+            uct_tcp_ep_destroy_internal(&aux_ep->super.super);
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
 ucs_status_t uct_tcp_ep_create(const uct_ep_params_t *params,
                                uct_ep_h *ep_p)
 {
@@ -464,6 +741,13 @@ ucs_status_t uct_tcp_ep_create(const uct_ep_params_t *params,
         }
     } while (ep == NULL);
 
+    if ((status == UCS_OK) && (iface->config.streams.count > 1)) {
+        status = uct_tcp_ep_create_streams(iface, ep);
+        if (status != UCS_OK) {
+            uct_tcp_ep_destroy(&ep->super.super);
+        }
+    }
+
     if (status == UCS_OK) {
         /* cppcheck-suppress autoVariables */
         *ep_p = &ep->super.super;
@@ -471,6 +755,89 @@ ucs_status_t uct_tcp_ep_create(const uct_ep_params_t *params,
     return status;
 }
 
+void uct_tcp_ep_set_ready(uct_tcp_ep_t *ep, int events)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    ep->ready_events |= events;
+    if ((ep->ready_events & ep->events) &&
+        ucs_list_is_empty(&ep->ready_list)) {
+        ucs_list_add_tail(&iface->ready.list, &ep->ready_list);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void
+uct_tcp_ep_clear_ready(uct_tcp_ep_t *ep, int events)
+{
+    /* The EP stays in the ready list until it is progressed, but the
+     * consumed events are not handled anymore */
+    ep->ready_events &= ~events;
+}
+
+unsigned uct_tcp_ep_progress_ready(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    int events             = ep->ready_events & ep->events;
+    unsigned count         = 0;
+
+    ucs_assertv(ep->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED, "ep=%p", ep);
+
+    if (events & UCS_EVENT_SET_EVERR) {
+        /* The error queue is drained by the progress */
+        uct_tcp_ep_clear_ready(ep, UCS_EVENT_SET_EVERR);
+        count += uct_tcp_ep_progress_msg_zcopy(ep);
+    }
+
+    /* The EP is marked as not ready for RX/TX when a socket call returns
+     * EAGAIN, or less data than requested is received */
+    if (events & UCS_EVENT_SET_EVREAD) {
+        count += uct_tcp_ep_cm_state[ep->conn_state].rx_progress(ep);
+        if (iface->ready.cur_ep != ep) {
+            /* The EP was destroyed */
+            return count;
+        }
+    }
+
+    if (ep->ready_events & ep->events & UCS_EVENT_SET_EVWRITE) {
+        count += uct_tcp_ep_cm_state[ep->conn_state].tx_progress(ep);
+    }
+
+    return count;
+}
+
+static void uct_tcp_ep_mod_events_edge(uct_tcp_iface_t *iface,
+                                       uct_tcp_ep_t *ep, int old_events)
+{
+    ucs_status_t status;
+
+    /* The socket is registered for all events, so only adding and removing
+     * the socket modifies the event set. EPOLLERR is always reported. */
+    if (ep->events == 0) {
+        status           = ucs_event_set_del(iface->event_set, ep->fd);
+        ep->ready_events = 0;
+        ucs_list_del(&ep->ready_list);
+        ucs_list_head_init(&ep->ready_list);
+    } else if (old_events == 0) {
+        ep->ready_events = 0;
+        status           = ucs_event_set_add(iface->event_set, ep->fd,
+                                             UCS_EVENT_SET_EVREAD |
+                                             UCS_EVENT_SET_EVWRITE |
+                                             UCS_EVENT_SET_EDGE_TRIGGERED,
+                                             (void*)ep);
+    } else {
+        /* Events which were reported before could be handled now */
+        uct_tcp_ep_set_ready(ep, 0);
+        return;
+    }
+
+    if (status != UCS_OK) {
+        ucs_fatal("unable to modify event set for tcp_ep %p (fd=%d)", ep,
+                  ep->fd);
+    }
+}
+
 void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, int add, int rem)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
@@ -484,6 +851,11 @@ void uct_tcp_ep_mod_events(uct_tcp_ep_t *ep, int add, int rem)
         ucs_trace("tcp_ep %p: set events to %c%c", ep,
                   (new_events & UCS_EVENT_SET_EVREAD)  ? 'r' : '-',
                   (new_events & UCS_EVENT_SET_EVWRITE) ? 'w' : '-');
+        if (iface->config.edge_triggered) {
+            uct_tcp_ep_mod_events_edge(iface, ep, old_events);
+            return;
+        }
+
         if (new_events == 0) {
             status = ucs_event_set_del(iface->event_set, ep->fd);
         } else if (old_events != 0) {
@@ -523,6 +895,13 @@ static inline void uct_tcp_ep_handle_put_ack(uct_tcp_ep_t *ep,
         uct_invoke_completion(put_comp->comp, UCS_OK);
         ucs_free(put_comp);
     }
+
+    if ((ep->stream.parent != NULL) &&
+        !(ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK)) &&
+        !ucs_queue_is_empty(&ep->stream.parent->pending_q)) {
+        /* Operations on the parent EP may wait for a fence */
+        uct_tcp_ep_pending_queue_dispatch(ep->stream.parent);
+    }
 }
 
 void uct_tcp_ep_pending_queue_dispatch(uct_tcp_ep_t *ep)
@@ -530,9 +909,15 @@ void uct_tcp_ep_pending_queue_dispatch(uct_tcp_ep_t *ep)
     uct_pending_req_priv_queue_t *priv;
 
     uct_pending_queue_dispatch(priv, &ep->pending_q,
-                               uct_tcp_ep_ctx_buf_empty(&ep->tx));
+                               uct_tcp_ep_check_tx_res(ep) == UCS_OK);
     if (uct_tcp_ep_ctx_buf_empty(&ep->tx)) {
-        ucs_assert(ucs_queue_is_empty(&ep->pending_q));
+        /* Pending operations may remain only if they wait for a fence, they
+         * are dispatched when PUT ACKs are received on auxiliary streams, or
+         * for MSG_ZEROCOPY completions */
+        ucs_assert(ucs_queue_is_empty(&ep->pending_q) ||
+                   ep->msg_zcopy.nobufs ||
+                   (ep->fence_beat != ucs_derived_of(ep->super.super.iface,
+                                                     uct_tcp_iface_t)->fence_beat));
         uct_tcp_ep_mod_events(ep, 0, UCS_EVENT_SET_EVWRITE);
     }
 }
@@ -542,6 +927,15 @@ static void uct_tcp_ep_handle_disconnected(uct_tcp_ep_t *ep,
 {
     ucs_debug("tcp_ep %p: remote disconnected", ep);
 
+    if ((ep->stream.parent != NULL) &&
+        ((ep->ctx_caps & (UCS_BIT(UCT_TCP_EP_CTX_TYPE_ZCOPY_TX) |
+                          UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK))) ||
+         !ucs_queue_is_empty(&ep->msg_zcopy.comp_q))) {
+        /* Data striped to the auxiliary stream is lost */
+        uct_tcp_ep_set_failed(ep);
+        return;
+    }
+
     uct_tcp_ep_ctx_reset(ctx);
 
     if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_TX)) {
@@ -549,6 +943,7 @@ static void uct_tcp_ep_handle_disconnected(uct_tcp_ep_t *ep,
             uct_tcp_ep_remove_ctx_cap(ep, UCT_TCP_EP_CTX_TYPE_RX);
         }
 
+        uct_tcp_ep_purge_msg_zcopy(ep, UCS_ERR_CONNECTION_RESET);
         uct_tcp_ep_mod_events(ep, 0, ep->events);
         ucs_close_fd(&ep->fd);
     } else {
@@ -569,9 +964,12 @@ static inline ssize_t uct_tcp_ep_send(uct_tcp_ep_t *ep)
 
     status = ucs_socket_send_nb(ep->fd, UCS_PTR_BYTE_OFFSET(ep->tx.buf, ep->tx.offset),
                                 &sent_length, NULL, NULL);
-    if (ucs_unlikely((status != UCS_OK) &&
-                     (status != UCS_ERR_NO_PROGRESS))) {
-        return status;
+    if (ucs_unlikely(status != UCS_OK)) {
+        if (status != UCS_ERR_NO_PROGRESS) {
+            return status;
+        }
+
+        uct_tcp_ep_clear_ready(ep, UCS_EVENT_SET_EVWRITE);
     }
 
     iface->outstanding -= sent_length;
@@ -582,13 +980,114 @@ static inline ssize_t uct_tcp_ep_send(uct_tcp_ep_t *ep)
     return sent_length;
 }
 
+static ucs_status_t
+uct_tcp_ep_sendv_iov_nb(uct_tcp_ep_t *ep, struct iovec *iov, size_t iov_cnt,
+                        size_t msg_zcopy_iov_index, size_t *length_p)
+{
+    size_t zcopy_length;
+    ucs_status_t status;
+
+    if (ucs_likely(msg_zcopy_iov_index >= iov_cnt)) {
+        return ucs_socket_sendv_nb(ep->fd, iov, iov_cnt, length_p, NULL, NULL);
+    }
+
+    if (msg_zcopy_iov_index == 0) {
+        *length_p = 0;
+    } else {
+        /* Service headers may reside in the TX buffer or on the user's stack,
+         * so they can't be passed to the kernel by reference */
+        status = ucs_socket_sendv_nb(ep->fd, iov, msg_zcopy_iov_index,
+                                     length_p, NULL, NULL);
+        if ((status != UCS_OK) ||
+            (*length_p < ucs_iovec_total_length(iov, msg_zcopy_iov_index))) {
+            return status;
+        }
+    }
+
+    status = ucs_socket_sendv_zcopy_nb(ep->fd, &iov[msg_zcopy_iov_index],
+                                       iov_cnt - msg_zcopy_iov_index,
+                                       &zcopy_length, NULL, NULL);
+    if (ucs_unlikely(status == UCS_ERR_NO_RESOURCE)) {
+        if (ucs_queue_is_empty(&ep->msg_zcopy.comp_q)) {
+            /* No completions to wait for on this socket, the limit is reached
+             * by other sockets - send a copy of the data */
+            status = ucs_socket_sendv_nb(ep->fd, &iov[msg_zcopy_iov_index],
+                                         iov_cnt - msg_zcopy_iov_index,
+                                         &zcopy_length, NULL, NULL);
+            if (status == UCS_OK) {
+                *length_p += zcopy_length;
+            } else if ((status == UCS_ERR_NO_PROGRESS) && (*length_p > 0)) {
+                return UCS_OK;
+            }
+
+            return status;
+        }
+
+        /* Stop sending until the kernel releases buffers of the completed
+         * sends, see uct_tcp_ep_progress_msg_zcopy() */
+        ucs_trace_data("tcp_ep %p: MSG_ZEROCOPY send is out of buffers", ep);
+        ep->msg_zcopy.nobufs = 1;
+        uct_tcp_ep_mod_events(ep, 0, UCS_EVENT_SET_EVWRITE);
+        return (*length_p > 0) ? UCS_OK : UCS_ERR_NO_RESOURCE;
+    } else if (status == UCS_OK) {
+        if (zcopy_length > 0) {
+            ep->msg_zcopy.tx_sn++;
+        }
+        *length_p += zcopy_length;
+    } else if ((status == UCS_ERR_NO_PROGRESS) && (*length_p > 0)) {
+        /* Headers were sent */
+        return UCS_OK;
+    }
+
+    return status;
+}
+
+static ucs_status_t
+uct_tcp_ep_sendv_iov(uct_tcp_ep_t *ep, struct iovec *iov, size_t iov_cnt,
+                     size_t msg_zcopy_iov_index, size_t *length_p)
+{
+    ucs_status_t status;
+
+    status = uct_tcp_ep_sendv_iov_nb(ep, iov, iov_cnt, msg_zcopy_iov_index,
+                                     length_p);
+    if (status == UCS_ERR_NO_PROGRESS) {
+        uct_tcp_ep_clear_ready(ep, UCS_EVENT_SET_EVWRITE);
+    }
+
+    return status;
+}
+
+static inline ucs_status_t
+uct_tcp_ep_zcopy_sent(uct_tcp_ep_t *ep, uct_tcp_ep_zcopy_tx_t *ctx,
+                      uct_completion_t *comp, ucs_status_t status)
+{
+    if (ucs_likely(ctx->msg_zcopy_comp == NULL)) {
+        return status;
+    }
+
+    if ((status == UCS_OK) &&
+        (ep->msg_zcopy.tx_sn != ep->msg_zcopy.comp_sn)) {
+        /* The kernel may still use user's buffers, defer the completion
+         * until they are released */
+        uct_tcp_ep_push_msg_zcopy_comp(ep, ctx->msg_zcopy_comp, comp);
+        status = UCS_INPROGRESS;
+    } else {
+        ucs_free(ctx->msg_zcopy_comp);
+    }
+
+    ctx->msg_zcopy_comp = NULL;
+    return status;
+}
+
 static inline void uct_tcp_ep_comp_zcopy(uct_tcp_ep_t *ep,
-                                         uct_completion_t *comp,
+                                         uct_tcp_ep_zcopy_tx_t *ctx,
                                          ucs_status_t status)
 {
     ep->ctx_caps &= ~UCS_BIT(UCT_TCP_EP_CTX_TYPE_ZCOPY_TX);
-    if (comp != NULL) {
-        uct_invoke_completion(comp, status);
+
+    status = uct_tcp_ep_zcopy_sent(ep, ctx, ctx->comp, status);
+    if ((status != UCS_INPROGRESS) && (ctx->comp != NULL)) {
+        uct_invoke_completion(ctx->comp, status);
     }
 }
 
@@ -603,17 +1102,20 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
     ucs_assertv((ep->tx.offset < ep->tx.length) &&
                 (ctx->iov_cnt > 0), "ep=%p", ep);
 
-    status = ucs_socket_sendv_nb(ep->fd, &ctx->iov[ctx->iov_index],
-                                 ctx->iov_cnt - ctx->iov_index,
-                                 &sent_length, NULL, NULL);
+    status = uct_tcp_ep_sendv_iov(ep, &ctx->iov[ctx->iov_index],
+                                  ctx->iov_cnt - ctx->iov_index,
+                                  (ctx->msg_zcopy_iov_index > ctx->iov_index) ?
+                                  (ctx->msg_zcopy_iov_index - ctx->iov_index) : 0,
+                                  &sent_length);
 
     if (ucs_unlikely(status != UCS_OK)) {
-        if (status == UCS_ERR_NO_PROGRESS) {
+        if ((status == UCS_ERR_NO_PROGRESS) ||
+            (status == UCS_ERR_NO_RESOURCE)) {
             ucs_assert(sent_length == 0);
             return 0;
         }
 
-        uct_tcp_ep_comp_zcopy(ep, ctx->comp, status);
+        uct_tcp_ep_comp_zcopy(ep, ctx, status);
         return status;
     }
 
@@ -624,7 +1126,7 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
         ucs_iov_advance(ctx->iov, ctx->iov_cnt,
                         &ctx->iov_index, sent_length);
     } else {
-        uct_tcp_ep_comp_zcopy(ep, ctx->comp, UCS_OK);
+        uct_tcp_ep_comp_zcopy(ep, ctx, UCS_OK);
     }
 
     ucs_assert(sent_length <= SSIZE_MAX);
@@ -685,7 +1187,8 @@ static ucs_status_t uct_tcp_ep_io_err_handler_cb(void *arg,
     if (uct_tcp_ep_is_conn_closed_by_peer(io_status) &&
         ((ep->conn_state == UCT_TCP_EP_CONN_STATE_ACCEPTING) ||
          ((ep->conn_state == UCT_TCP_EP_CONN_STATE_CONNECTED) &&
-          (ep->ctx_caps == UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX)) /* only RX cap */))) {
+          ((ep->ctx_caps & UCT_TCP_EP_CTX_CAPS) ==
+           UCS_BIT(UCT_TCP_EP_CTX_TYPE_RX)) /* only RX cap */))) {
         ucs_debug("tcp_ep %p: detected that [%s <-> %s] connection was "
                   "dropped by the peer", ep,
                   ucs_sockaddr_str((const struct sockaddr*)&iface->config.ifaddr,
@@ -713,10 +1216,22 @@ static inline void uct_tcp_ep_handle_recv_err(uct_tcp_ep_t *ep,
     }
 }
 
+static UCS_F_ALWAYS_INLINE void
+uct_tcp_ep_recv_done(uct_tcp_ep_t *ep, ucs_status_t status, size_t recv_length,
+                     size_t requested_length)
+{
+    /* The socket is drained if less data than requested was received */
+    if ((status == UCS_ERR_NO_PROGRESS) ||
+        ((status == UCS_OK) && (recv_length < requested_length))) {
+        uct_tcp_ep_clear_ready(ep, UCS_EVENT_SET_EVREAD);
+    }
+}
+
 static inline unsigned uct_tcp_ep_recv(uct_tcp_ep_t *ep, size_t recv_length)
 {
     uct_tcp_iface_t UCS_V_UNUSED *iface = ucs_derived_of(ep->super.super.iface,
                                                          uct_tcp_iface_t);
+    size_t requested_length             = recv_length;
     ucs_status_t status;
 
     ucs_assertv(recv_length != 0, "ep=%p", ep);
@@ -724,6 +1239,7 @@ static inline unsigned uct_tcp_ep_recv(uct_tcp_ep_t *ep, size_t recv_length)
     status = ucs_socket_recv_nb(ep->fd, UCS_PTR_BYTE_OFFSET(ep->rx.buf,
                                                             ep->rx.length),
                                 &recv_length, uct_tcp_ep_io_err_handler_cb, ep);
+    uct_tcp_ep_recv_done(ep, status, recv_length, requested_length);
     if (ucs_unlikely(status != UCS_OK)) {
         uct_tcp_ep_handle_recv_err(ep, status);
         return 0;
@@ -1004,6 +1520,7 @@ static unsigned uct_tcp_ep_progress_put_rx(uct_tcp_ep_t *ep)
     status      = ucs_socket_recv_nb(ep->fd, (void*)(uintptr_t)put_req->addr,
                                      &recv_length,
                                      uct_tcp_ep_io_err_handler_cb, ep);
+    uct_tcp_ep_recv_done(ep, status, recv_length, put_req->length);
     if (ucs_unlikely(status != UCS_OK)) {
         uct_tcp_ep_handle_recv_err(ep, status);
         return 0;
@@ -1154,7 +1671,8 @@ static inline ucs_status_t
 uct_tcp_ep_am_sendv(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
                     int short_sendv, uct_tcp_am_hdr_t *hdr,
                     size_t send_limit, const void *header,
-                    struct iovec *iov, size_t iov_cnt)
+                    struct iovec *iov, size_t iov_cnt,
+                    size_t msg_zcopy_iov_index)
 {
     ucs_status_t status;
 
@@ -1163,8 +1681,12 @@ uct_tcp_ep_am_sendv(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
     ucs_assertv((ep->tx.length <= send_limit) &&
                 (iov_cnt > 0), "ep=%p", ep);
 
-    status = ucs_socket_sendv_nb(ep->fd, iov, iov_cnt,
-                                 &ep->tx.offset, NULL, NULL);
+    status = uct_tcp_ep_sendv_iov(ep, iov, iov_cnt, msg_zcopy_iov_index,
+                                  &ep->tx.offset);
+    if (ucs_unlikely(status == UCS_ERR_NO_RESOURCE)) {
+        /* Nothing was sent, the caller releases the TX buffer */
+        return status;
+    }
 
     uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, hdr->am_id,
                        /* the function will be invoked only in case of
@@ -1273,7 +1795,8 @@ ucs_status_t uct_tcp_ep_am_short(uct_ep_h uct_ep, uint8_t am_id, uint64_t header
 
         status = uct_tcp_ep_am_sendv(iface, ep, 1, hdr,
                                      iface->config.tx_seg_size, &header,
-                                     iov, UCT_TCP_EP_AM_SHORTV_IOV_COUNT);
+                                     iov, UCT_TCP_EP_AM_SHORTV_IOV_COUNT,
+                                     UCT_TCP_EP_AM_SHORTV_IOV_COUNT);
         if ((status == UCS_OK) || (status == UCS_ERR_NO_PROGRESS)) {
             UCT_TL_EP_STAT_OP(&ep->super, AM, SHORT, payload_length);
 
@@ -1337,12 +1860,13 @@ ssize_t uct_tcp_ep_am_bcopy(uct_ep_h uct_ep, uint8_t am_id,
 static inline ucs_status_t
 uct_tcp_ep_prepare_zcopy(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep, uint8_t am_id,
                          const void *header, unsigned header_length,
-                         const uct_iov_t *iov, size_t iovcnt, const char *name,
-                         size_t *zcopy_payload_p, uct_tcp_ep_zcopy_tx_t **ctx_p)
+                         const uct_iov_t *iov, size_t iovcnt,
+                         ucs_iov_iter_t *iov_iter, size_t max_length,
+                         const char *name, size_t *zcopy_payload_p,
+                         uct_tcp_ep_zcopy_tx_t **ctx_p)
 {
     uct_tcp_am_hdr_t *hdr = NULL;
     size_t io_vec_cnt;
-    ucs_iov_iter_t uct_iov_iter;
     uct_tcp_ep_zcopy_tx_t *ctx;
     ucs_status_t status;
 
@@ -1373,11 +1897,28 @@ uct_tcp_ep_prepare_zcopy(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep, uint8_t am_id
     }
 
     /* User-defined payload */
-    ucs_iov_iter_init(&uct_iov_iter);
-    io_vec_cnt       = iovcnt; 
+    io_vec_cnt       = iovcnt;
     *zcopy_payload_p = uct_iov_to_iovec(&ctx->iov[ctx->iov_cnt], &io_vec_cnt,
-                                        iov, iovcnt, SIZE_MAX, &uct_iov_iter);
+                                        iov, iovcnt, max_length, iov_iter);
     *ctx_p           = ctx;
+
+    if ((*zcopy_payload_p != 0) &&
+        (*zcopy_payload_p >= iface->config.zcopy.msg_zcopy_thresh)) {
+        /* Allocate the completion in advance to not fail after the payload
+         * was passed to the kernel */
+        ctx->msg_zcopy_comp = ucs_malloc(sizeof(*ctx->msg_zcopy_comp),
+                                         "tcp_ep msg_zcopy completion");
+        if (ctx->msg_zcopy_comp == NULL) {
+            uct_tcp_ep_ctx_reset(&ep->tx);
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        ctx->msg_zcopy_iov_index = ctx->iov_cnt;
+    } else {
+        ctx->msg_zcopy_comp      = NULL;
+        ctx->msg_zcopy_iov_index = ctx->iov_cnt + io_vec_cnt;
+    }
+
     ctx->iov_cnt    += io_vec_cnt;
 
     return UCS_OK;
@@ -1392,6 +1933,7 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
     uct_tcp_iface_t *iface     = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
     uct_tcp_ep_zcopy_tx_t *ctx = NULL;
     size_t payload_length      = 0;
+    ucs_iov_iter_t iov_iter;
     ucs_status_t status;
 
     UCT_CHECK_LENGTH(header_length + uct_iov_total_length(iov, iovcnt), 0,
@@ -1399,9 +1941,10 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
                      "am_zcopy");
     UCT_CHECK_AM_ID(am_id);
 
+    ucs_iov_iter_init(&iov_iter);
     status = uct_tcp_ep_prepare_zcopy(iface, ep, am_id, header, header_length,
-                                      iov, iovcnt, "am_zcopy", &payload_length,
-                                      &ctx);
+                                      iov, iovcnt, &iov_iter, SIZE_MAX,
+                                      "am_zcopy", &payload_length, &ctx);
     if (ucs_unlikely(status != UCS_OK)) {
         return status;
     }
@@ -1410,7 +1953,8 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
 
     status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super,
                                  iface->config.rx_seg_size,
-                                 header, ctx->iov, ctx->iov_cnt);
+                                 header, ctx->iov, ctx->iov_cnt,
+                                 ctx->msg_zcopy_iov_index);
     if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
         goto out;
     }
@@ -1426,27 +1970,25 @@ ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h uct_ep, uint8_t am_id, const void *hea
     ucs_assert(status == UCS_OK);
 
 out:
+    status = uct_tcp_ep_zcopy_sent(ep, ctx, comp, status);
     uct_tcp_ep_ctx_reset(&ep->tx);
     return status;
 }
 
-ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
-                                  size_t iovcnt, uint64_t remote_addr,
-                                  uct_rkey_t rkey, uct_completion_t *comp)
+static ucs_status_t
+uct_tcp_ep_put_zcopy_common(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                            const uct_iov_t *iov, size_t iovcnt,
+                            ucs_iov_iter_t *iov_iter, size_t max_length,
+                            uint64_t remote_addr, uct_completion_t *comp)
 {
-    uct_tcp_ep_t *ep                 = ucs_derived_of(uct_ep, uct_tcp_ep_t);
-    uct_tcp_iface_t *iface           = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
     uct_tcp_ep_zcopy_tx_t *ctx       = NULL;
     uct_tcp_ep_put_req_hdr_t put_req = {0}; /* Suppress Cppcheck false-positive */
     ucs_status_t status;
 
-    UCT_CHECK_LENGTH(sizeof(put_req) + uct_iov_total_length(iov, iovcnt), 0,
-                     UCT_TCP_EP_PUT_ZCOPY_MAX - sizeof(uct_tcp_am_hdr_t),
-                     "put_zcopy");
-
     status = uct_tcp_ep_prepare_zcopy(iface, ep, UCT_TCP_EP_PUT_REQ_AM_ID,
                                       &put_req, sizeof(put_req),
-                                      iov, iovcnt, "put_zcopy",
+                                      iov, iovcnt, iov_iter, max_length,
+                                      "put_zcopy",
                                       /* Set a payload length directly to the
                                        * TX length, since PUT Zcopy doesn't
                                        * set the payload length to TCP AM hdr */
@@ -1461,7 +2003,8 @@ ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
     put_req.sn        = ep->tx.put_sn + 1;
 
     status = uct_tcp_ep_am_sendv(iface, ep, 0, &ctx->super, UCT_TCP_EP_PUT_ZCOPY_MAX,
-                                 &put_req, ctx->iov, ctx->iov_cnt);
+                                 &put_req, ctx->iov, ctx->iov_cnt,
+                                 ctx->msg_zcopy_iov_index);
     if (ucs_unlikely((status != UCS_OK) && (status != UCS_ERR_NO_PROGRESS))) {
         goto out;
     }
@@ -1489,10 +2032,175 @@ ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
     ucs_assert(status == UCS_OK);
 
 out:
+    status = uct_tcp_ep_zcopy_sent(ep, ctx, comp, status);
     uct_tcp_ep_ctx_reset(&ep->tx);
     return status;
 }
 
+static void uct_tcp_ep_stripe_comp_func(uct_completion_t *self,
+                                        ucs_status_t status)
+{
+    uct_tcp_ep_stripe_completion_t *stripe_comp =
+        ucs_container_of(self, uct_tcp_ep_stripe_completion_t, super);
+
+    /* Keep the first error, a stream which completes later successfully must
+     * not hide it */
+    if ((stripe_comp->status == UCS_OK) && (status != UCS_OK)) {
+        stripe_comp->status = status;
+    }
+
+    ucs_assert(stripe_comp->count > 0);
+    if (--stripe_comp->count > 0) {
+        /* re-arm to be invoked by the next stream */
+        self->count = 1;
+        return;
+    }
+
+    if (stripe_comp->comp != NULL) {
+        uct_invoke_completion(stripe_comp->comp, stripe_comp->status);
+    }
+
+    ucs_free(stripe_comp);
+}
+
+static ucs_status_t
+uct_tcp_ep_put_zcopy_striped(uct_tcp_iface_t *iface, uct_tcp_ep_t *ep,
+                             const uct_iov_t *iov, size_t iovcnt,
+                             size_t length, uint64_t remote_addr,
+                             uct_completion_t *comp)
+{
+    uct_tcp_ep_t *streams[UCT_TCP_EP_MAX_STREAMS];
+    uct_tcp_ep_put_completion_t *put_comps[UCT_TCP_EP_MAX_STREAMS];
+    uct_tcp_ep_stripe_completion_t *stripe_comp;
+    unsigned i, num_streams, num_waits;
+    size_t chunk_length, offset;
+    ucs_iov_iter_t iov_iter;
+    ucs_status_t status;
+
+    /* Use the streams which are able to send the data immediately */
+    streams[0]  = ep;
+    num_streams = 1;
+    for (i = 0; i < ep->stream.aux_count; ++i) {
+        if ((ep->stream.aux[i] != NULL) && (ep->stream.aux[i]->fd != -1) &&
+            (uct_tcp_ep_check_tx_res(ep->stream.aux[i]) == UCS_OK)) {
+            streams[num_streams++] = ep->stream.aux[i];
+        }
+    }
+
+    num_streams = ucs_min(num_streams, length);
+    if (num_streams == 1) {
+        ucs_iov_iter_init(&iov_iter);
+        return uct_tcp_ep_put_zcopy_common(iface, ep, iov, iovcnt, &iov_iter,
+                                           SIZE_MAX, remote_addr, comp);
+    }
+
+    /* Allocate the completions in advance to not fail after a part of the
+     * data was sent */
+    stripe_comp = ucs_malloc(sizeof(*stripe_comp), "put stripe completion");
+    if (stripe_comp == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    stripe_comp->super.func  = uct_tcp_ep_stripe_comp_func;
+    stripe_comp->super.count = 1;
+    stripe_comp->comp        = comp;
+    stripe_comp->count       = 0;
+    stripe_comp->status      = UCS_OK;
+
+    for (i = 0; i < num_streams; ++i) {
+        put_comps[i] = ucs_calloc(1, sizeof(*put_comps[i]), "put completion");
+        if (put_comps[i] == NULL) {
+            while (i-- > 0) {
+                ucs_free(put_comps[i]);
+            }
+            ucs_free(stripe_comp);
+            return UCS_ERR_NO_MEMORY;
+        }
+    }
+
+    ucs_iov_iter_init(&iov_iter);
+    chunk_length = length / num_streams;
+    offset       = 0;
+    num_waits    = 0;
+    for (i = 0; i < num_streams; ++i) {
+        if (i == (num_streams - 1)) {
+            chunk_length = length - offset;
+        }
+
+        status = uct_tcp_ep_put_zcopy_common(iface, streams[i], iov, iovcnt,
+                                             &iov_iter, chunk_length,
+                                             remote_addr + offset,
+                                             &stripe_comp->super);
+        if (status == UCS_INPROGRESS) {
+            ++num_waits;
+        } else if (ucs_unlikely(status != UCS_OK)) {
+            while (i < num_streams) {
+                ucs_free(put_comps[i++]);
+            }
+
+            if (num_waits == 0) {
+                ucs_free(stripe_comp);
+            } else {
+                /* The user's completion must not be invoked for the data
+                 * sent so far, since the operation is failed */
+                stripe_comp->count = num_waits;
+                stripe_comp->comp  = NULL;
+            }
+            return status;
+        }
+
+        offset += chunk_length;
+
+        /* The data on the stream is ordered with the following operations
+         * only after the peer acknowledges it, so complete the operation
+         * upon receiving PUT ACKs from all used streams */
+        put_comps[i]->wait_put_sn = streams[i]->tx.put_sn;
+        put_comps[i]->comp        = &stripe_comp->super;
+        ucs_queue_push(&streams[i]->put_comp_q, &put_comps[i]->elem);
+        ++num_waits;
+    }
+
+    ucs_assert(offset == length);
+    stripe_comp->count = num_waits;
+    return UCS_INPROGRESS;
+}
+
+ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h uct_ep, const uct_iov_t *iov,
+                                  size_t iovcnt, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(uct_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(uct_ep->iface, uct_tcp_iface_t);
+    size_t length          = uct_iov_total_length(iov, iovcnt);
+    ucs_iov_iter_t iov_iter;
+
+    UCT_CHECK_LENGTH(sizeof(uct_tcp_ep_put_req_hdr_t) + length, 0,
+                     UCT_TCP_EP_PUT_ZCOPY_MAX - sizeof(uct_tcp_am_hdr_t),
+                     "put_zcopy");
+
+    if ((ep->stream.aux_count != 0) && (comp != NULL) &&
+        (length >= iface->config.streams.stripe_thresh) &&
+        (uct_tcp_ep_check_tx_res(ep) == UCS_OK)) {
+        return uct_tcp_ep_put_zcopy_striped(iface, ep, iov, iovcnt, length,
+                                            remote_addr, comp);
+    }
+
+    ucs_iov_iter_init(&iov_iter);
+    return uct_tcp_ep_put_zcopy_common(iface, ep, iov, iovcnt, &iov_iter,
+                                       SIZE_MAX, remote_addr, comp);
+}
+
+ucs_status_t uct_tcp_ep_fence(uct_ep_h tl_ep, unsigned flags)
+{
+    uct_tcp_ep_t *ep       = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+
+    /* Make the following operations wait for PUT ACKs on auxiliary streams */
+    ep->fence_beat = iface->fence_beat - 1;
+    UCT_TL_EP_STAT_FENCE(&ep->super);
+    return UCS_OK;
+}
+
 ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req,
                                     unsigned flags)
 {
@@ -1516,33 +2224,102 @@ void uct_tcp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_purge_callback_t cb,
     uct_pending_queue_purge(priv, &ep->pending_q, 1, cb, arg);
 }
 
+static ucs_status_t
+uct_tcp_ep_flush_stream(uct_tcp_ep_t *ep, uct_completion_t *comp)
+{
+    uct_tcp_ep_put_completion_t *put_comp     = NULL;
+    uct_tcp_ep_zcopy_completion_t *zcopy_comp = NULL;
+    int wait_put_ack, wait_msg_zcopy;
+
+    wait_put_ack   = ep->ctx_caps &
+                     UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK);
+    wait_msg_zcopy = !ucs_queue_is_empty(&ep->msg_zcopy.comp_q);
+
+    if (!wait_put_ack && !wait_msg_zcopy) {
+        return UCS_OK;
+    }
+
+    if (comp == NULL) {
+        return UCS_INPROGRESS;
+    }
+
+    if (wait_put_ack) {
+        put_comp = ucs_calloc(1, sizeof(*put_comp), "put completion");
+        if (put_comp == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+    }
+
+    if (wait_msg_zcopy) {
+        zcopy_comp = ucs_malloc(sizeof(*zcopy_comp),
+                                "tcp_ep msg_zcopy completion");
+        if (zcopy_comp == NULL) {
+            ucs_free(put_comp);
+            return UCS_ERR_NO_MEMORY;
+        }
+    }
+
+    if (put_comp != NULL) {
+        put_comp->wait_put_sn = ep->tx.put_sn;
+        put_comp->comp        = comp;
+        ucs_queue_push(&ep->put_comp_q, &put_comp->elem);
+    }
+
+    if (zcopy_comp != NULL) {
+        if (put_comp != NULL) {
+            /* The completion is invoked by both PUT ACK and MSG_ZEROCOPY
+             * completions */
+            ++comp->count;
+        }
+        uct_tcp_ep_push_msg_zcopy_comp(ep, zcopy_comp, comp);
+    }
+
+    return UCS_INPROGRESS;
+}
+
 ucs_status_t uct_tcp_ep_flush(uct_ep_h tl_ep, unsigned flags,
                               uct_completion_t *comp)
 {
-    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
-    uct_tcp_ep_put_completion_t *put_comp;
+    uct_tcp_ep_t *ep   = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    unsigned num_waits = 0;
+    ucs_status_t status;
+    unsigned i;
 
     if (uct_tcp_ep_check_tx_res(ep) == UCS_ERR_NO_RESOURCE) {
         UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
         return UCS_ERR_NO_RESOURCE;
     }
 
-    if (ep->ctx_caps & UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK)) {
-        if (comp != NULL) {
-            put_comp = ucs_calloc(1, sizeof(*put_comp), "put completion");
-            if (put_comp == NULL) {
-                return UCS_ERR_NO_MEMORY;
-            }
+    for (i = 0; i <= ep->stream.aux_count; ++i) {
+        if (i == 0) {
+            status = uct_tcp_ep_flush_stream(ep, comp);
+        } else if (ep->stream.aux[i - 1] != NULL) {
+            status = uct_tcp_ep_flush_stream(ep->stream.aux[i - 1], comp);
+        } else {
+            continue;
+        }
 
-            put_comp->wait_put_sn = ep->tx.put_sn;
-            put_comp->comp        = comp;
-            ucs_queue_push(&ep->put_comp_q, &put_comp->elem);
+        if (status == UCS_INPROGRESS) {
+            ++num_waits;
+        } else if (ucs_unlikely(status != UCS_OK)) {
+            if (comp != NULL) {
+                /* Don't invoke the completion by the streams flushed so far */
+                comp->count += num_waits;
+            }
+            return status;
         }
+    }
 
-        return UCS_INPROGRESS;
+    if (num_waits == 0) {
+        UCT_TL_EP_STAT_FLUSH(&ep->super);
+        return UCS_OK;
     }
 
-    UCT_TL_EP_STAT_FLUSH(&ep->super);
-    return UCS_OK;
+    if (comp != NULL) {
+        /* The completion is invoked by each of the flushed streams */
+        comp->count += num_waits - 1;
+    }
+
+    return UCS_INPROGRESS;
 }
 
@@ -43,6 +43,25 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "Threshold for switching from send() to sendmsg() for short active messages",
    ucs_offsetof(uct_tcp_iface_config_t, sendv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"MSG_ZEROCOPY_THRESH", "inf",
+   "Threshold for using MSG_ZEROCOPY socket send for the payload of AM/PUT Zcopy\n"
+   "operations. The completion of such an operation is delayed until the kernel\n"
+   "releases the user's buffers. \"inf\" disables zero-copy socket send",
+   ucs_offsetof(uct_tcp_iface_config_t, msg_zcopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"NUM_STREAMS", "1",
+   "Number of sockets (streams) used by an endpoint to transfer data to a peer.\n"
+   "Large PUT Zcopy operations are striped across the sockets, while active\n"
+   "messages are always sent through the first one to keep their order. Maximal\n"
+   "value is " UCS_PP_MAKE_STRING(UCT_TCP_EP_MAX_STREAMS) ".",
+   ucs_offsetof(uct_tcp_iface_config_t, num_streams), UCS_CONFIG_TYPE_UINT},
+
+  {"STRIPE_THRESH", "256kb",
+   "Minimum size of PUT Zcopy payload which is striped across the sockets of\n"
+   "an endpoint, if more than one socket is used. A striped operation is\n"
+   "completed when the peer acknowledges the data received on every socket.",
+   ucs_offsetof(uct_tcp_iface_config_t, stripe_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"PREFER_DEFAULT", "y",
    "Give higher priority to the default network interface on the host",
    ucs_offsetof(uct_tcp_iface_config_t, prefer_default), UCS_CONFIG_TYPE_BOOL},
@@ -56,6 +75,14 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "time, but can lead to connection resets due to high load on TCP/IP stack",
    ucs_offsetof(uct_tcp_iface_config_t, conn_nb), UCS_CONFIG_TYPE_BOOL},
 
+  {"EDGE_TRIGGERED", "n",
+   "Use edge-triggered socket notifications. A socket is registered in the event\n"
+   "set once for all events, and the sockets which were reported as ready are\n"
+   "progressed until their data is drained. It saves modifications of the event\n"
+   "set when TX resources are exhausted and released, which is beneficial for a\n"
+   "large number of connections.",
+   ucs_offsetof(uct_tcp_iface_config_t, edge_triggered), UCS_CONFIG_TYPE_BOOL},
+
   {"MAX_POLL", UCS_PP_MAKE_STRING(UCT_TCP_MAX_EVENTS),
    "Number of times to poll on a ready socket. 0 - no polling, -1 - until drained",
    ucs_offsetof(uct_tcp_iface_config_t, max_poll), UCS_CONFIG_TYPE_UINT},
@@ -195,6 +222,12 @@ static void uct_tcp_iface_handle_events(void *callback_data,
 
     ucs_assertv(ep->conn_state != UCT_TCP_EP_CONN_STATE_CLOSED, "ep=%p", ep);
 
+    /* Reap MSG_ZEROCOPY completions first, since RX progress may destroy
+     * the EP */
+    if ((events & UCS_EVENT_SET_EVERR) &&
+        !ucs_queue_is_empty(&ep->msg_zcopy.comp_q)) {
+        *count += uct_tcp_ep_progress_msg_zcopy(ep);
+    }
     if (events & UCS_EVENT_SET_EVREAD) {
         *count += uct_tcp_ep_cm_state[ep->conn_state].rx_progress(ep);
     }
@@ -203,19 +236,58 @@ static void uct_tcp_iface_handle_events(void *callback_data,
     }
 }
 
+static void uct_tcp_iface_handle_ready_events(void *callback_data,
+                                              int events, void *arg)
+{
+    /* Only save the events, since handling them could destroy EPs whose
+     * events are returned in the same batch */
+    uct_tcp_ep_set_ready((uct_tcp_ep_t*)callback_data, events);
+}
+
+static unsigned uct_tcp_iface_progress_ready(uct_tcp_iface_t *iface)
+{
+    unsigned count = 0;
+    ucs_list_link_t ready_list;
+    uct_tcp_ep_t *ep;
+
+    /* Progress the EPs which are ready at this point, the EPs which still
+     * have events to handle are queued again for the next progress call */
+    ucs_list_head_init(&ready_list);
+    ucs_list_splice_tail(&ready_list, &iface->ready.list);
+    ucs_list_head_init(&iface->ready.list);
+
+    while (!ucs_list_is_empty(&ready_list)) {
+        ep = ucs_list_extract_head(&ready_list, uct_tcp_ep_t, ready_list);
+        ucs_list_head_init(&ep->ready_list);
+
+        iface->ready.cur_ep = ep;
+        count              += uct_tcp_ep_progress_ready(ep);
+        if (iface->ready.cur_ep != NULL) {
+            /* EP wasn't destroyed, requeue it if it is still ready */
+            uct_tcp_ep_set_ready(ep, 0);
+        }
+    }
+
+    iface->ready.cur_ep = NULL;
+    return count;
+}
+
 unsigned uct_tcp_iface_progress(uct_iface_h tl_iface)
 {
     uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
     unsigned max_events    = iface->config.max_poll;
     unsigned count         = 0;
+    ucs_event_set_handler_t handler;
     unsigned read_events;
     ucs_status_t status;
 
+    handler = iface->config.edge_triggered ?
+              uct_tcp_iface_handle_ready_events : uct_tcp_iface_handle_events;
+
     do {
         read_events = ucs_min(ucs_sys_event_set_max_wait_events, max_events);
         status = ucs_event_set_wait(iface->event_set, &read_events,
-                                    0, uct_tcp_iface_handle_events,
-                                    (void *)&count);
+                                    0, handler, (void *)&count);
         max_events -= read_events;
         ucs_trace_poll("iface=%p ucs_event_set_wait() returned %d: "
                        "read events=%u, total=%u",
@@ -224,9 +296,23 @@ unsigned uct_tcp_iface_progress(uct_iface_h tl_iface)
     } while ((max_events > 0) && (read_events == UCT_TCP_MAX_EVENTS) &&
              ((status == UCS_OK) || (status == UCS_INPROGRESS)));
 
+    if (!ucs_list_is_empty(&iface->ready.list)) {
+        count += uct_tcp_iface_progress_ready(iface);
+    }
+
     return count;
 }
 
+static ucs_status_t uct_tcp_iface_event_arm(uct_iface_h tl_iface,
+                                            unsigned events)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+
+    /* In edge-triggered mode the event set is not signaled again for the
+     * sockets which weren't drained */
+    return ucs_list_is_empty(&iface->ready.list) ? UCS_OK : UCS_ERR_BUSY;
+}
+
 static ucs_status_t uct_tcp_iface_flush(uct_iface_h tl_iface, unsigned flags,
                                         uct_completion_t *comp)
 {
@@ -245,6 +331,17 @@ static ucs_status_t uct_tcp_iface_flush(uct_iface_h tl_iface, unsigned flags,
     return UCS_OK;
 }
 
+static ucs_status_t uct_tcp_iface_fence(uct_iface_h tl_iface, unsigned flags)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+
+    /* Operations posted to EPs after the fence wait for PUT operations
+     * which are in-flight on auxiliary streams */
+    iface->fence_beat++;
+    UCT_TL_IFACE_STAT_FENCE(&iface->super);
+    return UCS_OK;
+}
+
 static void uct_tcp_iface_listen_close(uct_tcp_iface_t *iface)
 {
     if (iface->listen_fd != -1) {
@@ -300,7 +397,20 @@ ucs_status_t uct_tcp_iface_set_sockopt(uct_tcp_iface_t *iface, int fd)
         return status;
     }
 
-    return ucs_tcp_base_set_syn_cnt(fd, iface->config.syn_cnt);
+    status = ucs_tcp_base_set_syn_cnt(fd, iface->config.syn_cnt);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (iface->config.zcopy.msg_zcopy_thresh != UCS_MEMUNITS_INF) {
+        status = ucs_socket_set_zcopy(fd);
+        if (status != UCS_OK) {
+            ucs_error("failed to enable SO_ZEROCOPY on fd %d", fd);
+            return status;
+        }
+    }
+
+    return UCS_OK;
 }
 
 static uct_iface_ops_t uct_tcp_iface_ops = {
@@ -311,16 +421,16 @@ static uct_iface_ops_t uct_tcp_iface_ops = {
     .ep_pending_add           = uct_tcp_ep_pending_add,
     .ep_pending_purge         = uct_tcp_ep_pending_purge,
     .ep_flush                 = uct_tcp_ep_flush,
-    .ep_fence                 = uct_base_ep_fence,
+    .ep_fence                 = uct_tcp_ep_fence,
     .ep_create                = uct_tcp_ep_create,
     .ep_destroy               = uct_tcp_ep_destroy,
     .iface_flush              = uct_tcp_iface_flush,
-    .iface_fence              = uct_base_iface_fence,
+    .iface_fence              = uct_tcp_iface_fence,
     .iface_progress_enable    = uct_base_iface_progress_enable,
     .iface_progress_disable   = uct_base_iface_progress_disable,
     .iface_progress           = uct_tcp_iface_progress,
     .iface_event_fd_get       = uct_tcp_iface_event_fd_get,
-    .iface_event_arm          = ucs_empty_function_return_success,
+    .iface_event_arm          = uct_tcp_iface_event_arm,
     .iface_close              = UCS_CLASS_DELETE_FUNC_NAME(uct_tcp_iface_t),
     .iface_query              = uct_tcp_iface_query,
     .iface_get_address        = uct_tcp_iface_get_address,
@@ -413,6 +523,7 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     ucs_strncpy_zero(self->if_name, params->mode.device.dev_name,
                      sizeof(self->if_name));
     self->outstanding        = 0;
+    self->fence_beat         = 0;
     self->config.tx_seg_size = config->tx_seg_size +
                                sizeof(uct_tcp_am_hdr_t);
     self->config.rx_seg_size = config->rx_seg_size +
@@ -446,9 +557,13 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
 
     self->config.zcopy.max_hdr     = self->config.tx_seg_size -
                                      self->config.zcopy.hdr_offset;
+    self->config.zcopy.msg_zcopy_thresh = config->msg_zcopy_thresh;
     self->config.prefer_default    = config->prefer_default;
     self->config.put_enable        = config->put_enable;
+    self->config.streams.count     = config->num_streams;
+    self->config.streams.stripe_thresh = config->stripe_thresh;
     self->config.conn_nb           = config->conn_nb;
+    self->config.edge_triggered    = config->edge_triggered;
     self->config.max_poll          = config->max_poll;
     self->config.max_conn_retries  = config->max_conn_retries;
     self->config.syn_cnt           = config->syn_cnt;
@@ -459,6 +574,13 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     ucs_list_head_init(&self->ep_list);
     kh_init_inplace(uct_tcp_cm_eps, &self->ep_cm_map);
 
+    if ((self->config.streams.count == 0) ||
+        (self->config.streams.count > UCT_TCP_EP_MAX_STREAMS)) {
+        ucs_error("number of TCP streams (%u) must be in range [1..%d]",
+                  self->config.streams.count, UCT_TCP_EP_MAX_STREAMS);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
     if (self->config.tx_seg_size > self->config.rx_seg_size) {
         ucs_error("RX segment size (%zu) must be >= TX segment size (%zu)",
                   self->config.rx_seg_size, self->config.tx_seg_size);
@@ -497,11 +619,21 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
         goto err_cleanup_rx_mpool;
     }
 
+    ucs_list_head_init(&self->ready.list);
+    self->ready.cur_ep = NULL;
+
     status = uct_tcp_iface_listener_init(self);
     if (status != UCS_OK) {
         goto err_cleanup_event_set;
     }
 
+    if ((self->config.zcopy.msg_zcopy_thresh != UCS_MEMUNITS_INF) &&
+        (ucs_socket_set_zcopy(self->listen_fd) != UCS_OK)) {
+        ucs_warn("%s: MSG_ZEROCOPY is not supported by the system, disabling "
+                 "zero-copy socket send", self->if_name);
+        self->config.zcopy.msg_zcopy_thresh = UCS_MEMUNITS_INF;
+    }
+
     return UCS_OK;
 
 err_cleanup_event_set:
@@ -517,9 +649,12 @@ err:
 static void uct_tcp_iface_ep_list_cleanup(uct_tcp_iface_t *iface,
                                           ucs_list_link_t *ep_list)
 {
-    uct_tcp_ep_t *ep, *tmp;
+    uct_tcp_ep_t *ep;
 
-    ucs_list_for_each_safe(ep, tmp, ep_list, list) {
+    /* Destroying an EP may destroy its auxiliary streams which reside
+     * in the same list, so always take the list head */
+    while (!ucs_list_is_empty(ep_list)) {
+        ep = ucs_list_head(ep_list, uct_tcp_ep_t, list);
         uct_tcp_cm_purge_ep(ep);
         uct_tcp_ep_destroy_internal(&ep->super.super);
     }
@@ -573,6 +708,7 @@ static UCS_CLASS_CLEANUP_FUNC(uct_tcp_iface_t)
     }
 
     uct_tcp_iface_eps_cleanup(self);
+    ucs_assert(ucs_list_is_empty(&self->ready.list));
 
     ucs_mpool_cleanup(&self->rx_mpool, 1);
     ucs_mpool_cleanup(&self->tx_mpool, 1);
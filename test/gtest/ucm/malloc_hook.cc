@@ -20,6 +20,7 @@
 
 extern "C" {
 #include <ucs/time/time.h>
+#include <ucm/event/event.h>
 #include <ucm/malloc/malloc_hook.h>
 #include <ucm/bistro/bistro.h>
 #include <ucs/sys/sys.h>
@@ -1199,6 +1200,140 @@ UCS_TEST_SKIP_COND_F(malloc_hook, test_event_unmap,
     EXPECT_TRUE(status == UCS_OK);
 }
 
+class memory_event_dispatch : public ucs::test {
+protected:
+    /* The events are dispatched explicitly for a fake address range, which is
+     * not expected to overlap any memory registered by other tests */
+    static void *address() {
+        return reinterpret_cast<void*>(0x7e1230000000ul);
+    }
+
+    static void count_callback(ucm_event_type_t event_type, ucm_event_t *event,
+                               void *arg) {
+        ucs_atomic_add32(reinterpret_cast<volatile uint32_t*>(arg), 1);
+    }
+
+    static void set_handler(int events, volatile uint32_t *count) {
+        ucs_status_t status;
+
+        status = ucm_set_event_handler(events | UCM_EVENT_FLAG_NO_INSTALL, 0,
+                                       count_callback, (void*)count);
+        ASSERT_UCS_OK(status);
+    }
+
+    static void unset_handler(volatile uint32_t *count) {
+        ucm_unset_event_handler(UCM_EVENT_VM_UNMAPPED, count_callback,
+                                (void*)count);
+    }
+
+    /* Update the handler table, and mark completion in the int argument */
+    static void *update_thread_func(void *arg) {
+        volatile uint32_t count = 0;
+
+        set_handler(UCM_EVENT_VM_UNMAPPED, &count);
+        *reinterpret_cast<volatile int*>(arg) = 1;
+        unset_handler(&count);
+        return NULL;
+    }
+};
+
+UCS_TEST_F(memory_event_dispatch, addr_filter) {
+    const size_t size         = UCS_MBYTE;
+    volatile uint32_t count   = 0;
+    volatile uint32_t count_nofilter = 0;
+
+    set_handler(UCM_EVENT_VM_UNMAPPED | UCM_EVENT_FLAG_ADDR_FILTER, &count);
+    set_handler(UCM_EVENT_VM_UNMAPPED, &count_nofilter);
+
+    ucm_vm_munmap(address(), size);
+    EXPECT_EQ(0u, count);
+    EXPECT_EQ(1u, count_nofilter);
+
+    /* partial overlap with a filter range */
+    ucm_event_filter_add(address(), size);
+    ucm_vm_munmap(UCS_PTR_BYTE_OFFSET(address(), size / 2), size);
+    EXPECT_EQ(1u, count);
+
+    /* unknown size is never filtered */
+    ucm_event_filter_remove(address(), size);
+    ucm_vm_munmap(address(), 0);
+    EXPECT_EQ(2u, count);
+
+    ucm_vm_munmap(address(), size);
+    EXPECT_EQ(2u, count);
+    EXPECT_EQ(4u, count_nofilter);
+
+    unset_handler(&count);
+    unset_handler(&count_nofilter);
+}
+
+UCS_MT_TEST_F(memory_event_dispatch, handler_mt, 4) {
+    const int iters = 1000 / ucs::test_time_multiplier();
+    volatile uint32_t count;
+
+    /* Each thread adds and removes its own handler while other threads
+     * dispatch events */
+    for (int i = 0; i < iters; ++i) {
+        count = 0;
+        set_handler(UCM_EVENT_VM_UNMAPPED, &count);
+        ucm_vm_munmap(address(), UCS_MBYTE);
+        EXPECT_GE(count, 1u);
+
+        unset_handler(&count);
+        uint32_t count_after_unset = count;
+        ucm_vm_munmap(address(), UCS_MBYTE);
+        EXPECT_EQ(count_after_unset, count);
+    }
+}
+
+UCS_TEST_F(memory_event_dispatch, stale_reader_phase) {
+    volatile uint32_t count = 0;
+    unsigned token, stale_phase, current_phase;
+    volatile int writer_done;
+    bool handler_set = false;
+    pthread_t writer;
+
+    /* Simulate a reader which reads the dispatch phase, and is preempted
+     * before counting itself while the phase is flipped once or twice */
+    for (unsigned flips = 1; flips <= 2; ++flips) {
+        token       = ucm_event_enter();
+        stale_phase = token & 1;
+        ucm_event_leave(token);
+
+        for (unsigned i = 0; i < flips; ++i) {
+            if (handler_set) {
+                unset_handler(&count);
+            } else {
+                set_handler(UCM_EVENT_VM_UNMAPPED, &count);
+            }
+            handler_set = !handler_set;
+        }
+
+        token         = ucm_event_enter();
+        current_phase = token & 1;
+        ucm_event_leave(token);
+        EXPECT_EQ(stale_phase, current_phase ^ (flips & 1));
+
+        token = ucm_event_enter_phase(stale_phase);
+        EXPECT_EQ(current_phase, token & 1);
+
+        /* A handler table update must wait until the reader leaves */
+        writer_done = 0;
+        pthread_create(&writer, NULL, update_thread_func,
+                       const_cast<int*>(&writer_done));
+        usleep(100000);
+        EXPECT_EQ(0, writer_done);
+
+        ucm_event_leave(token);
+        pthread_join(writer, NULL);
+        EXPECT_EQ(1, writer_done);
+    }
+
+    if (handler_set) {
+        unset_handler(&count);
+    }
+}
+
 class malloc_hook_dlopen : public malloc_hook {
 protected:
     class library {
@@ -293,3 +293,145 @@ UCS_TEST_P(test_ucp_am, set_am_handler_realloc)
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_am)
+
+
+class test_ucp_am_rndv : public test_ucp_am {
+public:
+    enum {
+        RNDV_RECV,
+        RNDV_DROP,
+        RNDV_RELEASE,
+        RNDV_TRUNCATE
+    };
+
+    virtual void init() {
+        modify_config("AM_RNDV_THRESH", "16k");
+        test_ucp_am::init();
+
+        rndv_mode = RNDV_RECV;
+        rndv_desc = NULL;
+        ucp_worker_set_am_handler(receiver().worker(), UCP_SEND_ID,
+                                  rndv_am_cb, this, UCP_AM_FLAG_WHOLE_MSG);
+    }
+
+    static ucs_status_t rndv_am_cb(void *arg, void *data, size_t length,
+                                   ucp_ep_h reply_ep, unsigned flags)
+    {
+        test_ucp_am_rndv *self = reinterpret_cast<test_ucp_am_rndv*>(arg);
+
+        self->recv_ams++;
+        if (!(flags & UCP_CB_PARAM_FLAG_RNDV)) {
+            /* transport can't do get_zcopy, message was sent eagerly */
+            self->recv_buf.assign((const char*)data,
+                                  (const char*)data + length);
+            return UCS_OK;
+        }
+
+        EXPECT_TRUE(flags & UCP_CB_PARAM_FLAG_DATA);
+        self->rndv_length = length;
+        if (self->rndv_mode == RNDV_DROP) {
+            return UCS_OK;
+        }
+
+        self->rndv_desc = data;
+        return UCS_INPROGRESS;
+    }
+
+    static void rndv_recv_cb(void *request, ucs_status_t status,
+                             size_t length, void *user_data)
+    {
+        EXPECT_UCS_OK(status);
+        EXPECT_EQ(*reinterpret_cast<size_t*>(user_data), length);
+    }
+
+    void send_recv(size_t size) {
+        std::vector<char> sbuf(size);
+        ucs::fill_random(sbuf);
+
+        recv_ams  = 0;
+        rndv_desc = NULL;
+        recv_buf.clear();
+
+        ucs_status_ptr_t sreq = ucp_am_send_nb(sender().ep(), UCP_SEND_ID,
+                                               sbuf.data(), size,
+                                               ucp_dt_make_contig(1),
+                                               (ucp_send_callback_t)
+                                               ucs_empty_function, 0);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+
+        while (recv_ams == 0) {
+            progress();
+        }
+
+        if (rndv_desc != NULL) {
+            EXPECT_EQ(size, rndv_length);
+            if (rndv_mode == RNDV_RELEASE) {
+                ucp_am_data_release(receiver().worker(), rndv_desc);
+            } else if (rndv_mode == RNDV_TRUNCATE) {
+                /* the descriptor is not consumed by a rejected receive */
+                std::vector<char> small_buf(size / 2);
+                ucp_request_param_t param;
+                param.op_attr_mask = 0;
+
+                ucs_status_ptr_t rreq = ucp_am_recv_data_nbx(receiver().worker(),
+                                                             rndv_desc,
+                                                             &small_buf[0],
+                                                             small_buf.size(),
+                                                             &param);
+                EXPECT_EQ(UCS_ERR_MESSAGE_TRUNCATED, UCS_PTR_STATUS(rreq));
+                ucp_am_data_release(receiver().worker(), rndv_desc);
+            } else {
+                recv_buf.resize(size);
+
+                ucp_request_param_t param;
+                param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                                     UCP_OP_ATTR_FIELD_USER_DATA;
+                param.cb.recv_am   = rndv_recv_cb;
+                param.user_data    = &size;
+
+                ucs_status_ptr_t rreq = ucp_am_recv_data_nbx(receiver().worker(),
+                                                             rndv_desc,
+                                                             &recv_buf[0],
+                                                             size, &param);
+                ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+                wait(rreq);
+            }
+        }
+
+        /* sender is released once the receiver fetched or dropped the data */
+        wait(sreq);
+
+        if ((rndv_mode == RNDV_RECV) || recv_buf.size()) {
+            EXPECT_EQ(sbuf, recv_buf);
+        }
+    }
+
+protected:
+    int               rndv_mode;
+    void              *rndv_desc;
+    size_t            rndv_length;
+    std::vector<char> recv_buf;
+};
+
+UCS_TEST_P(test_ucp_am_rndv, send_recv) {
+    for (size_t size = UCS_KBYTE; size <= (4 * UCS_MBYTE); size *= 4) {
+        send_recv(size);
+    }
+}
+
+UCS_TEST_P(test_ucp_am_rndv, drop_in_callback) {
+    rndv_mode = RNDV_DROP;
+    send_recv(UCS_MBYTE);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, release_desc) {
+    rndv_mode = RNDV_RELEASE;
+    send_recv(UCS_MBYTE);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_truncated) {
+    rndv_mode = RNDV_TRUNCATE;
+    send_recv(UCS_MBYTE);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_rndv)
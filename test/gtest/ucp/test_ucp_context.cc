@@ -6,6 +6,7 @@
 
 #include "ucp_test.h"
 extern "C" {
+#include <ucs/arch/memcpy.h>
 #include <ucs/sys/sys.h>
 }
 
@@ -49,6 +50,16 @@ UCS_TEST_P(test_ucp_context, minimal_field_mask) {
     }
 }
 
+UCS_TEST_P(test_ucp_context, memcpy_select) {
+    /* the bulk copy kernels are selected by ucp_init(), not by the first copy
+     * on the data path */
+    ucs_memcpy_func_t temporal    = ucs_memcpy_dispatch.temporal;
+    ucs_memcpy_func_t nontemporal = ucs_memcpy_dispatch.nontemporal;
+
+    EXPECT_EQ(ucs_memcpy_selected(0)->func, temporal);
+    EXPECT_EQ(ucs_memcpy_selected(1)->func, nontemporal);
+}
+
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_context, all, "all")
 
 class test_ucp_aliases : public test_ucp_context {
@@ -46,3 +46,222 @@ UCS_TEST_F(test_ucp_dt_iov, seek)
         }
     }
 }
+
+class test_ucp_dt_strided : public ucs::test {
+protected:
+    /* Random non-overlapping layout, some of the strides negative */
+    static ucp_dt_strided_params_t random_params() {
+        static const size_t blocklens[] = {1, 2, 3, 4, 8, 16, 24};
+        ucp_dt_strided_params_t params;
+        size_t span;
+
+        params.field_mask = UCP_DT_STRIDED_PARAM_FIELD_BLOCKLEN |
+                            UCP_DT_STRIDED_PARAM_FIELD_DIMS |
+                            UCP_DT_STRIDED_PARAM_FIELD_EXTENT;
+        params.blocklen   = blocklens[ucs::rand() %
+                                      ucs_static_array_size(blocklens)];
+        params.num_dims   = ucs::rand() % 4;
+
+        span = params.blocklen;
+        for (unsigned dim = 0; dim < params.num_dims; ++dim) {
+            params.dims[dim].count  = (ucs::rand() % 5) + 1;
+            params.dims[dim].stride = span + (ucs::rand() % 3) * 8;
+            if (ucs::rand() % 4 == 0) {
+                params.dims[dim].stride = -params.dims[dim].stride;
+            }
+            span = ((params.dims[dim].count - 1) *
+                    std::abs(params.dims[dim].stride)) + span;
+        }
+
+        params.extent = span + (ucs::rand() % 3) * 8;
+        if (ucs::rand() % 4 == 0) {
+            params.extent = -params.extent;
+        }
+        return params;
+    }
+
+    /* Offsets of the blocks relative to the buffer, in packed order */
+    static void add_blocks(const ucp_dt_strided_params_t &params, int dim,
+                           ptrdiff_t base, std::vector<ptrdiff_t> &blocks) {
+        if (dim < 0) {
+            blocks.push_back(base);
+            return;
+        }
+
+        for (size_t i = 0; i < params.dims[dim].count; ++i) {
+            add_blocks(params, dim - 1, base + (i * params.dims[dim].stride),
+                       blocks);
+        }
+    }
+
+    static std::vector<ptrdiff_t>
+    blocks(const ucp_dt_strided_params_t &params, size_t count) {
+        std::vector<ptrdiff_t> result;
+
+        for (size_t i = 0; i < count; ++i) {
+            add_blocks(params, (int)params.num_dims - 1, i * params.extent,
+                       result);
+        }
+        return result;
+    }
+
+    static void split(size_t length, std::vector<size_t> &frags) {
+        size_t offset = 0;
+
+        frags.clear();
+        while (offset < length) {
+            frags.push_back(offset);
+            offset += (ucs::rand() % 64) + 1;
+        }
+        frags.push_back(length);
+    }
+};
+
+UCS_TEST_F(test_ucp_dt_strided, pack_unpack)
+{
+    for (int iter = 0; iter < 200; ++iter) {
+        ucp_dt_strided_params_t params = random_params();
+        size_t count                   = (ucs::rand() % 4) + 1;
+        std::vector<ptrdiff_t> offs    = blocks(params, count);
+        ucp_datatype_t dt;
+
+        ASSERT_UCS_OK(ucp_dt_create_strided(&params, &dt));
+
+        ptrdiff_t lo = 0, hi = 0;
+        for (size_t i = 0; i < offs.size(); ++i) {
+            lo = std::min(lo, offs[i]);
+            hi = std::max(hi, offs[i] + (ptrdiff_t)params.blocklen);
+        }
+
+        void *span_address;
+        size_t span_length;
+        std::vector<char> buffer(hi - lo), result(hi - lo, 0);
+        std::vector<char> expected(hi - lo, 0);
+        std::vector<char> packed, packed_ref;
+        char *base = &buffer[-lo];
+
+        ucp_dt_strided_span(dt, base, count, &span_address, &span_length);
+        EXPECT_EQ((void*)&buffer[0], span_address);
+        EXPECT_EQ(buffer.size(), span_length);
+
+        ucs::fill_random(buffer);
+        for (size_t i = 0; i < offs.size(); ++i) {
+            packed_ref.insert(packed_ref.end(), base + offs[i],
+                              base + offs[i] + params.blocklen);
+            memcpy(&expected[offs[i] - lo], base + offs[i], params.blocklen);
+        }
+
+        size_t length = ucp_dt_strided_length(dt, count);
+        ASSERT_EQ(packed_ref.size(), length);
+        EXPECT_LE(ucp_dt_strided_iov_count(dt, count), offs.size());
+
+        /* pack and unpack in random fragments */
+        std::vector<size_t> frags;
+        split(length, frags);
+        packed.resize(length);
+        for (size_t i = 0; i + 1 < frags.size(); ++i) {
+            ucp_dt_strided_pack(dt, &packed[frags[i]], base, frags[i],
+                                frags[i + 1] - frags[i]);
+        }
+        EXPECT_EQ(packed_ref, packed);
+
+        split(length, frags);
+        for (size_t i = 0; i + 1 < frags.size(); ++i) {
+            ucp_dt_strided_unpack(dt, &result[-lo], &packed[frags[i]],
+                                  frags[i], frags[i + 1] - frags[i]);
+        }
+        EXPECT_EQ(expected, result);
+
+        ucp_dt_destroy(dt);
+    }
+}
+
+UCS_TEST_F(test_ucp_dt_strided, uct_iov)
+{
+    const size_t max_iov = 4;
+    uct_iov_t iov[max_iov];
+
+    for (int iter = 0; iter < 200; ++iter) {
+        ucp_dt_strided_params_t params = random_params();
+        size_t count                   = (ucs::rand() % 4) + 1;
+        std::vector<ptrdiff_t> offs    = blocks(params, count);
+        ucp_datatype_t dt;
+
+        ASSERT_UCS_OK(ucp_dt_create_strided(&params, &dt));
+
+        void *span_address;
+        size_t span_length;
+        ucp_dt_strided_span(dt, NULL, count, &span_address, &span_length);
+
+        std::vector<char> buffer(span_length), packed_ref;
+        char *base = &buffer[0] - (ptrdiff_t)span_address;
+        ucs::fill_random(buffer);
+        for (size_t i = 0; i < offs.size(); ++i) {
+            packed_ref.insert(packed_ref.end(), base + offs[i],
+                              base + offs[i] + params.blocklen);
+        }
+
+        /* walk the data with random fragment sizes, every fragment describes
+         * the next part of the packed data */
+        std::vector<char> packed;
+        size_t offset = 0;
+        while (offset < packed_ref.size()) {
+            size_t iovcnt, len;
+
+            len = ucs_min((ucs::rand() % 100) + 1, packed_ref.size() - offset);
+            len = ucp_dt_strided_to_uct_iov(dt, base, offset, len,
+                                            UCT_MEM_HANDLE_NULL, iov, max_iov,
+                                            &iovcnt);
+            ASSERT_GT(len, 0u);
+            ASSERT_LE(iovcnt, max_iov);
+            for (size_t i = 0; i < iovcnt; ++i) {
+                EXPECT_EQ(1u, iov[i].count);
+                packed.insert(packed.end(), (char*)iov[i].buffer,
+                              (char*)iov[i].buffer + iov[i].length);
+            }
+            offset += len;
+        }
+        EXPECT_EQ(packed_ref, packed);
+
+        ucp_dt_destroy(dt);
+    }
+}
+
+UCS_TEST_F(test_ucp_dt_strided, normalize)
+{
+    ucp_dt_strided_params_t params;
+    ucp_datatype_t dt;
+    uct_iov_t iov;
+    size_t iovcnt;
+
+    /* 2x8 ints without gaps is a contiguous buffer */
+    params.field_mask     = UCP_DT_STRIDED_PARAM_FIELD_BLOCKLEN |
+                            UCP_DT_STRIDED_PARAM_FIELD_DIMS;
+    params.blocklen       = sizeof(int);
+    params.num_dims       = 3;
+    params.dims[0].count  = 8;
+    params.dims[0].stride = sizeof(int);
+    params.dims[1].count  = 1;
+    params.dims[1].stride = 1000;
+    params.dims[2].count  = 2;
+    params.dims[2].stride = 8 * sizeof(int);
+    ASSERT_UCS_OK(ucp_dt_create_strided(&params, &dt));
+
+    std::vector<int> buffer(16 * 3);
+    EXPECT_EQ(1u, ucp_dt_strided_iov_count(dt, 3));
+    EXPECT_EQ(buffer.size() * sizeof(int),
+              ucp_dt_strided_to_uct_iov(dt, &buffer[0], 0,
+                                        buffer.size() * sizeof(int),
+                                        UCT_MEM_HANDLE_NULL, &iov, 1,
+                                        &iovcnt));
+    EXPECT_EQ(1u, iovcnt);
+    EXPECT_EQ((void*)&buffer[0], iov.buffer);
+    ucp_dt_destroy(dt);
+
+    /* zero count is invalid */
+    params.dims[1].count = 0;
+    {
+        scoped_log_handler wrap_err(wrap_errors_logger);
+        EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucp_dt_create_strided(&params, &dt));
+    }
+}
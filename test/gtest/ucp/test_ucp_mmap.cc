@@ -9,6 +9,7 @@ extern "C" {
 #include <ucp/core/ucp_context.h>
 #include <ucp/core/ucp_mm.h>
 #include <ucp/core/ucp_ep.inl>
+#include <ucp/core/ucp_worker.h>
 }
 
 class test_ucp_mmap : public test_ucp_memheap {
@@ -392,4 +393,95 @@ UCS_TEST_P(test_ucp_mmap, fixed) {
     }
 }
 
+UCS_TEST_P(test_ucp_mmap, rkey_cache, "RKEY_CACHE_SIZE=2") {
+    const size_t num_keys   = 3;
+    ucp_worker_h worker     = sender().worker();
+    khash_t(ucp_worker_rkey_cache) *hash = &worker->rkey_cache.hash;
+    ucp_mem_h memh[num_keys];
+    std::vector<std::string> rkey_buffers;
+    ucp_mem_map_params_t params;
+    ucp_rkey_h rkey[num_keys], rkey2;
+    ucs_status_t status;
+    void *rkey_buffer;
+    size_t rkey_size;
+
+    sender().connect(&sender(), get_ep_params());
+
+    params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+                        UCP_MEM_MAP_PARAM_FIELD_LENGTH |
+                        UCP_MEM_MAP_PARAM_FIELD_FLAGS;
+    params.address    = NULL;
+    params.length     = 4096;
+    params.flags      = UCP_MEM_MAP_ALLOCATE;
+
+    for (size_t i = 0; i < num_keys; ++i) {
+        status = ucp_mem_map(sender().ucph(), &params, &memh[i]);
+        ASSERT_UCS_OK(status);
+
+        status = ucp_rkey_pack(sender().ucph(), memh[i], &rkey_buffer,
+                               &rkey_size);
+        if (status == UCS_OK) {
+            rkey_buffers.push_back(std::string((char*)rkey_buffer, rkey_size));
+            ucp_rkey_buffer_release(rkey_buffer);
+        }
+    }
+
+    if ((rkey_buffers.size() < num_keys) ||
+        (rkey_buffers[0] == rkey_buffers[1]) ||
+        (rkey_buffers[1] == rkey_buffers[2]) ||
+        (rkey_buffers[0] == rkey_buffers[2])) {
+        for (size_t i = 0; i < num_keys; ++i) {
+            ucp_mem_unmap(sender().ucph(), memh[i]);
+        }
+        UCS_TEST_SKIP_R("memory keys are not distinct");
+    }
+
+    /* repeated unpack returns the cached handle */
+    status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffers[0].data(), &rkey[0]);
+    ASSERT_UCS_OK(status);
+    status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffers[0].data(), &rkey2);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(rkey[0], rkey2);
+    EXPECT_TRUE(rkey[0]->flags & UCP_RKEY_DESC_FLAG_CACHED);
+    EXPECT_EQ(1u, kh_size(hash));
+    EXPECT_EQ(resolve_rma(&sender(), rkey[0]), resolve_rma(&sender(), rkey2));
+
+    /* the key stays cached after all its users destroyed it */
+    ucp_rkey_destroy(rkey2);
+    ucp_rkey_destroy(rkey[0]);
+    EXPECT_EQ(1u, kh_size(hash));
+    status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffers[0].data(), &rkey2);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(rkey[0], rkey2);
+    ucp_rkey_destroy(rkey2);
+
+    /* the idle key is evicted when the cache is full */
+    for (size_t i = 1; i < num_keys; ++i) {
+        status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffers[i].data(),
+                                    &rkey[i]);
+        ASSERT_UCS_OK(status);
+        EXPECT_TRUE(rkey[i]->flags & UCP_RKEY_DESC_FLAG_CACHED);
+    }
+    EXPECT_EQ(2u, kh_size(hash));
+
+    /* when all cached keys are in use, a new key is unpacked uncached */
+    status = ucp_ep_rkey_unpack(sender().ep(), rkey_buffers[0].data(), &rkey[0]);
+    ASSERT_UCS_OK(status);
+    EXPECT_FALSE(rkey[0]->flags & UCP_RKEY_DESC_FLAG_CACHED);
+    EXPECT_EQ(2u, kh_size(hash));
+
+    for (size_t i = 0; i < num_keys; ++i) {
+        ucp_rkey_destroy(rkey[i]);
+    }
+
+    /* endpoint destruction drops its cached keys */
+    disconnect(sender());
+    EXPECT_EQ(0u, kh_size(hash));
+
+    for (size_t i = 0; i < num_keys; ++i) {
+        status = ucp_mem_unmap(sender().ucph(), memh[i]);
+        ASSERT_UCS_OK(status);
+    }
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_mmap)
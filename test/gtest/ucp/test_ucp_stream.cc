@@ -12,6 +12,8 @@
 #include "ucp_datatype.h"
 #include "ucp_test.h"
 
+#include <ucp/core/ucp_ep.inl>
+
 
 class test_ucp_stream_base : public ucp_test {
 public:
@@ -611,6 +613,156 @@ UCS_TEST_P(test_ucp_stream, send_zero_ending_iov_recv_data) {
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_stream)
 
+
+class test_ucp_stream_rndv : public test_ucp_stream {
+public:
+    virtual void init() {
+        modify_config("STREAM_RNDV_THRESH", "16k");
+        test_ucp_stream::init();
+    }
+
+protected:
+    void do_send_recv_check_test(const std::vector<size_t> &send_sizes,
+                                 const std::vector<size_t> &recv_sizes,
+                                 unsigned recv_flags, bool recv_first);
+};
+
+void test_ucp_stream_rndv::do_send_recv_check_test(
+        const std::vector<size_t> &send_sizes,
+        const std::vector<size_t> &recv_sizes, unsigned recv_flags,
+        bool recv_first)
+{
+    size_t total = std::accumulate(send_sizes.begin(), send_sizes.end(),
+                                   size_t(0));
+    std::vector<char> sbuf(total), rbuf(total, 'r');
+    std::vector<void*> sreqs, rreqs;
+    std::vector<size_t> rlengths;
+    size_t offset;
+
+    ucs::fill_random(sbuf);
+
+    if (!recv_first) {
+        offset = 0;
+        for (size_t i = 0; i < send_sizes.size(); ++i) {
+            ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[offset],
+                                          send_sizes[i]);
+            sreqs.push_back(stream_send_nb(dt_desc));
+            ASSERT_FALSE(UCS_PTR_IS_ERR(sreqs.back()));
+            offset += send_sizes[i];
+        }
+        short_progress_loop();
+    }
+
+    offset = 0;
+    for (size_t i = 0; i < recv_sizes.size(); ++i) {
+        size_t length;
+        void *rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[offset],
+                                        recv_sizes[i], DATATYPE, ucp_recv_cb,
+                                        &length, recv_flags);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+        rreqs.push_back(rreq);
+        rlengths.push_back(UCS_PTR_IS_PTR(rreq) ? 0 : length);
+        offset += recv_sizes[i];
+    }
+
+    if (recv_first) {
+        offset = 0;
+        for (size_t i = 0; i < send_sizes.size(); ++i) {
+            ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[offset],
+                                          send_sizes[i]);
+            sreqs.push_back(stream_send_nb(dt_desc));
+            ASSERT_FALSE(UCS_PTR_IS_ERR(sreqs.back()));
+            offset += send_sizes[i];
+        }
+    }
+
+    for (size_t i = 0; i < rreqs.size(); ++i) {
+        if (UCS_PTR_IS_PTR(rreqs[i])) {
+            rlengths[i] = wait_stream_recv(rreqs[i]);
+        }
+
+        /* every receive is filled completely, since the sizes match */
+        EXPECT_EQ(recv_sizes[i], rlengths[i]) << "receive " << i;
+    }
+
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+
+    EXPECT_EQ(sbuf, rbuf);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, exp_recv) {
+    size_t rndv_thresh = ucp_ep_config(sender().ep())->stream.rndv_thresh;
+    std::vector<size_t> sizes;
+
+    if (rndv_thresh == SIZE_MAX) {
+        UCS_TEST_SKIP_R("stream rendezvous is not supported");
+    }
+
+    for (size_t size = rndv_thresh; size <= (4 * UCS_MBYTE); size *= 4) {
+        sizes.push_back(size);
+    }
+
+    /* a posted receive per message, each one is fetched in place and
+     * completes without the WAITALL flag */
+    do_send_recv_check_test(sizes, sizes, 0, true);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, exp_recv_waitall) {
+    std::vector<size_t> send_sizes, recv_sizes;
+    size_t total = 0;
+
+    for (size_t size = 3; size <= (4 * UCS_MBYTE); size *= 5) {
+        send_sizes.push_back(size);
+        total += size;
+    }
+
+    /* one receive which collects eager and rendezvous data in order */
+    recv_sizes.push_back(total);
+    do_send_recv_check_test(send_sizes, recv_sizes,
+                            UCP_STREAM_RECV_FLAG_WAITALL, true);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, exp_recv_small_buffers) {
+    std::vector<size_t> send_sizes, recv_sizes;
+
+    /* receive buffers are too small for the messages, which are fetched to
+     * a bounce descriptor and split between the requests */
+    send_sizes.push_back(256 * UCS_KBYTE);
+    send_sizes.push_back(100);
+    send_sizes.push_back(UCS_MBYTE);
+    recv_sizes.assign((send_sizes[0] + send_sizes[1] + send_sizes[2]) /
+                      (4 * UCS_KBYTE), 4 * UCS_KBYTE);
+    recv_sizes.push_back(send_sizes[1]);
+    do_send_recv_check_test(send_sizes, recv_sizes,
+                            UCP_STREAM_RECV_FLAG_WAITALL, true);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, unexp_recv) {
+    std::vector<size_t> sizes;
+    for (size_t size = UCS_KBYTE; size <= (4 * UCS_MBYTE); size *= 4) {
+        sizes.push_back(size);
+        sizes.push_back(size / 3);
+    }
+
+    do_send_recv_check_test(sizes, sizes, UCP_STREAM_RECV_FLAG_WAITALL, false);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, send_recv_data) {
+    do_send_recv_data_test(DATATYPE);
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, send_exp_recv_32) {
+    do_send_exp_recv_test<uint32_t, 0>(ucp_dt_make_contig(4));
+}
+
+UCS_TEST_P(test_ucp_stream_rndv, send_recv_data_recv_8) {
+    do_send_recv_data_recv_test(DATATYPE);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_stream_rndv)
+
 class test_ucp_stream_many2one : public test_ucp_stream_base {
 protected:
     struct request_wrapper_t {
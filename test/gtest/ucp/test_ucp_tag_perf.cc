@@ -6,6 +6,13 @@
 
 #include "test_ucp_tag.h"
 
+#include <deque>
+#include <map>
+
+extern "C" {
+#include <ucp/core/ucp_worker.h>
+}
+
 
 class test_ucp_tag_perf : public test_ucp_tag {
 public:
@@ -20,6 +27,14 @@ protected:
     static const size_t    COUNT    = 8192;
     static const ucp_tag_t TAG_MASK = 0xffffffffffffffffUL;
 
+    virtual ucp_tag_t perf_tag(size_t index) {
+        return index;
+    }
+
+    virtual ucp_tag_t perf_tag_mask() {
+        return TAG_MASK;
+    }
+
     double check_perf(size_t count, bool is_exp);
     void check_scalability(double max_growth, bool is_exp);
     void do_sends(size_t count);
@@ -33,7 +48,8 @@ double test_ucp_tag_perf::check_perf(size_t count, bool is_exp)
         std::vector<request*> rreqs;
 
         for (size_t i = 0; i < count; ++i) {
-            request *rreq = recv_nb(NULL, 0, DATATYPE, i, TAG_MASK);
+            request *rreq = recv_nb(NULL, 0, DATATYPE, perf_tag(i),
+                                    perf_tag_mask());
             assert(!UCS_PTR_IS_ERR(rreq));
             EXPECT_FALSE(rreq->completed);
             rreqs.push_back(rreq);
@@ -55,7 +71,7 @@ double test_ucp_tag_perf::check_perf(size_t count, bool is_exp)
 
         start_time = ucs_get_time();
         for (size_t i = 0; i < count; ++i) {
-            recv_b(NULL, 0, DATATYPE, i, TAG_MASK, &info);
+            recv_b(NULL, 0, DATATYPE, perf_tag(i), perf_tag_mask(), &info);
         }
     }
 
@@ -67,7 +83,7 @@ void test_ucp_tag_perf::do_sends(size_t count)
     size_t i = count;
     while (i > 0) {
         --i;
-        send_b(NULL, 0, DATATYPE, i);
+        send_b(NULL, 0, DATATYPE, perf_tag(i));
     }
 }
 
@@ -123,3 +139,153 @@ UCS_TEST_P(test_ucp_tag_perf, multi_unexp) {
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_perf)
+
+
+class test_ucp_tag_perf_sender : public test_ucp_tag_perf {
+public:
+    static ucp_params_t get_ctx_params() {
+        ucp_params_t params    = test_ucp_tag_perf::get_ctx_params();
+        params.field_mask     |= UCP_PARAM_FIELD_TAG_SENDER_MASK;
+        params.tag_sender_mask = SENDER_MASK;
+        return params;
+    }
+
+protected:
+    static const ucp_tag_t SENDER_MASK  = 0xffffff0000000000UL;
+    static const unsigned  SENDER_SHIFT = 40;
+    static const size_t    NUM_SENDERS  = 64;
+
+    /* Every receive selects a distinct sender and ignores the tag bits */
+    virtual ucp_tag_t perf_tag(size_t index) {
+        return (ucp_tag_t)(index + 1) << SENDER_SHIFT;
+    }
+
+    virtual ucp_tag_t perf_tag_mask() {
+        return SENDER_MASK;
+    }
+
+    static ucp_tag_t mixed_tag(size_t index) {
+        return ((ucp_tag_t)(index % NUM_SENDERS) << SENDER_SHIFT) | index;
+    }
+
+    static ucp_tag_t mixed_tag_mask(size_t index) {
+        switch (index % 8) {
+        case 0:
+            return 0;
+        case 1:
+        case 2:
+            return SENDER_MASK;
+        default:
+            return TAG_MASK;
+        }
+    }
+
+    void check_mixed_matching(size_t count);
+};
+
+/*
+ * Post receives with full, sender-only and wildcard masks, send the messages in
+ * reverse order, and check that every message matched the oldest posted
+ * receive which accepts it.
+ */
+void test_ucp_tag_perf_sender::check_mixed_matching(size_t count)
+{
+    ucp_tag_match_t *tm = &receiver().worker()->tm;
+    unsigned exp_size_log = tm->expected.hash.size_log;
+    std::vector<ssize_t> expected_msg(count, -1);
+    std::map<ucp_tag_t, std::deque<size_t> > sender_recvs;
+    std::deque<size_t> wild_recvs;
+    std::vector<request*> rreqs;
+    ucp_tag_recv_info_t info;
+    size_t num_unexp = 0;
+    ucs_time_t start_time;
+
+    for (size_t i = 0; i < count; ++i) {
+        request *rreq = recv_nb(NULL, 0, DATATYPE, mixed_tag(i),
+                                mixed_tag_mask(i));
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreq));
+        rreqs.push_back(rreq);
+
+        if (mixed_tag_mask(i) == 0) {
+            wild_recvs.push_back(i);
+        } else if (mixed_tag_mask(i) == SENDER_MASK) {
+            sender_recvs[mixed_tag(i) & SENDER_MASK].push_back(i);
+        }
+    }
+
+    EXPECT_GT(tm->expected.hash.size_log, exp_size_log);
+
+    /* Reference model: the oldest of the first wildcard receive, the first
+     * receive of the message sender, and the full tag receive */
+    for (size_t msg = count; msg-- > 0; ) {
+        std::deque<size_t> &src_q = sender_recvs[mixed_tag(msg) & SENDER_MASK];
+        size_t match              = SIZE_MAX;
+
+        if (!wild_recvs.empty()) {
+            match = wild_recvs.front();
+        }
+        if (!src_q.empty()) {
+            match = std::min(match, src_q.front());
+        }
+        if ((mixed_tag_mask(msg) == TAG_MASK) && (expected_msg[msg] == -1)) {
+            match = std::min(match, msg);
+        }
+
+        if (match == SIZE_MAX) {
+            ++num_unexp;
+            continue;
+        }
+
+        if (!wild_recvs.empty() && (match == wild_recvs.front())) {
+            wild_recvs.pop_front();
+        } else if (!src_q.empty() && (match == src_q.front())) {
+            src_q.pop_front();
+        }
+        expected_msg[match] = msg;
+    }
+
+    start_time = ucs_get_time();
+    for (size_t msg = count; msg-- > 0; ) {
+        send_b(NULL, 0, DATATYPE, mixed_tag(msg));
+    }
+    short_progress_loop();
+
+    UCS_TEST_MESSAGE << "matched " << count << " receives in "
+                     << ucs_time_to_usec(ucs_get_time() - start_time) / count
+                     << " usec/msg, " << UCS_BIT(tm->expected.hash.size_log)
+                     << " buckets";
+
+    for (size_t i = 0; i < count; ++i) {
+        request *rreq = rreqs[i];
+
+        if (expected_msg[i] == -1) {
+            EXPECT_FALSE(rreq->completed) << "receive " << i;
+            ucp_request_cancel(receiver().worker(), rreq);
+            wait(rreq);
+            EXPECT_EQ(UCS_ERR_CANCELED, rreq->status);
+        } else {
+            wait(rreq);
+            EXPECT_EQ(UCS_OK, rreq->status);
+            EXPECT_EQ(mixed_tag(expected_msg[i]), rreq->info.sender_tag)
+                      << "receive " << i;
+        }
+        request_release(rreq);
+    }
+
+    for (size_t i = 0; i < num_unexp; ++i) {
+        recv_b(NULL, 0, DATATYPE, 0, 0, &info);
+    }
+    EXPECT_TRUE(ucp_tag_unexp_is_empty(tm));
+    EXPECT_EQ(0u, tm->expected.src_hash.count);
+    EXPECT_EQ(0u, tm->expected.hash.count);
+}
+
+UCS_TEST_P(test_ucp_tag_perf_sender, multi_exp) {
+    check_scalability(1.5, true);
+}
+
+UCS_TEST_P(test_ucp_tag_perf_sender, mixed_100k) {
+    check_mixed_matching(100000);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_perf_sender)
@@ -115,6 +115,9 @@ public:
     void test_xfer_contig(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_generic(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_iov(size_t size, bool expected, bool sync, bool truncated);
+    void test_xfer_strided(size_t size, bool expected, bool sync, bool truncated);
+    void test_xfer_strided_large(size_t size, bool expected, bool sync,
+                                 bool truncated);
     void test_xfer_generic_err(size_t size, bool expected, bool sync, bool truncated);
 
 protected:
@@ -137,6 +140,10 @@ protected:
 
     void test_xfer_len_offset();
 
+    void test_xfer_strided_dt(const ucp_dt_strided_params_t &params,
+                              size_t size, bool expected, bool sync,
+                              bool truncated);
+
 private:
     request* do_send(const void *sendbuf, size_t count, ucp_datatype_t dt, bool sync);
 
@@ -416,6 +423,91 @@ void test_ucp_tag_xfer::test_xfer_iov(size_t size, bool expected, bool sync,
                                "IOV"));
 }
 
+void test_ucp_tag_xfer::test_xfer_strided_dt(const ucp_dt_strided_params_t &params,
+                                             size_t size, bool expected,
+                                             bool sync, bool truncated)
+{
+    size_t elem_size = params.blocklen;
+    ptrdiff_t extent = params.blocklen;
+    ucp_datatype_t dt;
+    size_t count, recvd;
+
+    for (unsigned dim = 0; dim < params.num_dims; ++dim) {
+        elem_size *= params.dims[dim].count;
+        extent     = params.dims[dim].count * params.dims[dim].stride;
+    }
+
+    count = size / elem_size;
+    if ((truncated) && (!count)) {
+        truncated = false;
+    }
+
+    ASSERT_UCS_OK(ucp_dt_create_strided(&params, &dt));
+
+    std::vector<char> sendbuf(count * extent, 0);
+    std::vector<char> recvbuf(count * extent, 0);
+    std::vector<char> expbuf(count * extent, 0);
+
+    ucs::fill_random(sendbuf);
+    recvd = do_xfer(sendbuf.data(), recvbuf.data(), count, dt, dt, expected,
+                    sync, truncated);
+    if (!truncated) {
+        EXPECT_EQ(count * elem_size, recvd);
+
+        /* the blocks are copied, and the gaps between them are untouched */
+        for (size_t offset = 0; offset < recvd; offset += params.blocklen) {
+            size_t block   = offset / params.blocklen;
+            ptrdiff_t addr = 0;
+            for (unsigned dim = 0; dim < params.num_dims; ++dim) {
+                addr  += (block % params.dims[dim].count) *
+                         params.dims[dim].stride;
+                block /= params.dims[dim].count;
+            }
+            addr += block * extent;
+            memcpy(&expbuf[addr], &sendbuf[addr], params.blocklen);
+        }
+        EXPECT_TRUE(expbuf == recvbuf) << "size=" << size
+                                       << " expected=" << expected
+                                       << " sync=" << sync;
+    }
+
+    ucp_dt_destroy(dt);
+}
+
+void test_ucp_tag_xfer::test_xfer_strided(size_t size, bool expected,
+                                          bool sync, bool truncated)
+{
+    ucp_dt_strided_params_t params;
+
+    /* 3 columns of doubles, every other one, of a 4-row matrix */
+    params.field_mask     = UCP_DT_STRIDED_PARAM_FIELD_BLOCKLEN |
+                            UCP_DT_STRIDED_PARAM_FIELD_DIMS;
+    params.blocklen       = sizeof(double);
+    params.num_dims       = 2;
+    params.dims[0].count  = 3;
+    params.dims[0].stride = 2 * sizeof(double);
+    params.dims[1].count  = 4;
+    params.dims[1].stride = 8 * sizeof(double);
+
+    test_xfer_strided_dt(params, size, expected, sync, truncated);
+}
+
+void test_ucp_tag_xfer::test_xfer_strided_large(size_t size, bool expected,
+                                                bool sync, bool truncated)
+{
+    ucp_dt_strided_params_t params;
+
+    /* blocks large enough to be sent with zero copy */
+    params.field_mask     = UCP_DT_STRIDED_PARAM_FIELD_BLOCKLEN |
+                            UCP_DT_STRIDED_PARAM_FIELD_DIMS;
+    params.blocklen       = 3000;
+    params.num_dims       = 1;
+    params.dims[0].count  = 2;
+    params.dims[0].stride = 4096;
+
+    test_xfer_strided_dt(params, size, expected, sync, truncated);
+}
+
 void test_ucp_tag_xfer::test_xfer_generic_err(size_t size, bool expected,
                                               bool sync, bool truncated)
 {
@@ -609,6 +701,30 @@ UCS_TEST_P(test_ucp_tag_xfer, iov_unexp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_iov, false, false, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_truncated) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, true);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_unexp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_zcopy, "ZCOPY_THRESH=1") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_large_exp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided_large, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_large_unexp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided_large, false, false, false);
+}
+
 UCS_TEST_P(test_ucp_tag_xfer, generic_err_exp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_generic_err, true, false, false);
 }
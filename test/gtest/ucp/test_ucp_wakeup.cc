@@ -10,6 +10,10 @@
 #include <sys/epoll.h>
 #include <sys/poll.h>
 
+extern "C" {
+#include <ucp/core/ucp_worker.h>
+}
+
 
 class test_ucp_wakeup : public ucp_test {
 public:
@@ -180,6 +184,150 @@ UCS_TEST_P(test_ucp_wakeup, signal)
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_wakeup)
 
+class test_ucp_wakeup_hybrid : public test_ucp_wakeup {
+protected:
+    /* State shared with the thread which waits for wakeup signals */
+    struct waiter {
+        ucp_worker_h        worker;
+        unsigned            count;
+        volatile unsigned   num_signaled;
+        volatile unsigned   num_woken;
+        volatile ucs_time_t signal_time;
+        ucs_time_t          total_latency;
+    };
+
+    virtual void init() {
+        modify_config("WAIT_MODE", "hybrid");
+        test_ucp_wakeup::init();
+    }
+
+    static void *wait_thread(void *arg) {
+        waiter *w = reinterpret_cast<waiter*>(arg);
+
+        for (unsigned i = 1; i <= w->count; ++i) {
+            /* ucp_worker_wait may return when there is no signal */
+            while (w->num_signaled < i) {
+                ucp_worker_wait(w->worker);
+            }
+
+            w->total_latency += ucs_get_time() - w->signal_time;
+            ucs_memory_cpu_store_fence();
+            w->num_woken      = i;
+        }
+
+        return NULL;
+    }
+
+    /* Measure average time from ucp_worker_signal to return from
+     * ucp_worker_wait in another thread, when signals are sent every gap_usec */
+    double wakeup_latency(ucp_worker_h worker, unsigned count,
+                          unsigned gap_usec) {
+        waiter w;
+        pthread_t thread;
+
+        w.worker        = worker;
+        w.count         = count;
+        w.num_signaled  = 0;
+        w.num_woken     = 0;
+        w.signal_time   = 0;
+        w.total_latency = 0;
+        pthread_create(&thread, NULL, wait_thread, &w);
+
+        for (unsigned i = 1; i <= count; ++i) {
+            usleep(gap_usec);
+            w.signal_time  = ucs_get_time();
+            ucs_memory_cpu_store_fence();
+            w.num_signaled = i;
+            ASSERT_UCS_OK(ucp_worker_signal(worker));
+            while (w.num_woken < i) {
+                sched_yield();
+            }
+        }
+
+        pthread_join(thread, NULL);
+        return ucs_time_to_usec(w.total_latency) / count;
+    }
+};
+
+UCS_TEST_SKIP_COND_P(test_ucp_wakeup_hybrid, tx_wait,
+                     has_transport("tcp"), "ZCOPY_THRESH=10000")
+{
+    const ucp_datatype_t DATATYPE = ucp_dt_make_contig(1);
+    const size_t COUNT            = 20000;
+    const uint64_t TAG            = 0xdeadbeef;
+    std::string send_data(COUNT, '2'), recv_data(COUNT, '1');
+    void *sreq, *rreq;
+
+    sender().connect(&receiver(), get_ep_params());
+
+    rreq = ucp_tag_recv_nb(receiver().worker(), &recv_data[0], COUNT, DATATYPE,
+                           TAG, (ucp_tag_t)-1, recv_completion);
+
+    sreq = ucp_tag_send_nb(sender().ep(), &send_data[0], COUNT, DATATYPE, TAG,
+                           send_completion);
+
+    if (UCS_PTR_IS_PTR(sreq)) {
+        do {
+            ucp_worker_wait(sender().worker());
+            while (progress());
+        } while (!ucp_request_is_completed(sreq));
+        ucp_request_release(sreq);
+    } else {
+        ASSERT_UCS_OK(UCS_PTR_STATUS(sreq));
+    }
+
+    wait(rreq);
+
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCS_TEST_P(test_ucp_wakeup_hybrid, spin_budget, "WAIT_SPIN_MAX=1ms")
+{
+    ucp_worker_h worker = sender().worker();
+
+    EXPECT_GT(worker->wait.spin_max, 0u);
+
+    /* events which arrive right away keep the spin time short */
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_UCS_OK(ucp_worker_signal(worker));
+        ASSERT_UCS_OK(ucp_worker_wait(worker));
+    }
+    EXPECT_LT(worker->wait.spin_budget, worker->wait.spin_max);
+
+    /* events which arrive after much longer than the maximal spin time make
+     * ucp_worker_wait sleep right away */
+    wakeup_latency(worker, 30, 10000);
+    EXPECT_EQ(0u, worker->wait.spin_budget);
+}
+
+/* Wakeup latency benchmark: compare blocking and hybrid waiting for bursty
+ * and sparse events. Reports the results without checking them, since they
+ * depend on the machine load. */
+UCS_TEST_SKIP_COND_P(test_ucp_wakeup_hybrid, latency, RUNNING_ON_VALGRIND,
+                     "WAIT_SPIN_MAX=100us")
+{
+    static const unsigned gaps_usec[] = { 0, 20, 200, 2000 };
+    const unsigned count              = 200 / ucs::test_time_multiplier();
+    ucp_worker_h worker               = sender().worker();
+    const ucs_time_t spin_max         = worker->wait.spin_max;
+
+    for (size_t i = 0; i < sizeof(gaps_usec) / sizeof(gaps_usec[0]); ++i) {
+        /* blocking mode is the hybrid mode with no spinning */
+        worker->wait.spin_max    = 0;
+        double block_latency     = wakeup_latency(worker, count, gaps_usec[i]);
+
+        worker->wait.spin_max    = spin_max;
+        worker->wait.spin_budget = spin_max;
+        double hybrid_latency    = wakeup_latency(worker, count, gaps_usec[i]);
+
+        UCS_TEST_MESSAGE << "gap " << gaps_usec[i] << " usec: wakeup latency "
+                         << "block " << block_latency << " usec, hybrid "
+                         << hybrid_latency << " usec";
+    }
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_wakeup_hybrid)
+
 class test_ucp_wakeup_external_epollfd : public test_ucp_wakeup {
 public:
     virtual ucp_worker_params_t get_worker_params() {
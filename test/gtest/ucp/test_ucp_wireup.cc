@@ -447,6 +447,179 @@ UCS_TEST_P(test_ucp_wireup_1sided, address) {
     ASSERT_TRUE(packed_dev_priorities == unpacked_dev_priorities);
 }
 
+UCS_TEST_P(test_ucp_wireup_1sided, address_template, "ADDRESS_TEMPLATE=y") {
+    ucp_worker_h worker = receiver().worker();
+    ucp_unpacked_address unpacked_address[2];
+    unsigned pack_flags[2];
+    ucs_status_t status;
+    size_t size[2];
+    void *buffer[2];
+
+    /* full address, and compact address which refers to template entries */
+    pack_flags[0] = UCP_ADDRESS_PACK_FLAGS_ALL;
+    pack_flags[1] = UCP_ADDRESS_PACK_FLAGS_ALL | UCP_ADDRESS_PACK_FLAG_TEMPLATE;
+    for (int i = 0; i < 2; ++i) {
+        status = ucp_address_pack(sender().worker(), NULL,
+                                  std::numeric_limits<uint64_t>::max(),
+                                  pack_flags[i], m_lanes2remote, &size[i],
+                                  &buffer[i]);
+        ASSERT_UCS_OK(status);
+        ASSERT_TRUE(buffer[i] != NULL);
+
+        status = ucp_address_unpack(worker, buffer[i],
+                                    UCP_ADDRESS_PACK_FLAGS_ALL,
+                                    &unpacked_address[i]);
+        ASSERT_UCS_OK(status);
+        EXPECT_TRUE(ucp_address_is_local_template(worker,
+                                                  &unpacked_address[i]));
+    }
+
+    EXPECT_LT(size[1], size[0]);
+    EXPECT_EQ(unpacked_address[0].uuid, unpacked_address[1].uuid);
+
+    ASSERT_EQ(unpacked_address[0].address_count,
+              unpacked_address[1].address_count);
+    for (unsigned i = 0; i < unpacked_address[0].address_count; ++i) {
+        const ucp_address_entry_t *ae0 = &unpacked_address[0].address_list[i];
+        const ucp_address_entry_t *ae1 = &unpacked_address[1].address_list[i];
+
+        EXPECT_EQ(ae0->dev_addr == NULL,   ae1->dev_addr == NULL);
+        EXPECT_EQ(ae0->iface_addr == NULL, ae1->iface_addr == NULL);
+        EXPECT_EQ(ae0->num_ep_addrs,  ae1->num_ep_addrs);
+        EXPECT_EQ(ae0->md_index,      ae1->md_index);
+        EXPECT_EQ(ae0->dev_index,     ae1->dev_index);
+        EXPECT_EQ(ae0->tl_name_csum,  ae1->tl_name_csum);
+        EXPECT_EQ(ae0->md_flags,      ae1->md_flags);
+        EXPECT_EQ(ae0->dev_num_paths, ae1->dev_num_paths);
+        EXPECT_EQ(0, memcmp(&ae0->iface_attr, &ae1->iface_attr,
+                            sizeof(ae0->iface_attr)));
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        ucs_free(unpacked_address[i].address_list);
+        ucs_free(buffer[i]);
+    }
+}
+
+UCS_TEST_P(test_ucp_wireup_1sided, address_template_mismatch,
+           "ADDRESS_TEMPLATE=y") {
+    /* without worker UUID and name, the template hash follows the header */
+    unsigned pack_flags = UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR |
+                          UCP_ADDRESS_PACK_FLAG_IFACE_ADDR |
+                          UCP_ADDRESS_PACK_FLAG_TEMPLATE;
+    ucp_unpacked_address unpacked_address;
+    ucs_status_t status;
+    uint64_t hash;
+    size_t size;
+    void *buffer;
+
+    status = ucp_address_pack(sender().worker(), NULL,
+                              std::numeric_limits<uint64_t>::max(),
+                              pack_flags, m_lanes2remote, &size, &buffer);
+    ASSERT_UCS_OK(status);
+    ASSERT_TRUE(buffer != NULL);
+    ASSERT_GT(size, 1 + sizeof(hash));
+
+    status = ucp_address_unpack(receiver().worker(), buffer, pack_flags,
+                                &unpacked_address);
+    ASSERT_UCS_OK(status);
+    ucs_free(unpacked_address.address_list);
+
+    memcpy(&hash, UCS_PTR_BYTE_OFFSET(buffer, 1), sizeof(hash));
+    EXPECT_EQ(unpacked_address.template_hash, hash);
+
+    /* compact address of a worker with a different template must not be
+     * unpacked */
+    hash ^= 1;
+    memcpy(UCS_PTR_BYTE_OFFSET(buffer, 1), &hash, sizeof(hash));
+    {
+        scoped_log_handler wrap_err(wrap_errors_logger);
+        status = ucp_address_unpack(receiver().worker(), buffer, pack_flags,
+                                    &unpacked_address);
+    }
+    EXPECT_EQ(UCS_ERR_UNREACHABLE, status);
+
+    ucs_free(buffer);
+}
+
+static void expect_same_attrs(const ucp_address_entry_t *ae1,
+                              const ucp_address_entry_t *ae2)
+{
+    EXPECT_EQ(ae1->md_index,      ae2->md_index);
+    EXPECT_EQ(ae1->dev_index,     ae2->dev_index);
+    EXPECT_EQ(ae1->tl_name_csum,  ae2->tl_name_csum);
+    EXPECT_EQ(ae1->md_flags,      ae2->md_flags);
+    EXPECT_EQ(ae1->dev_num_paths, ae2->dev_num_paths);
+    EXPECT_EQ(0, memcmp(&ae1->iface_attr, &ae2->iface_attr,
+                        sizeof(ae1->iface_attr)));
+}
+
+UCS_TEST_P(test_ucp_wireup_1sided, address_template_cache,
+           "ADDRESS_TEMPLATE=y") {
+    ucp_worker_h worker                = receiver().worker();
+    ucp_address_template_t *local_tmpl = worker->address_template;
+    uint64_t tl_bitmap                 = sender().ucph()->tl_bitmap;
+    ucp_unpacked_address unpacked_address[4];
+    uint64_t pack_tl_bitmap[4];
+    size_t cache_size[4];
+    ucs_status_t status;
+    size_t size;
+    void *buffer;
+
+    if (is_loopback()) {
+        UCS_TEST_SKIP_R("the sender must have its own template");
+    }
+
+    /* Unpack the addresses as if the sender had a different template. Only
+     * the full address of the sender adds its template to the cache. */
+    pack_tl_bitmap[0] = UCS_BIT(ucs_ilog2(tl_bitmap));
+    pack_tl_bitmap[1] = std::numeric_limits<uint64_t>::max();
+    pack_tl_bitmap[2] = std::numeric_limits<uint64_t>::max();
+    pack_tl_bitmap[3] = pack_tl_bitmap[0];
+
+    worker->address_template = NULL;
+    for (int i = 0; i < 4; ++i) {
+        status = ucp_address_pack(sender().worker(), NULL, pack_tl_bitmap[i],
+                                  UCP_ADDRESS_PACK_FLAGS_ALL, m_lanes2remote,
+                                  &size, &buffer);
+        ASSERT_UCS_OK(status);
+        ASSERT_TRUE(buffer != NULL);
+
+        status = ucp_address_unpack(worker, buffer, UCP_ADDRESS_PACK_FLAGS_ALL,
+                                    &unpacked_address[i]);
+        ucs_free(buffer);
+        ASSERT_UCS_OK(status);
+        cache_size[i] = kh_size(&worker->address_templates);
+        EXPECT_FALSE(ucp_address_is_local_template(worker,
+                                                   &unpacked_address[i]));
+    }
+    worker->address_template = local_tmpl;
+
+    /* The address with a single transport is a full address only if the
+     * sender has no other transports */
+    EXPECT_EQ((unpacked_address[0].address_count ==
+               unpacked_address[1].address_count) ? 1u : 0u, cache_size[0]);
+    for (int i = 1; i < 4; ++i) {
+        EXPECT_EQ(1u, cache_size[i]);
+    }
+
+    /* Entries taken from the cached template are the same as the parsed ones */
+    ASSERT_EQ(unpacked_address[1].address_count,
+              unpacked_address[2].address_count);
+    ASSERT_EQ(1u, unpacked_address[3].address_count);
+    for (unsigned i = 0; i < unpacked_address[1].address_count; ++i) {
+        expect_same_attrs(&unpacked_address[1].address_list[i],
+                          &unpacked_address[2].address_list[i]);
+    }
+
+    expect_same_attrs(&unpacked_address[0].address_list[0],
+                      &unpacked_address[3].address_list[0]);
+
+    for (int i = 0; i < 4; ++i) {
+        ucs_free(unpacked_address[i].address_list);
+    }
+}
+
 UCS_TEST_P(test_ucp_wireup_1sided, ep_address, "IB_NUM_PATHS?=2") {
     ucs_status_t status;
     size_t size;
@@ -510,6 +683,14 @@ UCS_TEST_P(test_ucp_wireup_1sided, one_sided_wireup) {
     flush_worker(sender());
 }
 
+UCS_TEST_P(test_ucp_wireup_1sided, one_sided_wireup_template,
+           "ADDRESS_TEMPLATE=y") {
+    sender().connect(&receiver(), get_ep_params());
+    EXPECT_TRUE(sender().ep()->flags & UCP_EP_FLAG_ADDR_TEMPLATE);
+    send_recv(sender().ep(), receiver().worker(), receiver().ep(), 1, 1);
+    flush_worker(sender());
+}
+
 UCS_TEST_P(test_ucp_wireup_1sided, one_sided_wireup_rndv, "RNDV_THRESH=1") {
     sender().connect(&receiver(), get_ep_params());
     send_recv(sender().ep(), receiver().worker(), receiver().ep(), BUFFER_LENGTH, 1);
@@ -679,6 +860,32 @@ UCS_TEST_P(test_ucp_wireup_1sided, multi_ep_1sided) {
     }
 }
 
+UCS_TEST_P(test_ucp_wireup_1sided, lane_select_memo) {
+    const unsigned count = 4;
+    ucp_worker_h worker  = sender().worker();
+
+    for (unsigned i = 0; i < count; ++i) {
+        sender().connect(&receiver(), get_ep_params(), i);
+    }
+
+    /* all endpoints are to the same peer, so the lanes are selected once */
+    EXPECT_EQ(1u, kh_size(&worker->select_memo));
+    for (unsigned i = 1; i < count; ++i) {
+        EXPECT_EQ(sender().ep(0, 0)->cfg_index, sender().ep(0, i)->cfg_index);
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        send_recv(sender().ep(0, i), receiver().worker(), receiver().ep(), 8, 1);
+    }
+}
+
+UCS_TEST_P(test_ucp_wireup_1sided, lane_select_memo_disabled,
+           "LANE_SELECT_CACHE_SIZE=0") {
+    sender().connect(&receiver(), get_ep_params());
+    EXPECT_EQ(0u, kh_size(&sender().worker()->select_memo));
+    send_recv(sender().ep(), receiver().worker(), receiver().ep(), 8, 1);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_wireup_1sided)
 
 class test_ucp_wireup_2sided : public test_ucp_wireup {
@@ -1077,3 +1077,256 @@ UCS_TEST_F(test_arbiter_random_resched, one_elem_many_groups) {
 UCS_TEST_F(test_arbiter_random_resched, many_elems_many_groups) {
     do_test_loop(42, 10, 4);
 }
+
+class test_arbiter_prio : public ucs::test {
+protected:
+    struct prio_elem {
+        unsigned           group_idx;
+        ucs_arbiter_elem_t elem;
+    };
+
+    virtual void init() {
+        ucs::test::init();
+        ucs_arbiter_init(&m_arb);
+        m_stop_after   = -1;
+        m_sched_group  = -1;
+    }
+
+    virtual void cleanup() {
+        for (size_t i = 0; i < m_groups.size(); ++i) {
+            ucs_arbiter_group_purge(&m_arb, &m_groups[i], purge_cb, NULL);
+            ucs_arbiter_group_cleanup(&m_groups[i]);
+        }
+        ucs_arbiter_cleanup(&m_arb);
+        ucs::test::cleanup();
+    }
+
+    void add_groups(unsigned count) {
+        m_groups.resize(count);
+        for (unsigned i = 0; i < count; ++i) {
+            ucs_arbiter_group_init(&m_groups[i]);
+        }
+    }
+
+    void push(unsigned group_idx, unsigned count, bool high_prio = false) {
+        for (unsigned i = 0; i < count; ++i) {
+            prio_elem *e = new prio_elem;
+            e->group_idx = group_idx;
+            ucs_arbiter_elem_init(&e->elem);
+            ucs_arbiter_group_push_elem(&m_groups[group_idx], &e->elem);
+            if (high_prio) {
+                ucs_arbiter_group_set_prio_elem(&m_groups[group_idx],
+                                                &e->elem);
+            }
+        }
+        ucs_arbiter_group_schedule(&m_arb, &m_groups[group_idx]);
+    }
+
+    void dispatch(unsigned per_group) {
+        m_order.clear();
+        ucs_arbiter_dispatch(&m_arb, per_group, dispatch_cb, this);
+    }
+
+    template <size_t N>
+    static std::vector<unsigned> order(const unsigned (&indices)[N]) {
+        return std::vector<unsigned>(indices, indices + N);
+    }
+
+    static ucs_arbiter_cb_result_t dispatch_cb(ucs_arbiter_t *arbiter,
+                                               ucs_arbiter_group_t *group,
+                                               ucs_arbiter_elem_t *elem,
+                                               void *arg)
+    {
+        test_arbiter_prio *self = static_cast<test_arbiter_prio*>(arg);
+        prio_elem *e            = ucs_container_of(elem, prio_elem, elem);
+
+        if (self->m_stop_after == 0) {
+            self->m_stop_after = -1;
+            return UCS_ARBITER_CB_RESULT_STOP;
+        } else if (self->m_stop_after > 0) {
+            --self->m_stop_after;
+        }
+
+        if (self->m_sched_group >= 0) {
+            /* schedule another group from the callback */
+            unsigned group_idx  = self->m_sched_group;
+            self->m_sched_group = -1;
+            self->push(group_idx, 1, true);
+        }
+
+        self->m_order.push_back(e->group_idx);
+        delete e;
+        return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    }
+
+    static ucs_arbiter_cb_result_t purge_cb(ucs_arbiter_t *arbiter,
+                                            ucs_arbiter_group_t *group,
+                                            ucs_arbiter_elem_t *elem,
+                                            void *arg)
+    {
+        delete ucs_container_of(elem, prio_elem, elem);
+        return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    }
+
+    /* remove a single element from a group */
+    void purge_elem(unsigned group_idx, ucs_arbiter_elem_t *elem) {
+        ucs_arbiter_group_purge(&m_arb, &m_groups[group_idx], purge_elem_cb,
+                                elem);
+    }
+
+    static ucs_arbiter_cb_result_t purge_elem_cb(ucs_arbiter_t *arbiter,
+                                                 ucs_arbiter_group_t *group,
+                                                 ucs_arbiter_elem_t *elem,
+                                                 void *arg)
+    {
+        if (elem != arg) {
+            return UCS_ARBITER_CB_RESULT_NEXT_GROUP;
+        }
+
+        return purge_cb(arbiter, group, elem, NULL);
+    }
+
+    ucs_arbiter_t                    m_arb;
+    std::vector<ucs_arbiter_group_t> m_groups;
+    std::vector<unsigned>            m_order;
+    int                              m_stop_after;
+    int                              m_sched_group;
+};
+
+UCS_TEST_F(test_arbiter_prio, strict_prio) {
+    static const unsigned expected[] = { 2, 2, 0, 1, 0, 1 };
+
+    add_groups(3);
+    push(0, 2);
+    push(1, 2);
+    push(2, 2, true);
+
+    dispatch(1);
+    EXPECT_EQ(order(expected), m_order);
+    EXPECT_TRUE(ucs_arbiter_is_empty(&m_arb));
+}
+
+UCS_TEST_F(test_arbiter_prio, raise_scheduled) {
+    static const unsigned expected1[] = { 2, 2, 0, 1, 0, 1 };
+    static const unsigned expected2[] = { 0, 1, 2 };
+
+    add_groups(3);
+    push(0, 2);
+    push(1, 2);
+    push(2, 1);
+
+    /* raising the priority moves an already scheduled group */
+    push(2, 1, true);
+    dispatch(1);
+    EXPECT_EQ(order(expected1), m_order);
+
+    /* the group returns to normal priority once it's empty */
+    push(0, 1);
+    push(1, 1);
+    push(2, 1);
+    dispatch(1);
+    EXPECT_EQ(order(expected2), m_order);
+}
+
+UCS_TEST_F(test_arbiter_prio, prio_until_dispatched) {
+    static const unsigned expected[] = { 1, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+    add_groups(2);
+    push(0, 4);
+    push(1, 1);
+    push(1, 1, true);
+
+    /* normal elements added after the high priority one do not keep the
+     * group in the high priority class */
+    push(1, 3);
+    dispatch(1);
+    EXPECT_EQ(order(expected), m_order);
+}
+
+UCS_TEST_F(test_arbiter_prio, purge_prio_elem) {
+    static const unsigned expected1[] = { 0, 1, 0, 1 };
+    static const unsigned expected2[] = { 1, 0, 1, 0 };
+
+    add_groups(2);
+
+    /* removing the only high priority element returns the group to the
+     * normal class, behind the groups which are already scheduled */
+    push(0, 2);
+    push(1, 1, true);
+    push(1, 2);
+    purge_elem(1, m_groups[1].prio_tail);
+    dispatch(1);
+    EXPECT_EQ(order(expected1), m_order);
+
+    /* the priority is kept until the element before the removed one is
+     * dispatched */
+    push(0, 2);
+    push(1, 1);
+    push(1, 1, true);
+    push(1, 1);
+    purge_elem(1, m_groups[1].prio_tail);
+    dispatch(1);
+    EXPECT_EQ(order(expected2), m_order);
+}
+
+UCS_TEST_F(test_arbiter_prio, sched_from_dispatch) {
+    static const unsigned expected[] = { 0, 2, 1, 0, 1 };
+
+    add_groups(3);
+    push(0, 2);
+    push(1, 2);
+
+    /* high priority group scheduled by the callback is dispatched next */
+    m_sched_group = 2;
+    dispatch(1);
+    EXPECT_EQ(order(expected), m_order);
+}
+
+UCS_TEST_F(test_arbiter_prio, weights) {
+    static const unsigned expected[] = { 0, 1, 1, 2, 2, 2,
+                                         0, 1, 1, 2, 2, 2,
+                                         0, 1, 2 };
+
+    add_groups(3);
+    for (unsigned i = 0; i < m_groups.size(); ++i) {
+        ucs_arbiter_group_set_weight(&m_groups[i], i + 1);
+    }
+    push(0, 3);
+    push(1, 5);
+    push(2, 7);
+
+    dispatch(1);
+    EXPECT_EQ(order(expected), m_order);
+}
+
+UCS_TEST_F(test_arbiter_prio, weights_per_group) {
+    static const unsigned expected[] = { 0, 0, 1, 1, 1, 1, 0, 0, 1, 1 };
+
+    add_groups(2);
+    ucs_arbiter_group_set_weight(&m_groups[1], 2);
+    push(0, 4);
+    push(1, 6);
+
+    dispatch(2);
+    EXPECT_EQ(order(expected), m_order);
+}
+
+UCS_TEST_F(test_arbiter_prio, stop_keeps_turn) {
+    static const unsigned expected1[] = { 0, 0 };
+    static const unsigned expected2[] = { 0, 1, 1, 1, 0, 0, 0, 1 };
+
+    add_groups(2);
+    ucs_arbiter_group_set_weight(&m_groups[0], 3);
+    ucs_arbiter_group_set_weight(&m_groups[1], 3);
+    push(0, 6);
+    push(1, 4);
+
+    /* stop in the middle of the turn of group 0 */
+    m_stop_after = 2;
+    dispatch(1);
+    EXPECT_EQ(order(expected1), m_order);
+
+    /* group 0 continues with the rest of its turn */
+    dispatch(1);
+    EXPECT_EQ(order(expected2), m_order);
+}
@@ -7,8 +7,12 @@
 #include <common/test.h>
 extern "C" {
 #include <ucs/sys/event_set.h>
+#include <ucs/sys/math.h>
+#include <ucs/time/time.h>
 #include <pthread.h>
 #include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 }
 
 #define MAX_BUF_LEN        255
@@ -282,3 +286,137 @@ INSTANTIATE_TEST_CASE_P(ext_fd, test_event_set,
                         ::testing::Values(static_cast<int>(
                                               UCS_EVENT_SET_EXTERNAL_FD)));
 INSTANTIATE_TEST_CASE_P(int_fd, test_event_set, ::testing::Values(0));
+
+class test_event_set_perf : public ucs::test {
+protected:
+    struct wait_arg {
+        unsigned count;
+    };
+
+    static void read_handler(void *callback_data, int events, void *arg)
+    {
+        wait_arg *warg = reinterpret_cast<wait_arg*>(arg);
+        int fd         = (int)(uintptr_t)callback_data;
+        char c;
+
+        /* Both modes drain the socket, which edge-triggered mode requires,
+         * so they handle the same amount of data per event */
+        if (events & UCS_EVENT_SET_EVREAD) {
+            while (read(fd, &c, sizeof(c)) == sizeof(c)) {
+                ++warg->count;
+            }
+        }
+    }
+
+    unsigned wait_once(wait_arg *warg)
+    {
+        unsigned num_events = ucs_sys_event_set_max_wait_events;
+        ucs_status_t status;
+
+        status = ucs_event_set_wait(m_event_set, &num_events, 0, read_handler,
+                                    warg);
+        EXPECT_TRUE((status == UCS_OK) || (status == UCS_INPROGRESS));
+        return num_events;
+    }
+
+    void wait(wait_arg *warg, unsigned count)
+    {
+        while (warg->count < count) {
+            wait_once(warg);
+        }
+    }
+
+    /* Every round a tenth of the connections receive a byte. Both modes
+     * watch the same events on the same sockets, so they differ only by the
+     * trigger mode */
+    void measure(unsigned num_conns, bool edge, double &usec_per_event)
+    {
+        const unsigned num_active = ucs_max(1u, num_conns / 10);
+        const unsigned num_rounds = ucs_max(10u, 100000u / num_conns);
+        std::vector<int> fds(num_conns * 2);
+        wait_arg warg  = { 0 };
+        char c         = 0;
+        unsigned count = 0;
+
+        ASSERT_UCS_OK(ucs_event_set_create(&m_event_set));
+
+        for (unsigned i = 0; i < num_conns; ++i) {
+            ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0,
+                                    &fds[i * 2])) << strerror(errno);
+            ASSERT_UCS_OK(ucs_event_set_add(m_event_set, fds[i * 2],
+                                            (ucs_event_set_type_t)
+                                            (UCS_EVENT_SET_EVREAD |
+                                             (edge ?
+                                              UCS_EVENT_SET_EDGE_TRIGGERED :
+                                              0)),
+                                            (void*)(uintptr_t)fds[i * 2]));
+        }
+
+        /* Consume whatever was reported on registration, until the set has no
+         * more events, so the measurement starts from a quiet set */
+        while (wait_once(&warg) > 0);
+        warg.count = 0;
+
+        ucs_time_t start = ucs_get_time();
+        for (unsigned round = 0; round < num_rounds; ++round) {
+            for (unsigned i = 0; i < num_active; ++i) {
+                unsigned conn = (round * num_active + i) % num_conns;
+                ASSERT_EQ(1, write(fds[conn * 2 + 1], &c, sizeof(c)));
+            }
+
+            count += num_active;
+            wait(&warg, count);
+        }
+        double elapsed = ucs_time_to_usec(ucs_get_time() - start);
+
+        ucs_event_set_cleanup(m_event_set);
+        for (unsigned i = 0; i < num_conns * 2; ++i) {
+            close(fds[i]);
+        }
+
+        usec_per_event = elapsed / count;
+    }
+
+    /* Returns how many connections can be opened */
+    unsigned max_conns()
+    {
+        struct rlimit limit;
+
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+            return 0;
+        }
+
+        if (limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+            getrlimit(RLIMIT_NOFILE, &limit);
+        }
+
+        /* Leave some descriptors for the test infrastructure */
+        return (limit.rlim_cur > 256) ? ((limit.rlim_cur - 256) / 2) : 0;
+    }
+
+    ucs_sys_event_set_t *m_event_set;
+};
+
+UCS_TEST_SKIP_COND_F(test_event_set_perf, conns_sweep,
+                     (ucs::test_time_multiplier() != 1)) {
+    unsigned max = max_conns();
+
+    for (unsigned num_conns = 10; num_conns <= 10000; num_conns *= 10) {
+        if (num_conns > max) {
+            UCS_TEST_MESSAGE << num_conns << " connections: exceed the limit "
+                             << "of open files";
+            break;
+        }
+
+        double level, edge;
+
+        measure(num_conns, false, level);
+        measure(num_conns, true, edge);
+
+        UCS_TEST_MESSAGE << num_conns << " connections: "
+                         << "level-triggered " << level << " usec/event, "
+                         << "edge-triggered " << edge << " usec/event";
+    }
+}
@@ -0,0 +1,124 @@
+/**
+* Copyright (C) Huawei Technologies Co., Ltd. 2021.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include <common/test.h>
+extern "C" {
+#include <ucs/arch/memcpy.h>
+}
+
+#include <vector>
+
+
+class test_memcpy : public ucs::test {
+protected:
+    enum {
+        guard_size  = 64,
+        guard_value = 0xa5
+    };
+
+    void test_copy(ucs_memcpy_func_t func, const std::string &name,
+                   size_t length, size_t src_offset, size_t dst_offset) {
+        std::vector<uint8_t> src(length + src_offset);
+        std::vector<uint8_t> dst(length + dst_offset + guard_size);
+
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = i * 7 + length;
+        }
+        std::fill(dst.begin(), dst.end(), guard_value);
+
+        func(&dst[dst_offset], &src[src_offset], length);
+
+        for (size_t i = 0; i < dst_offset; ++i) {
+            ASSERT_EQ((uint8_t)guard_value, dst[i])
+                    << name << " length " << length << " overwrote byte " << i;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            ASSERT_EQ(src[src_offset + i], dst[dst_offset + i])
+                    << name << " length " << length << " src_offset "
+                    << src_offset << " dst_offset " << dst_offset
+                    << " mismatch at " << i;
+        }
+        for (size_t i = dst_offset + length; i < dst.size(); ++i) {
+            ASSERT_EQ((uint8_t)guard_value, dst[i])
+                    << name << " length " << length << " overwrote byte " << i;
+        }
+    }
+
+    void test_func(ucs_memcpy_func_t func, const std::string &name) {
+        static const size_t lengths[] = { 0, 1, 31, 64, 127, 255, 256, 1000,
+                                          4096, 4099, 65536 + 17 };
+        static const size_t offsets[] = { 0, 1, 13, 32 };
+
+        for (size_t i = 0; i < ucs_static_array_size(lengths); ++i) {
+            for (size_t s = 0; s < ucs_static_array_size(offsets); ++s) {
+                for (size_t d = 0; d < ucs_static_array_size(offsets); ++d) {
+                    test_copy(func, name, lengths[i], offsets[s], offsets[d]);
+                }
+            }
+        }
+    }
+
+    static void memcpy_bulk(void *dst, const void *src, size_t length) {
+        ucs_memcpy_bulk(dst, src, length);
+    }
+};
+
+UCS_TEST_F(test_memcpy, kernels) {
+    const ucs_memcpy_kernel_t *kernels;
+    unsigned count;
+
+    kernels = ucs_memcpy_kernels(&count);
+    ASSERT_GT(count, 0u);
+
+    for (unsigned i = 0; i < count; ++i) {
+        if (!ucs_memcpy_kernel_is_supported(&kernels[i])) {
+            UCS_TEST_MESSAGE << kernels[i].name << ": not supported";
+            continue;
+        }
+
+        UCS_TEST_MESSAGE << kernels[i].name
+                         << (kernels[i].nontemporal ? " (non-temporal)" : "");
+        test_func(kernels[i].func, kernels[i].name);
+    }
+}
+
+UCS_TEST_F(test_memcpy, bulk) {
+    const ucs_memcpy_kernel_t *temporal    = ucs_memcpy_selected(0);
+    const ucs_memcpy_kernel_t *nontemporal = ucs_memcpy_selected(1);
+
+    ASSERT_TRUE(temporal != NULL);
+    ASSERT_TRUE(nontemporal != NULL);
+    EXPECT_FALSE(temporal->nontemporal);
+    EXPECT_TRUE(ucs_memcpy_kernel_is_supported(temporal));
+    EXPECT_TRUE(ucs_memcpy_kernel_is_supported(nontemporal));
+    EXPECT_GE(ucs_memcpy_dispatch.nt_thresh, (size_t)UCS_MEMCPY_BULK_MIN_LEN);
+
+    UCS_TEST_MESSAGE << "selected " << temporal->name << ", non-temporal "
+                     << nontemporal->name << " from "
+                     << ucs_memcpy_dispatch.nt_thresh << " bytes";
+
+    test_func(memcpy_bulk, "bulk");
+    if (ucs_memcpy_dispatch.nt_thresh < (64 * UCS_MBYTE)) {
+        test_copy(memcpy_bulk, "bulk", ucs_memcpy_dispatch.nt_thresh + 33,
+                  1, 3);
+    }
+}
+
+UCS_TEST_F(test_memcpy, kernel_names) {
+    const ucs_memcpy_kernel_t *kernels;
+    unsigned count;
+
+    /* every kernel name is unique, since it's used for configuration */
+    kernels = ucs_memcpy_kernels(&count);
+    for (unsigned i = 0; i < count; ++i) {
+        for (unsigned j = i + 1; j < count; ++j) {
+            EXPECT_STRNE(kernels[i].name, kernels[j].name);
+        }
+    }
+
+    EXPECT_STREQ("libc", kernels[0].name);
+    EXPECT_TRUE(ucs_memcpy_kernel_is_supported(&kernels[0]));
+}
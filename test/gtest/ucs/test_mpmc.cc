@@ -9,6 +9,7 @@
 extern "C" {
 #include <ucs/datastruct/mpmc.h>
 }
+#include <ucs/time/time.h>
 #include <pthread.h>
 
 
@@ -17,6 +18,7 @@ protected:
     static const unsigned MPMC_SIZE = 100;
     static const uint64_t SENTINEL  = 0x7fffffffu;
     static const unsigned NUM_THREADS = 4;
+    static const unsigned BATCH_SIZE  = 8;
 
 
     static long elem_count() {
@@ -41,6 +43,48 @@ protected:
         return NULL;
     }
 
+    static void * batch_producer_thread_func(void *arg) {
+        ucs_mpmc_queue_t *mpmc = reinterpret_cast<ucs_mpmc_queue_t*>(arg);
+        long count = elem_count();
+        uint64_t values[BATCH_SIZE];
+        unsigned i, n, pushed;
+
+        for (i = 0; i < count; i += n) {
+            n = ucs_min(BATCH_SIZE, count - i);
+            for (unsigned j = 0; j < n; ++j) {
+                values[j] = i + j;
+            }
+            for (pushed = 0; pushed < n; ) {
+                pushed += ucs_mpmc_queue_push_batch(mpmc, values + pushed,
+                                                    n - pushed);
+            }
+        }
+        while (ucs_mpmc_queue_push(mpmc, SENTINEL) == UCS_ERR_EXCEEDS_LIMIT);
+        return NULL;
+    }
+
+    static void * batch_consumer_thread_func(void *arg) {
+        ucs_mpmc_queue_t *mpmc = reinterpret_cast<ucs_mpmc_queue_t*>(arg);
+        uint64_t values[BATCH_SIZE];
+        size_t count = 0;
+        unsigned n;
+
+        for (;;) {
+            n = ucs_mpmc_queue_pull_batch(mpmc, values, BATCH_SIZE);
+            for (unsigned i = 0; i < n; ++i) {
+                if (values[i] == SENTINEL) {
+                    /* Return the rest of the batch to other consumers */
+                    for (unsigned j = i + 1; j < n; ++j) {
+                        while (ucs_mpmc_queue_push(mpmc, values[j]) ==
+                               UCS_ERR_EXCEEDS_LIMIT);
+                    }
+                    return (void*)(uintptr_t)count;
+                }
+                ++count;
+            }
+        }
+    }
+
     static void * consumer_thread_func(void *arg) {
         ucs_mpmc_queue_t *mpmc = reinterpret_cast<ucs_mpmc_queue_t*>(arg);
         ucs_status_t status;
@@ -59,6 +103,35 @@ protected:
         return (void*)((uintptr_t)count - 1); /* return count except sentinel */
     }
 
+    void test_multi_threaded(void* (*producer)(void*),
+                             void* (*consumer)(void*)) {
+        pthread_t producers[NUM_THREADS];
+        pthread_t consumers[NUM_THREADS];
+
+        ucs_mpmc_queue_t mpmc;
+        ucs_status_t status;
+        size_t total;
+        void *retval;
+
+        status = ucs_mpmc_queue_init(&mpmc, MPMC_SIZE);
+        ASSERT_UCS_OK(status);
+
+        for (unsigned i = 0; i < NUM_THREADS; ++i) {
+            pthread_create(&producers[i], NULL, producer, &mpmc);
+            pthread_create(&consumers[i], NULL, consumer, &mpmc);
+        }
+
+        total = 0;
+        for (unsigned i = 0; i < NUM_THREADS; ++i) {
+            pthread_join(producers[i], &retval);
+            pthread_join(consumers[i], &retval);
+            total += (uintptr_t)retval;
+        }
+
+        EXPECT_EQ(NUM_THREADS * elem_count(), (long)total);
+        EXPECT_TRUE(ucs_mpmc_queue_is_empty(&mpmc));
+        ucs_mpmc_queue_cleanup(&mpmc);
+    }
 };
 
 UCS_TEST_F(test_mpmc, basic) {
@@ -101,31 +174,145 @@ UCS_TEST_F(test_mpmc, basic) {
 }
 
 
-UCS_TEST_F(test_mpmc, multi_threaded) {
-    pthread_t producers[NUM_THREADS];
-    pthread_t consumers[NUM_THREADS];
+UCS_TEST_F(test_mpmc, full_values) {
+    uint64_t values[] = { UINT64_MAX, UCS_BIT(63), (uintptr_t)this, 0 };
+    ucs_mpmc_queue_t mpmc;
+    ucs_status_t status;
+    uint64_t value, expected;
 
+    status = ucs_mpmc_queue_init(&mpmc, MPMC_SIZE);
+    ASSERT_UCS_OK(status);
+
+    /* Go over the queue several times to check wrap-around */
+    for (unsigned i = 0; i < 3 * MPMC_SIZE; ++i) {
+        expected = values[i % ucs_static_array_size(values)];
+        status   = ucs_mpmc_queue_push(&mpmc, expected);
+        ASSERT_UCS_OK(status);
+
+        status = ucs_mpmc_queue_pull(&mpmc, &value);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(expected, value);
+    }
+
+    EXPECT_TRUE(ucs_mpmc_queue_is_empty(&mpmc));
+    ucs_mpmc_queue_cleanup(&mpmc);
+}
+
+UCS_TEST_F(test_mpmc, batch) {
+    std::vector<uint64_t> values(2 * MPMC_SIZE), result(2 * MPMC_SIZE);
     ucs_mpmc_queue_t mpmc;
     ucs_status_t status;
-    size_t total;
-    void *retval;
+    unsigned count;
 
     status = ucs_mpmc_queue_init(&mpmc, MPMC_SIZE);
     ASSERT_UCS_OK(status);
 
-    for (unsigned i = 0; i < NUM_THREADS; ++i) {
-        pthread_create(&producers[i], NULL, producer_thread_func, &mpmc);
-        pthread_create(&consumers[i], NULL, consumer_thread_func, &mpmc);
+    for (unsigned i = 0; i < values.size(); ++i) {
+        values[i] = (uint64_t)-1 - i;
     }
 
-    total = 0;
-    for (unsigned i = 0; i < NUM_THREADS; ++i) {
-        pthread_join(producers[i], &retval);
-        pthread_join(consumers[i], &retval);
-        total += (uintptr_t)retval;
+    /* The batch is truncated when the queue becomes full */
+    count = ucs_mpmc_queue_push_batch(&mpmc, &values[0], values.size());
+    EXPECT_EQ(mpmc.length, count);
+    EXPECT_EQ(0u, ucs_mpmc_queue_push_batch(&mpmc, &values[count], 1));
+
+    count = ucs_mpmc_queue_pull_batch(&mpmc, &result[0], 3);
+    EXPECT_EQ(3u, count);
+
+    count = ucs_mpmc_queue_pull_batch(&mpmc, &result[3], result.size());
+    EXPECT_EQ(mpmc.length - 3, count);
+    EXPECT_EQ(0u, ucs_mpmc_queue_pull_batch(&mpmc, &result[0], 1));
+
+    for (unsigned i = 0; i < mpmc.length; ++i) {
+        EXPECT_EQ(values[i], result[i]) << "index " << i;
     }
 
-    EXPECT_EQ(NUM_THREADS * elem_count(), (long)total);
     EXPECT_TRUE(ucs_mpmc_queue_is_empty(&mpmc));
     ucs_mpmc_queue_cleanup(&mpmc);
 }
+
+UCS_TEST_F(test_mpmc, multi_threaded) {
+    test_multi_threaded(producer_thread_func, consumer_thread_func);
+}
+
+UCS_TEST_F(test_mpmc, multi_threaded_batch) {
+    test_multi_threaded(batch_producer_thread_func,
+                        batch_consumer_thread_func);
+}
+
+
+class test_mpmc_perf : public ucs::test {
+protected:
+    static const unsigned MPMC_SIZE = 1024;
+    static const unsigned NUM_OPS   = 200000;
+
+    struct thread_arg {
+        ucs_mpmc_queue_t *mpmc;
+        unsigned         batch;
+    };
+
+    /* Every thread pushes and pulls the same number of elements, so the
+     * queue never overflows */
+    static void *thread_func(void *arg) {
+        thread_arg *targ = reinterpret_cast<thread_arg*>(arg);
+        uint64_t values[16];
+        unsigned i, n;
+
+        for (i = 0; i < targ->batch; ++i) {
+            values[i] = (uintptr_t)targ + i;
+        }
+
+        for (i = 0; i < NUM_OPS; i += targ->batch) {
+            n = 0;
+            while (n < targ->batch) {
+                n += ucs_mpmc_queue_push_batch(targ->mpmc, values + n,
+                                               targ->batch - n);
+            }
+
+            n = 0;
+            while (n < targ->batch) {
+                n += ucs_mpmc_queue_pull_batch(targ->mpmc, values + n,
+                                               targ->batch - n);
+            }
+        }
+
+        return NULL;
+    }
+
+    /* Sets total number of push+pull operations per second */
+    void measure(unsigned num_threads, unsigned batch, double &rate) {
+        std::vector<pthread_t> threads(num_threads);
+        thread_arg targ;
+        ucs_mpmc_queue_t mpmc;
+
+        ASSERT_UCS_OK(ucs_mpmc_queue_init(&mpmc, MPMC_SIZE));
+        targ.mpmc  = &mpmc;
+        targ.batch = batch;
+
+        ucs_time_t start = ucs_get_time();
+        for (unsigned i = 0; i < num_threads; ++i) {
+            pthread_create(&threads[i], NULL, thread_func, &targ);
+        }
+        for (unsigned i = 0; i < num_threads; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        double elapsed = ucs_time_to_sec(ucs_get_time() - start);
+
+        EXPECT_TRUE(ucs_mpmc_queue_is_empty(&mpmc));
+        ucs_mpmc_queue_cleanup(&mpmc);
+        rate = (2.0 * num_threads * NUM_OPS) / elapsed;
+    }
+};
+
+UCS_TEST_SKIP_COND_F(test_mpmc_perf, scaling,
+                     (ucs::test_time_multiplier() != 1)) {
+    for (unsigned num_threads = 1; num_threads <= 8; num_threads *= 2) {
+        double rate, batch_rate;
+
+        measure(num_threads, 1, rate);
+        measure(num_threads, 16, batch_rate);
+        UCS_TEST_MESSAGE << num_threads << " threads: "
+                         << (rate / 1e6) << " M ops/sec, batch of 16: "
+                         << (batch_rate / 1e6) << " M ops/sec";
+    }
+}
@@ -7,6 +7,7 @@
 #include <common/test.h>
 extern "C" {
 #include <ucs/datastruct/mpool.h>
+#include <ucs/memory/numa.h>
 }
 
 #include <limits.h>
@@ -203,3 +204,113 @@ UCS_TEST_F(test_mpool, infinite) {
 
     ucs_mpool_cleanup(&mp, 1);
 }
+
+UCS_TEST_F(test_mpool, release_idle) {
+    const unsigned NUM_ELEMS = 100;
+    ucs_status_t status;
+    size_t chunks_size;
+    ucs_mpool_t mp;
+
+    ucs_mpool_ops_t ops = {
+       ucs_mpool_chunk_malloc,
+       ucs_mpool_chunk_free,
+       NULL,
+       NULL
+    };
+
+    status = ucs_mpool_init(&mp, 0, header_size + data_size, header_size, align,
+                            10, NUM_ELEMS, &ops, "test");
+    ASSERT_UCS_OK(status);
+
+    std::vector<void*> objs;
+    for (unsigned i = 0; i < NUM_ELEMS; ++i) {
+        void *obj = ucs_mpool_get(&mp);
+        ASSERT_TRUE(obj != NULL);
+        objs.push_back(obj);
+    }
+    EXPECT_TRUE(ucs_mpool_is_empty(&mp));
+
+    chunks_size = ucs_mpool_chunks_size(&mp);
+    EXPECT_EQ(chunks_size, mp.data->backing_size[UCS_MPOOL_CHUNK_BACKING_HEAP]);
+
+    /* all chunks are in use */
+    EXPECT_EQ(0u, ucs_mpool_release_idle(&mp));
+
+    /* keep only the first object, the other chunks become idle */
+    for (unsigned i = 1; i < NUM_ELEMS; ++i) {
+        ucs_mpool_put(objs[i]);
+    }
+    objs.resize(1);
+
+    EXPECT_GT(ucs_mpool_release_idle(&mp), 0u);
+    EXPECT_LT(ucs_mpool_chunks_size(&mp), chunks_size);
+    EXPECT_GT(ucs_mpool_chunks_size(&mp), 0u);
+    EXPECT_EQ(0u, ucs_mpool_release_idle(&mp));
+
+    /* the pool can grow up to its limit again */
+    for (unsigned i = 1; i < NUM_ELEMS; ++i) {
+        void *obj = ucs_mpool_get(&mp);
+        ASSERT_TRUE(obj != NULL);
+        objs.push_back(obj);
+    }
+    EXPECT_TRUE(ucs_mpool_is_empty(&mp));
+
+    for (unsigned i = 0; i < NUM_ELEMS; ++i) {
+        ucs_mpool_put(objs[i]);
+    }
+
+    EXPECT_GT(ucs_mpool_release_idle(&mp), 0u);
+    EXPECT_EQ(0u, ucs_mpool_chunks_size(&mp));
+
+    void *obj = ucs_mpool_get(&mp);
+    EXPECT_TRUE(obj != NULL);
+    ucs_mpool_put(obj);
+
+    ucs_mpool_cleanup(&mp, 1);
+}
+
+UCS_TEST_F(test_mpool, numa_node) {
+    const unsigned NUM_ELEMS = 1000;
+    int node                 = ucs_numa_current_node();
+    ucs_status_t status;
+    ucs_mpool_t mp;
+
+    ucs_mpool_ops_t ops = {
+       ucs_mpool_hugetlb_malloc,
+       ucs_mpool_hugetlb_free,
+       NULL,
+       NULL
+    };
+
+    if (node < 0) {
+        UCS_TEST_SKIP_R("NUMA is not supported");
+    }
+
+    status = ucs_mpool_init(&mp, 0, header_size + data_size, header_size, align,
+                            100, UINT_MAX, &ops, "test");
+    ASSERT_UCS_OK(status);
+
+    ucs_mpool_set_numa_node(&mp, UCS_NUMA_POLICY_PREFERRED, node);
+    EXPECT_EQ(node, mp.data->numa_node);
+
+    std::vector<void*> objs;
+    for (unsigned i = 0; i < NUM_ELEMS; ++i) {
+        void *obj = ucs_mpool_get(&mp);
+        ASSERT_TRUE(obj != NULL);
+        memset(obj, 0, data_size);
+        objs.push_back(obj);
+    }
+
+    /* bound chunks are not allocated from the heap */
+    EXPECT_GT(ucs_mpool_chunks_size(&mp), 0u);
+    EXPECT_EQ(0u, mp.data->backing_size[UCS_MPOOL_CHUNK_BACKING_HEAP]);
+
+    for (unsigned i = 0; i < NUM_ELEMS; ++i) {
+        ucs_mpool_put(objs[i]);
+    }
+
+    EXPECT_GT(ucs_mpool_release_idle(&mp), 0u);
+    EXPECT_EQ(0u, ucs_mpool_chunks_size(&mp));
+
+    ucs_mpool_cleanup(&mp, 1);
+}
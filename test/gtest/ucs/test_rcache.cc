@@ -32,7 +32,9 @@ UCS_TEST_F(test_rcache_basic, create_fail) {
         1000,
         &ops,
         NULL,
-        0
+        0,
+        ULONG_MAX,
+        SIZE_MAX
     };
 
     ucs_rcache_t *rcache;
@@ -57,8 +59,7 @@ protected:
     test_rcache() : m_reg_count(0), m_ptr(NULL) {
     }
 
-    virtual void init() {
-        ucs::test::init();
+    virtual ucs_rcache_params_t rcache_params() {
         static const ucs_rcache_ops_t ops = {
             mem_reg_cb,
             mem_dereg_cb,
@@ -72,8 +73,16 @@ protected:
             1000,
             &ops,
             reinterpret_cast<void*>(this),
-            0
+            0,
+            ULONG_MAX,
+            SIZE_MAX
         };
+        return params;
+    }
+
+    virtual void init() {
+        ucs::test::init();
+        ucs_rcache_params_t params = rcache_params();
         UCS_TEST_CREATE_HANDLE_IF_SUPPORTED(ucs_rcache_t*, m_rcache, ucs_rcache_destroy,
                                             ucs_rcache_create, &params, "test", ucs_stats_get_root());
     }
@@ -640,6 +649,182 @@ UCS_MT_TEST_F(test_rcache_no_register, merge_invalid_prot_slow, 5)
     munmap(mem, size1+size2);
 }
 
+class test_rcache_with_limit : public test_rcache {
+protected:
+    virtual ucs_rcache_params_t rcache_params()
+    {
+        ucs_rcache_params_t params = test_rcache::rcache_params();
+        params.max_regions         = 2;
+        params.max_size            = 4 * ucs_get_page_size();
+        params.alignment           = ucs_get_page_size();
+        return params;
+    }
+};
+
+UCS_TEST_F(test_rcache_with_limit, by_count) {
+    static const size_t size = ucs_get_page_size();
+    void *mem = alloc_pages(4 * size, PROT_READ|PROT_WRITE);
+    void *ptr[4];
+    region *r[4];
+
+    for (int i = 0; i < 4; ++i) {
+        ptr[i] = UCS_PTR_BYTE_OFFSET(mem, i * size);
+    }
+
+    /* Regions in use are never evicted */
+    for (int i = 0; i < 3; ++i) {
+        r[i] = get(ptr[i], size);
+    }
+    EXPECT_EQ(3u, m_reg_count);
+    EXPECT_EQ(3ul, m_rcache->num_regions);
+
+    for (int i = 0; i < 3; ++i) {
+        put(r[i]);
+    }
+    EXPECT_EQ(3ul, m_rcache->lru.count);
+
+    /* Registering a new region evicts the least recently released ones */
+    r[3] = get(ptr[3], size);
+    EXPECT_EQ(2u, m_reg_count);
+    EXPECT_EQ(2ul, m_rcache->num_regions);
+    put(r[3]);
+
+    r[2] = get(ptr[2], size);
+    EXPECT_EQ(2u, m_reg_count);
+    put(r[2]);
+
+    munmap(mem, 4 * size);
+}
+
+UCS_TEST_F(test_rcache_with_limit, by_size) {
+    static const size_t size = 3 * ucs_get_page_size();
+    void *mem1 = alloc_pages(size, PROT_READ|PROT_WRITE);
+    void *mem2 = alloc_pages(size, PROT_READ|PROT_WRITE);
+    region *r1, *r2;
+
+    r1 = get(mem1, size);
+    put(r1);
+    EXPECT_EQ(1u, m_reg_count);
+
+    r2 = get(mem2, size);
+    EXPECT_EQ(1u, m_reg_count);
+    EXPECT_EQ(size, m_rcache->total_size);
+
+    /* r2 is in use, so it cannot be evicted even if over the limit */
+    r1 = get(mem1, size);
+    EXPECT_EQ(2u, m_reg_count);
+    EXPECT_EQ(2 * size, m_rcache->total_size);
+
+    put(r1);
+    put(r2);
+
+    munmap(mem1, size);
+    munmap(mem2, size);
+}
+
+UCS_TEST_F(test_rcache_with_limit, lru_order) {
+    static const size_t size = ucs_get_page_size();
+    void *mem = alloc_pages(3 * size, PROT_READ|PROT_WRITE);
+    void *ptr1 = mem;
+    void *ptr2 = UCS_PTR_BYTE_OFFSET(mem, size);
+    void *ptr3 = UCS_PTR_BYTE_OFFSET(mem, 2 * size);
+    region *r1, *r2, *r3;
+    uint32_t id1, id2;
+
+    r1 = get(ptr1, size);
+    id1 = r1->id;
+    put(r1);
+
+    r2 = get(ptr2, size);
+    id2 = r2->id;
+    put(r2);
+
+    /* Use r1 again, so r2 becomes the least recently used */
+    r1 = get(ptr1, size);
+    EXPECT_EQ(id1, r1->id);
+    put(r1);
+
+    r3 = get(ptr3, size);
+    put(r3);
+    EXPECT_EQ(2u, m_reg_count);
+
+    r1 = get(ptr1, size);
+    EXPECT_EQ(id1, r1->id);
+    put(r1);
+
+    r2 = get(ptr2, size);
+    EXPECT_NE(id2, r2->id);
+    put(r2);
+
+    munmap(mem, 3 * size);
+}
+
+class test_rcache_perf : public test_rcache {
+protected:
+    struct thread_arg {
+        test_rcache_perf *test;
+        void             *ptr;
+        size_t           size;
+        unsigned         num_iters;
+    };
+
+    static void* get_put_thread_func(void *arg)
+    {
+        thread_arg *targ = reinterpret_cast<thread_arg*>(arg);
+
+        for (unsigned i = 0; i < targ->num_iters; ++i) {
+            targ->test->put(targ->test->get(targ->ptr, targ->size));
+        }
+        return NULL;
+    }
+
+    /* Run get/put pairs which hit the cache from several threads, each thread
+     * using its own buffer, and return total number of operations per second */
+    double measure_hits(unsigned num_threads, unsigned num_iters)
+    {
+        static const size_t size = ucs_get_page_size();
+        std::vector<thread_arg> args(num_threads);
+        std::vector<pthread_t> threads(num_threads);
+        void *mem = alloc_pages(num_threads * size, PROT_READ|PROT_WRITE);
+
+        for (unsigned i = 0; i < num_threads; ++i) {
+            args[i].test      = this;
+            args[i].ptr       = UCS_PTR_BYTE_OFFSET(mem, i * size);
+            args[i].size      = size;
+            args[i].num_iters = num_iters;
+            /* register in advance, so the measured loop has only hits */
+            put(get(args[i].ptr, size));
+        }
+
+        unsigned reg_count = m_reg_count;
+        ucs_time_t start   = ucs_get_time();
+        for (unsigned i = 0; i < num_threads; ++i) {
+            int ret = pthread_create(&threads[i], NULL, get_put_thread_func,
+                                     &args[i]);
+            EXPECT_EQ(0, ret) << strerror(ret);
+        }
+        for (unsigned i = 0; i < num_threads; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        double elapsed = ucs_time_to_sec(ucs_get_time() - start);
+
+        EXPECT_EQ(reg_count, m_reg_count);
+        munmap(mem, num_threads * size);
+        return (num_threads * num_iters) / elapsed;
+    }
+};
+
+UCS_TEST_SKIP_COND_F(test_rcache_perf, get_hit_mt,
+                     (ucs::test_time_multiplier() != 1)) {
+    static const unsigned num_iters = 200000;
+
+    for (unsigned num_threads = 1; num_threads <= 8; num_threads *= 2) {
+        double rate = measure_hits(num_threads, num_iters);
+        UCS_TEST_MESSAGE << num_threads << " threads: "
+                         << (rate / 1e6) << " M hits/sec";
+    }
+}
+
 #ifdef ENABLE_STATS
 class test_rcache_stats : public test_rcache {
 protected:
@@ -668,7 +853,7 @@ protected:
     /* a helper function for stats tests debugging */
     void dump_stats() {
         printf("gets %d hf %d hs %d misses %d merges %d unmaps %d"
-               " unmaps_inv %d puts %d regs %d deregs %d\n",
+               " unmaps_inv %d puts %d regs %d deregs %d evicts %d\n",
                get_counter(UCS_RCACHE_GETS),
                get_counter(UCS_RCACHE_HITS_FAST),
                get_counter(UCS_RCACHE_HITS_SLOW),
@@ -678,7 +863,8 @@ protected:
                get_counter(UCS_RCACHE_UNMAP_INVALIDATES),
                get_counter(UCS_RCACHE_PUTS),
                get_counter(UCS_RCACHE_REGS),
-               get_counter(UCS_RCACHE_DEREGS));
+               get_counter(UCS_RCACHE_DEREGS),
+               get_counter(UCS_RCACHE_EVICTS));
     }
 };
 
@@ -830,6 +1016,82 @@ UCS_TEST_F(test_rcache_stats, hits_slow) {
     put(r2);
     munmap(mem2, size1);
 }
+
+UCS_TEST_F(test_rcache_stats, unmap_coalesce) {
+    static const size_t num_pages = 16;
+    size_t page_size              = ucs_get_page_size();
+    void *mem = alloc_pages(num_pages * page_size, PROT_READ|PROT_WRITE);
+    region *r1;
+
+    r1 = get(mem, num_pages * page_size);
+    put(r1);
+
+    /* unmap the region page by page under lock, the adjacent pending ranges
+     * should be merged into a single queue entry */
+    pthread_rwlock_wrlock(&m_rcache->pgt_lock);
+    for (size_t i = 0; i < num_pages; ++i) {
+        munmap(UCS_PTR_BYTE_OFFSET(mem, i * page_size), page_size);
+    }
+    pthread_rwlock_unlock(&m_rcache->pgt_lock);
+
+    EXPECT_GE(get_counter(UCS_RCACHE_UNMAPS), (int)num_pages);
+    EXPECT_GE(get_counter(UCS_RCACHE_INV_COALESCED), (int)num_pages - 1);
+    EXPECT_EQ(1, get_counter(UCS_RCACHE_INV_QUEUE_MAX));
+    EXPECT_EQ(0, get_counter(UCS_RCACHE_UNMAP_INVALIDATES));
+
+    /* the next rcache operation should invalidate the region once */
+    mem = alloc_pages(page_size, PROT_READ|PROT_WRITE);
+    r1  = get(mem, page_size);
+    EXPECT_EQ(1, get_counter(UCS_RCACHE_UNMAP_INVALIDATES));
+    EXPECT_EQ(1, get_counter(UCS_RCACHE_DEREGS));
+
+    put(r1);
+    munmap(mem, page_size);
+}
+
+UCS_TEST_F(test_rcache_stats, unmap_async_drain, "RCACHE_INV_DRAIN_THRESH=4") {
+    static const size_t num_regions = 4;
+    size_t page_size                = ucs_get_page_size();
+    void *mem = alloc_pages(2 * num_regions * page_size,
+                            PROT_READ|PROT_WRITE);
+    region *r1;
+
+    if (m_rcache->inv_drain_fd == -1) {
+        munmap(mem, 2 * num_regions * page_size);
+        UCS_TEST_SKIP_R("async drain is not supported");
+    }
+
+    /* create regions which are not adjacent to each other */
+    for (size_t i = 0; i < num_regions; ++i) {
+        r1 = get(UCS_PTR_BYTE_OFFSET(mem, 2 * i * page_size), page_size);
+        put(r1);
+    }
+
+    /* unmap them under lock, so every range is queued separately */
+    pthread_rwlock_wrlock(&m_rcache->pgt_lock);
+    for (size_t i = 0; i < num_regions; ++i) {
+        munmap(UCS_PTR_BYTE_OFFSET(mem, 2 * i * page_size), page_size);
+    }
+    pthread_rwlock_unlock(&m_rcache->pgt_lock);
+
+    EXPECT_GE(get_counter(UCS_RCACHE_INV_QUEUE_MAX), (int)num_regions);
+
+    /* the async thread should invalidate the regions without any further
+     * rcache operation */
+    ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+    while ((get_counter(UCS_RCACHE_DEREGS) < (int)num_regions) &&
+           (ucs_get_time() < deadline)) {
+        usleep(1000);
+    }
+
+    EXPECT_EQ((int)num_regions, get_counter(UCS_RCACHE_UNMAP_INVALIDATES));
+    EXPECT_EQ((int)num_regions, get_counter(UCS_RCACHE_DEREGS));
+    EXPECT_GE(get_counter(UCS_RCACHE_INV_DRAINS_ASYNC), 1);
+
+    for (size_t i = 0; i < num_regions; ++i) {
+        munmap(UCS_PTR_BYTE_OFFSET(mem, (2 * i + 1) * page_size), page_size);
+    }
+}
 #endif
 
 
@@ -7,10 +7,14 @@
 #include <common/test.h>
 extern "C" {
 #include <ucs/stats/stats.h>
+#include <ucs/stats/stats_shm.h>
 }
 
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <netinet/in.h>
+#include <fcntl.h>
 
 #ifdef ENABLE_STATS
 #define NUM_DATA_NODES 20
@@ -40,6 +44,7 @@ public:
         push_config();
         modify_config("STATS_DEST",    stats_dest_config().c_str());
         modify_config("STATS_TRIGGER", stats_trigger_config().c_str());
+        modify_config("STATS_SHM",     stats_shm_config().c_str());
         ucs_stats_init();
         ASSERT_TRUE(ucs_stats_is_active());
     }
@@ -54,6 +59,10 @@ public:
     virtual std::string stats_dest_config()    = 0;
     virtual std::string stats_trigger_config() = 0;
 
+    virtual std::string stats_shm_config() {
+        return "n";
+    }
+
     void prepare_nodes(ucs_stats_node_t **cat_node,
                        ucs_stats_node_t *data_nodes[NUM_DATA_NODES]) {
         static ucs_stats_class_t category_stats_class = {
@@ -105,10 +114,10 @@ public:
             EXPECT_EQ(unsigned(NUM_COUNTERS),  data_node->cls->num_counters);
             EXPECT_EQ(std::string("counter0"), std::string(data_node->cls->counter_names[0]));
 
-            EXPECT_EQ((unsigned)10, data_node->counters[0]);
-            EXPECT_EQ((unsigned)20, data_node->counters[1]);
-            EXPECT_EQ((unsigned)30, data_node->counters[2]);
-            EXPECT_EQ((unsigned)40, data_node->counters[3]);
+            EXPECT_EQ((unsigned)10, UCS_STATS_GET_COUNTER(data_node, 0));
+            EXPECT_EQ((unsigned)20, UCS_STATS_GET_COUNTER(data_node, 1));
+            EXPECT_EQ((unsigned)30, UCS_STATS_GET_COUNTER(data_node, 2));
+            EXPECT_EQ((unsigned)40, UCS_STATS_GET_COUNTER(data_node, 3));
         }
     }
 
@@ -253,6 +262,108 @@ public:
     }
 };
 
+class stats_shm_test : public stats_test {
+public:
+    stats_shm_test() : m_node(NULL), m_hdr(NULL), m_size(0) {
+    }
+
+    virtual void init() {
+        stats_test::init();
+        ucs_status_t status = UCS_STATS_NODE_ALLOC(&m_node, m_data_stats_class,
+                                                   ucs_stats_get_root(), "-shm");
+        ASSERT_UCS_OK(status);
+        map_region();
+    }
+
+    virtual void cleanup() {
+        if (m_hdr != NULL) {
+            munmap((void*)m_hdr, m_size);
+        }
+        UCS_STATS_NODE_FREE(m_node);
+        stats_test::cleanup();
+    }
+
+    virtual std::string stats_dest_config() {
+        return "";
+    }
+
+    virtual std::string stats_trigger_config() {
+        return "";
+    }
+
+    virtual std::string stats_shm_config() {
+        return "y";
+    }
+
+    void map_region() {
+        std::string name = "/ucx_stats_" + ucs::to_string(getpid());
+        struct stat st;
+
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        ASSERT_GE(fd, 0) << name << ": " << strerror(errno);
+        ASSERT_EQ(0, fstat(fd, &st));
+        m_size = st.st_size;
+
+        void *ptr = mmap(NULL, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        ASSERT_NE(MAP_FAILED, ptr);
+
+        m_hdr = (const ucs_stats_shm_header_t*)ptr;
+        EXPECT_EQ(UCS_STATS_SHM_MAGIC,        m_hdr->magic);
+        EXPECT_EQ(UCS_STATS_SHM_VERSION,      (int)m_hdr->version);
+        EXPECT_EQ((uint32_t)getpid(),         m_hdr->pid);
+        EXPECT_EQ(m_size,                     m_hdr->size);
+        EXPECT_EQ(0ul,                        m_hdr->generation % 2);
+    }
+
+    int find_node(const std::string &cls_name, const std::string &name) {
+        const ucs_stats_shm_node_t *nodes = ucs_stats_shm_nodes(m_hdr);
+
+        for (uint32_t i = 0; i < m_hdr->num_nodes; ++i) {
+            if ((nodes[i].state != UCS_STATS_SHM_NODE_FREE) &&
+                (cls_name == nodes[i].cls_name) && (name == nodes[i].name)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    ucs_stats_counter_t shm_counter(int index, unsigned counter) {
+        const ucs_stats_shm_node_t *node = &ucs_stats_shm_nodes(m_hdr)[index];
+        ucs_stats_counter_t value        = 0;
+
+        for (unsigned shard = 0; shard < m_hdr->num_shards; ++shard) {
+            value += ucs_stats_shm_shard(m_hdr, shard)[node->first_counter +
+                                                       counter];
+        }
+        return value;
+    }
+
+    void check_shm_nodes(int cat_index) {
+        const ucs_stats_shm_node_t *nodes = ucs_stats_shm_nodes(m_hdr);
+        const ucs_stats_shm_counter_name_t *names =
+                        ucs_stats_shm_counter_names(m_hdr);
+
+        for (unsigned i = 0; i < NUM_DATA_NODES; ++i) {
+            int index = find_node("data", "-" + ucs::to_string(i));
+            ASSERT_GE(index, 0) << "data-" << i;
+            EXPECT_EQ((uint32_t)cat_index, nodes[index].parent);
+            EXPECT_EQ((uint32_t)NUM_COUNTERS, nodes[index].num_counters);
+
+            for (unsigned j = 0; j < NUM_COUNTERS; ++j) {
+                EXPECT_EQ("counter" + ucs::to_string(j),
+                          std::string(names[nodes[index].first_counter + j]));
+                EXPECT_EQ((j + 1) * 10, shm_counter(index, j));
+            }
+        }
+    }
+
+protected:
+    ucs_stats_node_t             *m_node;
+    const ucs_stats_shm_header_t *m_hdr;
+    size_t                       m_size;
+};
+
 UCS_TEST_F(stats_on_demand_test, null_root) {
     ucs_stats_node_t       *cat_node;
 
@@ -335,4 +446,96 @@ UCS_MT_TEST_F(stats_file_test, mt_add_remove, 10) {
     }
 }
 
+UCS_TEST_F(stats_shm_test, nodes) {
+    ucs_stats_node_t       *cat_node;
+    ucs_stats_node_t       *data_nodes[NUM_DATA_NODES] = {NULL};
+
+    prepare_nodes(&cat_node, data_nodes);
+
+    int cat_index = find_node("category", "");
+    ASSERT_GE(cat_index, 0);
+    uint32_t root_index = ucs_stats_shm_nodes(m_hdr)[cat_index].parent;
+    ASSERT_LT(root_index, m_hdr->num_nodes);
+    EXPECT_EQ(UCS_STATS_SHM_NO_PARENT,
+              ucs_stats_shm_nodes(m_hdr)[root_index].parent);
+    check_shm_nodes(cat_index);
+
+    UCS_STATS_SET_COUNTER(data_nodes[0], 0, 5);
+    EXPECT_EQ(5u, shm_counter(find_node("data", "-0"), 0));
+
+    uint32_t num_nodes = m_hdr->num_nodes;
+    free_nodes(cat_node, data_nodes);
+    EXPECT_EQ(-1, find_node("data", "-0"));
+    EXPECT_EQ(-1, find_node("category", ""));
+
+    /* released entries are reused, with zeroed counters */
+    prepare_nodes(&cat_node, data_nodes);
+    EXPECT_EQ(num_nodes, m_hdr->num_nodes);
+    check_shm_nodes(find_node("category", ""));
+    free_nodes(cat_node, data_nodes);
+}
+
+UCS_TEST_F(stats_shm_test, region_full, "STATS_MAX_COUNTERS=16") {
+    ucs_stats_node_t       *cat_node;
+    ucs_stats_node_t       *data_nodes[NUM_DATA_NODES] = {NULL};
+
+    /* nodes which do not fit are not sharded, but still count */
+    prepare_nodes(&cat_node, data_nodes);
+    EXPECT_EQ(m_hdr->max_nodes, m_hdr->num_nodes);
+    EXPECT_EQ(-1, find_node("data", "-" + ucs::to_string(NUM_DATA_NODES - 1)));
+    free_nodes(cat_node, data_nodes);
+}
+
+UCS_MT_TEST_F(stats_shm_test, mt_update, 8) {
+    static const unsigned count = 10000;
+
+    for (unsigned i = 0; i < count; ++i) {
+        UCS_STATS_UPDATE_COUNTER(m_node, 0, 1);
+        UCS_STATS_UPDATE_COUNTER(m_node, 1, 2);
+    }
+
+    if (barrier()) {
+        int index = find_node("data", "-shm");
+        ASSERT_GE(index, 0);
+        EXPECT_EQ(count * num_threads(),     UCS_STATS_GET_COUNTER(m_node, 0));
+        EXPECT_EQ(count * num_threads() * 2, UCS_STATS_GET_COUNTER(m_node, 1));
+        EXPECT_EQ(count * num_threads(),     shm_counter(index, 0));
+        EXPECT_EQ(count * num_threads() * 2, shm_counter(index, 1));
+    }
+}
+
+UCS_MT_TEST_F(stats_shm_test, mt_set_max, 8) {
+    static const unsigned count = 1000;
+    ucs_stats_counter_t total   = count * num_threads();
+
+    for (unsigned i = 0; i < count; ++i) {
+        UCS_STATS_UPDATE_COUNTER(m_node, 0, 1);
+        UCS_STATS_UPDATE_COUNTER(m_node, 1, 1);
+    }
+
+    /* set and max apply to the value summed over all shards */
+    if (barrier()) {
+        UCS_STATS_SET_COUNTER(m_node, 0, 7);
+        EXPECT_EQ(7u, UCS_STATS_GET_COUNTER(m_node, 0));
+
+        UCS_STATS_UPDATE_MAX(m_node, 1, total - 1);
+        EXPECT_EQ(total, UCS_STATS_GET_COUNTER(m_node, 1));
+        UCS_STATS_UPDATE_MAX(m_node, 1, total + 5);
+        EXPECT_EQ(total + 5, UCS_STATS_GET_COUNTER(m_node, 1));
+    }
+    barrier();
+
+    for (unsigned i = 0; i < count; ++i) {
+        UCS_STATS_UPDATE_COUNTER(m_node, 0, 1);
+    }
+
+    if (barrier()) {
+        int index = find_node("data", "-shm");
+        ASSERT_GE(index, 0);
+        EXPECT_EQ(total + 7, UCS_STATS_GET_COUNTER(m_node, 0));
+        EXPECT_EQ(total + 7, shm_counter(index, 0));
+        EXPECT_EQ(total + 5, shm_counter(index, 1));
+    }
+}
+
 #endif
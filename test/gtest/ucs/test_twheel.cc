@@ -18,6 +18,8 @@ extern "C" {
  */
 class twheel : public ucs::test {
 protected:
+    /* range of timer delays used by the tests, in resolution units */
+    static const int num_slots = 1024;
 
     struct hr_timer {
         ucs_wtimer_t timer;
@@ -101,23 +103,23 @@ void twheel::set_timer_delta(struct hr_timer *t, int how)
         break;
     case 1:
         /* last */
-        slot = m_wheel.num_slots - 1;
+        slot = num_slots - 1;
         break;
     case 2:
         /* middle */
-        slot = m_wheel.num_slots / 2;
+        slot = num_slots / 2;
         break;
     case -2:
         /* overflow */
-        slot = m_wheel.num_slots + (ucs::rand() % 1000000);
+        slot = num_slots + (ucs::rand() % 1000000);
         break;
     default:
-        slot = 1 + ucs::rand() % (m_wheel.num_slots - 2);
+        slot = 1 + ucs::rand() % (num_slots - 2);
         break;
     }
 
     if (how == -2) {
-        t->d = m_wheel.res + m_wheel.res * (m_wheel.num_slots - 1) / 2;
+        t->d = m_wheel.res + m_wheel.res * (num_slots - 1) / 2;
     } else {
         t->d = m_wheel.res + m_wheel.res * slot / 2;
     }
@@ -173,7 +175,7 @@ UCS_TEST_SKIP_COND_F(twheel, precision_multi, true) {
     do {
         now = ucs_get_time();
         ucs_twheel_sweep(&m_wheel, now);
-    } while (now < start + m_wheel.res * m_wheel.num_slots);
+    } while (now < start + m_wheel.res * num_slots);
 
     /* all timers should ve been triggered
      * correct delta
@@ -239,3 +241,250 @@ UCS_TEST_F(twheel, delayed_sweep) {
     }
 }
 
+UCS_TEST_F(twheel, add_to_idle_wheel) {
+    struct hr_timer t;
+    ucs_time_t start;
+
+    init_timer(&t, 0);
+    t.d = m_wheel.res * 100;
+
+    /* users do not sweep an empty wheel, so its time gets stale; a new timer
+     * must still be counted from the time it was added */
+    start = ucs_get_time();
+    while (ucs_get_time() < (start + (t.d * 4)));
+
+    add_timer(&t);
+    ucs_twheel_sweep(&m_wheel, ucs_get_time());
+    EXPECT_EQ((ucs_time_t)0, t.end_time);
+
+    ucs_wtimer_remove(&m_wheel, &t.timer);
+}
+
+
+class twheel_levels : public ucs::test {
+protected:
+    struct test_timer {
+        ucs_wtimer_t  timer;
+        ucs_time_t    deadline;
+        ucs_time_t    expired_time;
+        twheel_levels *self;
+    };
+
+    static const ucs_time_t resolution = 16;
+
+    virtual void init() {
+        ucs::test::init();
+        /* the simulated time is kept ahead of the real clock, since adding a
+         * timer to an empty wheel moves it forward to the real time */
+        m_now = ucs_get_time() + ucs_time_from_sec(3600) + 7;
+        ASSERT_UCS_OK(ucs_twheel_init(&m_wheel, resolution, m_now));
+    }
+
+    virtual void cleanup() {
+        ucs_twheel_cleanup(&m_wheel);
+        ucs::test::cleanup();
+    }
+
+    static void timer_cb(ucs_wtimer_t *self) {
+        test_timer *t = ucs_container_of(self, test_timer, timer);
+        t->expired_time = t->self->m_wheel.now;
+    }
+
+    /* earliest time at which a sweep may have work to do */
+    ucs_time_t next_expiry() const {
+        return m_wheel.next_tick << m_wheel.res_order;
+    }
+
+    void add(test_timer *t, ucs_time_t delta) {
+        ucs_wtimer_init(&t->timer, timer_cb);
+        t->self         = this;
+        t->expired_time = 0;
+        t->deadline     = m_now + delta;
+        ASSERT_UCS_OK(ucs_wtimer_add(&m_wheel, &t->timer, delta));
+    }
+
+    /* advance the time in steps, and check that timers expire after their
+     * deadline and not later than one resolution step after it */
+    void advance(std::vector<test_timer> &timers, ucs_time_t until,
+                 ucs_time_t step) {
+        while (m_now < until) {
+            m_now += step;
+            ucs_twheel_sweep(&m_wheel, m_now);
+            for (size_t i = 0; i < timers.size(); ++i) {
+                if (timers[i].expired_time == 0) {
+                    ASSERT_TRUE(timers[i].timer.is_active);
+                    ASSERT_GT(timers[i].deadline, m_now - resolution)
+                            << "timer " << i << " was not expired";
+                } else {
+                    ASSERT_GE(timers[i].expired_time + resolution,
+                              timers[i].deadline) << "timer " << i;
+                }
+            }
+        }
+    }
+
+public:
+    ucs_twheel_t m_wheel;
+    ucs_time_t   m_now;
+};
+
+UCS_TEST_F(twheel_levels, expire_all_levels) {
+    std::vector<test_timer> timers(200);
+    ucs_time_t max_delta = 0;
+
+    for (size_t i = 0; i < timers.size(); ++i) {
+        /* delays spread over all levels of the wheel */
+        ucs_time_t delta = resolution *
+                           (1 + (ucs::rand() % (1ul << (2 + (i % 22)))));
+        add(&timers[i], delta);
+        max_delta = ucs_max(max_delta, delta);
+    }
+
+    EXPECT_EQ(timers.size(), m_wheel.count);
+    advance(timers, m_now + max_delta + resolution, resolution * 53);
+    EXPECT_TRUE(ucs_twheel_is_empty(&m_wheel));
+    EXPECT_EQ(UINT64_MAX, m_wheel.next_tick);
+}
+
+UCS_TEST_F(twheel_levels, fine_steps) {
+    std::vector<test_timer> timers(64);
+
+    for (size_t i = 0; i < timers.size(); ++i) {
+        add(&timers[i], resolution * (1 + (i * 97)));
+    }
+
+    advance(timers, m_now + resolution * (64 * 97 + 2), resolution / 2);
+    EXPECT_TRUE(ucs_twheel_is_empty(&m_wheel));
+}
+
+UCS_TEST_F(twheel_levels, remove) {
+    std::vector<test_timer> timers(1000);
+
+    for (size_t i = 0; i < timers.size(); ++i) {
+        add(&timers[i], resolution * (1 + ucs::rand() % 100000));
+    }
+
+    for (size_t i = 0; i < timers.size(); i += 2) {
+        ucs_wtimer_remove(&m_wheel, &timers[i].timer);
+        EXPECT_FALSE(timers[i].timer.is_active);
+    }
+    EXPECT_EQ(timers.size() / 2, m_wheel.count);
+
+    ucs_twheel_sweep(&m_wheel, m_now + resolution * 200000);
+    for (size_t i = 0; i < timers.size(); ++i) {
+        EXPECT_EQ((i % 2) != 0, timers[i].expired_time != 0) << i;
+    }
+    EXPECT_TRUE(ucs_twheel_is_empty(&m_wheel));
+}
+
+UCS_TEST_F(twheel_levels, next_expiry) {
+    test_timer t1, t2;
+    ucs_time_t next;
+
+    EXPECT_EQ(UINT64_MAX, m_wheel.next_tick);
+
+    add(&t1, resolution * 10);
+    next = next_expiry();
+    EXPECT_LE(next, t1.deadline);
+    EXPECT_GT(next + resolution, t1.deadline);
+
+    /* a later timer does not change the next expiry */
+    add(&t2, resolution * 100000);
+    EXPECT_EQ(next, next_expiry());
+
+    /* sweeping before the next expiry does nothing */
+    ucs_twheel_sweep(&m_wheel, next - 1);
+    EXPECT_EQ(0u, t1.expired_time);
+    EXPECT_EQ(2u, m_wheel.count);
+
+    ucs_twheel_sweep(&m_wheel, next);
+    EXPECT_NE(0u, t1.expired_time);
+    EXPECT_EQ(1u, m_wheel.count);
+
+    /* the next expiry of a far timer may be an intermediate cascade, but
+     * never later than the deadline */
+    while (t2.expired_time == 0) {
+        next = next_expiry();
+        ASSERT_LE(next, t2.deadline);
+        ucs_twheel_sweep(&m_wheel, next);
+    }
+    EXPECT_EQ(UINT64_MAX, m_wheel.next_tick);
+}
+
+UCS_TEST_F(twheel_levels, add_after_idle) {
+    std::vector<test_timer> timers(1);
+    test_timer far;
+
+    /* sweeping an idle wheel must still move it forward, so the delay of a
+     * new timer is counted from the sweep time and not from the last tick
+     * which had work */
+    m_now += resolution * 1000000;
+    ucs_twheel_sweep(&m_wheel, m_now);
+    EXPECT_EQ(m_now, ucs_twheel_get_time(&m_wheel));
+
+    add(&timers[0], resolution * 100);
+    advance(timers, m_now + resolution, resolution);
+    EXPECT_EQ(0u, timers[0].expired_time);
+    advance(timers, timers[0].deadline + resolution, resolution);
+    EXPECT_NE(0u, timers[0].expired_time);
+
+    /* same when the wheel holds only a far timer */
+    add(&far, resolution * 500000);
+    m_now += resolution * 1000;
+    ucs_twheel_sweep(&m_wheel, m_now);
+    EXPECT_EQ(m_now, ucs_twheel_get_time(&m_wheel));
+    EXPECT_EQ(0u, far.expired_time);
+
+    add(&timers[0], resolution * 100);
+    advance(timers, m_now + resolution, resolution);
+    EXPECT_EQ(0u, timers[0].expired_time);
+    advance(timers, timers[0].deadline + resolution, resolution);
+    EXPECT_NE(0u, timers[0].expired_time);
+
+    ucs_wtimer_remove(&m_wheel, &far.timer);
+}
+
+UCS_TEST_F(twheel_levels, max_delay) {
+    std::vector<test_timer> timers(1);
+
+    /* longer timers are clamped to the wheel range */
+    add(&timers[0], resolution * UCS_TWHEEL_MAX_TICKS * 2);
+    ucs_twheel_sweep(&m_wheel,
+                     m_now + resolution * (UCS_TWHEEL_MAX_TICKS + 1));
+    EXPECT_NE(0u, timers[0].expired_time);
+}
+
+UCS_TEST_F(twheel_levels, readd_from_callback) {
+    static const int count = 100;
+    struct periodic : test_timer {
+        int expirations;
+    } t;
+
+    struct cb {
+        static void func(ucs_wtimer_t *self) {
+            periodic *p = static_cast<periodic*>(ucs_container_of(self,
+                                                                  test_timer,
+                                                                  timer));
+            if (++p->expirations < count) {
+                ucs_wtimer_add(&p->self->m_wheel, self, resolution * 3);
+            }
+        }
+    };
+
+    t.self        = this;
+    t.expirations = 0;
+    ucs_wtimer_init(&t.timer, cb::func);
+    ucs_wtimer_add(&m_wheel, &t.timer, resolution * 3);
+
+    /* a single late sweep expires the timer once, since it's re-added
+     * relative to the sweep time */
+    m_now += resolution * 1000;
+    ucs_twheel_sweep(&m_wheel, m_now);
+    EXPECT_EQ(1, t.expirations);
+
+    while (t.expirations < count) {
+        m_now += resolution;
+        ucs_twheel_sweep(&m_wheel, m_now);
+    }
+    EXPECT_TRUE(ucs_twheel_is_empty(&m_wheel));
+}
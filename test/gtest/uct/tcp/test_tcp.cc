@@ -255,3 +255,112 @@ UCS_TEST_P(test_uct_tcp, listener_flood_connect_and_close) {
 }
 
 _UCT_INSTANTIATE_TEST_CASE(test_uct_tcp, tcp)
+
+
+class test_uct_tcp_streams : public uct_test {
+public:
+    typedef struct {
+        uct_completion_t uct;
+        ucs_status_t     status;
+    } put_completion_t;
+
+    void init() {
+        modify_config("NUM_STREAMS", "4");
+        modify_config("STRIPE_THRESH", "1k");
+
+        uct_test::init();
+
+        m_err_count = 0;
+        m_sender    = uct_test::create_entity(0, err_handler);
+        m_entities.push_back(m_sender);
+        m_receiver  = uct_test::create_entity(0);
+        m_entities.push_back(m_receiver);
+
+        m_sender->connect(0, *m_receiver, 0);
+    }
+
+    static ucs_status_t err_handler(void *arg, uct_ep_h ep,
+                                    ucs_status_t status) {
+        test_uct_tcp_streams *self = reinterpret_cast<test_uct_tcp_streams*>(arg);
+
+        ++self->m_err_count;
+        return UCS_OK;
+    }
+
+    static void put_comp_cb(uct_completion_t *self, ucs_status_t status) {
+        put_completion_t *comp = ucs_container_of(self, put_completion_t, uct);
+
+        comp->status = status;
+    }
+
+    bool streams_connected(uct_tcp_ep_t *ep) {
+        if (ep->conn_state != UCT_TCP_EP_CONN_STATE_CONNECTED) {
+            return false;
+        }
+
+        for (unsigned i = 0; i < ep->stream.aux_count; ++i) {
+            if ((ep->stream.aux[i] == NULL) ||
+                (ep->stream.aux[i]->conn_state !=
+                 UCT_TCP_EP_CONN_STATE_CONNECTED)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+protected:
+    entity   *m_sender;
+    entity   *m_receiver;
+    unsigned m_err_count;
+};
+
+UCS_TEST_P(test_uct_tcp_streams, aux_stream_failure_during_put) {
+    const size_t length = 1 * UCS_MBYTE;
+    uct_tcp_ep_t *ep    = ucs_derived_of(m_sender->ep(0), uct_tcp_ep_t);
+    put_completion_t comp;
+    ucs_status_t status;
+
+    ASSERT_EQ(3u, ep->stream.aux_count);
+
+    ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0) *
+                                           ucs::test_time_multiplier();
+    while (!streams_connected(ep) && (ucs_get_time() < deadline)) {
+        progress();
+    }
+    ASSERT_TRUE(streams_connected(ep));
+
+    mapped_buffer sendbuf(length, 1, *m_sender);
+    mapped_buffer recvbuf(length, 0, *m_receiver);
+
+    comp.uct.func  = put_comp_cb;
+    comp.uct.count = 1;
+    comp.status    = UCS_OK;
+
+    status = uct_ep_put_zcopy(m_sender->ep(0), sendbuf.iov(), 1,
+                              recvbuf.addr(), recvbuf.rkey(), &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+    ASSERT_TRUE(ep->stream.aux[0]->ctx_caps &
+                UCS_BIT(UCT_TCP_EP_CTX_TYPE_PUT_TX_WAITING_ACK));
+
+    /* Kill an auxiliary stream before its chunk is acknowledged */
+    ASSERT_EQ(0, shutdown(ep->stream.aux[0]->fd, SHUT_RDWR));
+
+    {
+        scoped_log_handler slh(wrap_errors_logger);
+        deadline = ucs_get_time() + ucs_time_from_sec(10.0) *
+                                    ucs::test_time_multiplier();
+        while ((comp.uct.count != 0) && (ucs_get_time() < deadline)) {
+            progress();
+        }
+    }
+
+    /* The operation and the user's EP are failed instead of hanging */
+    ASSERT_EQ(0, comp.uct.count);
+    EXPECT_EQ(UCS_ERR_UNREACHABLE, comp.status);
+    EXPECT_EQ(1u, m_err_count);
+    EXPECT_EQ(UCS_ERR_ENDPOINT_TIMEOUT,
+              uct_ep_flush(m_sender->ep(0), 0, NULL));
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_tcp_streams, tcp)
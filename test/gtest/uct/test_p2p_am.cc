@@ -707,3 +707,54 @@ UCS_TEST_P(uct_p2p_am_tx_bufs, am_tx_max_bufs) {
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_tx_bufs)
+
+class uct_p2p_am_msg_zcopy : public uct_p2p_am_test
+{
+public:
+    uct_p2p_am_msg_zcopy() : uct_p2p_am_test() {
+        ucs_status_t status = uct_config_modify(m_iface_config,
+                                                "MSG_ZEROCOPY_THRESH", "1k");
+        ASSERT_UCS_OK(status);
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_am_msg_zcopy, am_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_AM_ZCOPY,
+                                 UCT_IFACE_FLAG_AM_DUP)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_zcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_zcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_msg_zcopy, tcp)
+
+class uct_p2p_am_edge_triggered : public uct_p2p_am_test
+{
+public:
+    uct_p2p_am_edge_triggered() : uct_p2p_am_test() {
+        ucs_status_t status = uct_config_modify(m_iface_config,
+                                                "EDGE_TRIGGERED", "y");
+        ASSERT_UCS_OK(status);
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_am_edge_triggered, am_bcopy,
+                     !check_caps(UCT_IFACE_FLAG_AM_BCOPY,
+                                 UCT_IFACE_FLAG_AM_DUP)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_bcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_bcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+UCS_TEST_SKIP_COND_P(uct_p2p_am_edge_triggered, am_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_AM_ZCOPY,
+                                 UCT_IFACE_FLAG_AM_DUP)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_am_test::am_zcopy),
+                    0ul,
+                    sender().iface_attr().cap.am.max_zcopy,
+                    TEST_UCT_FLAG_DIR_SEND_TO_RECV);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_edge_triggered, tcp)
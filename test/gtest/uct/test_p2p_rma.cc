@@ -152,3 +152,42 @@ UCS_TEST_SKIP_COND_P(uct_p2p_rma_test, madvise,
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test)
+
+class uct_p2p_rma_msg_zcopy : public uct_p2p_rma_test {
+public:
+    uct_p2p_rma_msg_zcopy() : uct_p2p_rma_test() {
+        ucs_status_t status = uct_config_modify(m_iface_config,
+                                                "MSG_ZEROCOPY_THRESH", "1k");
+        ASSERT_UCS_OK(status);
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_msg_zcopy, put_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_PUT_ZCOPY)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_msg_zcopy, tcp)
+
+class uct_p2p_rma_streams : public uct_p2p_rma_test {
+public:
+    uct_p2p_rma_streams() : uct_p2p_rma_test() {
+        ucs_status_t status = uct_config_modify(m_iface_config,
+                                                "NUM_STREAMS", "4");
+        ASSERT_UCS_OK(status);
+
+        status = uct_config_modify(m_iface_config, "STRIPE_THRESH", "1k");
+        ASSERT_UCS_OK(status);
+    }
+};
+
+UCS_TEST_SKIP_COND_P(uct_p2p_rma_streams, put_zcopy,
+                     !check_caps(UCT_IFACE_FLAG_PUT_ZCOPY)) {
+    test_xfer_multi(static_cast<send_func_t>(&uct_p2p_rma_test::put_zcopy),
+                    0ul, sender().iface_attr().cap.put.max_zcopy,
+                    TEST_UCT_FLAG_SEND_ZCOPY);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_streams, tcp)